@@ -0,0 +1,262 @@
+/**
+ * @file
+ * Bounding volume hierarchy over capsules for ray casting.
+ */
+
+#include "CapsuleBVH.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+constexpr unsigned LeafSize = 4;
+constexpr int StackSize = 64;
+
+inline float Dot3(const float* a, const float* b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/// First root of `t^2 + 2 b t + c` (with `h = b^2 - c`) in [tmin, tmax]
+inline bool FirstRoot(float b, float h, float tmin, float tmax, float& t)
+{
+  if (h < 0.f)
+    return false;
+  float const sq = std::sqrt(h);
+  for (float root : {-b - sq, -b + sq}) {
+    if (root >= tmin && root <= tmax) {
+      t = root;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline bool HitSphere(const float* center, float radius, const float* ro,
+    const float* rd, float tmin, float tmax, float& t)
+{
+  float const oc[3] = {ro[0] - center[0], ro[1] - center[1], ro[2] - center[2]};
+  float const b = Dot3(rd, oc);
+  float const c = Dot3(oc, oc) - radius * radius;
+  return FirstRoot(b, b * b - c, tmin, tmax, t);
+}
+
+/// `rd` must be normalized
+bool HitCapsule(const CapsuleBVH::Capsule& cap, float radius, const float* ro,
+    const float* rd, float tmin, float tmax, float& t)
+{
+  bool hit = false;
+
+  float const ba[3] = {
+      cap.v2[0] - cap.v1[0], cap.v2[1] - cap.v1[1], cap.v2[2] - cap.v1[2]};
+  float const baba = Dot3(ba, ba);
+
+  if (baba > 0.f) {
+    // cylinder body
+    float const oa[3] = {ro[0] - cap.v1[0], ro[1] - cap.v1[1], ro[2] - cap.v1[2]};
+    float const bard = Dot3(ba, rd);
+    float const baoa = Dot3(ba, oa);
+    float const a = baba - bard * bard;
+
+    if (a > 1e-6f * baba) {
+      float const b = (baba * Dot3(rd, oa) - baoa * bard) / a;
+      float const c =
+          (baba * Dot3(oa, oa) - baoa * baoa - radius * radius * baba) / a;
+      float tb;
+      if (FirstRoot(b, b * b - c, tmin, tmax, tb)) {
+        float const y = baoa + tb * bard;
+        if (y >= 0.f && y <= baba) {
+          t = tmax = tb;
+          hit = true;
+        }
+      }
+    }
+
+    // far cap, the near one is tested below
+    if (HitSphere(cap.v2, radius, ro, rd, tmin, tmax, t)) {
+      tmax = t;
+      hit = true;
+    }
+  }
+
+  if (HitSphere(cap.v1, radius, ro, rd, tmin, tmax, t)) {
+    hit = true;
+  }
+
+  return hit;
+}
+
+} // namespace
+
+CapsuleBVH::CapsuleBVH(std::vector<Capsule> capsules)
+    : m_capsules(std::move(capsules))
+{
+  unsigned const n = m_capsules.size();
+  if (!n)
+    return;
+
+  m_order.resize(n);
+  for (unsigned i = 0; i < n; ++i) {
+    m_order[i] = i;
+  }
+
+  m_nodes.reserve(2 * (n / LeafSize + 1));
+  build(0, n);
+}
+
+unsigned CapsuleBVH::build(unsigned start, unsigned count)
+{
+  unsigned const index = m_nodes.size();
+  m_nodes.emplace_back();
+
+  Node node;
+  std::fill_n(node.min, 3, std::numeric_limits<float>::max());
+  std::fill_n(node.max, 3, std::numeric_limits<float>::lowest());
+  float cmin[3], cmax[3];
+  std::copy_n(node.min, 3, cmin);
+  std::copy_n(node.max, 3, cmax);
+
+  for (unsigned i = start; i < start + count; ++i) {
+    auto const& cap = m_capsules[m_order[i]];
+    for (int k = 0; k < 3; ++k) {
+      float const lo = std::min(cap.v1[k], cap.v2[k]);
+      float const hi = std::max(cap.v1[k], cap.v2[k]);
+      node.min[k] = std::min(node.min[k], lo - cap.radius);
+      node.max[k] = std::max(node.max[k], hi + cap.radius);
+      float const center = 0.5f * (lo + hi);
+      cmin[k] = std::min(cmin[k], center);
+      cmax[k] = std::max(cmax[k], center);
+    }
+  }
+
+  int axis = 0;
+  for (int k = 1; k < 3; ++k) {
+    if (cmax[k] - cmin[k] > cmax[axis] - cmin[axis])
+      axis = k;
+  }
+
+  if (count <= LeafSize || !(cmax[axis] > cmin[axis])) {
+    node.start = start;
+    node.count = count;
+    m_nodes[index] = node;
+    return index;
+  }
+
+  unsigned const half = count / 2;
+  auto const first = m_order.begin() + start;
+  std::nth_element(first, first + half, first + count,
+      [this, axis](unsigned a, unsigned b) {
+        auto const& ca = m_capsules[a];
+        auto const& cb = m_capsules[b];
+        return ca.v1[axis] + ca.v2[axis] < cb.v1[axis] + cb.v2[axis];
+      });
+
+  build(start, half); // left child is index + 1
+  node.start = build(start + half, count - half);
+  node.count = 0;
+  m_nodes[index] = node;
+  return index;
+}
+
+bool CapsuleBVH::intersect(const float* origin, const float* dir, float tmin,
+    float tmax, float pad, Hit& hit) const
+{
+  if (m_nodes.empty())
+    return false;
+
+  float const len = std::sqrt(Dot3(dir, dir));
+  if (!(len > 0.f))
+    return false;
+
+  float const rd[3] = {dir[0] / len, dir[1] / len, dir[2] / len};
+  float inv[3];
+  for (int k = 0; k < 3; ++k) {
+    inv[k] = 1.f / rd[k];
+  }
+
+  tmin *= len;
+  float best = tmax * len;
+  bool found = false;
+
+  // entry distance of the ray into a (padded) node box
+  auto enter = [&](const Node& node, float& tnear) {
+    float t0 = tmin, t1 = best;
+    for (int k = 0; k < 3; ++k) {
+      float const lo = node.min[k] - pad;
+      float const hi = node.max[k] + pad;
+      if (rd[k] == 0.f) {
+        if (origin[k] < lo || origin[k] > hi)
+          return false;
+        continue;
+      }
+      float ta = (lo - origin[k]) * inv[k];
+      float tb = (hi - origin[k]) * inv[k];
+      if (ta > tb)
+        std::swap(ta, tb);
+      t0 = std::max(t0, ta);
+      t1 = std::min(t1, tb);
+      if (t0 > t1)
+        return false;
+    }
+    tnear = t0;
+    return true;
+  };
+
+  unsigned stack[StackSize];
+  int sp = 0;
+  float tnear;
+
+  stack[sp++] = 0;
+
+  while (sp) {
+    unsigned const index = stack[--sp];
+    auto const& node = m_nodes[index];
+
+    // tested again since `best` may have shrunk after the push
+    if (!enter(node, tnear))
+      continue;
+
+    if (node.count) {
+      for (unsigned i = node.start; i < node.start + node.count; ++i) {
+        auto const& cap = m_capsules[m_order[i]];
+        float const radius = cap.padded ? cap.radius + pad : cap.radius;
+        float t;
+        if (HitCapsule(cap, radius, origin, rd, tmin, best, t)) {
+          best = t;
+          hit.id = m_order[i];
+          found = true;
+        }
+      }
+      continue;
+    }
+
+    unsigned const left = index + 1, right = node.start;
+    float tleft, tright;
+    bool const hit_left = enter(m_nodes[left], tleft);
+    bool const hit_right = enter(m_nodes[right], tright);
+
+    if (hit_left && hit_right) {
+      // nearer child on top
+      if (tleft < tright) {
+        stack[sp++] = right;
+        stack[sp++] = left;
+      } else {
+        stack[sp++] = left;
+        stack[sp++] = right;
+      }
+    } else if (hit_left) {
+      stack[sp++] = left;
+    } else if (hit_right) {
+      stack[sp++] = right;
+    }
+  }
+
+  if (found) {
+    hit.t = best / len;
+  }
+
+  return found;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file
+ * Bounding volume hierarchy over capsules for ray casting.
+ *
+ * A capsule is a line segment with a radius, which covers spheres
+ * (coincident end points) as well as cylinders with round caps. Nodes are
+ * split at the centroid median of their longest axis and stored depth
+ * first, so the left child of a node always follows it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class CapsuleBVH
+{
+public:
+  struct Capsule {
+    float v1[3];
+    float v2[3];
+    float radius;
+    bool padded; //!< radius grows by the `pad` of a query (e.g. pixel wide lines)
+  };
+
+  struct Hit {
+    std::size_t id; //!< index into the capsules given to the constructor
+    float t;        //!< ray parameter of the hit
+  };
+
+  CapsuleBVH() = default;
+  explicit CapsuleBVH(std::vector<Capsule> capsules);
+
+  const std::vector<Capsule>& capsules() const { return m_capsules; }
+  std::size_t size() const { return m_capsules.size(); }
+
+  /**
+   * Find the nearest capsule along the ray `origin + t * dir`.
+   *
+   * @param origin Ray origin
+   * @param dir Ray direction, doesn't need to be normalized
+   * @param tmin Smallest accepted ray parameter
+   * @param tmax Largest accepted ray parameter
+   * @param pad Extra radius of padded capsules
+   * @param[out] hit Nearest hit
+   * @return false if no capsule is hit within [tmin, tmax]
+   */
+  bool intersect(const float* origin, const float* dir, float tmin, float tmax,
+      float pad, Hit& hit) const;
+
+private:
+  struct Node {
+    float min[3];
+    float max[3];
+    unsigned start; //!< leaf: first entry in m_order, inner: right child
+    unsigned count; //!< leaf: number of capsules, inner: 0
+  };
+
+  unsigned build(unsigned start, unsigned count);
+
+  std::vector<Capsule> m_capsules;
+  std::vector<unsigned> m_order;
+  std::vector<Node> m_nodes;
+};
@@ -104,6 +104,14 @@ PyObject *FieldAsPyList(PyMOLGlobals * G, CField * I)
   PyList_SetItem(result, 4, PConvIntArrayToPyList((int *) I->dim.data(), I->n_dim()));
   PyList_SetItem(result, 5, PConvIntArrayToPyList((int *) I->stride.data(), I->n_dim()));
   n_elem = I->data.size() / I->base_size;
+  if (I->type == cFieldInt || I->type == cFieldFloat) {
+    if (PyObject* ref = PConvSessionSectionToPyRef(G,
+            pymol::SessionSection::FieldData, I->type, I->data.data(),
+            I->data.size())) {
+      PyList_SetItem(result, 6, ref);
+      return result;
+    }
+  }
   switch (I->type) {
   case cFieldInt:
     PyList_SetItem(result, 6, PConvIntArrayToPyList((int *) I->data.data(), n_elem, dump_binary));
@@ -129,6 +137,31 @@ CField *FieldNewFromPyList_From_List(PyMOLGlobals * G, PyObject * list, int el){
   return ret;
 }
 
+/**
+ * True if dimensions, strides and element size of a field which was read
+ * from a session describe a dense array of `nbytes` bytes
+ */
+static bool FieldCheckLayout(const CField* I, int n_dim, size_t nbytes)
+{
+  if (I->n_dim() != n_dim || I->stride.size() != I->dim.size() ||
+      I->base_size != (I->type == cFieldInt ? sizeof(int) : sizeof(float))) {
+    return false;
+  }
+
+  size_t local_stride = I->base_size;
+  for (int a = n_dim - 1; a >= 0; a--) {
+    if (I->stride[a] != local_stride) {
+      return false;
+    }
+    local_stride *= I->dim[a];
+    if (local_stride > nbytes) {
+      return false;
+    }
+  }
+
+  return local_stride == nbytes;
+}
+
 CField *FieldNewFromPyList(PyMOLGlobals * G, PyObject * list)
 {
   int ok = true;
@@ -156,7 +189,19 @@ CField *FieldNewFromPyList(PyMOLGlobals * G, PyObject * list)
   /* TO SUPPORT BACKWARDS COMPATIBILITY...
      Always check ll when adding new PyList_GetItem's */
 
-  if(ok) {
+  const pymol::SessionFile::Section* section = nullptr;
+  if(ok)
+    section = PConvPyRefToSessionSection(
+        G, PyList_GetItem(list, 6), pymol::SessionSection::FieldData);
+
+  if(section) {
+    ok = section->version == unsigned(I->type) &&
+         FieldCheckLayout(I, n_dim, section->size);
+    if (ok) {
+      auto const* src = static_cast<const unsigned char*>(section->data);
+      I->data.assign(src, src + section->size);
+    }
+  } else if(ok) {
     switch (I->type) {
     case cFieldInt:
       {
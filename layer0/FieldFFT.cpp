@@ -0,0 +1,252 @@
+/**
+ * @file
+ * Reciprocal space (FFT) operations on 3D scalar fields
+ *
+ * Based on the bundled pocketfft (contrib/pocketfft).
+ */
+
+#include "FieldFFT.h"
+#include "Field.h"
+#include "Matrix.h"
+#include "Vector.h"
+
+#include "pocketfft_hdronly.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Real space field, padded to FFT friendly dimensions, and its half-complex
+ * spectrum (last axis has n[2] / 2 + 1 entries).
+ */
+struct FieldSpectrum {
+  std::size_t dim[3]{}; //!< field dimensions
+  std::size_t n[3]{};   //!< transform dimensions
+  std::size_t nc{};     //!< n[2] / 2 + 1
+  double metric[9]{};   //!< |s|^2 = u^T metric u, with u_i = freq_i / n_i
+  std::vector<float> real;
+  std::vector<std::complex<float>> recip;
+
+  pocketfft::shape_t shape() const { return {n[0], n[1], n[2]}; }
+  pocketfft::stride_t realStride() const
+  {
+    return {std::ptrdiff_t(n[1] * n[2] * sizeof(float)),
+        std::ptrdiff_t(n[2] * sizeof(float)), std::ptrdiff_t(sizeof(float))};
+  }
+  pocketfft::stride_t recipStride() const
+  {
+    using C = std::complex<float>;
+    return {std::ptrdiff_t(n[1] * nc * sizeof(C)),
+        std::ptrdiff_t(nc * sizeof(C)), std::ptrdiff_t(sizeof(C))};
+  }
+
+  /// Squared reciprocal length |s|^2 of spectrum element (a, b, c)
+  double s2(std::size_t a, std::size_t b, std::size_t c) const
+  {
+    double const u[3] = {signedFreq(a, n[0]) / double(n[0]),
+        signedFreq(b, n[1]) / double(n[1]), double(c) / double(n[2])};
+    double r = 0.0;
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        r += u[i] * metric[i * 3 + j] * u[j];
+    return r;
+  }
+
+  /// Multiplicity of spectrum element in the full (hermitian) spectrum
+  int weight(std::size_t c) const
+  {
+    return (c == 0 || (n[2] % 2 == 0 && c == n[2] / 2)) ? 1 : 2;
+  }
+
+  static long signedFreq(std::size_t k, std::size_t n)
+  {
+    return (k <= n / 2) ? long(k) : long(k) - long(n);
+  }
+};
+
+/**
+ * Reciprocal metric inv(M) * inv(M)^T for step matrix M.
+ */
+void ReciprocalMetric(const float* step, double* metric)
+{
+  double m[9], inv[9];
+  std::copy_n(step, 9, m);
+  xx_matrix_invert(inv, m, 3);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j) {
+      double sum = 0.0;
+      for (int k = 0; k < 3; ++k)
+        sum += inv[i * 3 + k] * inv[j * 3 + k];
+      metric[i * 3 + j] = sum;
+    }
+}
+
+/**
+ * Number of padding grid points needed to contain a kernel of `width`
+ * Angstrom along the shortest step.
+ */
+std::size_t PaddingForWidth(const float* step, float width)
+{
+  float shortest = 0.f;
+  for (int j = 0; j < 3; ++j) {
+    float const len = std::sqrt(step[j] * step[j] + step[3 + j] * step[3 + j] +
+                                step[6 + j] * step[6 + j]);
+    if (len > 0.f && (shortest == 0.f || len < shortest))
+      shortest = len;
+  }
+  if (shortest == 0.f)
+    return 2;
+  return std::max<std::size_t>(2, std::size_t(std::ceil(width / shortest)));
+}
+
+/**
+ * Copies the field into a (padded) real space buffer. The padding is filled
+ * with the field mean.
+ */
+void SpectrumLoad(FieldSpectrum& spec, const CField* field,
+    const FieldFFTGrid& grid, std::size_t pad)
+{
+  for (int i = 0; i < 3; ++i) {
+    spec.dim[i] = field->dim[i];
+    if (grid.periodic && spec.dim[i] > 1) {
+      spec.n[i] = spec.dim[i] - 1;
+    } else {
+      spec.n[i] = pocketfft::detail::util::good_size_real(spec.dim[i] + 2 * pad);
+    }
+  }
+  spec.nc = spec.n[2] / 2 + 1;
+  ReciprocalMetric(grid.step, spec.metric);
+
+  std::size_t const ca = std::min(spec.dim[0], spec.n[0]);
+  std::size_t const cb = std::min(spec.dim[1], spec.n[1]);
+  std::size_t const cc = std::min(spec.dim[2], spec.n[2]);
+
+  double sum = 0.0;
+  for (std::size_t a = 0; a < ca; ++a)
+    for (std::size_t b = 0; b < cb; ++b)
+      for (std::size_t c = 0; c < cc; ++c)
+        sum += Ffloat3(field, a, b, c);
+  float const mean = float(sum / double(ca * cb * cc));
+
+  spec.real.assign(spec.n[0] * spec.n[1] * spec.n[2], mean);
+
+  for (std::size_t a = 0; a < ca; ++a)
+    for (std::size_t b = 0; b < cb; ++b) {
+      float* dst = spec.real.data() + (a * spec.n[1] + b) * spec.n[2];
+      for (std::size_t c = 0; c < cc; ++c)
+        dst[c] = Ffloat3(field, a, b, c);
+    }
+}
+
+void SpectrumForward(FieldSpectrum& spec, int nthreads)
+{
+  spec.recip.resize(spec.n[0] * spec.n[1] * spec.nc);
+  pocketfft::r2c<float>(spec.shape(), spec.realStride(), spec.recipStride(),
+      {0, 1, 2}, pocketfft::FORWARD, spec.real.data(), spec.recip.data(), 1.f,
+      std::max(1, nthreads));
+}
+
+void SpectrumBackward(FieldSpectrum& spec, int nthreads)
+{
+  float const norm = 1.f / float(spec.n[0] * spec.n[1] * spec.n[2]);
+  pocketfft::c2r<float>(spec.shape(), spec.recipStride(), spec.realStride(),
+      {0, 1, 2}, pocketfft::BACKWARD, spec.recip.data(), spec.real.data(),
+      norm, std::max(1, nthreads));
+}
+
+/**
+ * Copies the real space buffer back into the field. For periodic fields, the
+ * redundant last plane along each axis is filled by wrapping around.
+ */
+void SpectrumStore(const FieldSpectrum& spec, CField* field)
+{
+  for (std::size_t a = 0; a < spec.dim[0]; ++a)
+    for (std::size_t b = 0; b < spec.dim[1]; ++b) {
+      const float* src = spec.real.data() +
+                         ((a % spec.n[0]) * spec.n[1] + (b % spec.n[1])) *
+                             spec.n[2];
+      for (std::size_t c = 0; c < spec.dim[2]; ++c)
+        Ffloat3(field, a, b, c) = src[c % spec.n[2]];
+    }
+}
+
+} // namespace
+
+void FieldFFTFilter(CField* field, const FieldFFTGrid& grid, float bfactor,
+    float resolution, int nthreads)
+{
+  // real space width of the Gaussian kernel: sigma^2 = |B| / (8 pi^2)
+  float const sigma = std::sqrt(std::fabs(bfactor) / float(8.0 * cPI * cPI));
+  float const width = std::max(3.f * sigma, resolution);
+
+  FieldSpectrum spec;
+  SpectrumLoad(spec, field, grid, PaddingForWidth(grid.step, width));
+  SpectrumForward(spec, nthreads);
+
+  double const s2max =
+      (resolution > 0.f) ? 1.0 / (double(resolution) * resolution) : -1.0;
+  double const quarter_b = bfactor / 4.0;
+  long const n0 = spec.n[0];
+
+#pragma omp parallel for
+  for (long a = 0; a < n0; ++a) {
+    for (std::size_t b = 0; b < spec.n[1]; ++b) {
+      auto* row = spec.recip.data() + (a * spec.n[1] + b) * spec.nc;
+      for (std::size_t c = 0; c < spec.nc; ++c) {
+        double const s2 = spec.s2(a, b, c);
+        if (s2max > 0.0 && s2 > s2max) {
+          row[c] = 0.f;
+        } else if (quarter_b != 0.0) {
+          row[c] *= float(std::exp(-quarter_b * s2));
+        }
+      }
+    }
+  }
+
+  SpectrumBackward(spec, nthreads);
+  SpectrumStore(spec, field);
+}
+
+double FieldFFTCorrelation(const CField* field1, const CField* field2,
+    const FieldFFTGrid& grid, float resolution, int nthreads)
+{
+  FieldSpectrum spec1, spec2;
+  std::size_t const pad = grid.periodic ? 0 : 2;
+  SpectrumLoad(spec1, field1, grid, pad);
+  SpectrumLoad(spec2, field2, grid, pad);
+  SpectrumForward(spec1, nthreads);
+  SpectrumForward(spec2, nthreads);
+
+  double const s2max =
+      (resolution > 0.f) ? 1.0 / (double(resolution) * resolution) : -1.0;
+  double sum12 = 0.0, sum11 = 0.0, sum22 = 0.0;
+  long const n0 = spec1.n[0];
+
+#pragma omp parallel for reduction(+ : sum12, sum11, sum22)
+  for (long a = 0; a < n0; ++a) {
+    for (std::size_t b = 0; b < spec1.n[1]; ++b) {
+      std::size_t const offset = (a * spec1.n[1] + b) * spec1.nc;
+      for (std::size_t c = 0; c < spec1.nc; ++c) {
+        if (a == 0 && b == 0 && c == 0)
+          continue; // F000 (mean) does not contribute
+        if (s2max > 0.0 && spec1.s2(a, b, c) > s2max)
+          continue;
+        auto const& f1 = spec1.recip[offset + c];
+        auto const& f2 = spec2.recip[offset + c];
+        int const w = spec1.weight(c);
+        sum12 += w * double(std::real(f1 * std::conj(f2)));
+        sum11 += w * double(std::norm(f1));
+        sum22 += w * double(std::norm(f2));
+      }
+    }
+  }
+
+  if (sum11 <= 0.0 || sum22 <= 0.0)
+    return 0.0;
+  return sum12 / std::sqrt(sum11 * sum22);
+}
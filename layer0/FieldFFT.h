@@ -0,0 +1,48 @@
+/**
+ * @file
+ * Reciprocal space (FFT) operations on 3D scalar fields
+ *
+ * Based on the bundled pocketfft (contrib/pocketfft).
+ */
+
+#pragma once
+
+struct CField;
+
+/**
+ * Grid geometry needed to map FFT frequency indices to reciprocal space.
+ */
+struct FieldFFTGrid {
+  /// Row-major 3x3 matrix whose columns are the real space step vectors
+  /// between adjacent grid points along each field axis.
+  float step[9];
+  /// If true, the field covers exactly one period (e.g. a full unit cell
+  /// with the redundant last plane along each axis) and no padding is used.
+  bool periodic = false;
+};
+
+/**
+ * Applies a reciprocal space filter F(s) *= exp(-B s^2 / 4), optionally
+ * truncated at 1/resolution. Positive B blurs (Gaussian), negative B sharpens.
+ *
+ * Non-periodic fields are padded with their mean value to reduce wrap-around
+ * artifacts.
+ *
+ * @param field 3D float field, modified in place
+ * @param grid grid geometry
+ * @param bfactor B-factor in Angstrom^2
+ * @param resolution low-pass cutoff in Angstrom (0 = no cutoff)
+ * @param nthreads number of threads for the transforms
+ */
+void FieldFFTFilter(CField* field, const FieldFFTGrid& grid, float bfactor,
+    float resolution, int nthreads);
+
+/**
+ * Correlation coefficient of two fields with identical dimensions, computed
+ * from their Fourier coefficients (excluding F000). With a positive
+ * resolution, only terms with d >= resolution contribute.
+ *
+ * @return correlation coefficient, or 0 if either field is flat
+ */
+double FieldFFTCorrelation(const CField* field1, const CField* field2,
+    const FieldFFTGrid& grid, float resolution, int nthreads);
@@ -30,6 +30,10 @@ Z* -------------------------------------------------------------------
 
 #include "PyMOLGlobals.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
 #ifndef int2
 typedef int int2[2];
 #endif
@@ -367,30 +371,276 @@ int MatchMatrixFromFile(CMatch * I, const char *fname, int quiet)
   return (ok);
 }
 
+/**
+ * First index of the maximum of `values[i] + penalty[i]` for i in [0, n).
+ *
+ * @param[out] max_value The maximum
+ * @return index or -1 if n < 1
+ */
+static int MatchArgMax(const float* values, const float* penalty, int n,
+    float& max_value)
+{
+  float mx = -FLT_MAX;
+
+#pragma omp simd reduction(max : mx)
+  for (int i = 0; i < n; ++i) {
+    mx = std::max(mx, values[i] + penalty[i]);
+  }
+
+  for (int i = 0; i < n; ++i) {
+    if (values[i] + penalty[i] == mx) {
+      max_value = mx;
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+namespace
+{
+struct MatchAlignContext {
+  int na, nb;
+  float gap_penalty, ext_penalty;
+  int max_gap, max_skip, window;
+  float ante;
+  const float* const* mat;
+  const float* const* da;
+  const float* const* db;
+  float** score;
+  float** scoreT;   //!< transposed copy of `score` for column scans
+  int2** point;
+  const float* pen; //!< gap penalty by gap length (0 for no gap)
+};
+} // namespace
+
+/**
+ * Find the best next step from cell (a, b) and store the cumulative score.
+ * Only reads cells (f, g) with f > a and g > b.
+ */
+static void MatchAlignCell(const MatchAlignContext& C, int a, int b)
+{
+  const float MIN_SCORE = 0.0F;
+  int const na = C.na, nb = C.nb;
+  int const nf = na + 1, ng = nb + 1;
+  float const gap_penalty = C.gap_penalty, ext_penalty = C.ext_penalty;
+  int const window = C.window;
+  float const ante = C.ante;
+  auto const da = C.da;
+  auto const db = C.db;
+  auto const score = C.score;
+  auto const point = C.point;
+  int f, g, sf, sg, gap;
+  float tst = 0.0;
+
+  /* find the maximum scoring cell accessible from this position, 
+   * while taking gap penalties into account */
+
+  float mxv = MIN_SCORE;
+  int mxa = -1;
+  int mxb = -1;
+
+  /* search for asymmetric insertions and deletions */
+  f = a + 1;
+  /* no limit for the first cell */
+  if((C.max_gap >= 0) && !((a == na - 1) && (b == nb - 1))) {
+    sf = a + 2 + C.max_gap;
+    sg = b + 2 + C.max_gap;
+    if(sg > ng)
+      sg = ng;
+    if(sf > nf)
+      sf = nf;
+  } else {
+    sg = ng;
+    sf = nf;
+  }
+
+  if(!window) {
+    /* cells at the end have zero score and no penalty, so they can't
+       win, and the remaining candidates are contiguous in memory */
+    if(f < na) {
+      int i = MatchArgMax(score[f] + b + 1, C.pen, std::min(sg, nb) - (b + 1), tst);
+      if((i >= 0) && (tst > mxv)) {
+        mxv = tst;
+        mxa = f;
+        mxb = b + 1 + i;
+      }
+    }
+
+    g = b + 1;
+
+    if(g < nb) {
+      int i = MatchArgMax(C.scoreT[g] + a + 1, C.pen, std::min(sf, na) - (a + 1), tst);
+      if((i >= 0) && (tst > mxv)) {
+        mxv = tst;
+        mxa = a + 1 + i;
+        mxb = g;
+      }
+    }
+
+    if(C.max_skip > 0) {
+      /* search for high scoring mismatched stretches (only the last
+         column of the stretch is considered, with mxb one past it) */
+      sf = a + 1 + C.max_skip;
+      sg = b + 1 + C.max_skip;
+      if(sf > nf)
+        sf = nf;
+      if(sg > ng)
+        sg = ng;
+
+      g = sg - 1;
+
+      for(f = a + 1; f < sf; f++) {
+        tst = score[f][g];
+
+        /* only penalize if we are not at the end */
+        if(!((f == na) || (g == nb))) {
+          gap = ((f - (a + 1)) + (g - (b + 1)));
+          if(gap > 1)
+            tst += 2 * gap_penalty + ext_penalty * (gap - 2);
+        }
+        if(tst > mxv) {
+          mxv = tst;
+          mxa = f;
+          mxb = sg;
+        }
+      }
+    }
+  } else {
+    for(g = b + 1; g < sg; g++) {
+      tst = score[f][g];
+
+      {
+        int aa = a, bb = b, ff = f, gg = g, cc;
+        tst += ante;
+        for(cc = 0; cc < window; cc++) {
+          if((ff >= 0) && (gg >= 0) && (ff < na) && (gg < nb)) {
+            tst -= (float) fabs(da[a][ff] - db[b][gg]);
+            aa = ff;
+            bb = gg;
+            ff = point[aa][bb][0];
+            gg = point[aa][bb][1];
+          } else
+            break;
+        }
+      }
+
+      if(!((f == na) || (g == nb))) {
+        gap = g - (b + 1);
+        if(gap)
+          tst += gap_penalty + ext_penalty * (gap - 1);
+      }
+      if(tst > mxv) {
+        mxv = tst;
+        mxa = f;
+        mxb = g;
+      }
+    }
+    g = b + 1;
+
+    for(f = a + 1; f < sf; f++) {
+      tst = score[f][g];
+
+      {
+        int aa = a, bb = b, ff = f, gg = g, cc;
+        tst += ante;
+        for(cc = 0; cc < window; cc++) {
+          if((ff >= 0) && (gg >= 0) && (ff < na) && (gg < nb)) {
+            tst -= (float) fabs(da[a][ff] - db[b][gg]);
+            aa = ff;
+            bb = gg;
+            ff = point[aa][bb][0];
+            gg = point[aa][bb][1];
+          } else
+            break;
+        }
+      }
+
+      if(!((f == na) || (g == nb))) {
+        gap = (f - (a + 1));
+        if(gap)
+          tst += gap_penalty + ext_penalty * (gap - 1);
+      }
+      if(tst > mxv) {
+        mxv = tst;
+        mxa = f;
+        mxb = g;
+      }
+    }
+
+    if(C.max_skip) {
+      /* search for high scoring mismatched stretches */
+
+      sf = a + 1 + C.max_skip;
+      sg = b + 1 + C.max_skip;
+      if(sf > nf)
+        sf = nf;
+      if(sg > ng)
+        sg = ng;
+
+      for(f = a + 1; f < sf; f++) {
+        for(g = b + 1; g < sg; g++) {
+          tst = score[f][g];
+
+          {
+            int aa = a, bb = b, ff = f, gg = g, cc;
+            tst += ante;
+            for(cc = 0; cc < window; cc++) {
+              if((ff >= 0) && (gg >= 0) && (ff < na) && (gg < nb)) {
+                tst -= (float) fabs(da[a][ff] - db[b][gg]);
+                aa = ff;
+                bb = gg;
+                ff = point[aa][bb][0];
+                gg = point[aa][bb][1];
+              } else
+                break;
+            }
+          }
+
+          /* only penalize if we are not at the end */
+          if(!((f == na) || (g == nb))) {
+            gap = ((f - (a + 1)) + (g - (b + 1)));
+            if(gap > 1)
+              tst += 2 * gap_penalty + ext_penalty * (gap - 2);
+          }
+        }
+        if(tst > mxv) {
+          mxv = tst;
+          mxa = f;
+          mxb = g;
+        }
+      }
+    }
+  }
+
+  /* store what the best next step is */
+
+  point[a][b][0] = mxa;
+  point[a][b][1] = mxb;
+
+  /* and store the cumulative score for this cell */
+  score[a][b] = C.scoreT[b][a] = mxv + C.mat[a][b];
+}
+
 int MatchAlign(CMatch * I, float gap_penalty, float ext_penalty,
                int max_gap, int max_skip, int quiet, int window, float ante)
 {
   PyMOLGlobals *G = I->G;
   int a, b, f, g;
   int nf, ng;
-  int sf, sg;
-  float **score;
-  float **da, **db;
+  float **score, **scoreT;
   int na = I->na, nb = I->nb;
   unsigned int dim[2];
   int2 **point;
   float mxv;
   int mxa, mxb;
   float tst = 0.0;
-  int gap = 0;
   int *p;
   int cnt;
   int ok = true;
   const float MIN_SCORE = 0.0F;
   nf = na + 1;
   ng = nb + 1;
-  da = I->da;
-  db = I->db;
   if(!quiet) {
     PRINTFB(G, FB_Match, FB_Actions)
       " MatchAlign: aligning residues (%d vs %d)...\n", na, nb ENDFB(G);
@@ -401,156 +651,41 @@ int MatchAlign(CMatch * I, float gap_penalty, float ext_penalty,
   VLAFreeP(I->pair);
   score = (float **) UtilArrayCalloc(dim, 2, sizeof(float));
   point = (int2 **) UtilArrayCalloc(dim, 2, sizeof(int2));
-  if(score && point) {
+  dim[0] = ng;
+  dim[1] = nf;
+  scoreT = (float **) UtilArrayCalloc(dim, 2, sizeof(float));
+  std::vector<float> pen(std::max(nf, ng));
+  if(score && point && scoreT) {
 
     /* initialize the scoring matrix */
     for(f = 0; f < nf; f++) {
       for(g = 0; g < ng; g++) {
         score[f][g] = MIN_SCORE;
+        scoreT[g][f] = MIN_SCORE;
         point[f][g][0] = -1;
         point[f][g][1] = -1;
       }
     }
-    /* now start walking backwards up the alignment */
-    {
-      int second_pass = false;
-      for(b = nb - 1; b >= 0; b--) {
-        for(a = na - 1; a >= 0; a--) {
-          /* find the maximum scoring cell accessible from this position, 
-           * while taking gap penalties into account */
-
-          mxv = MIN_SCORE;
-          mxa = -1;
-          mxb = -1;
-
-          /* search for asymmetric insertions and deletions */
-          f = a + 1;
-          if((max_gap >= 0) && (second_pass)) {
-            sf = a + 2 + max_gap;
-            sg = b + 2 + max_gap;
-            if(sg > ng)
-              sg = ng;
-            if(sf > nf)
-              sf = nf;
-          } else {
-            sg = ng;
-            sf = nf;
-          }
-          for(g = b + 1; g < sg; g++) {
-            tst = score[f][g];
-
-            if(window) {
-              int aa = a, bb = b, ff = f, gg = g, cc;
-              tst += ante;
-              for(cc = 0; cc < window; cc++) {
-                if((ff >= 0) && (gg >= 0) && (ff < na) && (gg < nb)) {
-                  tst -= (float) fabs(da[a][ff] - db[b][gg]);
-                  aa = ff;
-                  bb = gg;
-                  ff = point[aa][bb][0];
-                  gg = point[aa][bb][1];
-                } else
-                  break;
-              }
-            }
-
-            if(!((f == na) || (g == nb))) {
-              gap = g - (b + 1);
-              if(gap)
-                tst += gap_penalty + ext_penalty * (gap - 1);
-            }
-            if(tst > mxv) {
-              mxv = tst;
-              mxa = f;
-              mxb = g;
-            }
-          }
-          g = b + 1;
-
-          for(f = a + 1; f < sf; f++) {
-            tst = score[f][g];
-
-            if(window) {
-              int aa = a, bb = b, ff = f, gg = g, cc;
-              tst += ante;
-              for(cc = 0; cc < window; cc++) {
-                if((ff >= 0) && (gg >= 0) && (ff < na) && (gg < nb)) {
-                  tst -= (float) fabs(da[a][ff] - db[b][gg]);
-                  aa = ff;
-                  bb = gg;
-                  ff = point[aa][bb][0];
-                  gg = point[aa][bb][1];
-                } else
-                  break;
-              }
-            }
-
-            if(!((f == na) || (g == nb))) {
-              gap = (f - (a + 1));
-              if(gap)
-                tst += gap_penalty + ext_penalty * (gap - 1);
-            }
-            if(tst > mxv) {
-              mxv = tst;
-              mxa = f;
-              mxb = g;
-            }
-          }
-
-          if(max_skip) {
-            /* search for high scoring mismatched stretches */
-
-            sf = a + 1 + max_skip;
-            sg = b + 1 + max_skip;
-            if(sf > nf)
-              sf = nf;
-            if(sg > ng)
-              sg = ng;
-
-            for(f = a + 1; f < sf; f++) {
-              for(g = b + 1; g < sg; g++) {
-                tst = score[f][g];
-
-                if(window) {
-                  int aa = a, bb = b, ff = f, gg = g, cc;
-                  tst += ante;
-                  for(cc = 0; cc < window; cc++) {
-                    if((ff >= 0) && (gg >= 0) && (ff < na) && (gg < nb)) {
-                      tst -= (float) fabs(da[a][ff] - db[b][gg]);
-                      aa = ff;
-                      bb = gg;
-                      ff = point[aa][bb][0];
-                      gg = point[aa][bb][1];
-                    } else
-                      break;
-                  }
-                }
-
-                /* only penalize if we are not at the end */
-                if(!((f == na) || (g == nb))) {
-                  gap = ((f - (a + 1)) + (g - (b + 1)));
-                  if(gap > 1)
-                    tst += 2 * gap_penalty + ext_penalty * (gap - 2);
-                }
-              }
-              if(tst > mxv) {
-                mxv = tst;
-                mxa = f;
-                mxb = g;
-              }
-            }
-          }
-
-          /* store what the best next step is */
-
-          point[a][b][0] = mxa;
-          point[a][b][1] = mxb;
 
-          /* and store the cumulative score for this cell */
-          score[a][b] = mxv + I->mat[a][b];
+    /* gap penalties by gap length */
+    for(int gap = 1; gap < int(pen.size()); gap++) {
+      pen[gap] = gap_penalty + ext_penalty * (gap - 1);
+    }
 
-          second_pass = true;
-        }
+    MatchAlignContext const ctx = {na, nb, gap_penalty, ext_penalty, max_gap,
+        max_skip, window, ante, I->mat, I->da, I->db, score, scoreT, point,
+        pen.data()};
+
+    /* now start walking backwards up the alignment. Cells only depend on
+       cells with larger indices, so each anti-diagonal can be done in
+       parallel. */
+#pragma omp parallel if ((size_t) na * nb > 10000)
+    for(int d = na + nb - 2; d >= 0; d--) {
+      int const a_begin = std::max(0, d - (nb - 1));
+      int const a_end = std::min(na - 1, d);
+#pragma omp for schedule(static)
+      for(int a = a_begin; a <= a_end; a++) {
+        MatchAlignCell(ctx, a, d - a);
       }
     }
 
@@ -601,9 +736,10 @@ int MatchAlign(CMatch * I, float gap_penalty, float ext_penalty,
     I->score = mxv;
     I->n_pair = cnt;
     VLASize(I->pair, int, (p - I->pair));
-    FreeP(score);
-    FreeP(point);
   }
+  FreeP(score);
+  FreeP(scoreT);
+  FreeP(point);
   return (ok);
 }
 
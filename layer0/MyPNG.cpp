@@ -31,6 +31,10 @@ Z* -------------------------------------------------------------------
 
 #ifdef _PYMOL_LIBPNG
 #include<png.h>
+#include<zlib.h>
+
+#include <algorithm>
+#include <cstdlib>
 
 
 /* The png_jmpbuf() macro, used in error handling, became available in
@@ -167,11 +171,204 @@ static void write_data_to_file(
   auto fp = static_cast<FILE*>(png_get_io_ptr(png_ptr));
   fwrite(buffer, 1, count, fp);
 }
+
+/**
+ * Apply PNG filter `type` to one row.
+ * @return Sum of absolute values of the filtered bytes
+ */
+static unsigned MyPNGFilterApply(int type, const unsigned char* row,
+    const unsigned char* prev, size_t rowbytes, unsigned char* dst)
+{
+  const size_t bpp = 4;
+  unsigned sum = 0;
+
+  auto store = [&](size_t i, int pred) {
+    unsigned char const v = row[i] - pred;
+    dst[i] = v;
+    sum += (v < 128) ? v : 256 - v;
+  };
+
+  switch (type) {
+  case 0:
+    for (size_t i = 0; i < rowbytes; ++i)
+      store(i, 0);
+    break;
+  case 1:
+    for (size_t i = 0; i < rowbytes; ++i)
+      store(i, i < bpp ? 0 : row[i - bpp]);
+    break;
+  case 2:
+    for (size_t i = 0; i < rowbytes; ++i)
+      store(i, prev[i]);
+    break;
+  case 3:
+    for (size_t i = 0; i < rowbytes; ++i)
+      store(i, ((i < bpp ? 0 : row[i - bpp]) + prev[i]) / 2);
+    break;
+  case 4:
+    for (size_t i = 0; i < rowbytes; ++i) {
+      int const a = i < bpp ? 0 : row[i - bpp];
+      int const b = prev[i];
+      int const c = i < bpp ? 0 : prev[i - bpp];
+      int const pa = std::abs(b - c), pb = std::abs(a - c),
+                pc = std::abs(a + b - 2 * c);
+      store(i, (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c);
+    }
+    break;
+  }
+
+  return sum;
+}
+
+/**
+ * Filter one row (RGBA, 4 bytes per pixel) into `out`, which receives the
+ * filter type byte followed by `rowbytes` filtered bytes.
+ *
+ * @param prev Previous row or nullptr for the first row of the image
+ * @param fast Always use the Up filter, otherwise pick the filter with the
+ * smallest sum of absolute values like libpng does
+ * @param scratch Buffer of `rowbytes` bytes
+ */
+static void MyPNGFilterRow(const unsigned char* row, const unsigned char* prev,
+    size_t rowbytes, bool fast, unsigned char* out, unsigned char* scratch)
+{
+  if (!prev) {
+    // Sub is the only filter which doesn't need the previous row
+    out[0] = fast ? 0 : 1;
+    MyPNGFilterApply(out[0], row, prev, rowbytes, out + 1);
+    return;
+  }
+
+  if (fast) {
+    out[0] = 2;
+    MyPNGFilterApply(2, row, prev, rowbytes, out + 1);
+    return;
+  }
+
+  out[0] = 0;
+  unsigned best = MyPNGFilterApply(0, row, prev, rowbytes, out + 1);
+  for (int type = 1; type <= 4 && best; ++type) {
+    unsigned const sum = MyPNGFilterApply(type, row, prev, rowbytes, scratch);
+    if (sum < best) {
+      best = sum;
+      out[0] = type;
+      std::copy_n(scratch, rowbytes, out + 1);
+    }
+  }
+}
+
+/**
+ * Filter and deflate the image into a zlib stream for the IDAT chunks.
+ *
+ * Bands of rows are compressed independently as raw deflate streams, each
+ * primed with the last 32K of the previous band as dictionary. All but the
+ * last band end with a sync flush so they concatenate into one stream.
+ *
+ * @param image RGBA pixels, bottom row first
+ */
+static bool MyPNGDeflate(const unsigned char* image, size_t width,
+    size_t height, const MyPNGEncoding& encoding, std::vector<unsigned char>& zdata)
+{
+  const size_t window = 32768;
+  const size_t band_min = 1 << 18; // bytes, smaller bands compress worse
+  size_t const rowbytes = width * 4;
+  size_t const linebytes = rowbytes + 1;
+
+  // PNG row `y` from the bottom-up image
+  auto get_row = [&](size_t y) -> const unsigned char* {
+    return image + (height - 1 - y) * rowbytes;
+  };
+
+  size_t const n_threads = std::max(1, encoding.n_threads);
+  size_t band_rows = (height + n_threads - 1) / n_threads;
+  band_rows = std::max(band_rows, (band_min + linebytes - 1) / linebytes);
+  band_rows = std::max<size_t>(band_rows, 1);
+  int const n_band = (height + band_rows - 1) / band_rows;
+
+  int const level = encoding.fast ? 1 : Z_DEFAULT_COMPRESSION;
+  int const strategy = encoding.fast ? Z_RLE : Z_FILTERED;
+
+  std::vector<std::vector<unsigned char>> bands(n_band);
+  std::vector<uLong> adlers(n_band);
+  std::vector<uLong> lengths(n_band);
+  bool ok = true;
+
+#pragma omp parallel for schedule(dynamic) num_threads(n_threads) if (n_band > 1) \
+    reduction(&& : ok)
+  for (int b = 0; b < n_band; ++b) {
+    size_t const y0 = b * band_rows;
+    size_t const y1 = std::min(height, y0 + band_rows);
+
+    // dictionary rows at the end of the previous band
+    size_t const dict_rows =
+        b ? std::min(y0, (window + linebytes - 1) / linebytes) : 0;
+    size_t const start = y0 - dict_rows;
+
+    std::vector<unsigned char> raw((y1 - start) * linebytes);
+    std::vector<unsigned char> scratch(rowbytes);
+    for (size_t y = start; y < y1; ++y) {
+      MyPNGFilterRow(get_row(y), y ? get_row(y - 1) : nullptr, rowbytes,
+          encoding.fast, raw.data() + (y - start) * linebytes, scratch.data());
+    }
+
+    const unsigned char* input = raw.data() + dict_rows * linebytes;
+    size_t const input_len = (y1 - y0) * linebytes;
+    lengths[b] = input_len;
+    adlers[b] = adler32(adler32(0L, Z_NULL, 0), input, input_len);
+
+    z_stream strm{};
+    if (deflateInit2(&strm, level, Z_DEFLATED, -15, 8, strategy) != Z_OK) {
+      ok = false;
+      continue;
+    }
+
+    if (dict_rows) {
+      size_t const dict_len = std::min(window, dict_rows * linebytes);
+      deflateSetDictionary(&strm, input - dict_len, dict_len);
+    }
+
+    auto& out = bands[b];
+    out.resize(deflateBound(&strm, input_len) + 16);
+    strm.next_in = const_cast<Bytef*>(input);
+    strm.avail_in = input_len;
+    strm.next_out = out.data();
+    strm.avail_out = out.size();
+
+    int const flush = (b == n_band - 1) ? Z_FINISH : Z_SYNC_FLUSH;
+    int const ret = deflate(&strm, flush);
+    if (ret != (flush == Z_FINISH ? Z_STREAM_END : Z_OK) || strm.avail_in) {
+      ok = false;
+    }
+    out.resize(out.size() - strm.avail_out);
+    deflateEnd(&strm);
+  }
+
+  if (!ok)
+    return false;
+
+  // zlib header: deflate with 32K window, FLEVEL fastest or default
+  zdata.clear();
+  zdata.push_back(0x78);
+  zdata.push_back(encoding.fast ? 0x01 : 0x9C);
+
+  uLong adler = adler32(0L, Z_NULL, 0);
+  for (int b = 0; b < n_band; ++b) {
+    zdata.insert(zdata.end(), bands[b].begin(), bands[b].end());
+    adler = adler32_combine(adler, adlers[b], lengths[b]);
+  }
+
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    zdata.push_back((adler >> shift) & 0xFF);
+  }
+
+  return true;
+}
 #endif
 
 int MyPNGWrite(pymol::zstring_view file_name_view, const pymol::Image& img,
     const float dpi, const int format, const int quiet,
-    const float screen_gamma, const float file_gamma, png_outbuf_t* io_ptr)
+    const float screen_gamma, const float file_gamma, png_outbuf_t* io_ptr,
+    const MyPNGEncoding& encoding)
 {
   const char* file_name = file_name_view.c_str();
   const unsigned char* data_ptr = img.bits();
@@ -186,13 +383,12 @@ int MyPNGWrite(pymol::zstring_view file_name_view, const pymol::Image& img,
       png_structp png_ptr;
       png_infop info_ptr;
       int bit_depth = 8;
-      int bytes_per_pixel = 4;
-      png_uint_32 k;
-      png_byte *image = (png_byte *) data_ptr;
-      png_bytep *row_pointers;
       int fd = 0;
+      std::vector<unsigned char> zdata;
 
-      row_pointers = pymol::malloc<png_bytep>(height);
+      if(!MyPNGDeflate(data_ptr, width, height, encoding, zdata)) {
+        return false;
+      }
 
       /* open the file, allowing use of an encoded file descriptor, with
          approach adapted from TJO: chr(1) followed by ascii-format integer */
@@ -293,17 +489,17 @@ int MyPNGWrite(pymol::zstring_view file_name_view, const pymol::Image& img,
       /* Write the file header information.  REQUIRED */
       png_write_info(png_ptr, info_ptr);
 
-      /* The easiest way to write the image (you may have a different memory
-       * layout, however, so choose what fits your needs best).  You need to
-       * use the first method if you aren't handling interlacing yourself.
-       */
-      for(k = 0; k < height; k++)
-        row_pointers[(height - k) - 1] = image + k * width * bytes_per_pixel;
-
-      png_write_image(png_ptr, row_pointers);
-
-      /* It is REQUIRED to call this to finish writing the rest of the file */
-      png_write_end(png_ptr, info_ptr);
+      /* The image data was compressed by MyPNGDeflate, write it as IDAT
+       * chunks and finish the file without png_write_end (which insists on
+       * rows written through libpng) */
+      {
+        const size_t chunk_max = 1 << 20;
+        for(size_t offset = 0; offset < zdata.size(); offset += chunk_max) {
+          png_write_chunk(png_ptr, (png_const_bytep) "IDAT", zdata.data() + offset,
+                          std::min(chunk_max, zdata.size() - offset));
+        }
+        png_write_chunk(png_ptr, (png_const_bytep) "IEND", nullptr, 0);
+      }
 
       /* clean up after the write, and free any memory allocated */
       png_destroy_write_struct(&png_ptr, &info_ptr);
@@ -314,7 +510,6 @@ int MyPNGWrite(pymol::zstring_view file_name_view, const pymol::Image& img,
         fclose(fp);
       }
 
-      mfree(row_pointers);
       /* that's it */
 
       return ok;
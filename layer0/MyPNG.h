@@ -28,10 +28,23 @@ Z* -------------------------------------------------------------------
 
 #define cMyPNG_FormatPNG 0
 #define cMyPNG_FormatPPM 1
+/* movie stream formats, see MovieWriter.h (not supported by MyPNGWrite) */
+#define cMyPNG_FormatY4M 2
+#define cMyPNG_FormatRGBA 3
+
+/**
+ * PNG encoder parameters. Row bands are filtered and deflated in parallel
+ * and joined into a single zlib stream.
+ */
+struct MyPNGEncoding {
+  bool fast = false; //!< fixed Up filter and lowest compression level
+  int n_threads = 1; //!< maximum number of bands compressed in parallel
+};
 
 int MyPNGWrite(pymol::zstring_view file_name, const pymol::Image& img, const float dpi,
     const int format, const int quiet, const float screen_gamma,
-    const float file_gamma, png_outbuf_t* io_ptr = nullptr);
+    const float file_gamma, png_outbuf_t* io_ptr = nullptr,
+    const MyPNGEncoding& encoding = {});
 
 std::unique_ptr<pymol::Image> MyPNGRead(const char *file_name);
 
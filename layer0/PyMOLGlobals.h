@@ -22,6 +22,7 @@ namespace pymol
 {
 class cif_file;
 class cif_data;
+class SessionFile;
 }; // namespace pymol
 
 /* retina scale factor for ortho gui */
@@ -197,6 +198,9 @@ struct PyMOLGlobals {
   // user defined scenes
   CMovieScenes * scenes;
 
+  // binary session container while saving or loading a .pseb file
+  pymol::SessionFile* SessionFile;
+
   struct { lexidx_t
 #include "lex_constants.h"
     _; } lex_const;
@@ -0,0 +1,370 @@
+/**
+ * @file
+ * Pairwise RMSD matrices with the QCP (quaternion characteristic polynomial)
+ * method, and RMSD based clustering.
+ */
+
+#include "RMSMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+QCPConformation::QCPConformation(const float* xyz, std::size_t n)
+    : x(n), y(n), z(n)
+{
+  for (std::size_t i = 0; i < n; ++i) {
+    center[0] += xyz[i * 3 + 0];
+    center[1] += xyz[i * 3 + 1];
+    center[2] += xyz[i * 3 + 2];
+  }
+  if (n) {
+    for (auto& c : center) {
+      c /= n;
+    }
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = float(xyz[i * 3 + 0] - center[0]);
+    y[i] = float(xyz[i * 3 + 1] - center[1]);
+    z[i] = float(xyz[i * 3 + 2] - center[2]);
+    G += double(x[i]) * x[i] + double(y[i]) * y[i] + double(z[i]) * z[i];
+  }
+}
+
+/**
+ * Inner product matrix M = sum_i a_i b_i^T, accumulated in independent
+ * lanes (vectorizable). Double precision is needed since the RMSD is
+ * derived from the small difference of two large numbers.
+ */
+static void QCPInnerProduct(
+    const QCPConformation& a, const QCPConformation& b, double* M)
+{
+  constexpr std::size_t L = 8; // accumulator lanes
+  double acc[9][L] = {};
+
+  std::size_t const n = a.size();
+  std::size_t const n_blocked = n - n % L;
+  const float *ax = a.x.data(), *ay = a.y.data(), *az = a.z.data();
+  const float *bx = b.x.data(), *by = b.y.data(), *bz = b.z.data();
+
+  for (std::size_t i = 0; i < n_blocked; i += L) {
+    for (std::size_t l = 0; l < L; ++l) {
+      acc[0][l] += double(ax[i + l]) * bx[i + l];
+      acc[1][l] += double(ax[i + l]) * by[i + l];
+      acc[2][l] += double(ax[i + l]) * bz[i + l];
+      acc[3][l] += double(ay[i + l]) * bx[i + l];
+      acc[4][l] += double(ay[i + l]) * by[i + l];
+      acc[5][l] += double(ay[i + l]) * bz[i + l];
+      acc[6][l] += double(az[i + l]) * bx[i + l];
+      acc[7][l] += double(az[i + l]) * by[i + l];
+      acc[8][l] += double(az[i + l]) * bz[i + l];
+    }
+  }
+
+  for (int k = 0; k < 9; ++k) {
+    double sum = 0.0;
+    for (std::size_t l = 0; l < L; ++l) {
+      sum += acc[k][l];
+    }
+    M[k] = sum;
+  }
+
+  for (std::size_t i = n_blocked; i < n; ++i) {
+    M[0] += double(ax[i]) * bx[i];
+    M[1] += double(ax[i]) * by[i];
+    M[2] += double(ax[i]) * bz[i];
+    M[3] += double(ay[i]) * bx[i];
+    M[4] += double(ay[i]) * by[i];
+    M[5] += double(ay[i]) * bz[i];
+    M[6] += double(az[i]) * bx[i];
+    M[7] += double(az[i]) * by[i];
+    M[8] += double(az[i]) * bz[i];
+  }
+}
+
+namespace
+{
+/**
+ * Key matrix quantities for one pair of conformations
+ */
+struct QCPKey {
+  double M[9]; //!< inner product matrix
+  double E0;   //!< (Ga + Gb) / 2
+  double lambda; //!< largest eigenvalue of the key matrix
+};
+} // namespace
+
+static void QCPSolve(
+    const QCPConformation& a, const QCPConformation& b, QCPKey& key)
+{
+  double* M = key.M;
+  QCPInnerProduct(a, b, M);
+
+  double const Sxx = M[0], Sxy = M[1], Sxz = M[2];
+  double const Syx = M[3], Syy = M[4], Syz = M[5];
+  double const Szx = M[6], Szy = M[7], Szz = M[8];
+
+  double const Sxx2 = Sxx * Sxx, Syy2 = Syy * Syy, Szz2 = Szz * Szz;
+  double const Sxy2 = Sxy * Sxy, Syz2 = Syz * Syz, Sxz2 = Sxz * Sxz;
+  double const Syx2 = Syx * Syx, Szy2 = Szy * Szy, Szx2 = Szx * Szx;
+
+  double const SyzSzymSyySzz2 = 2.0 * (Syz * Szy - Syy * Szz);
+  double const Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+
+  // coefficients of the characteristic polynomial of the key matrix
+  double const C2 =
+      -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2 + Syz2 + Szy2);
+  double const C1 =
+      8.0 * (Sxx * Syz * Szy + Syy * Szx * Sxz + Szz * Sxy * Syx -
+                Sxx * Syy * Szz - Syz * Szx * Sxy - Szy * Syx * Sxz);
+
+  double const SxzpSzx = Sxz + Szx, SyzpSzy = Syz + Szy, SxypSyx = Sxy + Syx;
+  double const SyzmSzy = Syz - Szy, SxzmSzx = Sxz - Szx, SxymSyx = Sxy - Syx;
+  double const SxxpSyy = Sxx + Syy, SxxmSyy = Sxx - Syy;
+  double const Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
+
+  double const C0 =
+      Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2 +
+      (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) *
+          (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2) +
+      (-SxzpSzx * SyzmSzy + SxymSyx * (SxxmSyy - Szz)) *
+          (-SxzmSzx * SyzpSzy + SxymSyx * (SxxmSyy + Szz)) +
+      (-SxzpSzx * SyzpSzy - SxypSyx * (SxxpSyy - Szz)) *
+          (-SxzmSzx * SyzmSzy - SxypSyx * (SxxpSyy + Szz)) +
+      (SxypSyx * SyzpSzy + SxzpSzx * (SxxmSyy + Szz)) *
+          (-SxymSyx * SyzmSzy + SxzpSzx * (SxxpSyy + Szz)) +
+      (SxypSyx * SyzmSzy + SxzmSzx * (SxxmSyy - Szz)) *
+          (-SxymSyx * SyzpSzy + SxzmSzx * (SxxpSyy - Szz));
+
+  // largest eigenvalue by Newton-Raphson, starting from the upper bound E0
+  double const E0 = key.E0 = (a.G + b.G) * 0.5;
+  double lambda = E0;
+  for (int i = 0; i < 50; ++i) {
+    double const prev = lambda;
+    double const x2 = lambda * lambda;
+    double const b_ = (x2 + C2) * lambda;
+    double const a_ = b_ + C1;
+    double const denom = 2.0 * x2 * lambda + b_ + a_;
+    if (denom == 0.0) {
+      break;
+    }
+    lambda -= (a_ * lambda + C0) / denom;
+    if (std::fabs(lambda - prev) < std::fabs(1e-11 * lambda)) {
+      break;
+    }
+  }
+
+  key.lambda = lambda;
+}
+
+static float QCPKeyRMSD(const QCPKey& key, std::size_t n)
+{
+  return float(std::sqrt(std::fabs(2.0 * (key.E0 - key.lambda) / n)));
+}
+
+float QCPRMSD(const QCPConformation& a, const QCPConformation& b)
+{
+  std::size_t const n = a.size();
+  if (!n || n != b.size()) {
+    return 0.f;
+  }
+
+  QCPKey key;
+  QCPSolve(a, b, key);
+  return QCPKeyRMSD(key, n);
+}
+
+/**
+ * Rotation matrix from the eigenvector of the key matrix for the largest
+ * eigenvalue, computed from the columns of the adjoint of (K - lambda I).
+ * Falls back to other columns if one is (numerically) zero.
+ */
+static void QCPRotation(const QCPKey& key, double* rot)
+{
+  const double* M = key.M;
+  double const Sxx = M[0], Sxy = M[1], Sxz = M[2];
+  double const Syx = M[3], Syy = M[4], Syz = M[5];
+  double const Szx = M[6], Szy = M[7], Szz = M[8];
+  double const lambda = key.lambda;
+
+  double const a11 = Sxx + Syy + Szz - lambda;
+  double const a12 = Syz - Szy, a13 = Szx - Sxz, a14 = Sxy - Syx;
+  double const a21 = a12, a22 = Sxx - Syy - Szz - lambda;
+  double const a23 = Sxy + Syx, a24 = Sxz + Szx;
+  double const a31 = a13, a32 = a23, a33 = Syy - Sxx - Szz - lambda;
+  double const a34 = Syz + Szy;
+  double const a41 = a14, a42 = a24, a43 = a34;
+  double const a44 = Szz - Sxx - Syy - lambda;
+
+  double const a3344_4334 = a33 * a44 - a43 * a34;
+  double const a3244_4234 = a32 * a44 - a42 * a34;
+  double const a3243_4233 = a32 * a43 - a42 * a33;
+  double const a3143_4133 = a31 * a43 - a41 * a33;
+  double const a3144_4134 = a31 * a44 - a41 * a34;
+  double const a3142_4132 = a31 * a42 - a41 * a32;
+
+  double q[4] = {
+      a22 * a3344_4334 - a23 * a3244_4234 + a24 * a3243_4233,
+      -a21 * a3344_4334 + a23 * a3144_4134 - a24 * a3143_4133,
+      a21 * a3244_4234 - a22 * a3144_4134 + a24 * a3142_4132,
+      -a21 * a3243_4233 + a22 * a3143_4133 - a23 * a3142_4132,
+  };
+
+  auto qsqr = [&q]() {
+    return q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+  };
+
+  double const evecprec = 1e-6;
+
+  if (qsqr() < evecprec) {
+    q[0] = a12 * a3344_4334 - a13 * a3244_4234 + a14 * a3243_4233;
+    q[1] = -a11 * a3344_4334 + a13 * a3144_4134 - a14 * a3143_4133;
+    q[2] = a11 * a3244_4234 - a12 * a3144_4134 + a14 * a3142_4132;
+    q[3] = -a11 * a3243_4233 + a12 * a3143_4133 - a13 * a3142_4132;
+
+    if (qsqr() < evecprec) {
+      double const a1324_1423 = a13 * a24 - a14 * a23;
+      double const a1224_1422 = a12 * a24 - a14 * a22;
+      double const a1223_1322 = a12 * a23 - a13 * a22;
+      double const a1124_1421 = a11 * a24 - a14 * a21;
+      double const a1123_1321 = a11 * a23 - a13 * a21;
+      double const a1122_1221 = a11 * a22 - a12 * a21;
+
+      q[0] = a42 * a1324_1423 - a43 * a1224_1422 + a44 * a1223_1322;
+      q[1] = -a41 * a1324_1423 + a43 * a1124_1421 - a44 * a1123_1321;
+      q[2] = a41 * a1224_1422 - a42 * a1124_1421 + a44 * a1122_1221;
+      q[3] = -a41 * a1223_1322 + a42 * a1123_1321 - a43 * a1122_1221;
+
+      if (qsqr() < evecprec) {
+        q[0] = a32 * a1324_1423 - a33 * a1224_1422 + a34 * a1223_1322;
+        q[1] = -a31 * a1324_1423 + a33 * a1124_1421 - a34 * a1123_1321;
+        q[2] = a31 * a1224_1422 - a32 * a1124_1421 + a34 * a1122_1221;
+        q[3] = -a31 * a1223_1322 + a32 * a1123_1321 - a33 * a1122_1221;
+
+        if (qsqr() < evecprec) {
+          // no rotation (e.g. identical structures)
+          double const identity[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+          std::copy_n(identity, 9, rot);
+          return;
+        }
+      }
+    }
+  }
+
+  double const norm = std::sqrt(qsqr());
+  for (auto& qi : q) {
+    qi /= norm;
+  }
+
+  double const a2 = q[0] * q[0], x2 = q[1] * q[1];
+  double const y2 = q[2] * q[2], z2 = q[3] * q[3];
+  double const xy = q[1] * q[2], az = q[0] * q[3], zx = q[3] * q[1];
+  double const ay = q[0] * q[2], yz = q[2] * q[3], ax = q[0] * q[1];
+
+  rot[0] = a2 + x2 - y2 - z2;
+  rot[1] = 2 * (xy + az);
+  rot[2] = 2 * (zx - ay);
+  rot[3] = 2 * (xy - az);
+  rot[4] = a2 - x2 + y2 - z2;
+  rot[5] = 2 * (yz + ax);
+  rot[6] = 2 * (zx + ay);
+  rot[7] = 2 * (yz - ax);
+  rot[8] = a2 - x2 - y2 + z2;
+}
+
+float QCPSuperpose(const QCPConformation& target,
+    const QCPConformation& mobile, float* matrix)
+{
+  std::size_t const n = target.size();
+  if (!n || n != mobile.size()) {
+    return -1.f;
+  }
+
+  QCPKey key;
+  QCPSolve(target, mobile, key);
+
+  double rot[9];
+  QCPRotation(key, rot);
+
+  // x' = R (x - mobile.center) + target.center
+  for (int i = 0; i < 3; ++i) {
+    double t = target.center[i];
+    for (int j = 0; j < 3; ++j) {
+      matrix[i * 4 + j] = float(rot[i * 3 + j]);
+      t -= rot[i * 3 + j] * mobile.center[j];
+    }
+    matrix[i * 4 + 3] = float(t);
+  }
+  matrix[12] = matrix[13] = matrix[14] = 0.f;
+  matrix[15] = 1.f;
+
+  return QCPKeyRMSD(key, n);
+}
+
+void QCPRMSDMatrix(const std::vector<QCPConformation>& confs, float* out)
+{
+  long const n = confs.size();
+
+  // upper triangle, rows get shorter so hand them out dynamically
+#pragma omp parallel for schedule(dynamic)
+  for (long i = 0; i < n; ++i) {
+    out[i * n + i] = 0.f;
+    for (long j = i + 1; j < n; ++j) {
+      out[i * n + j] = out[j * n + i] = QCPRMSD(confs[i], confs[j]);
+    }
+  }
+}
+
+void QCPRMSDMatrixRows(const std::vector<QCPConformation>& confs,
+    std::size_t row_begin, std::size_t row_end, float* out)
+{
+  long const n = confs.size();
+  long const n_rows = row_end - row_begin;
+
+#pragma omp parallel for
+  for (long r = 0; r < n_rows; ++r) {
+    long const i = row_begin + r;
+    for (long j = 0; j < n; ++j) {
+      out[r * n + j] = (i == j) ? 0.f : QCPRMSD(confs[i], confs[j]);
+    }
+  }
+}
+
+std::vector<int> ClusterGromos(const std::vector<std::vector<int>>& neighbors)
+{
+  std::size_t const n = neighbors.size();
+  std::vector<int> cluster(n, -1);
+  std::vector<int> count(n);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    count[i] = neighbors[i].size();
+  }
+
+  auto remove = [&](int i, int c) {
+    cluster[i] = c;
+    for (int j : neighbors[i]) {
+      --count[j];
+    }
+  };
+
+  for (int c = 0, n_assigned = 0; n_assigned < int(n); ++c) {
+    // unassigned element with most unassigned neighbors
+    int center = -1;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (cluster[i] == -1 && (center == -1 || count[i] > count[center])) {
+        center = i;
+      }
+    }
+
+    remove(center, c);
+    ++n_assigned;
+
+    for (int j : neighbors[center]) {
+      if (cluster[j] == -1) {
+        remove(j, c);
+        ++n_assigned;
+      }
+    }
+  }
+
+  return cluster;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file
+ * Pairwise RMSD matrices with the QCP (quaternion characteristic polynomial)
+ * method, and RMSD based clustering.
+ *
+ * QCP: Theobald, Acta Cryst A 61 (2005) 478-480 and Liu, Agrafiotis,
+ * Theobald, J Comput Chem 31 (2010) 1561-1563.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Centered coordinates of one conformation, stored as separate x, y and z
+ * arrays so that the inner product loop vectorizes.
+ */
+struct QCPConformation {
+  std::vector<float> x, y, z;
+  double G = 0.0; //!< sum of squared (centered) coordinates
+  double center[3] = {0.0, 0.0, 0.0};
+
+  /**
+   * @param xyz n coordinates (3 * n floats)
+   * @param n number of atoms
+   */
+  QCPConformation(const float* xyz, std::size_t n);
+
+  std::size_t size() const { return x.size(); }
+};
+
+/**
+ * Minimum RMSD of two conformations with the same number of atoms after
+ * optimal superposition.
+ */
+float QCPRMSD(const QCPConformation& a, const QCPConformation& b);
+
+/**
+ * Like QCPRMSD, but also computes the superposition.
+ *
+ * @param target Reference conformation (stays fixed)
+ * @param mobile Conformation to superpose onto `target`
+ * @param[out] matrix Homogenous 4x4 matrix (row-major) which transforms
+ * `mobile` onto `target`
+ * @return RMSD after superposition
+ */
+float QCPSuperpose(const QCPConformation& target,
+    const QCPConformation& mobile, float* matrix);
+
+/**
+ * Computes the full pairwise RMSD matrix.
+ *
+ * @param[out] out confs.size()^2 values, row-major
+ */
+void QCPRMSDMatrix(const std::vector<QCPConformation>& confs, float* out);
+
+/**
+ * Computes rows [row_begin, row_end) of the pairwise RMSD matrix, for
+ * processing matrices which don't fit in memory tile by tile.
+ *
+ * @param[out] out (row_end - row_begin) * confs.size() values, row-major
+ */
+void QCPRMSDMatrixRows(const std::vector<QCPConformation>& confs,
+    std::size_t row_begin, std::size_t row_end, float* out);
+
+/**
+ * GROMOS clustering (Daura et al., Angew Chem Int Ed 38 (1999) 236-240):
+ * The element with the most neighbors becomes the center of a cluster which
+ * contains all its neighbors. Those are removed from the pool and the
+ * procedure is repeated until all elements are assigned.
+ *
+ * Each center has the most unassigned neighbors at the time it is picked,
+ * and removing elements only lowers those counts, so the clusters come out
+ * ordered by size without sorting.
+ *
+ * @param neighbors Symmetric neighbor lists (excluding the element itself)
+ * @return Cluster index for each element, clusters are ordered by size
+ * (largest first, starting with 0)
+ */
+std::vector<int> ClusterGromos(const std::vector<std::vector<int>>& neighbors);
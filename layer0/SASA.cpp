@@ -0,0 +1,289 @@
+/**
+ * @file
+ * Shrake-Rupley surface area with bitmask dot occlusion.
+ */
+
+#include "SASA.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+
+constexpr std::size_t BlockSize = 64;
+
+inline int BitCount(std::uint64_t v)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(v);
+#else
+  int count = 0;
+  for (; v; v &= v - 1)
+    ++count;
+  return count;
+#endif
+}
+
+/// Index of the lowest set bit, `v` must not be zero
+inline int LowestBit(std::uint64_t v)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll(v);
+#else
+  int k = 0;
+  for (; !(v & 1); v >>= 1)
+    ++k;
+  return k;
+#endif
+}
+
+/**
+ * Uniform grid with cell size >= largest interaction distance, stored as
+ * compressed cell lists (atoms sorted by cell).
+ */
+struct SASAGrid {
+  float origin[3];
+  float recip_cell;
+  int dim[3];
+  std::vector<int> start; //!< first entry of each cell in `atoms`, +1 sentinel
+  std::vector<int> atoms;
+
+  SASAGrid(const float* coords, std::size_t n, const bool* occluder,
+      float cell)
+  {
+    float max[3] = {0.f, 0.f, 0.f};
+    bool first = true;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (occluder && !occluder[i])
+        continue;
+      for (int d = 0; d < 3; ++d) {
+        float const v = coords[i * 3 + d];
+        if (first || v < origin[d])
+          origin[d] = v;
+        if (first || v > max[d])
+          max[d] = v;
+      }
+      first = false;
+    }
+
+    if (first) {
+      std::fill_n(origin, 3, 0.f);
+      std::fill_n(max, 3, 0.f);
+    }
+
+    // limit the number of (mostly empty) cells for sparse systems
+    for (;; cell *= 1.5f) {
+      recip_cell = 1.f / cell;
+      double n_cell = 1.0;
+      for (int d = 0; d < 3; ++d) {
+        dim[d] = int((max[d] - origin[d]) * recip_cell) + 1;
+        n_cell *= dim[d];
+      }
+      if (n_cell <= 8.0 * n + 64) {
+        break;
+      }
+    }
+
+    start.assign(std::size_t(dim[0]) * dim[1] * dim[2] + 1, 0);
+
+    std::vector<int> cell_of(n, -1);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (occluder && !occluder[i])
+        continue;
+      cell_of[i] = cellIndex(coords + i * 3);
+      ++start[cell_of[i] + 1];
+    }
+    for (std::size_t c = 1; c < start.size(); ++c) {
+      start[c] += start[c - 1];
+    }
+
+    atoms.resize(start.back());
+    std::vector<int> fill(start.begin(), start.end() - 1);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (cell_of[i] >= 0) {
+        atoms[fill[cell_of[i]]++] = i;
+      }
+    }
+  }
+
+  int cellCoord(float v, int d) const
+  {
+    return std::clamp(int((v - origin[d]) * recip_cell), 0, dim[d] - 1);
+  }
+
+  int cellIndex(const float* v) const
+  {
+    return (cellCoord(v[0], 0) * dim[1] + cellCoord(v[1], 1)) * dim[2] +
+           cellCoord(v[2], 2);
+  }
+};
+
+struct SASANeighbor {
+  float dist2;
+  float u[3];
+  float t; //!< dot is buried if dot . u >= t
+};
+
+/**
+ * Marks dots of one block which are buried by the given neighbor.
+ */
+inline std::uint64_t SASABuriedBits(const SASADots& dots, std::size_t offset,
+    const SASANeighbor& nb, std::uint64_t exposed)
+{
+  const float* x = dots.x.data() + offset;
+  const float* y = dots.y.data() + offset;
+  const float* z = dots.z.data() + offset;
+  std::uint64_t bits = 0;
+
+  if (BitCount(exposed) > 8) {
+    // dense, vectorizable
+    for (std::size_t k = 0; k < BlockSize; ++k) {
+      bits |= std::uint64_t(x[k] * nb.u[0] + y[k] * nb.u[1] +
+                                z[k] * nb.u[2] >=
+                            nb.t)
+              << k;
+    }
+  } else {
+    // only a few exposed dots left
+    for (auto rest = exposed; rest; rest &= rest - 1) {
+      int const k = LowestBit(rest);
+      if (x[k] * nb.u[0] + y[k] * nb.u[1] + z[k] * nb.u[2] >= nb.t) {
+        bits |= std::uint64_t(1) << k;
+      }
+    }
+  }
+
+  return bits & exposed;
+}
+
+} // namespace
+
+SASADots::SASADots(const float* dots, const float* area_, std::size_t n_)
+    : n(n_)
+{
+  std::size_t const padded = (n + BlockSize - 1) / BlockSize * BlockSize;
+  x.assign(padded, 0.f);
+  y.assign(padded, 0.f);
+  z.assign(padded, 0.f);
+  area.assign(padded, 0.f);
+  for (std::size_t k = 0; k < n; ++k) {
+    x[k] = dots[k * 3 + 0];
+    y[k] = dots[k * 3 + 1];
+    z[k] = dots[k * 3 + 2];
+    area[k] = area_[k];
+  }
+}
+
+void SASAAtomAreas(const SASADots& dots, const float* coords,
+    const float* radii, std::size_t n, const bool* surface,
+    const bool* occluder, float* area)
+{
+  float max_radius = 0.f;
+  for (std::size_t i = 0; i < n; ++i) {
+    max_radius = std::max(max_radius, radii[i]);
+  }
+
+  if (!n || max_radius <= 0.f) {
+    std::fill_n(area, n, 0.f);
+    return;
+  }
+
+  SASAGrid const grid(coords, n, occluder, 2.f * max_radius);
+  std::size_t const n_block = dots.x.size() / BlockSize;
+
+  // padding dots count as buried
+  std::vector<std::uint64_t> initial(n_block, 0);
+  for (std::size_t k = dots.n; k < dots.x.size(); ++k) {
+    initial[k / BlockSize] |= std::uint64_t(1) << (k % BlockSize);
+  }
+
+#pragma omp parallel
+  {
+    std::vector<SASANeighbor> neighbors;
+    std::vector<std::uint64_t> buried;
+
+#pragma omp for schedule(dynamic, 64)
+    for (long i = 0; i < long(n); ++i) {
+      if ((surface && !surface[i]) || !(radii[i] > 0.f)) {
+        area[i] = 0.f;
+        continue;
+      }
+
+      const float* vi = coords + i * 3;
+      float const ri = radii[i];
+
+      neighbors.clear();
+
+      int lo[3], hi[3];
+      for (int d = 0; d < 3; ++d) {
+        int const c = grid.cellCoord(vi[d], d);
+        lo[d] = std::max(0, c - 1);
+        hi[d] = std::min(grid.dim[d] - 1, c + 1);
+      }
+
+      for (int a = lo[0]; a <= hi[0]; ++a) {
+        for (int b = lo[1]; b <= hi[1]; ++b) {
+          for (int c = lo[2]; c <= hi[2]; ++c) {
+            int const cell = (a * grid.dim[1] + b) * grid.dim[2] + c;
+            for (int e = grid.start[cell]; e != grid.start[cell + 1]; ++e) {
+              int const j = grid.atoms[e];
+              if (j == i) {
+                continue;
+              }
+              const float* vj = coords + j * 3;
+              float const rj = radii[j];
+              SASANeighbor nb;
+              nb.u[0] = vj[0] - vi[0];
+              nb.u[1] = vj[1] - vi[1];
+              nb.u[2] = vj[2] - vi[2];
+              nb.dist2 = nb.u[0] * nb.u[0] + nb.u[1] * nb.u[1] +
+                         nb.u[2] * nb.u[2];
+              float const rsum = ri + rj;
+              if (nb.dist2 >= rsum * rsum) {
+                continue;
+              }
+              nb.t = (ri * ri + nb.dist2 - rj * rj) / (2.f * ri);
+              neighbors.push_back(nb);
+            }
+          }
+        }
+      }
+
+      // closest neighbors bury the most dots
+      std::sort(neighbors.begin(), neighbors.end(),
+          [](const SASANeighbor& p, const SASANeighbor& q) {
+            return p.dist2 < q.dist2;
+          });
+
+      buried = initial;
+      std::size_t n_full = 0;
+      for (auto word : buried) {
+        n_full += (~word == 0);
+      }
+
+      for (const auto& nb : neighbors) {
+        if (n_full == n_block) {
+          break;
+        }
+        for (std::size_t w = 0; w < n_block; ++w) {
+          auto const exposed = ~buried[w];
+          if (exposed) {
+            buried[w] |= SASABuriedBits(dots, w * BlockSize, nb, exposed);
+            n_full += (~buried[w] == 0);
+          }
+        }
+      }
+
+      float sum = 0.f;
+      for (std::size_t w = 0; w < n_block; ++w) {
+        for (auto rest = ~buried[w]; rest; rest &= rest - 1) {
+          sum += dots.area[w * BlockSize + LowestBit(rest)];
+        }
+      }
+
+      area[i] = ri * ri * sum;
+    }
+  }
+}
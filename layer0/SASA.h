@@ -0,0 +1,48 @@
+/**
+ * @file
+ * Shrake-Rupley surface area with bitmask dot occlusion.
+ *
+ * Each atom is covered with a set of dots on a sphere of its (probe
+ * inflated) radius. A dot is buried if it lies within the sphere of any
+ * neighboring atom. For a neighbor at `u = r_j - r_i` this reduces to the
+ * half-space test `dot . u >= (R_i^2 + |u|^2 - R_j^2) / (2 R_i)`, which is
+ * evaluated for 64 dots at a time and collected in bit masks. Neighbors are
+ * processed closest first and an atom is done as soon as all dots are
+ * buried.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Unit sphere dots and their areas, stored as separate x, y and z arrays
+ * (padded to a multiple of 64) so that the occlusion test vectorizes.
+ */
+struct SASADots {
+  std::vector<float> x, y, z, area;
+  std::size_t n = 0; //!< number of dots without padding
+
+  /**
+   * @param dots n unit vectors (3 * n floats)
+   * @param area n areas on the unit sphere
+   * @param n number of dots
+   */
+  SASADots(const float* dots, const float* area, std::size_t n);
+};
+
+/**
+ * Computes per-atom surface areas. Runs in parallel over atoms.
+ *
+ * @param dots Dot sphere
+ * @param coords n coordinates (3 * n floats)
+ * @param radii n radii, including the probe radius
+ * @param n Number of atoms
+ * @param surface Atoms which get a surface (nullptr for all)
+ * @param occluder Atoms which can bury dots (nullptr for all)
+ * @param[out] area n areas (0 for atoms without surface)
+ */
+void SASAAtomAreas(const SASADots& dots, const float* coords,
+    const float* radii, std::size_t n, const bool* surface,
+    const bool* occluder, float* area);
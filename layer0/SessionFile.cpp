@@ -0,0 +1,258 @@
+/**
+ * @file
+ * Binary session container (.pseb)
+ */
+
+#include "SessionFile.h"
+#include "File.h"
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pymol
+{
+
+namespace
+{
+
+constexpr char Magic[8] = {'P', 'Y', 'M', 'O', 'L', 'S', 'E', 'S'};
+constexpr std::uint32_t ByteOrderMark = 0x01020304;
+constexpr std::size_t HeaderSize = 64;
+constexpr std::size_t EntrySize = 32;
+constexpr std::size_t Alignment = 64;
+
+template <typename T> void put(unsigned char* buf, std::size_t pos, T value)
+{
+  std::memcpy(buf + pos, &value, sizeof(T));
+}
+
+template <typename T> T get(const unsigned char* buf, std::size_t pos)
+{
+  T value;
+  std::memcpy(&value, buf + pos, sizeof(T));
+  return value;
+}
+
+} // namespace
+
+SessionFile::~SessionFile()
+{
+  if (m_fp) {
+    // not finished
+    fclose(m_fp);
+    std::remove(m_filename.c_str());
+  }
+#ifndef _WIN32
+  if (m_mapped) {
+    munmap(const_cast<unsigned char*>(m_data), m_dataSize);
+  }
+#endif
+}
+
+Result<std::unique_ptr<SessionFile>> SessionFile::create(const char* filename)
+{
+  std::unique_ptr<SessionFile> I(new SessionFile());
+  I->m_filename = filename;
+  I->m_fp = pymol_fopen(filename, "wb");
+
+  if (!I->m_fp) {
+    return make_error("Cannot open file for writing: ", filename);
+  }
+
+  // placeholder, written by finish()
+  unsigned char header[HeaderSize] = {};
+  if (!I->writeBytes(header, HeaderSize)) {
+    return make_error("Write failed: ", filename);
+  }
+
+  return I;
+}
+
+bool SessionFile::writeBytes(const void* data, std::size_t size)
+{
+  if (size && fwrite(data, 1, size, m_fp) != size) {
+    if (m_writeError.empty()) {
+      m_writeError = "Write failed: " + m_filename;
+    }
+    return false;
+  }
+  m_offset += size;
+  return true;
+}
+
+int SessionFile::write(SessionSection type, std::uint32_t version,
+    const void* data, std::size_t size)
+{
+  if (!m_fp || !m_writeError.empty()) {
+    return -1;
+  }
+
+  static const unsigned char zeros[Alignment] = {};
+  if (!writeBytes(zeros, (Alignment - m_offset % Alignment) % Alignment)) {
+    return -1;
+  }
+
+  Section section{type, version, m_offset, size, nullptr};
+
+  if (!writeBytes(data, size)) {
+    return -1;
+  }
+
+  m_sections.push_back(section);
+  return int(m_sections.size()) - 1;
+}
+
+Result<> SessionFile::finish()
+{
+  if (!m_fp) {
+    return make_error("Session file not open for writing");
+  }
+
+  if (m_writeError.empty()) {
+    std::uint64_t const table_offset = m_offset;
+
+    for (auto const& section : m_sections) {
+      unsigned char entry[EntrySize] = {};
+      put(entry, 0, std::uint32_t(section.type));
+      put(entry, 4, section.version);
+      put(entry, 8, section.offset);
+      put(entry, 16, std::uint64_t(section.size));
+      if (!writeBytes(entry, EntrySize)) {
+        break;
+      }
+    }
+
+    unsigned char header[HeaderSize] = {};
+    std::memcpy(header, Magic, sizeof(Magic));
+    put(header, 8, Version);
+    put(header, 12, ByteOrderMark);
+    put(header, 16, table_offset);
+    put(header, 24, std::uint64_t(m_sections.size()));
+
+    if (m_writeError.empty() &&
+        (fseek(m_fp, 0, SEEK_SET) != 0 || !writeBytes(header, HeaderSize))) {
+      m_writeError = "Write failed: " + m_filename;
+    }
+  }
+
+  if (fclose(m_fp) != 0 && m_writeError.empty()) {
+    m_writeError = "Write failed: " + m_filename;
+  }
+  m_fp = nullptr;
+
+  if (!m_writeError.empty()) {
+    std::remove(m_filename.c_str());
+    return make_error(m_writeError);
+  }
+
+  return {};
+}
+
+Result<std::unique_ptr<SessionFile>> SessionFile::open(const char* filename)
+{
+  std::unique_ptr<SessionFile> I(new SessionFile());
+  I->m_filename = filename;
+
+#ifndef _WIN32
+  int fd = ::open(filename, O_RDONLY);
+  if (fd != -1) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        I->m_data = static_cast<const unsigned char*>(addr);
+        I->m_dataSize = st.st_size;
+        I->m_mapped = true;
+      }
+    }
+    ::close(fd);
+  }
+
+  if (!I->m_mapped)
+#endif
+  {
+    FILE* fp = pymol_fopen(filename, "rb");
+    if (!fp) {
+      return make_error("Cannot open file: ", filename);
+    }
+    unsigned char buf[1 << 16];
+    for (std::size_t n; (n = fread(buf, 1, sizeof(buf), fp));) {
+      I->m_buffer.insert(I->m_buffer.end(), buf, buf + n);
+    }
+    fclose(fp);
+    I->m_data = I->m_buffer.data();
+    I->m_dataSize = I->m_buffer.size();
+  }
+
+  auto const* data = I->m_data;
+  auto const size = I->m_dataSize;
+
+  if (size < HeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+    return make_error("Not a binary PyMOL session: ", filename);
+  }
+
+  if (get<std::uint32_t>(data, 12) != ByteOrderMark) {
+    return make_error("Binary session has incompatible byte order");
+  }
+
+  auto const version = get<std::uint32_t>(data, 8);
+  if (version > Version) {
+    return make_error("Binary session version ", version,
+        " is not supported (only up to ", Version, ")");
+  }
+
+  auto const table_offset = get<std::uint64_t>(data, 16);
+  auto const count = get<std::uint64_t>(data, 24);
+
+  if (table_offset > size || count > (size - table_offset) / EntrySize) {
+    return make_error("Binary session is truncated or corrupt");
+  }
+
+  I->m_sections.reserve(count);
+
+  for (std::uint64_t i = 0; i < count; ++i) {
+    auto const* entry = data + table_offset + i * EntrySize;
+    Section section{};
+    section.type = SessionSection(get<std::uint32_t>(entry, 0));
+    section.version = get<std::uint32_t>(entry, 4);
+    section.offset = get<std::uint64_t>(entry, 8);
+    auto const section_size = get<std::uint64_t>(entry, 16);
+
+    if (section.offset > table_offset ||
+        section_size > table_offset - section.offset) {
+      return make_error("Binary session is truncated or corrupt");
+    }
+
+    section.size = section_size;
+    section.data = data + section.offset;
+    I->m_sections.push_back(section);
+  }
+
+  return I;
+}
+
+const SessionFile::Section* SessionFile::section(int index) const
+{
+  if (index < 0 || std::size_t(index) >= m_sections.size()) {
+    return nullptr;
+  }
+  return &m_sections[index];
+}
+
+const SessionFile::Section* SessionFile::find(SessionSection type) const
+{
+  for (auto const& section : m_sections) {
+    if (section.type == type) {
+      return &section;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace pymol
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * Binary session container (.pseb)
+ *
+ * Large binary blocks of a session (atom tables, bonds, coordinates, map
+ * grids) are stored as typed sections instead of being embedded in the
+ * pickled session dictionary. Sections are 64 byte aligned and the file is
+ * memory mapped when reading, so loading copies directly from the mapping
+ * into the destination arrays.
+ *
+ * Layout:
+ *
+ *     header   64 bytes (magic, version, byte order mark, table offset/size)
+ *     sections each starting at a 64 byte aligned offset
+ *     table    one 32 byte entry per section (type, version, offset, size)
+ */
+
+#pragma once
+
+#include "Result.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pymol
+{
+
+enum class SessionSection : std::uint32_t {
+  Pickle = 1,      //!< pickled session dictionary (objects, settings, scenes)
+  AtomInfo = 2,    //!< AtomInfoType array, AtomInfoTypeConverter format
+  AtomStrings = 3, //!< lexicon strings referenced by AtomInfo
+  Bonds = 4,       //!< BondType array, Copy_To_BondType_Version format
+  Coords = 5,      //!< CoordSet coordinates (float x 3 x NIndex)
+  IdxToAtm = 6,    //!< CoordSet index to atom mapping (int x NIndex)
+  FieldData = 7,   //!< CField grid data
+};
+
+class SessionFile
+{
+public:
+  static constexpr std::uint32_t Version = 1;
+
+  /// Blocks smaller than this are not worth a section
+  static constexpr std::size_t MinSectionSize = 256;
+
+  struct Section {
+    SessionSection type;
+    std::uint32_t version; //!< format version of the section content
+    std::uint64_t offset;  //!< file offset
+    std::size_t size;
+    const void* data; //!< only valid for files opened for reading
+  };
+
+  /**
+   * Creates a new file for writing. The file is removed again unless
+   * finish() succeeds.
+   */
+  static Result<std::unique_ptr<SessionFile>> create(const char* filename);
+
+  /**
+   * Opens (memory maps) an existing file for reading.
+   */
+  static Result<std::unique_ptr<SessionFile>> open(const char* filename);
+
+  ~SessionFile();
+
+  /**
+   * Appends a section.
+   * @return section index, or -1 on write error (reported by finish())
+   */
+  int write(SessionSection type, std::uint32_t version, const void* data,
+      std::size_t size);
+
+  /**
+   * Writes the section table and completes the file.
+   */
+  Result<> finish();
+
+  bool isWriting() const { return m_fp != nullptr; }
+
+  std::size_t size() const { return m_sections.size(); }
+
+  /// Section by index, or nullptr if out of range
+  const Section* section(int index) const;
+
+  /// First section of the given type, or nullptr
+  const Section* find(SessionSection type) const;
+
+private:
+  SessionFile() = default;
+
+  std::string m_filename;
+  std::vector<Section> m_sections;
+
+  // writing
+  FILE* m_fp = nullptr;
+  std::uint64_t m_offset = 0;
+  std::string m_writeError;
+
+  // reading
+  const unsigned char* m_data = nullptr;
+  std::size_t m_dataSize = 0;
+  std::vector<unsigned char> m_buffer; //!< fallback if mmap is not available
+#ifndef _WIN32
+  bool m_mapped = false;
+#endif
+
+  bool writeBytes(const void* data, std::size_t size);
+};
+
+} // namespace pymol
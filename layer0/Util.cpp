@@ -15,6 +15,7 @@ Z* -------------------------------------------------------------------
 */
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 
 #include"os_predef.h"
@@ -54,6 +55,52 @@ int UtilShouldWePrintQuantity(int quantity)
   }
   return 0;
 }
+/**
+ * Fast equivalent of sprintf(buf, "%*.*f", width, precision, value), without
+ * format string parsing and locale lookup. Used for coordinates in
+ * molecular file export.
+ *
+ * A float times 10^precision is exact in double precision for precision <= 4,
+ * so rounding the product half to even gives the same digits as printf.
+ *
+ * @return Number of characters written (excluding the null byte)
+ */
+int UtilFormatFixed(char *buf, float value, int width, int precision)
+{
+  static const double scale[] = {1., 10., 100., 1000., 10000.};
+
+  if (precision < 0 || precision > 4 ||
+      !(std::fabs(value * scale[precision]) < 9e15)) {
+    return sprintf(buf, "%*.*f", width, precision, value);
+  }
+
+  auto digits = static_cast<unsigned long long>(
+      std::fabs(std::nearbyint(value * scale[precision])));
+
+  char tmp[32];
+  char *p = tmp + sizeof(tmp);
+  int n = 0;
+
+  do {
+    *(--p) = '0' + digits % 10;
+    digits /= 10;
+    if (++n == precision)
+      *(--p) = '.';
+  } while (digits || n <= precision);
+
+  if (std::signbit(value))
+    *(--p) = '-';
+
+  int len = tmp + sizeof(tmp) - p;
+  int pad = std::max(0, width - len);
+
+  std::fill_n(buf, pad, ' ');
+  std::copy_n(p, len, buf + pad);
+  buf[pad + len] = 0;
+
+  return pad + len;
+}
+
 int UtilCountStringVLA(char *vla)
 {
   int result=0;
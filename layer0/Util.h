@@ -65,4 +65,6 @@ void UtilSortIndexGlobals(PyMOLGlobals * G, int n, const void *array, int *x,
 
 int UtilShouldWePrintQuantity(int quantity);
 
+int UtilFormatFixed(char *buf, float value, int width, int precision);
+
 #endif
@@ -36,6 +36,12 @@
 
 #include "ce_types.h"
 
+#include <algorithm>
+
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
 #include "tnt/tnt.h"
 #include "tnt/jama_lu.h"
 #include "tnt/jama_svd.h"
@@ -52,33 +58,37 @@ TA2<double> transpose(const TA2<double>& v);
 /////////////////////////////////////////////////////////////////////////////
 // CE Specific
 /////////////////////////////////////////////////////////////////////////////
-double** calcDM(pcePoint coords, int len)
+ceMatrix calcDM(const cePoint* coords, int len)
 {
-  int i = 0;
-
-  double** dm = (double**) malloc(sizeof(double*)*len);
-  for (i = 0; i < len; i++)
-    dm[i] = (double*) malloc( sizeof(double)*len);
-
-  int row=0, col=0;
-  for (row = 0; row < len; row++) {
-    for (col = 0; col < len; col++) {
-      dm[row][col] = sqrt(pow(coords[row].x - coords[col].x,2) +
-			  pow(coords[row].y - coords[col].y,2) +
-			  pow(coords[row].z - coords[col].z,2) );
+  ceMatrix dm(len, len);
+
+  // symmetric, compute the upper triangle and mirror it
+#pragma omp parallel for schedule(dynamic, 16)
+  for (int row = 0; row < len; row++) {
+    const double x = coords[row].x, y = coords[row].y, z = coords[row].z;
+    double* dm_row = dm[row];
+    for (int col = row; col < len; col++) {
+      const double dx = x - coords[col].x;
+      const double dy = y - coords[col].y;
+      const double dz = z - coords[col].z;
+      dm_row[col] = sqrt(dx * dx + dy * dy + dz * dz);
     }
   }
+
+  for (int row = 1; row < len; row++) {
+    for (int col = 0; col < row; col++) {
+      dm[row][col] = dm[col][row];
+    }
+  }
+
   return dm;
 }
 
-double** calcS(double** d1, double** d2, int lenA, int lenB, int wSize)
+ceMatrix calcS(const ceMatrix& d1, const ceMatrix& d2, int lenA, int lenB, int wSize)
 {
-  int i;
   double winSize = (double) wSize;
   // initialize the 2D similarity matrix
-  double** S = (double**) malloc(sizeof(double*)*lenA);
-  for (i = 0; i < lenA; i++)
-    S[i] = (double*) malloc( sizeof(double)*lenB);
+  ceMatrix S(lenA, lenB);
   
   double sumSize = (winSize-1.0)*(winSize-2.0) / 2.0;
   //
@@ -87,10 +97,11 @@ double** calcS(double** d1, double** d2, int lenA, int lenB, int wSize)
   // i - i+winSize in protein A, match to residues j - j+winSize in protein
   // B.  A value of 0 means absolute match; a value >> 1 means bad match.
   //
-  int iA, iB, row, col;
-  for (iA = 0; iA < lenA; iA++) {
-    for (iB = 0; iB < lenB; iB++) {
-      S[iA][iB] = -1.0;
+#pragma omp parallel for schedule(dynamic, 4)
+  for (int iA = 0; iA < lenA; iA++) {
+    double* S_row = S[iA];
+    for (int iB = 0; iB < lenB; iB++) {
+      S_row[iB] = -1.0;
       if (iA > lenA - wSize || iB > lenB - wSize)
 	continue;
 		
@@ -103,13 +114,15 @@ double** calcS(double** d1, double** d2, int lenA, int lenB, int wSize)
       // residues is 3.8 Angstroms.  Due to entropy, S = -k ln pi * pi,
       // this tell us nothing, so it doesn't help so ignore it.
       //
-      for (row = 0; row <  wSize - 2; row++) {
-	for (col = row + 2; col <  wSize; col++) {
-	  score += fabs( d1[iA+row][iA+col] - d2[iB+row][iB+col] );
+      for (int row = 0; row <  wSize - 2; row++) {
+	const double* d1_row = d1[iA + row] + iA;
+	const double* d2_row = d2[iB + row] + iB;
+	for (int col = row + 2; col <  wSize; col++) {
+	  score += fabs( d1_row[col] - d2_row[col] );
 	}
       }
 
-      S[iA][iB] = score / sumSize;
+      S_row[iB] = score / sumSize;
     }
   }
   return S;
@@ -117,13 +130,10 @@ double** calcS(double** d1, double** d2, int lenA, int lenB, int wSize)
 
 
 
-pcePoint getCoords(PyObject* L, int length)
+std::vector<cePoint> getCoords(PyObject* L, int length)
 {
   // make space for the current coords
-  pcePoint coords = (pcePoint) malloc(sizeof(cePoint)*length);
-
-  if (!coords)
-    return nullptr;
+  std::vector<cePoint> coords(length);
 
   // loop through the arguments, pulling out the
   // XYZ coordinates.
@@ -154,8 +164,201 @@ pcePoint getCoords(PyObject* L, int length)
 }
 
 
+namespace {
 
-pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, float D0, float D1, int winSize, int gapMax, int * bufferSize )
+// Scratch buffers for extending one seed (one set per thread)
+struct ceSeedScratch {
+  // this 2D array keeps track of all partial gapped scores
+  std::vector<double> allScoreBuffer;
+  std::vector<int> tIndex;
+  std::vector<afp> curPath;
+};
+
+// All extensions of one seed
+struct ceSeedPath {
+  std::vector<afp> path;      // longest extension
+  std::vector<double> scores; // total score of each extension (length = index + 2)
+};
+
+struct ceSearch {
+  const ceMatrix& S;
+  const ceMatrix& dA;
+  const ceMatrix& dB;
+  int lenA, lenB;
+  float D0, D1;
+  int winSize, gapMax;
+  int smaller;
+  int winSum;
+  std::vector<int> winCache;
+};
+
+} // namespace
+
+//
+// Check all possible paths starting from iA, iB. Independent of other seeds.
+//
+static void extendSeed(const ceSearch& C, int iA, int iB, ceSeedScratch& scratch, ceSeedPath& out)
+{
+  const ceMatrix& S = C.S;
+  const ceMatrix& dA = C.dA;
+  const ceMatrix& dB = C.dB;
+  const int lenA = C.lenA, lenB = C.lenB;
+  const float D0 = C.D0, D1 = C.D1;
+  const int winSize = C.winSize, gapMax = C.gapMax;
+  const int winSum = C.winSum;
+  const int* winCache = C.winCache.data();
+  const int nGap = gapMax * 2 + 1;
+  double* allScoreBuffer = scratch.allScoreBuffer.data();
+  int* tIndex = scratch.tIndex.data();
+  afp* curPath = scratch.curPath.data();
+
+  // only the first curPathLength entries are used, no need to reset
+  curPath[0].first = iA;
+  curPath[0].second = iB;
+  int curPathLength = 1;
+  tIndex[curPathLength-1] = 0;
+  double curTotalScore = 0.0;
+  int gapBestIndex = -1;
+
+  out.scores.clear();
+
+  int done = 0;
+  while ( ! done ) {
+    double gapBestScore = 1e6;
+    gapBestIndex = -1;
+    int g;
+
+    //
+    // Check all possible gaps [1..gapMax] from here
+    //
+    for ( g = 0; g < nGap; g++ ) {
+      int jA = curPath[curPathLength-1].first + winSize;
+      int jB = curPath[curPathLength-1].second + winSize;
+
+      if ( (g+1) % 2 == 0 ) {
+	jA += (g+1)/2;
+      }
+      else { // ( g odd )
+	jB += (g+1)/2;
+      }
+
+      //
+      // Following are three heuristics to ensure high quality
+      // long paths and make sure we don't run over the end of
+      // the S, matrix.
+					
+      // 1st: If jA and jB are at the end of the matrix
+      if ( jA > lenA-winSize || jB > lenB-winSize ){
+	// FIXME, was: jA > lenA-winSize-1 || jB > lenB-winSize-1
+	continue;
+      }
+      // 2nd: If this gapped octapeptide is bad, ignore it.
+      if ( S[jA][jB] > D0 )
+	continue;
+      // 3rd: if too close to end, ignore it.
+      if ( S[jA][jB] == -1.0 )
+	continue;
+					
+      double curScore = 0.0;
+      const double curScoreDenom = (double) winSize * (double) curPathLength;
+      const double curScoreBound = std::min((double) D1, gapBestScore);
+      int s;
+      for ( s = 0; s < curPathLength; s++ ) {
+	// the partial sum only grows, stop as soon as this gap can't be
+	// accepted anymore (below D1 and better than the best gap so far)
+	if ( s && curScore / curScoreDenom >= curScoreBound )
+	  break;
+
+	const double* dA_s = dA[curPath[s].first];
+	const double* dB_s = dB[curPath[s].second];
+	const double* dA_e = dA[curPath[s].first + (winSize-1)];
+	const double* dB_e = dB[curPath[s].second + (winSize-1)];
+	curScore += fabs( dA_s[jA] - dB_s[jB] );
+	curScore += fabs( dA_e[jA+(winSize-1)] - dB_e[jB+(winSize-1)] );
+	int k;
+	for ( k = 1; k < winSize-1; k++ )
+	  curScore += fabs( dA[curPath[s].first  + k][ jA + (winSize-1) - k ] - 
+			    dB[curPath[s].second + k][ jB + (winSize-1) - k ] );
+      }
+					
+      if ( s < curPathLength )
+	continue;
+
+      curScore /= curScoreDenom;
+
+      if ( curScore >= D1 ) {
+	continue;
+      }
+
+      // store GAPPED best					
+      if ( curScore < gapBestScore ) {
+	curPath[curPathLength].first = jA;
+	curPath[curPathLength].second = jB;
+	gapBestScore = curScore;
+	gapBestIndex = g;
+	allScoreBuffer[(curPathLength-1) * nGap + g] = curScore;
+      }
+    } /// ROF -- END GAP SEARCHING
+				
+    //
+    // DONE GAPPING:
+    //
+
+    // calculate curTotalScore
+    curTotalScore = 0.0;
+    int jGap, gA, gB;
+    double score1=0.0, score2=0.0;
+				
+    if ( gapBestIndex != -1 ) {
+      jGap = (gapBestIndex + 1 ) / 2;
+      if ((gapBestIndex + 1 ) % 2 == 0) {
+	gA = curPath[ curPathLength-1 ].first + winSize + jGap;
+	gB = curPath[ curPathLength-1 ].second + winSize;
+      }
+      else {
+	gA = curPath[ curPathLength-1 ].first + winSize;
+	gB = curPath[ curPathLength-1 ].second + winSize + jGap;
+      }
+
+      // perfect
+      score1 = (allScoreBuffer[(curPathLength-1) * nGap + gapBestIndex] * winSize * curPathLength
+		+ S[gA][gB]*winSum)/(winSize*curPathLength+winSum);
+
+      // perfect
+      score2 = ((curPathLength > 1 ? (allScoreBuffer[(curPathLength-2) * nGap + tIndex[curPathLength-1]])
+		 : S[iA][iB])
+		* winCache[curPathLength-1] 
+		+ score1 * (winCache[curPathLength] - winCache[curPathLength-1]))
+	/ winCache[curPathLength];
+
+      curTotalScore = score2;
+      // heuristic -- path is getting sloppy, stop looking
+      if ( curTotalScore > D1 ) {
+	done = 1;
+	gapBestIndex=-1;
+	break;
+      }
+      else {
+	allScoreBuffer[(curPathLength-1) * nGap + gapBestIndex] = curTotalScore;
+	tIndex[curPathLength] = gapBestIndex;
+	curPathLength++;
+      }
+    }
+    else {
+      // if here, then there was no good gapped path
+      // so quit and restart from iA, iB+1
+      done = 1;
+      curPathLength--;
+      break;
+    }
+
+    out.scores.push_back(curTotalScore);
+  } /// END WHILE
+
+  out.path.assign(curPath, curPath + out.scores.size() + 1);
+}
+
+std::vector<std::vector<afp>> findPath( const ceMatrix& S, const ceMatrix& dA, const ceMatrix& dB, int lenA, int lenB, float D0, float D1, int winSize, int gapMax )
 {
   // CE-specific cutoffs
   const int MAX_KEPT = 20;
@@ -168,57 +371,59 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
   int smaller = ( lenA < lenB ) ? lenA : lenB;
   int winSum = (winSize-1)*(winSize-2)/2;
 
-  path bestPath = (path) malloc(sizeof(afp)*smaller);
-
-  // index variable for below
-  int i, j;
-  for ( i = 0; i < smaller; i++ ) {
-    bestPath[i].first = -1;
-    bestPath[i].second = -1;
-  }
+  std::vector<afp> bestPath(smaller, afp{-1, -1});
 
   //======================================================================
   // for storing the best 20 paths
-  int bufferIndex = 0; //, bufferSize = 0;
+  int bufferIndex = 0, bufferSize = 0;
   int lenBuffer[MAX_KEPT];
   double scoreBuffer[MAX_KEPT];
-  pathCache pathBuffer = (pathCache) malloc(sizeof(path*)*MAX_KEPT);
+  std::vector<std::vector<afp>> pathBuffer(MAX_KEPT);
 
+  int i;
   for ( i = 0; i < MAX_KEPT; i++ ) {
     // initialize the paths
     scoreBuffer[i] = 1e6;
     lenBuffer[i] = 0;
-    pathBuffer[i] = 0;
   }
 
+  ceSearch C{S, dA, dB, lenA, lenB, D0, D1, winSize, gapMax, smaller, winSum, {}};
+
   // winCache
   // this array stores a list of residues seen.  We use it to calculate the
   // total score of a path from 1..M and then add it to M+1..N.
-  int* winCache = (int*) malloc(sizeof(int)*smaller);
+  C.winCache.resize(smaller);
   for ( i = 0; i < smaller; i++ )
-    winCache[i] = (i+1)*i*winSize/2 + (i+1)*winSum;
-
-  // allScoreBuffer
-  // this 2D array keeps track of all partial gapped scores
-  double** allScoreBuffer = (double**) malloc(sizeof(double*)*smaller);
-  for ( i = 0; i < smaller; i++ ) {
-    allScoreBuffer[i] = (double*) malloc( (gapMax*2+1) * sizeof(double));
-    // initialize the ASB
-    for ( j = 0; j < gapMax*2+1; j++ )
-      allScoreBuffer[i][j] = 1e6;
+    C.winCache[i] = (i+1)*i*winSize/2 + (i+1)*winSum;
+
+#ifdef PYMOL_OPENMP
+  // only one thread per search if called from a parallel region (batch)
+  std::vector<ceSeedScratch> scratch(
+      omp_in_parallel() ? 1 : omp_get_max_threads());
+#else
+  std::vector<ceSeedScratch> scratch(1);
+#endif
+  for (auto& sc : scratch) {
+    sc.allScoreBuffer.assign(size_t(smaller) * (gapMax*2+1), 1e6);
+    sc.tIndex.resize(smaller);
+    sc.curPath.resize(smaller);
   }
-	
-  int* tIndex = (int*) malloc(sizeof(int)*smaller);
-  int gapBestIndex = -1;
+
+  std::vector<int> seeds;
+  std::vector<ceSeedPath> seedPaths;
 
   //======================================================================
   // Start the search through the CE matrix.
   //
+  // Seeds of one row are extended in parallel. Merging the results in
+  // order gives the same best paths (and pruning) as the serial search.
+  //
   int iA, iB;
   for ( iA = 0; iA < lenA; iA++ ) {
     if ( iA > lenA - winSize*(bestPathLength-1) )
       break;
 
+    seeds.clear();
     for ( iB = 0; iB < lenB; iB++ ) {
       if ( S[iA][iB] >= D0 )
 	continue;
@@ -226,170 +431,50 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
       if ( S[iA][iB] == -1.0 )
 	continue;
 			
+      // bestPathLength can only grow, so this is a superset of the
+      // seeds which are visited below
       if ( iB > lenB - winSize*(bestPathLength-1) )
 	break;
 
-      //
-      // Restart curPath here.
-      //
-      path curPath = (path) malloc( sizeof(afp)*smaller );
-
-      int i;
-      for ( i = 0; i < smaller; i++ ) {
-	curPath[i].first = -1;
-	curPath[i].second = -1;
-      }
-      curPath[0].first = iA;
-      curPath[0].second = iB;
-      int curPathLength = 1;
-      tIndex[curPathLength-1] = 0;
-      double curTotalScore = 0.0;
-
-      //
-      // Check all possible paths starting from iA, iB
-      //
-      int done = 0;
-      while ( ! done ) {
-	double gapBestScore = 1e6;
-	gapBestIndex = -1;
-	int g;
-
-	//
-	// Check all possible gaps [1..gapMax] from here
-	//
-	for ( g = 0; g < (gapMax*2)+1; g++ ) {
-	  int jA = curPath[curPathLength-1].first + winSize;
-	  int jB = curPath[curPathLength-1].second + winSize;
-
-	  if ( (g+1) % 2 == 0 ) {
-	    jA += (g+1)/2;
-	  }
-	  else { // ( g odd )
-	    jB += (g+1)/2;
-	  }
+      seeds.push_back(iB);
+    }
 
-	  //
-	  // Following are three heuristics to ensure high quality
-	  // long paths and make sure we don't run over the end of
-	  // the S, matrix.
-					
-	  // 1st: If jA and jB are at the end of the matrix
-	  if ( jA > lenA-winSize || jB > lenB-winSize ){
-	    // FIXME, was: jA > lenA-winSize-1 || jB > lenB-winSize-1
-	    continue;
-	  }
-	  // 2nd: If this gapped octapeptide is bad, ignore it.
-	  if ( S[jA][jB] > D0 )
-	    continue;
-	  // 3rd: if too close to end, ignore it.
-	  if ( S[jA][jB] == -1.0 )
-	    continue;
-					
-	  double curScore = 0.0;
-	  int s;
-	  for ( s = 0; s < curPathLength; s++ ) {
-	    curScore += fabs( dA[curPath[s].first][jA] - dB[curPath[s].second][jB] );
-	    curScore += fabs( dA[curPath[s].first  + (winSize-1)][jA+(winSize-1)] - 
-			      dB[curPath[s].second + (winSize-1)][jB+(winSize-1)] );
-	    int k;
-	    for ( k = 1; k < winSize-1; k++ )
-	      curScore += fabs( dA[curPath[s].first  + k][ jA + (winSize-1) - k ] - 
-				dB[curPath[s].second + k][ jB + (winSize-1) - k ] );
-	  }
-					
-	  curScore /= (double) winSize * (double) curPathLength;
+    int const nSeeds = seeds.size();
+    if (seedPaths.size() < size_t(nSeeds))
+      seedPaths.resize(nSeeds);
 
-	  if ( curScore >= D1 ) {
-	    continue;
-	  }
+#pragma omp parallel for schedule(dynamic) num_threads(int(scratch.size()))
+    for (int n = 0; n < nSeeds; n++) {
+#ifdef PYMOL_OPENMP
+      auto& sc = scratch[omp_get_thread_num()];
+#else
+      auto& sc = scratch[0];
+#endif
+      extendSeed(C, iA, seeds[n], sc, seedPaths[n]);
+    }
 
-	  // store GAPPED best					
-	  if ( curScore < gapBestScore ) {
-	    curPath[curPathLength].first = jA;
-	    curPath[curPathLength].second = jB;
-	    gapBestScore = curScore;
-	    gapBestIndex = g;
-	    allScoreBuffer[curPathLength-1][g] = curScore;
-	  }
-	} /// ROF -- END GAP SEARCHING
-				
-	//
-	// DONE GAPPING:
-	//
-
-	// calculate curTotalScore
-	curTotalScore = 0.0;
-	int jGap, gA, gB;
-	double score1=0.0, score2=0.0;
-				
-	if ( gapBestIndex != -1 ) {
-	  jGap = (gapBestIndex + 1 ) / 2;
-	  if ((gapBestIndex + 1 ) % 2 == 0) {
-	    gA = curPath[ curPathLength-1 ].first + winSize + jGap;
-	    gB = curPath[ curPathLength-1 ].second + winSize;
-	  }
-	  else {
-	    gA = curPath[ curPathLength-1 ].first + winSize;
-	    gB = curPath[ curPathLength-1 ].second + winSize + jGap;
-	  }
+    for (int n = 0; n < nSeeds; n++) {
+      iB = seeds[n];
 
-	  // perfect
-	  score1 = (allScoreBuffer[curPathLength-1][gapBestIndex] * winSize * curPathLength
-		    + S[gA][gB]*winSum)/(winSize*curPathLength+winSum);
-
-	  // perfect
-	  score2 = ((curPathLength > 1 ? (allScoreBuffer[curPathLength-2][tIndex[curPathLength-1]])
-		     : S[iA][iB])
-		    * winCache[curPathLength-1] 
-		    + score1 * (winCache[curPathLength] - winCache[curPathLength-1]))
-	    / winCache[curPathLength];
-
-	  curTotalScore = score2;
-	  // heuristic -- path is getting sloppy, stop looking
-	  if ( curTotalScore > D1 ) {
-	    done = 1;
-	    gapBestIndex=-1;
-	    break;
-	  }
-	  else {
-	    allScoreBuffer[curPathLength-1][gapBestIndex] = curTotalScore;
-	    tIndex[curPathLength] = gapBestIndex;
-	    curPathLength++;
-	  }
-	}
-	else {
-	  // if here, then there was no good gapped path
-	  // so quit and restart from iA, iB+1
-	  done = 1;
-	  curPathLength--;
-	  break;
-	}
+      if ( iB > lenB - winSize*(bestPathLength-1) )
+	break;
 
-	//
-	// test this gapped path against the best seen
-	// starting from iA, iB
-	// 
+      const ceSeedPath& seedPath = seedPaths[n];
 
-	// if our currently best gapped path from iA and iB is LONGER
-	// than the current best; or, it's equal length and the score's
-	// better, keep the new path.
+      // if our currently best gapped path from iA and iB is LONGER
+      // than the current best; or, it's equal length and the score's
+      // better, keep the new path.
+      for (size_t k = 0; k < seedPath.scores.size(); k++) {
+	int curPathLength = k + 2;
+	double curTotalScore = seedPath.scores[k];
 	if ( curPathLength > bestPathLength ||
 	     (curPathLength == bestPathLength && curTotalScore < bestPathScore )) {
 	  bestPathLength = curPathLength;
 	  bestPathScore = curTotalScore;
-	  // deep copy curPath
-	  path tempPath = (path) malloc( sizeof(afp)*smaller );
-
-	  int i;
-	  for ( i = 0; i < smaller; i++ ) {
-	    tempPath[i].first = curPath[i].first;
-	    tempPath[i].second = curPath[i].second;
-	  }
-
-	  free(bestPath);
-	  bestPath = tempPath;
+	  std::fill(bestPath.begin(), bestPath.end(), afp{-1, -1});
+	  std::copy_n(seedPath.path.begin(), curPathLength, bestPath.begin());
 	}
-      } /// END WHILE
+      }
 
       //
       // At this point, we've found the best path starting at iA, iB.
@@ -401,49 +486,30 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
 	// we're going to add an entry to the ring-buffer.
 	// Adjust maxSize values and curIndex accordingly.
 	bufferIndex = ( bufferIndex == MAX_KEPT-1 ) ? 0 : bufferIndex+1;
-	*bufferSize = ( *bufferSize < MAX_KEPT ) ? (*bufferSize)+1 : MAX_KEPT;
-	path pathCopy = (path) malloc( sizeof(afp)*smaller );
-
-	int i;
-	for ( i = 0; i < smaller; i++ ) {
-	  pathCopy[i].first = bestPath[i].first;
-	  pathCopy[i].second = bestPath[i].second;
-	}
+	bufferSize = ( bufferSize < MAX_KEPT ) ? bufferSize+1 : MAX_KEPT;
 
-	if ( bufferIndex == 0 && (*bufferSize) == MAX_KEPT ) {
-	  if ( pathBuffer[MAX_KEPT-1] )
-	    free(pathBuffer[MAX_KEPT-1]); 
-	  pathBuffer[MAX_KEPT-1] = pathCopy;
+	if ( bufferIndex == 0 && bufferSize == MAX_KEPT ) {
+	  pathBuffer[MAX_KEPT-1] = bestPath;
 	  scoreBuffer[MAX_KEPT-1] = bestPathScore;
 	  lenBuffer[MAX_KEPT-1] = bestPathLength;
 	}
 	else {	
-	  if ( pathBuffer[bufferIndex-1] )
-	    free(pathBuffer[bufferIndex-1]);
-	  pathBuffer[bufferIndex-1] = pathCopy;
+	  pathBuffer[bufferIndex-1] = bestPath;
 	  scoreBuffer[bufferIndex-1] = bestPathScore;
 	  lenBuffer[bufferIndex-1] = bestPathLength;
 	}
       }
-      free(curPath); curPath=0;
     } // ROF -- end for iB
   } // ROF -- end for iA
 
-  // free memory
-  for ( i = 0; i < smaller; i++ )
-    free(allScoreBuffer[i]);
-  free(allScoreBuffer);
-  free(tIndex);
-  free(winCache);
-  free(bestPath);
-
+  pathBuffer.resize(bufferSize);
   return pathBuffer;
 }
 
 
 
 
-PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int bufferSize, int smaller, int winSize )
+bool findBest( const cePoint* coordsA, const cePoint* coordsB, const std::vector<std::vector<afp>>& paths, int smaller, int winSize, ceAlignment& result )
 {
   // keep the best values
   double bestRMSD = 1e6;
@@ -453,7 +519,7 @@ PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int buf
   int bestO = -1;
 	
   // loop through the buffer
-  for ( int o = 0; o < bufferSize; o++ ) {
+  for ( int o = 0; o < (int) paths.size(); o++ ) {
 
     // grab the current path
     TA2<double> c1(smaller, 3, 0.0);
@@ -610,27 +676,69 @@ PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int buf
 
   if ( bestRMSD == 1e6 ) {
     std::cout << "ERROR: Best RMSD found was 1e6.  Broken.\n";
-    return nullptr;
+    return false;
+  }
+
+  const double ttt[16] = {
+    bestU[0][0], bestU[1][0], bestU[2][0], bestCOM1[0],
+    bestU[0][1], bestU[1][1], bestU[2][1], bestCOM1[1],
+    bestU[0][2], bestU[1][2], bestU[2][2], bestCOM1[2],
+    -bestCOM2[0], -bestCOM2[1], -bestCOM2[2], 1.};
+
+  result.length = bestLen;
+  result.rmsd = bestRMSD;
+  std::copy_n(ttt, 16, result.ttt);
+  result.pathA.clear();
+  result.pathB.clear();
+  for (int j = 0; j < smaller && paths[bestO][j].first != -1; j++) {
+    result.pathA.push_back(paths[bestO][j].first);
+    result.pathB.push_back(paths[bestO][j].second);
   }
 
+  return true;
+}
+
+
+bool ceAlign(const std::vector<cePoint>& coordsA, const ceMatrix& dmA,
+    const std::vector<cePoint>& coordsB, float D0, float D1, int winSize,
+    int gapMax, ceAlignment& result)
+{
+  int lenA = coordsA.size();
+  int lenB = coordsB.size();
+  int smaller = ( lenA < lenB ) ? lenA : lenB;
+
+  // calculate the distance matrix for B and the similarity matrix
+  ceMatrix dmB = calcDM(coordsB.data(), lenB);
+  ceMatrix S = calcS(dmA, dmB, lenA, lenB, winSize);
+
+  // find the best path through the CE Sim. matrix
+  auto paths = findPath(S, dmA, dmB, lenA, lenB, D0, D1, winSize, gapMax);
+
+  return findBest(coordsA.data(), coordsB.data(), paths, smaller, winSize, result);
+}
+
+
+PyObject* ceAlignmentAsPyList(const ceAlignment& result)
+{
+  const double* t = result.ttt;
   PyObject* pyU = Py_BuildValue( "[f,f,f,f, f,f,f,f, f,f,f,f, f,f,f,f]",
-				 bestU[0][0], bestU[1][0], bestU[2][0], bestCOM1[0],
-				 bestU[0][1], bestU[1][1], bestU[2][1], bestCOM1[1],
-				 bestU[0][2], bestU[1][2], bestU[2][2], bestCOM1[2],
-				 -bestCOM2[0], -bestCOM2[1], -bestCOM2[2], 1.);
-	
+				 t[0], t[1], t[2], t[3],
+				 t[4], t[5], t[6], t[7],
+				 t[8], t[9], t[10], t[11],
+				 t[12], t[13], t[14], t[15]);
+
   PyObject* pyPathA = PyList_New(0);
   PyObject* pyPathB = PyList_New(0);
-  for (int j = 0; j < smaller && paths[bestO][j].first != -1; j++) {
-    PyObject* v = Py_BuildValue("i", paths[bestO][j].first);
+  for (size_t j = 0; j < result.pathA.size(); j++) {
+    PyObject* v = Py_BuildValue("i", result.pathA[j]);
     PyList_Append(pyPathA, v);
     Py_DECREF(v);
-    v = Py_BuildValue("i", paths[bestO][j].second);
+    v = Py_BuildValue("i", result.pathB[j]);
     PyList_Append(pyPathB, v);
     Py_DECREF(v);
   }
 
-  return Py_BuildValue("[ifNNN]", bestLen, bestRMSD, pyU, pyPathA, pyPathB);
+  return Py_BuildValue("[ifNNN]", result.length, result.rmsd, pyU, pyPathA, pyPathB);
 }
 
 
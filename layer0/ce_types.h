@@ -3,6 +3,8 @@
 
 #include"os_python.h"
 
+#include <vector>
+
 /*
 // Typical XYZ point and array of points
 */
@@ -13,29 +15,63 @@ typedef struct {
 } cePoint, *pcePoint;
 
 /*
-// An AFP (aligned fragment pair), and list/pointer
+// An AFP (aligned fragment pair)
 */
 typedef struct {
 	int first;
 	int second;
-} afp, *path, **pathCache;
+} afp;
+
+/*
+// Dense (contiguous, row-major) matrix
+*/
+struct ceMatrix {
+	int rows = 0;
+	int cols = 0;
+	std::vector<double> data;
+
+	ceMatrix() = default;
+	ceMatrix(int rows_, int cols_)
+	    : rows(rows_), cols(cols_), data(size_t(rows_) * cols_) {}
+
+	double* operator[](int row) { return data.data() + size_t(row) * cols; }
+	const double* operator[](int row) const {
+		return data.data() + size_t(row) * cols;
+	}
+};
+
+/*
+// Result of findBest
+*/
+struct ceAlignment {
+	int length = 0;     // number of aligned residues
+	double rmsd = 0.0;
+	double ttt[16];     // TTT matrix (column major rotation, pre/post translation)
+	std::vector<int> pathA, pathB; // start of each aligned fragment
+};
 
 /////////////////////////////////////////////////////////////////////////////
 // Function Declarations
 /////////////////////////////////////////////////////////////////////////////
 // Calculates the CE Similarity Matrix
-double** calcS(double** d1, double** d2, int lenA, int lenB, int wSize);
+ceMatrix calcS(const ceMatrix& d1, const ceMatrix& d2, int lenA, int lenB, int wSize);
 
 // calculates a simple distance matrix
-double** calcDM(pcePoint coords, int len);
+ceMatrix calcDM(const cePoint* coords, int len);
 
 // Converter: Python Object -> C Structs
-pcePoint getCoords( PyObject* L, int len );
+std::vector<cePoint> getCoords( PyObject* L, int len );
 
-// Optimal path finding algorithm (CE).
-pathCache findPath(double** S, double** dA, double**dB, int lenA, int lenB, float D0, float D1, int winSize, int gapMax, int* bufferSize);
+// Optimal path finding algorithm (CE). Returns up to 20 best paths.
+std::vector<std::vector<afp>> findPath(const ceMatrix& S, const ceMatrix& dA, const ceMatrix& dB, int lenA, int lenB, float D0, float D1, int winSize, int gapMax);
 
 // filter through the results and find the best
-PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int bufferSize, int smaller, int winSize );
+bool findBest( const cePoint* coordsA, const cePoint* coordsB, const std::vector<std::vector<afp>>& paths, int smaller, int winSize, ceAlignment& result );
+
+// Full alignment (all of the above), thread-safe
+bool ceAlign( const std::vector<cePoint>& coordsA, const ceMatrix& dmA, const std::vector<cePoint>& coordsB, float D0, float D1, int winSize, int gapMax, ceAlignment& result );
+
+// Converter: C Structs -> Python Object [len, rmsd, ttt, pathA, pathB]
+PyObject* ceAlignmentAsPyList( const ceAlignment& result );
 
 #endif
@@ -42,7 +42,7 @@ Z* -------------------------------------------------------------------
 #undef None
 #endif
 
-enum class cCylCap {
+enum class cCylCap : unsigned char {
   None = 0,
   Flat = 1,
   Round = 2,
@@ -70,16 +70,17 @@ typedef struct {
   int vert;
   float v1[3], v2[3], v3[3];
   float n0[3], n1[3], n2[3], n3[3];
-  float c1[3], c2[3], c3[3], ic[3], tr[3];      /* ic = interior color, tr = transparency */
+  float c1[3], c2[3], c3[3], tr[3];     /* tr = transparency */
   float r1, r2, l1;
   float trans;
   int char_id;
+  int ic;                       /* interior color, index into CRay::IntColors */
   char type;
   cCylCap cap1, cap2;
-  int cull;
+  char cull;
   char wobble, ramped, no_lighting;
   /* float wobble_param[3] eliminated to save space */
-} CPrimitive;                   /* currently 172 bytes -> appoximately 6.5 million primitives per gigabyte */
+} CPrimitive;                   /* currently 168 bytes -> approximately 6.4 million primitives per gigabyte */
 
 typedef struct {
   PyMOLGlobals *G;
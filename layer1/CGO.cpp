@@ -426,6 +426,98 @@ CGO* CGONewFromPyList(
   }
 }
 
+namespace cgo
+{
+/**
+ * Typed structure-of-arrays vertex streams of the BEGIN/END block which is
+ * being recorded, see CGOSetCombineBeginEnd(). Every attribute is recorded
+ * for every vertex, CGOEnd() keeps the ones which were set inside the block
+ * (same rules as CGOCombineBeginEnd). The buffers keep their capacity from
+ * one block to the next.
+ */
+struct vertex_streams {
+  bool in_block = false;
+  int mode = 0;
+  int arraybits = 0;
+  bool first_color = false; // color only set before the first vertex
+  bool first_alpha = false; // alpha only set before the first vertex
+  float normal[3];
+  float accessibility = 1.f;
+  std::vector<float> vertexVals;
+  std::vector<float> normalVals;
+  std::vector<float> colorVals;
+  std::vector<float> pickColorVals;
+  std::vector<float> accessibilityVals;
+
+  int nverts() const { return vertexVals.size() / VERTEX_POS_SIZE; }
+};
+} // namespace cgo
+
+/**
+ * Vertex streams of the BEGIN/END block which is being recorded, or nullptr
+ */
+static cgo::vertex_streams* CGOGetRecordingStreams(CGO* I)
+{
+  auto streams = I->begin_end_streams.get();
+  return (streams && streams->in_block) ? streams : nullptr;
+}
+
+static void CGOStreamVertex(
+    const CGO* I, cgo::vertex_streams& streams, const float* v)
+{
+  streams.vertexVals.insert(streams.vertexVals.end(), v, v + 3);
+  streams.normalVals.insert(
+      streams.normalVals.end(), streams.normal, streams.normal + 3);
+  streams.colorVals.insert(streams.colorVals.end(), I->color, I->color + 3);
+  streams.colorVals.push_back(I->alpha);
+  auto const pla = streams.pickColorVals.size();
+  streams.pickColorVals.resize(pla + VERTEX_PICKCOLOR_INDEX_SIZE);
+  CGO_put_uint(streams.pickColorVals.data() + pla, I->current_pick_color_index);
+  CGO_put_int(streams.pickColorVals.data() + pla + 1, I->current_pick_color_bond);
+  streams.accessibilityVals.push_back(streams.accessibility);
+}
+
+/**
+ * Ends the recorded BEGIN/END block and writes it as a CGO_DRAW_ARRAYS
+ * operation
+ */
+static int CGOFlushStreams(CGO* I, cgo::vertex_streams& streams)
+{
+  streams.in_block = false;
+
+  int const nverts = streams.nverts();
+  if (!nverts)
+    return true;
+
+  if (streams.first_alpha && !CGOAlpha(I, I->alpha))
+    return false;
+  if (streams.first_color && !CGOColorv(I, I->color))
+    return false;
+
+  float* vals =
+      I->add<cgo::draw::arrays>(streams.mode, streams.arraybits, nverts);
+  if (!vals)
+    return false;
+
+  vals = std::copy(streams.vertexVals.begin(), streams.vertexVals.end(), vals);
+  if (streams.arraybits & CGO_NORMAL_ARRAY) {
+    vals = std::copy(streams.normalVals.begin(), streams.normalVals.end(), vals);
+  }
+  if (streams.arraybits & CGO_COLOR_ARRAY) {
+    vals = std::copy(streams.colorVals.begin(), streams.colorVals.end(), vals);
+  }
+  if (streams.arraybits & CGO_PICK_COLOR_ARRAY) {
+    vals += VERTEX_PICKCOLOR_RGBA_SIZE * nverts;
+    vals = std::copy(
+        streams.pickColorVals.begin(), streams.pickColorVals.end(), vals);
+  }
+  if (streams.arraybits & CGO_ACCESSIBILITY_ARRAY) {
+    std::copy(streams.accessibilityVals.begin(),
+        streams.accessibilityVals.end(), vals);
+  }
+  return true;
+}
+
 CGO::CGO(PyMOLGlobals* G, int size)
     : G(G)
 {
@@ -447,6 +539,25 @@ void CGOSetUseShader(CGO* I, int use_shader)
     I->cgo_shader_ub_normal = 0;
   }
 }
+
+/**
+ * Record BEGIN/END blocks as CGO_DRAW_ARRAYS operations right away, instead
+ * of CGO_BEGIN ... CGO_END which need a CGOCombineBeginEnd() pass. Blocks
+ * may only contain vertex, normal, color, alpha, pick color and
+ * accessibility operations.
+ *
+ * Switching it off releases the stream buffers and discards an unfinished
+ * block.
+ */
+void CGOSetCombineBeginEnd(CGO* I, bool combine)
+{
+  if (!combine) {
+    I->begin_end_streams.reset();
+  } else if (!I->begin_end_streams) {
+    I->begin_end_streams = std::make_unique<cgo::vertex_streams>();
+  }
+}
+
 void CGOReset(CGO* I)
 {
   I->c = 0;
@@ -590,6 +701,24 @@ int CGOFromFloatArray(CGO* I, const float* src, int len)
 
 int CGOBegin(CGO* I, int mode)
 {
+  if (auto streams = I->begin_end_streams.get()) {
+    assert(!streams->in_block);
+    streams->in_block = true;
+    streams->mode = mode;
+    streams->arraybits = CGO_VERTEX_ARRAY;
+    streams->first_color = false;
+    streams->first_alpha = false;
+    copy3f(I->normal, streams->normal);
+    streams->vertexVals.clear();
+    streams->normalVals.clear();
+    streams->colorVals.clear();
+    streams->pickColorVals.clear();
+    streams->accessibilityVals.clear();
+    I->texture[0] = 0.f;
+    I->texture[1] = 0.f;
+    return true;
+  }
+
   float* pc = CGO_add(I, CGO_BEGIN_SZ + 1);
   if (!pc)
     return false;
@@ -603,6 +732,10 @@ int CGOBegin(CGO* I, int mode)
 
 int CGOEnd(CGO* I)
 {
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    return CGOFlushStreams(I, *streams);
+  }
+
   float* pc = CGO_add(I, CGO_END_SZ + 1);
   if (!pc)
     return false;
@@ -719,6 +852,12 @@ int CGOBoundingBox(CGO* I, const float* min, const float* max)
 
 int CGOAccessibility(CGO* I, float a)
 {
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    streams->arraybits |= CGO_ACCESSIBILITY_ARRAY;
+    streams->accessibility = a;
+    return true;
+  }
+
   float* pc = CGO_add(I, CGO_ACCESSIBILITY_SZ + 1);
   if (!pc)
     return false;
@@ -858,6 +997,12 @@ int CGOPickColor(CGO* I, unsigned int index, int bond)
   if (I->current_pick_color_index == index &&
       I->current_pick_color_bond == bond)
     return true;
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    streams->arraybits |= CGO_PICK_COLOR_ARRAY;
+    I->current_pick_color_index = index;
+    I->current_pick_color_bond = bond;
+    return true;
+  }
   float* pc = CGO_add(I, CGO_PICK_COLOR_SZ + 1);
   if (!pc)
     return false;
@@ -871,6 +1016,17 @@ int CGOPickColor(CGO* I, unsigned int index, int bond)
 
 int CGOAlpha(CGO* I, float alpha)
 {
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    if (streams->nverts()) {
+      streams->first_alpha = false;
+      streams->arraybits |= CGO_COLOR_ARRAY;
+    } else {
+      streams->first_alpha = true;
+    }
+    I->alpha = alpha;
+    return true;
+  }
+
   float* pc = CGO_add(I, CGO_ALPHA_SZ + 1);
   if (!pc)
     return false;
@@ -1050,6 +1206,12 @@ int CGOAlphaTriangle(CGO* I, const float* v1, const float* v2, const float* v3,
 
 int CGOVertex(CGO* I, float v1, float v2, float v3)
 {
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    const float v[3] = {v1, v2, v3};
+    CGOStreamVertex(I, *streams, v);
+    return true;
+  }
+
   float* pc = CGO_add(I, CGO_VERTEX_SZ + 1);
   if (!pc)
     return false;
@@ -1062,6 +1224,11 @@ int CGOVertex(CGO* I, float v1, float v2, float v3)
 
 int CGOVertexv(CGO* I, const float* v)
 {
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    CGOStreamVertex(I, *streams, v);
+    return true;
+  }
+
   float* pc = CGO_add(I, CGO_VERTEX_SZ + 1);
   if (!pc)
     return false;
@@ -1099,6 +1266,19 @@ int CGOInterpolated(CGO* I, const bool interp)
 
 int CGOColor(CGO* I, float v1, float v2, float v3)
 {
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    if (streams->nverts()) {
+      streams->first_color = false;
+      streams->arraybits |= CGO_COLOR_ARRAY;
+    } else {
+      streams->first_color = true;
+    }
+    I->color[0] = v1;
+    I->color[1] = v2;
+    I->color[2] = v3;
+    return true;
+  }
+
   float* pc = CGO_add(I, CGO_COLOR_SZ + 1);
   if (!pc)
     return false;
@@ -1132,6 +1312,13 @@ int CGOTexCoord2f(CGO* I, float v1, float v2)
 
 int CGONormal(CGO* I, float v1, float v2, float v3)
 {
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    streams->arraybits |= CGO_NORMAL_ARRAY;
+    set3f(streams->normal, v1, v2, v3);
+    set3f(I->normal, v1, v2, v3);
+    return true;
+  }
+
   float* pc = CGO_add(I, CGO_NORMAL_SZ + 1);
   if (!pc)
     return false;
@@ -1278,6 +1465,12 @@ int CGOWriteIndent(CGO* I, const char* str, float indent)
 
 int CGONormalv(CGO* I, const float* v)
 {
+  if (auto streams = CGOGetRecordingStreams(I)) {
+    streams->arraybits |= CGO_NORMAL_ARRAY;
+    copy3f(v, streams->normal);
+    return true;
+  }
+
   float* pc = CGO_add(I, CGO_NORMAL_SZ + 1);
   if (!pc)
     return false;
@@ -7134,6 +7327,19 @@ bool CGOHasBezierOperations(const CGO* I)
   return CGOHasOperationsOfTypeN(I, optypes);
 }
 
+/**
+ * True if CGOSimplify would do more than copy `I`, i.e. if it has any
+ * primitives which get tessellated or any BEGIN/END blocks.
+ */
+bool CGOHasSimplifyOperations(const CGO* I)
+{
+  static std::set<int> optypes = {CGO_SHADER_CYLINDER,
+      CGO_SHADER_CYLINDER_WITH_2ND_COLOR, CGO_CYLINDER, CGO_CONE, CGO_SAUSAGE,
+      CGO_CUSTOM_CYLINDER, CGO_CUSTOM_CYLINDER_ALPHA, CGO_SPHERE,
+      CGO_ELLIPSOID, CGO_QUADRIC, CGO_BEGIN};
+  return CGOHasOperationsOfTypeN(I, optypes);
+}
+
 bool CGOCheckWhetherToFree(PyMOLGlobals* G, CGO* I)
 {
   if (I->use_shader) {
@@ -295,6 +295,10 @@ struct ObjectGadgetRamp;
 
 class CGO;
 
+namespace cgo {
+  struct vertex_streams;
+}
+
 // These are only the optimized operations
 namespace cgo {
   namespace draw {
@@ -794,6 +798,10 @@ public:
                        // calcDepth=1 by default
   short sphere_quality { 0 }; // quality of spheres when simplified or rendered in immediate mode
   bool interpolated { false };
+
+  // BEGIN/END block recording state, see CGOSetCombineBeginEnd()
+  std::unique_ptr<cgo::vertex_streams> begin_end_streams;
+
   /***********************************************************************
    * CGO iterator
    *
@@ -956,6 +964,7 @@ CGO *CGOSimplifyNoCompress(const CGO * I, int est, short sphere_quality = -1, bo
 
 // -1 - no lines, 0 - some no interpolation, 1 - all interpolation, 2 - all no interpolation
 bool CGOCombineBeginEnd(CGO ** I, bool do_not_split_lines = false);
+void CGOSetCombineBeginEnd(CGO * I, bool combine);
 CGO* CGOCombineBeginEnd(const CGO* I, int est = 0, bool do_not_split_lines = false);
 
 void CGOFreeVBOs(CGO *I);
@@ -1116,6 +1125,7 @@ bool CGOHasOperationsOfType(const CGO *I, int optype);
 bool CGOHasOperationsOfTypeN(const CGO *I, const std::set<int> &optype);
 bool CGOHasCylinderOperations(const CGO *I);
 bool CGOHasSphereOperations(const CGO *I);
+bool CGOHasSimplifyOperations(const CGO *I);
 
 /**
  * @param cgo input CGO
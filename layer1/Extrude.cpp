@@ -31,6 +31,8 @@ Z* -------------------------------------------------------------------
 
 #include "pymol/algorithm.h"
 
+#include <algorithm>
+
 static
 void ExtrudeInit(PyMOLGlobals * G, CExtrude * I);
 
@@ -855,6 +857,49 @@ void TubeCapFlat(const CExtrude * I, CGO * cgo, int index, bool inv_dir, const f
   CGOPickColor(cgo, -1, cPickableNoPick);
 }
 
+/**
+ * Sweeps the profile (sv, sn) along the path. Computes the transformed shape
+ * vertices and normals of all profile points at all path points, with the
+ * first profile point repeated at the end to close the surface.
+ *
+ * The frame of each path point is loaded once and applied to the whole
+ * profile, which is a simple fixed-length loop the compiler can vectorize.
+ *
+ * TV, TN: output, 3 * (Ns + 1) * N floats each, indexed by (b * N + a)
+ */
+static void ExtrudeSweepProfile(const CExtrude* I, float* TV, float* TN)
+{
+  int const N = I->N;
+  int const Ns = I->Ns;
+  const float* sv = I->sv;
+  const float* sn = I->sn;
+
+  for (int a = 0; a < N; ++a) {
+    const float* n = I->n + 9 * a;
+    const float* v = I->p + 3 * a;
+    float const m0 = n[0], m1 = n[1], m2 = n[2], m3 = n[3], m4 = n[4],
+                m5 = n[5], m6 = n[6], m7 = n[7], m8 = n[8];
+    float const p0 = v[0], p1 = v[1], p2 = v[2];
+
+    for (int b = 0; b < Ns; ++b) {
+      float* tv = TV + 3 * (b * N + a);
+      float* tn = TN + 3 * (b * N + a);
+      const float* s = sv + 3 * b;
+      const float* t = sn + 3 * b;
+      tv[0] = p0 + (m0 * s[0] + m3 * s[1] + m6 * s[2]);
+      tv[1] = p1 + (m1 * s[0] + m4 * s[1] + m7 * s[2]);
+      tv[2] = p2 + (m2 * s[0] + m5 * s[1] + m8 * s[2]);
+      tn[0] = m0 * t[0] + m3 * t[1] + m6 * t[2];
+      tn[1] = m1 * t[0] + m4 * t[1] + m7 * t[2];
+      tn[2] = m2 * t[0] + m5 * t[1] + m8 * t[2];
+    }
+  }
+
+  // close the loop
+  std::copy_n(TV, 3 * N, TV + 3 * Ns * N);
+  std::copy_n(TN, 3 * N, TN + 3 * Ns * N);
+}
+
 /**
  * I: tube instance
  * cgo: CGO to add to
@@ -872,7 +917,7 @@ int ExtrudeCGOSurfaceTube(const CExtrude* I, CGO* cgo, cCylCap cap,
   float *n;
   float *c;
   const float *alpha;
-  float *sv, *sn, *tv, *tn, *tv1, *tn1, *TV = nullptr, *TN = nullptr;
+  float *sv, *tv, *tn, *tv1, *tn1, *TV = nullptr, *TN = nullptr;
   int start, stop;
   int ok = true;
   PRINTFD(I->G, FB_Extrude)
@@ -887,32 +932,8 @@ int ExtrudeCGOSurfaceTube(const CExtrude* I, CGO* cgo, cCylCap cap,
     /* compute transformed shape vertices */
 
     if (ok){
-      tn = TN;
-      tv = TV;
-      
-      sv = I->sv;
-      sn = I->sn;
-      for(b = 0; b <= I->Ns; b++) {
-	if(b == I->Ns) {
-	  sv = I->sv;
-	  sn = I->sn;
-	}
-	v = I->p;
-	n = I->n;
-	
-	for(a = 0; a < I->N; a++) {
-	  transform33Tf3f(n, sv, tv);
-	  add3f(v, tv, tv);
-	  tv += 3;
-	  transform33Tf3f(n, sn, tn);
-	  tn += 3;
-	  n += 9;
-	  v += 3;
-	}
-	sv += 3;
-	sn += 3;
-      }
-      
+      ExtrudeSweepProfile(I, TV, TN);
+
       start = I->Ns / 4;
       stop = 3 * I->Ns / 4;
     }
@@ -1513,7 +1534,7 @@ int ExtrudeCGOSurfacePolygon(const CExtrude * I, CGO * cgo, cCylCap cap, const f
   float *n;
   float *c;
   const float *alpha;
-  float *sv, *sn, *tv, *tn, *tv1, *tn1, *TV = nullptr, *TN = nullptr;
+  float *sv, *tv, *tn, *tv1, *tn1, *TV = nullptr, *TN = nullptr;
   float v0[3];
   int ok = true;
 
@@ -1530,32 +1551,8 @@ int ExtrudeCGOSurfacePolygon(const CExtrude * I, CGO * cgo, cCylCap cap, const f
     /* compute transformed shape vertices */
 
     if (ok){
-      tn = TN;
-      tv = TV;
-      
-      sv = I->sv;
-      sn = I->sn;
-      for(b = 0; b <= I->Ns; b++) {
-	if(b == I->Ns) {
-	  sv = I->sv;
-	  sn = I->sn;
-	}
-	v = I->p;
-	n = I->n;
-	
-	for(a = 0; a < I->N; a++) {
-	  transform33Tf3f(n, sv, tv);
-	  add3f(v, tv, tv);
-	  tv += 3;
-	  transform33Tf3f(n, sn, tn);
-	  tn += 3;
-	  n += 9;
-	  v += 3;
-	}
-	sv += 3;
-	sn += 3;
-      }
-      
+      ExtrudeSweepProfile(I, TV, TN);
+
       /* fill in each strip separately */
       
       tv = TV;
@@ -16,6 +16,13 @@ Z* -------------------------------------------------------------------
 */
 #include"os_python.h"
 
+#include <algorithm>
+#include <chrono>
+
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
 #include"os_predef.h"
 #include"os_std.h"
 #include"os_gl.h"
@@ -42,6 +49,9 @@ Z* -------------------------------------------------------------------
 #include"CGO.h"
 #include"MovieScene.h"
 #include"Feedback.h"
+#include"MovieWriter.h"
+#include"Ray.h"
+#include"SceneRay.h"
 
 #define cMovieDragModeMoveKey   1
 #define cMovieDragModeInsDel    2
@@ -623,6 +633,66 @@ void MovieSetSize(PyMOLGlobals * G, unsigned int width, unsigned int height)
 
 
 /*========================================================================*/
+static void MovieReportWriterErrors(PyMOLGlobals * G, CMovieModal * M)
+{
+  for(auto& msg : M->writer->takeErrors()) {
+    PRINTFB(G, FB_Movie, FB_Errors)
+      " MoviePNG-Error: %s\n", msg.c_str() ENDFB(G);
+  }
+}
+
+/*
+ * Builds the ray of the current frame and queues it for tracing on a worker
+ * thread. Rays which can't be detached are traced on the main thread once
+ * they are flushed.
+ */
+static bool MovieQueueRayFrame(PyMOLGlobals * G, CMovieModal * M)
+{
+  int antialias = 0;
+
+  ExecutiveUpdateSceneMembers(G);
+
+  CRay *ray = SceneRayBuildFrame(G, M->width, M->height, &antialias);
+  if(!ray)
+    return false;
+
+  bool detached = bool(ray->Detached);
+  auto trace = [ray, antialias, detached]() {
+#ifdef PYMOL_OPENMP
+    /* the thread budget is split between frames */
+    if(detached)
+      omp_set_num_threads(1);
+#endif
+    return SceneRayTraceFrame(ray, antialias);
+  };
+
+  M->rayFrames.push_back({M->fname,
+      std::async(detached ? std::launch::async : std::launch::deferred,
+                 trace)});
+  M->rayQueued = true;
+  return true;
+}
+
+/*
+ * Hands traced frames over to the writer, in frame order. Waits for the
+ * oldest frames until no more than max_pending are left.
+ */
+static void MovieFlushRayFrames(PyMOLGlobals * G, CMovieModal * M,
+                                size_t max_pending)
+{
+  while(!M->rayFrames.empty()) {
+    auto& front = M->rayFrames.front();
+    if(M->rayFrames.size() <= max_pending &&
+       front.image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      break;
+    // incomplete if tracing was interrupted
+    if(auto image = front.image.get())
+      M->writer->push(front.fname, std::move(image));
+    M->rayFrames.pop_front();
+  }
+  MovieReportWriterErrors(G, M);
+}
+
 static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
 {
   switch (M->stage) {
@@ -656,6 +726,29 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
       SceneSetFrame(G, 0, 0);
     MoviePlay(G, cMoviePlay);
     VecCheck(I->Image, M->nFrame);
+    {
+      pymol::MovieWriter::Options options;
+      options.format = M->format;
+      options.dpi = SettingGetGlobal_f(G, cSetting_image_dots_per_inch);
+      options.screen_gamma = SettingGetGlobal_f(G, cSetting_png_screen_gamma);
+      options.file_gamma = SettingGetGlobal_f(G, cSetting_png_file_gamma);
+      options.fps = SettingGetGlobal_f(G, cSetting_movie_fps);
+      options.quiet = M->quiet;
+      /* frames are encoded in parallel by the writer threads */
+      options.png_encoding.fast = SettingGet<bool>(G, cSetting_png_fast);
+      /* leave most cores to the renderer, one extra frame may wait in
+         the queue while all writers are busy */
+      std::size_t n_threads =
+          std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+      M->writer = std::make_shared<pymol::MovieWriter>(
+          options, n_threads, n_threads + 1);
+    }
+    M->rayFramesMax = 1;
+    if(M->mode == cSceneImage_Ray) {
+      M->rayFramesMax = SettingGetGlobal_i(G, cSetting_movie_ray_frames);
+      if(M->rayFramesMax < 1)
+        M->rayFramesMax = SettingGetGlobal_i(G, cSetting_max_threads);
+    }
     M->frame = 0;
     M->stage = 1;
     if(G->Interrupt) {
@@ -671,6 +764,11 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
       PRINTFB(G, FB_Movie, FB_Debugging)
         " MoviePNG-DEBUG: Cycle %d...\n", M->frame ENDFB(G);
       switch (M->format) {
+      case cMyPNG_FormatY4M:
+      case cMyPNG_FormatRGBA:
+        /* single stream, may be a named pipe */
+        M->fname = M->prefix;
+        break;
       case cMyPNG_FormatPPM:
         M->fname = pymol::string_format("%s%04d.ppm", M->prefix.c_str(), M->frame + 1);
         break;
@@ -680,7 +778,7 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
         break;
       }
 
-      if(M->missing_only) {
+      if(M->missing_only && !pymol::MovieWriter::isStreamFormat(M->format)) {
         FILE *tmp = fopen(M->fname.c_str(), "rb");
         if(tmp) {
           fclose(tmp);
@@ -709,7 +807,9 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
        (M->frame <= M->stop) && (M->file_missing)) {    /* ...that don't already exist */
       if(!I->Image[M->image]) {
         SceneUpdate(G, false);
-        if(SceneMakeMovieImage(G, false, M->modal, M->mode, M->width, M->height)
+        if(M->rayFramesMax > 1 && MovieQueueRayFrame(G, M)) {
+          M->stage = 3;
+        } else if(SceneMakeMovieImage(G, false, M->modal, M->mode, M->width, M->height)
             || !M->modal) {
           M->stage = 3;
         } else {
@@ -732,28 +832,36 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
 
   switch (M->stage) {
   case 3:                      /* IN RENDER LOOP: have image, so write to file */
-    if(!I->Image[M->image]) {
-      PRINTFB(G, FB_Movie, FB_Errors)
-        "MoviePNG-Error: Missing rendered image.\n" ENDFB(G);
-    } else {
-      if (!MyPNGWrite(M->fname.c_str(), *I->Image[M->image],
-              SettingGetGlobal_f(G, cSetting_image_dots_per_inch), M->format,
-              M->quiet, SettingGetGlobal_f(G, cSetting_png_screen_gamma),
-              SettingGetGlobal_f(G, cSetting_png_file_gamma))) {
-        PRINTFB(G, FB_Movie, FB_Errors)
-          " MoviePNG-Error: unable to write '%s'\n", M->fname.c_str() ENDFB(G);
-      }
+    if(M->rayQueued) {
+      /* keep up to movie_ray_frames frames tracing while the next one is
+         built, unless this one has to be traced on the main thread */
+      auto& last = M->rayFrames.back().image;
+      bool deferred = last.wait_for(std::chrono::seconds(0)) ==
+                      std::future_status::deferred;
+      MovieFlushRayFrames(G, M, deferred ? 0 : M->rayFramesMax - 1);
+      M->rayQueued = false;
       ExecutiveDrawNow(G);
       OrthoBusySlow(G, M->frame, M->nFrame);
       if(G->HaveGUI)
         PyMOL_SwapBuffers(G->PyMOL);
+    } else if(!I->Image[M->image]) {
+      PRINTFB(G, FB_Movie, FB_Errors)
+        "MoviePNG-Error: Missing rendered image.\n" ENDFB(G);
+    } else {
+      MovieFlushRayFrames(G, M, 0);
       PRINTFB(G, FB_Movie, FB_Debugging)
         " MoviePNG-DEBUG: i = %d, I->Image[image] = %p\n", M->image,
         I->Image[M->image]->bits() ENDFB(G);
+      /* hand the image over to the writer threads, blocks if too many
+         frames are in flight */
+      M->writer->push(M->fname, std::move(I->Image[M->image]));
+      ExecutiveDrawNow(G);
+      OrthoBusySlow(G, M->frame, M->nFrame);
+      if(G->HaveGUI)
+        PyMOL_SwapBuffers(G->PyMOL);
     }
-    if(I->Image[M->image]) {
-      I->Image[M->image] = nullptr;
-    }
+    I->Image[M->image] = nullptr;
+    MovieReportWriterErrors(G, M);
     M->timing = UtilGetSeconds(G) - M->timing;
     M->accumTiming += M->timing;
     {
@@ -794,6 +902,12 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
   case 5:                      /* finish up */
 
     SceneInvalidate(G);         /* important */
+    if(M->writer) {
+      MovieFlushRayFrames(G, M, 0);
+      M->writer->finish();
+      MovieReportWriterErrors(G, M);
+      M->writer = nullptr;
+    }
     PRINTFB(G, FB_Movie, FB_Debugging)
       " MoviePNG-DEBUG: done.\n" ENDFB(G);
     SettingSetGlobal_b(G, cSetting_cache_frames, M->save);
@@ -832,8 +946,8 @@ int MoviePNG(PyMOLGlobals * G, const char* prefix, int save, int start,
 
   mode = SceneValidateImageMode(G, mode, width || height);
 
-  /* default behavior is to go modal unless we're ray tracing */
-  if(modal < 0 && mode == cSceneImage_Ray) {
+  /* default behavior is to go modal unless we're ray tracing or headless */
+  if(modal < 0 && (mode == cSceneImage_Ray || !G->HaveGUI)) {
     modal = 0;
   }
 
@@ -17,6 +17,8 @@ Z* -------------------------------------------------------------------
 #ifndef _H_Movie
 #define _H_Movie
 
+#include <deque>
+#include <future>
 #include <memory>
 #include <string>
 #include"os_python.h"
@@ -24,6 +26,11 @@ Z* -------------------------------------------------------------------
 #include"Scene.h"
 #include"View.h"
 
+namespace pymol
+{
+class MovieWriter;
+}
+
 struct CMovieModal {
   int stage = 0;
 
@@ -50,6 +57,18 @@ struct CMovieModal {
   int format = 0;
   int quiet = 0;
   std::string fname;
+
+  /* frames in flight are compressed and written in the background */
+  std::shared_ptr<pymol::MovieWriter> writer;
+
+  /* ray traced frames in flight, oldest first (movie_ray_frames) */
+  struct RayFrame {
+    std::string fname;
+    std::future<std::shared_ptr<pymol::Image>> image;
+  };
+  std::deque<RayFrame> rayFrames;
+  int rayFramesMax = 1;
+  int rayQueued = false;        /* current frame is in rayFrames */
 };
 
 struct CMovie : public Block {
@@ -0,0 +1,216 @@
+/**
+ * @file
+ * Asynchronous movie frame output
+ */
+
+#include "MovieWriter.h"
+#include "File.h"
+#include "MyPNG.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pymol
+{
+
+namespace
+{
+
+/// BT.601 studio range, 8 bit fixed point
+inline unsigned char RGBToY(int r, int g, int b)
+{
+  return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+}
+
+inline unsigned char RGBToU(int r, int g, int b)
+{
+  return ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+}
+
+inline unsigned char RGBToV(int r, int g, int b)
+{
+  return ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+}
+
+} // namespace
+
+MovieWriter::MovieWriter(
+    const Options& options, std::size_t n_threads, std::size_t capacity)
+    : m_options(options)
+    , m_capacity(std::max<std::size_t>(1, capacity))
+{
+  if (isStreamFormat(options.format) || n_threads < 1) {
+    n_threads = 1;
+  }
+
+  for (std::size_t i = 0; i < n_threads; ++i) {
+    m_threads.emplace_back(&MovieWriter::run, this);
+  }
+}
+
+MovieWriter::~MovieWriter()
+{
+  finish();
+}
+
+bool MovieWriter::isStreamFormat(int format)
+{
+  return format == cMyPNG_FormatY4M || format == cMyPNG_FormatRGBA;
+}
+
+void MovieWriter::push(std::string filename, std::shared_ptr<const Image> image)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_notFull.wait(lock, [this] { return m_queue.size() < m_capacity; });
+  m_queue.push_back({std::move(filename), std::move(image)});
+  m_notEmpty.notify_one();
+}
+
+std::vector<std::string> MovieWriter::takeErrors()
+{
+  std::vector<std::string> errors;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  errors.swap(m_errors);
+  return errors;
+}
+
+Result<> MovieWriter::finish()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = true;
+  }
+  m_notEmpty.notify_all();
+
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+  m_threads.clear();
+
+  if (m_stream) {
+    if (fclose(m_stream) != 0) {
+      m_errors.push_back("Write failed: movie stream");
+      ++m_errorCount;
+    }
+    m_stream = nullptr;
+  }
+
+  if (m_errorCount) {
+    return make_error(m_errorCount, " movie frame(s) could not be written");
+  }
+
+  return {};
+}
+
+void MovieWriter::run()
+{
+  for (;;) {
+    Frame frame;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_notEmpty.wait(lock, [this] { return m_done || !m_queue.empty(); });
+      if (m_queue.empty()) {
+        return;
+      }
+      frame = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+    m_notFull.notify_one();
+
+    auto result = write(frame);
+
+    // release the image before the next frame is taken
+    frame.image.reset();
+
+    if (!result) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_errors.push_back(result.error().what());
+      ++m_errorCount;
+    }
+  }
+}
+
+Result<> MovieWriter::write(const Frame& frame)
+{
+  if (isStreamFormat(m_options.format)) {
+    return writeStream(frame);
+  }
+
+  if (!MyPNGWrite(frame.filename, *frame.image, m_options.dpi,
+          m_options.format, m_options.quiet, m_options.screen_gamma,
+          m_options.file_gamma, nullptr, m_options.png_encoding)) {
+    return make_error("unable to write '", frame.filename, "'");
+  }
+
+  return {};
+}
+
+Result<> MovieWriter::writeStream(const Frame& frame)
+{
+  auto const& image = *frame.image;
+  int const width = image.getWidth();
+  int const height = image.getHeight();
+
+  if (!m_stream) {
+    const char* filename = frame.filename.c_str();
+    int fd = 0;
+    if (filename[0] == 1 && sscanf(filename + 1, "%d", &fd) == 1) {
+      m_stream = fdopen(fd, "wb");
+    } else {
+      m_stream = pymol_fopen(filename, "wb");
+    }
+    if (!m_stream) {
+      return make_error("unable to open '", frame.filename, "'");
+    }
+
+    m_streamWidth = width;
+    m_streamHeight = height;
+
+    if (m_options.format == cMyPNG_FormatY4M) {
+      int const fps_milli = std::max(1, int(std::lround(m_options.fps * 1000)));
+      fprintf(m_stream, "YUV4MPEG2 W%d H%d F%d:1000 Ip A1:1 C444\n", width,
+          height, fps_milli);
+    }
+  }
+
+  if (width != m_streamWidth || height != m_streamHeight) {
+    return make_error("frame size ", width, "x", height,
+        " does not match stream size ", m_streamWidth, "x", m_streamHeight);
+  }
+
+  // images are stored bottom-up
+  std::size_t const n_pixel = std::size_t(width) * height;
+  const unsigned char* bits = image.bits();
+
+  if (m_options.format == cMyPNG_FormatY4M) {
+    m_streamBuffer.resize(3 * n_pixel);
+    unsigned char* y = m_streamBuffer.data();
+    unsigned char* u = y + n_pixel;
+    unsigned char* v = u + n_pixel;
+    for (int row = 0; row < height; ++row) {
+      const unsigned char* p = bits + std::size_t(height - 1 - row) * width * 4;
+      std::size_t const offset = std::size_t(row) * width;
+      for (int col = 0; col < width; ++col, p += 4) {
+        y[offset + col] = RGBToY(p[0], p[1], p[2]);
+        u[offset + col] = RGBToU(p[0], p[1], p[2]);
+        v[offset + col] = RGBToV(p[0], p[1], p[2]);
+      }
+    }
+    fputs("FRAME\n", m_stream);
+  } else {
+    m_streamBuffer.resize(4 * n_pixel);
+    for (int row = 0; row < height; ++row) {
+      std::copy_n(bits + std::size_t(height - 1 - row) * width * 4, width * 4,
+          m_streamBuffer.data() + std::size_t(row) * width * 4);
+    }
+  }
+
+  if (fwrite(m_streamBuffer.data(), 1, m_streamBuffer.size(), m_stream) !=
+      m_streamBuffer.size()) {
+    return make_error("write failed: '", frame.filename, "'");
+  }
+
+  return {};
+}
+
+} // namespace pymol
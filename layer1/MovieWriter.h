@@ -0,0 +1,112 @@
+/**
+ * @file
+ * Asynchronous movie frame output
+ *
+ * Rendered frames are handed to a bounded queue and written by background
+ * threads, so compressing and writing frame N overlaps with building and
+ * rendering frame N+1. push() blocks while the queue is full, which limits
+ * the number of frames in flight and keeps memory flat for long movies.
+ *
+ * Numbered image files (PNG, PPM) are written by several threads in any
+ * order. Stream formats (Y4M, raw RGBA) append all frames to a single file,
+ * which may be a named pipe or an encoded file descriptor (chr(1) followed
+ * by the decimal descriptor number, as for MyPNGWrite), and use a single
+ * thread to keep frames in order.
+ */
+
+#pragma once
+
+#include "Image.h"
+#include "MyPNG.h"
+#include "Result.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pymol
+{
+
+class MovieWriter
+{
+public:
+  struct Options {
+    int format = 0; //!< cMyPNG_Format*
+    float dpi = 0.f;
+    float screen_gamma = 1.f;
+    float file_gamma = 1.f;
+    float fps = 30.f; //!< Y4M header only
+    int quiet = 1;
+    MyPNGEncoding png_encoding;
+  };
+
+  /**
+   * @param options Output format and PNG parameters
+   * @param n_threads Number of writer threads (1 for stream formats)
+   * @param capacity Maximum number of queued frames
+   */
+  MovieWriter(const Options& options, std::size_t n_threads,
+      std::size_t capacity);
+
+  /// Waits for queued frames
+  ~MovieWriter();
+
+  MovieWriter(const MovieWriter&) = delete;
+  MovieWriter& operator=(const MovieWriter&) = delete;
+
+  /// True for formats which write all frames to one file
+  static bool isStreamFormat(int format);
+
+  /**
+   * Queues a frame. Blocks while the queue is full.
+   * @param filename Output file (ignored after the first frame for streams)
+   */
+  void push(std::string filename, std::shared_ptr<const Image> image);
+
+  /**
+   * Error messages of frames written since the last call. Called from the
+   * main thread, the writer threads don't print feedback themselves.
+   */
+  std::vector<std::string> takeErrors();
+
+  /**
+   * Waits for all queued frames, stops the threads and closes the stream.
+   * @return Error if any frame could not be written
+   */
+  Result<> finish();
+
+private:
+  struct Frame {
+    std::string filename;
+    std::shared_ptr<const Image> image;
+  };
+
+  void run();
+  Result<> write(const Frame& frame);
+  Result<> writeStream(const Frame& frame);
+
+  Options m_options;
+  std::size_t m_capacity;
+  std::deque<Frame> m_queue;
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_notEmpty;
+  std::condition_variable m_notFull;
+  bool m_done = false;
+  std::vector<std::string> m_errors;
+  std::size_t m_errorCount = 0;
+
+  // stream state, only touched by the (single) writer thread
+  FILE* m_stream = nullptr;
+  int m_streamWidth = 0;
+  int m_streamHeight = 0;
+  std::vector<unsigned char> m_streamBuffer;
+};
+
+} // namespace pymol
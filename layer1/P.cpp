@@ -54,6 +54,7 @@ the initialization functions for these libraries on startup.
 #include"Cmd.h"
 #include"main.h"
 #include"AtomInfo.h"
+#include"AtomExpression.h"
 #include"CoordSet.h"
 #include"Util.h"
 #include"Executive.h"
@@ -67,7 +68,11 @@ the initialization functions for these libraries on startup.
 #include"Property.h"
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <vector>
 
 /**
  * Use with functions which return a PyObject - if they return nullptr, then an
@@ -1468,6 +1473,227 @@ int PAlterAtom(PyMOLGlobals* G, ObjectMolecule* obj, CoordSet* cs,
   return PAlterAtomState(G, expr_co, read_only, obj, cs, atm, /* idx */ -1, state, space);
 }
 
+/**
+ * Compiles an alter/iterate expression for native evaluation, with global
+ * names and append targets resolved in `space`.
+ *
+ * @return nullptr if the expression must be evaluated by Python
+ * @pre GIL
+ */
+std::unique_ptr<AtomExpression> PAtomExpressionCompile(PyMOLGlobals* G,
+    const char* expr, int read_only, bool with_state, PyObject* space)
+{
+  assert(PyGILState_Check());
+
+  if (!expr || !space || !PyDict_Check(space) ||
+      !SettingGet<bool>(G, cSetting_iterate_native)) {
+    return nullptr;
+  }
+
+  using Lookup = AtomExpression::Lookup;
+  using Type = AtomExpression::Type;
+
+  AtomExpression::Scope scope;
+
+  scope.lookup = [space](const std::string& name, AtomExpression::Value& value) {
+    PyObject* obj = PyDict_GetItemString(space, name.c_str()); // borrowed
+    if (!obj) {
+      return Lookup::NotFound;
+    }
+    if (PyBool_Check(obj)) {
+      value.type = Type::Bool;
+      value.i = (obj == Py_True);
+    } else if (PyLong_CheckExact(obj)) {
+      int overflow = 0;
+      value.type = Type::Int;
+      value.i = PyLong_AsLongLongAndOverflow(obj, &overflow);
+      if (overflow) {
+        return Lookup::Unsupported;
+      }
+    } else if (PyFloat_CheckExact(obj)) {
+      value.type = Type::Float;
+      value.f = PyFloat_AsDouble(obj);
+    } else if (PyUnicode_CheckExact(obj)) {
+      const char* str = PyUnicode_AsUTF8(obj);
+      if (!str) {
+        PyErr_Clear();
+        return Lookup::Unsupported;
+      }
+      value.type = Type::Str;
+      value.s = str;
+    } else {
+      return Lookup::Unsupported;
+    }
+    return Lookup::Found;
+  };
+
+  scope.canAppend = [space](const std::string& dotted_name) {
+    auto target = unique_PyObject_ptr(
+        PyRun_String(dotted_name.c_str(), Py_eval_input, space, space));
+    if (!target) {
+      PyErr_Clear();
+      return false;
+    }
+    return bool(PyList_CheckExact(target.get()));
+  };
+
+  auto atom_expr =
+      AtomExpression::compile(G, expr, read_only, with_state, scope);
+
+  PRINTFD(G, FB_Python)
+    " %s: '%s' %s\n", __func__, expr,
+    atom_expr ? "compiled" : "needs Python" ENDFD;
+
+  return atom_expr;
+}
+
+/**
+ * Appends the values which were collected by `name.append(...)` statements
+ * of a native expression to their Python lists.
+ *
+ * @pre GIL
+ */
+bool PAtomExpressionFlush(
+    PyMOLGlobals* G, AtomExpression* atom_expr, PyObject* space)
+{
+  assert(PyGILState_Check());
+
+  if (!atom_expr || atom_expr->appended().empty()) {
+    return true;
+  }
+
+  // keep the exception of a failed evaluation, the values collected before
+  // it must still be appended (like Python would have done)
+  PyObject *exc_type, *exc_value, *exc_tb;
+  PyErr_Fetch(&exc_type, &exc_value, &exc_tb);
+
+  std::vector<unique_PyObject_ptr> targets;
+  for (auto const& dotted_name : atom_expr->appendTargets()) {
+    targets.emplace_back(
+        PyRun_String(dotted_name.c_str(), Py_eval_input, space, space));
+    if (!targets.back()) {
+      break;
+    }
+  }
+
+  auto to_python = [](const AtomExpression::Value& value) -> PyObject* {
+    switch (value.type) {
+    case AtomExpression::Type::Bool:
+      return PyBool_FromLong(value.i);
+    case AtomExpression::Type::Int:
+      return PyLong_FromLongLong(value.i);
+    case AtomExpression::Type::Float:
+      return PyFloat_FromDouble(value.f);
+    default:
+      return PyUnicode_FromStringAndSize(value.s.data(), value.s.size());
+    }
+  };
+
+  auto const& values = atom_expr->appendedValues();
+  bool ok = targets.size() == atom_expr->appendTargets().size() &&
+            targets.back();
+
+  for (auto const& rec : atom_expr->appended()) {
+    if (!ok) {
+      break;
+    }
+
+    unique_PyObject_ptr item;
+    if (!rec.sequence) {
+      item.reset(to_python(values[rec.begin]));
+    } else {
+      auto const n = rec.end - rec.begin;
+      item.reset(rec.tuple ? PyTuple_New(n) : PyList_New(n));
+      for (unsigned i = 0; item && i < n; ++i) {
+        PyObject* elem = to_python(values[rec.begin + i]);
+        if (!elem) {
+          item.reset();
+        } else if (rec.tuple) {
+          PyTuple_SET_ITEM(item.get(), i, elem);
+        } else {
+          PyList_SET_ITEM(item.get(), i, elem);
+        }
+      }
+    }
+
+    if (!item || PyList_Append(targets[rec.target].get(), item.get()) != 0) {
+      ok = false;
+    }
+  }
+
+  atom_expr->clearAppended();
+
+  if (exc_type) {
+    PyErr_Restore(exc_type, exc_value, exc_tb);
+    return false;
+  }
+  return ok;
+}
+
+/**
+ * Raises the Python exception for a failed AtomExpression::eval
+ */
+static void PAtomExpressionRaise(const AtomExpression* atom_expr)
+{
+  PyObject* exc = PyExc_RuntimeError;
+  switch (atom_expr->error()) {
+  case AtomExpression::Error::ZeroDivision:
+    exc = PyExc_ZeroDivisionError;
+    break;
+  case AtomExpression::Error::Value:
+    exc = PyExc_ValueError;
+    break;
+  case AtomExpression::Error::Overflow:
+    exc = PyExc_OverflowError;
+    break;
+  default:
+    break;
+  }
+  PyErr_SetString(exc, atom_expr->errorMessage().c_str());
+}
+
+/**
+ * Evaluates a native expression for one atom. If the native evaluator
+ * can't continue (e.g. int overflow), the remaining statements run in
+ * Python, after flushing the values which were appended so far.
+ *
+ * @param state 0-based state like with PAlterAtomState (-1 for none)
+ * @return false with a Python exception set on error
+ * @pre GIL
+ */
+bool PAtomExpressionEval(PyMOLGlobals* G, AtomExpression* atom_expr,
+    ObjectMolecule* obj, CoordSet* cs, int atm, int idx, int state,
+    int read_only, PyObject* space)
+{
+  assert(PyGILState_Check());
+
+  if (atom_expr->eval(obj, cs, atm, idx, state + 1)) {
+    return true;
+  }
+
+  if (atom_expr->error() != AtomExpression::Error::Fallback) {
+    PAtomExpressionRaise(atom_expr);
+    return false;
+  }
+
+  PRINTFD(G, FB_Python)
+    " %s: Python fallback for '%s'\n", __func__,
+    atom_expr->fallbackSource() ENDFD;
+
+  if (!PAtomExpressionFlush(G, atom_expr, space)) {
+    return false;
+  }
+
+  auto expr_co = unique_PyObject_ptr(
+      Py_CompileString(atom_expr->fallbackSource(), "", Py_single_input));
+  if (!expr_co) {
+    return false;
+  }
+
+  return PAlterAtomState(
+      G, expr_co.get(), read_only, obj, cs, atm, idx, state, space);
+}
+
 /**
  * String conversion which takes "label_digits" setting into account.
  */
@@ -2401,6 +2627,63 @@ void PAutoUnblock(PyMOLGlobals * G, int flag)
     PUnblock(G);
 }
 
+/**
+ * Run func(i) for all i in [0, n_task) on up to n_thread threads (including
+ * the calling thread). Tasks are handed out dynamically, so they don't need
+ * to be of similar cost.
+ *
+ * Worker threads get their own Python thread state and release the GIL the
+ * same way the calling thread does, so tasks may use PAutoBlock.
+ *
+ * @pre API lock
+ */
+void PRunParallel(PyMOLGlobals* G, int n_thread, size_t n_task,
+    const std::function<void(size_t)>& func)
+{
+  n_thread = std::min<size_t>(std::max(n_thread, 1),
+      std::min<size_t>(n_task, PYMOL_MAX_THREADS));
+
+  if (n_thread < 2) {
+    for (size_t i = 0; i != n_task; ++i) {
+      func(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+
+  auto work = [&]() {
+    for (size_t i; (i = next++) < n_task;) {
+      func(i);
+    }
+  };
+
+  int blocked = PAutoBlock(G);
+
+  std::vector<std::thread> workers;
+  workers.reserve(n_thread - 1);
+
+  for (int t = 1; t < n_thread; ++t) {
+    workers.emplace_back([G, &work]() {
+      auto gstate = PyGILState_Ensure();
+      PUnblock(G);
+      work();
+      PBlock(G);
+      PyGILState_Release(gstate);
+    });
+  }
+
+  PUnblock(G);
+  work();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  PBlock(G);
+  PAutoUnblock(G, blocked);
+}
+
 /**
  * Acquire GIL, release API lock and flush
  * @pre no GIL
@@ -25,6 +25,11 @@ Z* -------------------------------------------------------------------
 
 #include "pymol/zstring_view.h"
 
+#include <functional>
+#include <memory>
+
+class AtomExpression;
+
 #define cLockAPI 1
 #define cLockInbox 2
 #define cLockOutbox 3
@@ -120,6 +125,10 @@ int PLabelAtomAlt(PyMOLGlobals * G, AtomInfoType * at, const char *model, const
 
 #define PAlterAtomState(G,a,b,c,d,e,f,g,h,i,j,k) 0
 
+#define PAtomExpressionCompile(G,a,b,c,d) nullptr
+#define PAtomExpressionFlush(G,a,b) true
+#define PAtomExpressionEval(G,a,b,c,d,e,f,g,h) false
+
 #else
 
 ov_status PCacheSet(PyMOLGlobals * G, PyObject * entry, PyObject * output);
@@ -147,6 +156,14 @@ int PAlterAtomState(PyMOLGlobals * G, PyObject *expr_co, int read_only,
                     ObjectMolecule *obj, CoordSet *cs, int atm, int idx,
                     int state, PyObject * space);
 
+std::unique_ptr<AtomExpression> PAtomExpressionCompile(PyMOLGlobals* G,
+    const char* expr, int read_only, bool with_state, PyObject* space);
+bool PAtomExpressionFlush(
+    PyMOLGlobals* G, AtomExpression* atom_expr, PyObject* space);
+bool PAtomExpressionEval(PyMOLGlobals* G, AtomExpression* atom_expr,
+    ObjectMolecule* obj, CoordSet* cs, int atm, int idx, int state,
+    int read_only, PyObject* space);
+
 void PLog(PyMOLGlobals * G, pymol::zstring_view str, int lf);
 void PLogFlush(PyMOLGlobals * G);
 
@@ -171,6 +188,9 @@ void PUnblock(PyMOLGlobals * G);
 int PAutoBlock(PyMOLGlobals * G);
 void PAutoUnblock(PyMOLGlobals * G, int flag);
 
+void PRunParallel(PyMOLGlobals* G, int n_thread, size_t n_task,
+    const std::function<void(size_t)>& func);
+
 void PBlockAndUnlockAPI(PyMOLGlobals * G);
 void PLockAPIAndUnblock(PyMOLGlobals * G);
 int PTryLockAPIAndUnblock(PyMOLGlobals * G);
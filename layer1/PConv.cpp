@@ -58,6 +58,52 @@ ok_except1:
   return str;
 }
 
+/*
+ * Section references are (type, index) tuples, they never appear where the
+ * regular session format has lists or bytes.
+ */
+PyObject* PConvSessionSectionToPyRef(PyMOLGlobals* G,
+    pymol::SessionSection type, std::uint32_t version, const void* data,
+    std::size_t size)
+{
+  auto* file = G->SessionFile;
+  if (!file || !file->isWriting() ||
+      size < pymol::SessionFile::MinSectionSize) {
+    return nullptr;
+  }
+
+  int const index = file->write(type, version, data, size);
+  if (index < 0) {
+    return nullptr;
+  }
+
+  return Py_BuildValue("(ii)", int(type), index);
+}
+
+const pymol::SessionFile::Section* PConvPyRefToSessionSection(
+    PyMOLGlobals* G, PyObject* obj, pymol::SessionSection type)
+{
+  auto* file = G->SessionFile;
+  if (!file || file->isWriting() || !obj || !PyTuple_Check(obj) ||
+      PyTuple_Size(obj) != 2) {
+    return nullptr;
+  }
+
+  int ref_type = 0, index = -1;
+  if (!PConvPyIntToInt(PyTuple_GetItem(obj, 0), &ref_type) ||
+      !PConvPyIntToInt(PyTuple_GetItem(obj, 1), &index) ||
+      ref_type != int(type)) {
+    return nullptr;
+  }
+
+  auto const* section = file->section(index);
+  if (!section || section->type != type) {
+    return nullptr;
+  }
+
+  return section;
+}
+
 PyObject *PConvAutoNone(PyObject * result)
 {                               /* automatically own Py_None */
   if(result == Py_None)
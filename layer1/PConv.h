@@ -23,6 +23,7 @@ Z* -------------------------------------------------------------------
 #include"Base.h"
 #include"OVLexicon.h"
 #include "Result.h"
+#include "SessionFile.h"
 
 #include <array>
 #include <map>
@@ -189,6 +190,23 @@ PyObject *PConv3DIntArrayTo3DPyList(int ***array, int *dim);
 
 PyObject *PConvPickleLoads(PyObject * str);
 PyObject *PConvPickleDumps(PyObject * obj);
+
+/**
+ * While a binary session file is written (G->SessionFile): Stores the block
+ * as a section and returns a reference to it (new reference).
+ * @return nullptr if no session file is written or the block is small
+ */
+PyObject* PConvSessionSectionToPyRef(PyMOLGlobals* G,
+    pymol::SessionSection type, std::uint32_t version, const void* data,
+    std::size_t size);
+
+/**
+ * While a binary session file is read (G->SessionFile): The section which
+ * `obj` refers to.
+ * @return nullptr if `obj` is not a reference to a section of type `type`
+ */
+const pymol::SessionFile::Section* PConvPyRefToSessionSection(
+    PyMOLGlobals* G, PyObject* obj, pymol::SessionSection type);
 PyObject *PConvAutoNone(PyObject * result);     /* automatically own Py_None */
 PyObject *PConvIntToPyDictItem(PyObject * dict, const char *key, int i);
 
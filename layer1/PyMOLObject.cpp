@@ -1319,12 +1319,24 @@ void ObjectStateTransformMatrix(CObjectState * I, const double *matrix)
 
 int ObjectStatePushAndApplyMatrix(CObjectState * I, RenderInfo * info)
 {
-  PyMOLGlobals *G = I->G;
+  if(I->Matrix.empty())
+    return false;
+  return ObjectPushAndApplyMatrix(I->G, info, I->Matrix.data());
+}
+
+void ObjectStatePopMatrix(CObjectState * I, RenderInfo * info)
+{
+  ObjectPopMatrix(I->G, info);
+}
+
+/**
+ * Pushes the current model-view (or ray TTT) matrix and multiplies it with
+ * the given row-major 4x4 matrix.
+ * @return false if nothing was pushed
+ */
+int ObjectPushAndApplyMatrix(PyMOLGlobals * G, RenderInfo * info, const double *i_matrix)
+{
   float matrix[16];
-  const double *i_matrix = nullptr;
-  if(!I->Matrix.empty()) {
-    i_matrix = I->Matrix.data();
-  }
   int result = false;
   if(i_matrix) {
     if(info->ray) {
@@ -1370,9 +1382,8 @@ int ObjectStatePushAndApplyMatrix(CObjectState * I, RenderInfo * info)
   return result;
 }
 
-void ObjectStatePopMatrix(CObjectState * I, RenderInfo * info)
+void ObjectPopMatrix(PyMOLGlobals * G, RenderInfo * info)
 {
-  PyMOLGlobals *G = I->G;
   if(info->ray) {
     RayPopTTT(info->ray);
   } else if(G->HaveGUI && G->ValidContext) {
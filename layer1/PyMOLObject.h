@@ -180,6 +180,8 @@ PyObject *ObjectStateAsPyList(CObjectState * I);
 int ObjectStateFromPyList(PyMOLGlobals * G, PyObject * list, CObjectState * I);
 int ObjectStatePushAndApplyMatrix(CObjectState * I, RenderInfo * info);
 void ObjectStatePopMatrix(CObjectState * I, RenderInfo * info);
+int ObjectPushAndApplyMatrix(PyMOLGlobals * G, RenderInfo * info, const double *matrix);
+void ObjectPopMatrix(PyMOLGlobals * G, RenderInfo * info);
 void ObjectStateRightCombineMatrixR44d(CObjectState * I, const double *matrix);
 void ObjectStateLeftCombineMatrixR44d(CObjectState * I, const double *matrix);
 void ObjectStateCombineMatrixTTT(CObjectState * I, float *matrix);
@@ -188,8 +190,6 @@ int ObjectMotionModify(pymol::CObject* I, ViewElemAction action, int index,
 void ObjectMotionReinterpolate(pymol::CObject *I);
 int ObjectMotionGetLength(pymol::CObject *I);
 
-struct CObjectUpdateThreadInfo;
-
 #define cObjectTypeAll                    0
 #define cObjectTypeObjects                1
 #define cObjectTypeSelections             2
@@ -58,6 +58,7 @@ Z* -------------------------------------------------------------------
 /* note: the following value must be at least one greater than the max
    number of lights */
 #define MAX_BASIS 12
+#define MAX_OCCLUSION_BASIS 32
 
 typedef float float3[3];
 typedef float float4[4];
@@ -78,6 +79,8 @@ struct _CRayThreadInfo {
   int y_start, y_stop;
   unsigned int *edging;
   unsigned int edging_cutoff;
+  int edge_samples; /* adaptive antialiasing: samples per axis on edges */
+  int n_edge;       /* number of pixels supersampled by this thread */
   int perspective;
   float fov, pos[3];
   float *depth;
@@ -137,6 +140,7 @@ float RayGetScreenVertexScale(CRay * I, float *v1)
 
   float vt[3];
   float ratio;
+  I->ViewDependent = true;
   RayApplyMatrix33(1, (float3 *) vt, I->ModelView, (float3 *) v1);
 
   if(I->Ortho) {
@@ -158,6 +162,8 @@ static void RayApplyContextToVertex(CRay * I, float *v)
       float tw;
       float th;
 
+      I->ViewDependent = true;
+
       if(I->AspRatio > 1.0F) {
         tw = I->AspRatio;
         th = 1.0F;
@@ -613,7 +619,7 @@ int RayExpandPrimitives(CRay * I)
   nNorm = 0;
   v0 = basis->Vertex;
   n0 = basis->Normal;
-  ok &= !I->G->Interrupt;
+  ok &= !RayInterrupted(I);
   for(a = 0; ok && a < I->NPrimitive; a++) {
     switch (I->Primitive[a].type) {
     case cPrimTriangle:
@@ -725,7 +731,7 @@ int RayExpandPrimitives(CRay * I)
       nVert++;
       break;
     }
-    ok &= !I->G->Interrupt;
+    ok &= !RayInterrupted(I);
   }
   if(nVert > basis->NVertex) {
     fprintf(stderr, "Error: basis->NVertex exceeded\n");
@@ -733,6 +739,7 @@ int RayExpandPrimitives(CRay * I)
   PRINTFB(I->G, FB_Ray, FB_Blather)
     " Ray: minvoxel  %8.3f\n Ray: NPrimit  %d nvert %d\n", basis->MinVoxel, I->NPrimitive,
     nVert ENDFB(I->G);
+  I->Expanded = ok;
   return ok;
 }
 
@@ -871,7 +878,7 @@ int RayTransformFirst(CRay * I, int perspective, int identity)
     VLASize2<float>(basis1->Radius2, basis0->NVertex);
     CHECKOK(ok, basis1->Radius2);
   }
-  ok &= !I->G->Interrupt;
+  ok &= !RayInterrupted(I);
   if (ok){
     if(identity) {
       UtilCopyMem(basis1->Vertex, basis0->Vertex, basis0->NVertex * sizeof(float) * 3);
@@ -880,20 +887,20 @@ int RayTransformFirst(CRay * I, int perspective, int identity)
 		       I->ModelView, (float3 *) basis0->Vertex);
     }
   }
-  ok &= !I->G->Interrupt;
+  ok &= !RayInterrupted(I);
 
   if (ok){
     memcpy(basis1->Radius, basis0->Radius, basis0->NVertex * sizeof(float));
     memcpy(basis1->Radius2, basis0->Radius2, basis0->NVertex * sizeof(float));
     memcpy(basis1->Vert2Normal, basis0->Vert2Normal, basis0->NVertex * sizeof(int));
   }
-  ok &= !I->G->Interrupt;
+  ok &= !RayInterrupted(I);
   if (ok){
     basis1->MaxRadius = basis0->MaxRadius;
     basis1->MinVoxel = basis0->MinVoxel;
     basis1->NVertex = basis0->NVertex;
   }
-  ok &= !I->G->Interrupt;
+  ok &= !RayInterrupted(I);
   if (ok){
     if(identity) {
       UtilCopyMem(basis1->Normal, basis0->Normal, basis0->NNormal * sizeof(float) * 3);
@@ -903,7 +910,7 @@ int RayTransformFirst(CRay * I, int perspective, int identity)
     }
     basis1->NNormal = basis0->NNormal;
   }
-  ok &= !I->G->Interrupt;
+  ok &= !RayInterrupted(I);
   if(perspective) {
     for(a = 0; ok && a < I->NPrimitive; a++) {
       prm = I->Primitive + a;
@@ -919,7 +926,7 @@ int RayTransformFirst(CRay * I, int perspective, int identity)
                                            basis1->Vert2Normal[prm->vert] * 3);
         break;
       }
-      ok &= !I->G->Interrupt;
+      ok &= !RayInterrupted(I);
     }
   } else {
     for(a = 0; ok && a < I->NPrimitive; a++) {
@@ -945,7 +952,7 @@ int RayTransformFirst(CRay * I, int perspective, int identity)
         break;
 
       }
-      ok &= !I->G->Interrupt;
+      ok &= !RayInterrupted(I);
     }
   }
   return ok;
@@ -3154,6 +3161,19 @@ static void RayPrimGetColorRamped(PyMOLGlobals * G, float *matrix, RayInfo * r,
   }
 }
 
+/**
+ * Pseudo random but reproducible value in [0, 1) for a pixel, used to
+ * rotate the sample pattern of soft shadows from pixel to pixel.
+ */
+static float RayPixelHash(int x, int y)
+{
+  unsigned int h = ((unsigned int) x * 0x8da6b343u) ^ ((unsigned int) y * 0xd8163841u);
+  h ^= h >> 13;
+  h *= 0x5bd1e995u;
+  h ^= h >> 15;
+  return (h & 0xFFFFFF) / 16777216.0F;
+}
+
 int RayTraceThread(CRayThreadInfo * T)
 {
   CRay *I = T->ray;
@@ -3207,7 +3227,7 @@ int RayTraceThread(CRayThreadInfo * T)
   CBasis *bp1, *bp2;
   int render_height;
   int offset = 0;
-  BasisCallRec BasisCall[MAX_BASIS];
+  BasisCallRec BasisCall[MAX_BASIS + MAX_OCCLUSION_BASIS];
   float border_offset;
   int edge_sampling = false;
   unsigned int edge_avg[4] = { 0, 0, 0, 0 };
@@ -3217,6 +3237,11 @@ int RayTraceThread(CRayThreadInfo * T)
   float interior_normal[3] = {0.0F, 0.0F, 0.0F};
   float edge_width = 0.35356F;
   float edge_height = 0.35356F;
+  float edge_pixel_width, edge_pixel_height;
+  int const edge_samples = T->edge_samples;
+  /* legacy edge oversampling adds 4 samples to the traced one,
+     adaptive antialiasing replaces it by a regular grid */
+  int const edge_total = edge_samples ? (edge_samples * edge_samples) : 5;
   float trans_spec_cut, trans_spec_scale, trans_oblique, oblique_power;
   float direct_shade;
   float red_blend = 0.0F;
@@ -3243,6 +3268,12 @@ int RayTraceThread(CRayThreadInfo * T)
   const int spec_local = SettingGetGlobal_i(I->G, cSetting_ray_spec_local);
   float legacy = SettingGetGlobal_f(I->G, cSetting_ray_legacy_lighting);
   int spec_count = SettingGetGlobal_i(I->G, cSetting_spec_count);
+  const float shadow_soft = tanf(
+      std::clamp(SettingGetGlobal_f(I->G, cSetting_ray_shadow_softness), 0.0F, 45.0F) *
+      (float) cPI / 180.0F);
+  const int shadow_samples = std::max(1, SettingGetGlobal_i(I->G, cSetting_ray_shadow_samples));
+  const float occlusion_radius = SettingGetGlobal_f(I->G, cSetting_ray_ambient_occlusion_radius);
+  float occlusion_vis;
   const float _0 = 0.0F;
   const float _1 = 1.0F;
   const float _p5 = 0.5F;
@@ -3251,7 +3282,7 @@ int RayTraceThread(CRayThreadInfo * T)
   const float _p499 = 0.499F;
   const float _persistLimit = 0.0001F;
   float legacy_1m = _1 - legacy;
-  int n_basis = I->NBasis;
+  int n_basis = I->NBasis - I->NOcclusion; /* lights */
   int bg_image_mode = SettingGetGlobal_i(I->G, cSetting_bg_image_mode);
   int bg_image_linear = SettingGetGlobal_b(I->G, cSetting_bg_image_linear);
   auto bg_image_tilesize = SettingGet<const float*>(I->G, cSetting_bg_image_tilesize);
@@ -3435,9 +3466,11 @@ int RayTraceThread(CRayThreadInfo * T)
 
   edge_width *= invWdthRange;
   edge_height *= invHgtRange;
+  edge_pixel_width = invWdthRange;
+  edge_pixel_height = invHgtRange;
 
   bp1 = I->Basis + 1;
-  if(I->NBasis > 2)
+  if(n_basis > 2)
     bp2 = I->Basis + 2;
   else
     bp2 = nullptr;
@@ -3494,7 +3527,8 @@ int RayTraceThread(CRayThreadInfo * T)
       BasisCall[bc].back = _0;
       BasisCall[bc].excl_trans = _0;
       BasisCall[bc].trans_shadows = trans_shadows;
-      BasisCall[bc].nearest_shadow = (shadow_decay != _0) || (clip_shadows);
+      BasisCall[bc].nearest_shadow = (shadow_decay != _0) || (clip_shadows) ||
+                                     (shadow_soft != _0);
       BasisCall[bc].check_interior = false;
       BasisCall[bc].fudge0 = BasisFudge0;
       BasisCall[bc].fudge1 = BasisFudge1;
@@ -3503,6 +3537,101 @@ int RayTraceThread(CRayThreadInfo * T)
     }
   }
 
+  for(int bc = n_basis; bc < I->NBasis; bc++) {  /* ambient occlusion */
+    BasisCall[bc].Basis = I->Basis + bc;
+    BasisCall[bc].rr = &r2;
+    BasisCall[bc].vert2prim = vert2prim_ptr;
+    BasisCall[bc].prim = I->Primitive;
+    BasisCall[bc].shadow = true;
+    BasisCall[bc].front = _0;
+    BasisCall[bc].back = _0;
+    BasisCall[bc].excl_trans = _0;
+    BasisCall[bc].trans_shadows = trans_shadows;
+    BasisCall[bc].nearest_shadow = true;
+    BasisCall[bc].check_interior = false;
+    BasisCall[bc].fudge0 = BasisFudge0;
+    BasisCall[bc].fudge1 = BasisFudge1;
+    BasisCall[bc].label_shadow_mode = label_shadow_mode;
+    BasisCall[bc].cache = MapCacheType(*I->Basis[bc].Map);
+  }
+
+  /* light which reaches the impact point (r2.base in the basis bc) along
+     the shadow ray, with the occluder distance in r2.dist if less than one */
+  auto shadow_lit = [&](int bc, int except) -> float {
+    CBasis *bp = I->Basis + bc;
+    float lit = _1;
+    BasisCall[bc].except2 = -1;
+    BasisCall[bc].except1 = except;  /* exclude current prim from shadow comp */
+    if(BasisHitShadow(&BasisCall[bc]) > -1) {
+      if((!clip_shadows) || (bp->LightNormal[2] >= _0) ||
+         ((T->front + r1.impact[2] - (r2.dist * bp->LightNormal[2])) < _0)) {
+        lit = (float) pow(r2.trans, _p5);
+        if((shadow_decay != _0) && (r2.dist > shadow_range)) {
+          if(shadow_decay > 0) {
+            lit +=
+              ((_1 - lit) * (_1 -
+                             _1 / exp((r2.dist - shadow_range) *
+                                      shadow_decay)));
+          } else {
+            lit +=
+              ((_1 - lit) * (_1 -
+                             _1 / pow(r2.dist / shadow_range,
+                                      -shadow_decay)));
+          }
+        }
+      }
+    }
+    return lit;
+  };
+
+  /* area light with an angular radius of atan(shadow_soft): averages
+     shadow rays from stratified offsets of the origin (Vogel disk, rotated
+     per pixel). An occluder hit by an offset ray only counts if it lies in
+     the cone of the light, so the penumbra widens with the occluder
+     distance. The central ray (center_lit) sets the offset scale. */
+  const float soft_range = 0.25F * (T->back - T->front);
+  auto soft_shadow_lit = [&](int bc, int except, float center_lit, float rot) -> float {
+    float base[3];
+    copy3f(r2.base, base);
+    const float radius = shadow_soft * ((center_lit < _1) ? r2.dist : soft_range);
+    float sum = _0;
+    for(int s = 0; s < shadow_samples; s++) {
+      const float r = radius * sqrt1f((s + _p5) / shadow_samples);
+      const float phi = (s + rot) * 2.39996323F;      /* golden angle */
+      r2.base[0] = base[0] + r * cosf(phi);
+      r2.base[1] = base[1] + r * sinf(phi);
+      r2.base[2] = base[2];
+      float lit = shadow_lit(bc, except);
+      if((lit < _1) && (r > r2.dist * shadow_soft))
+        lit = _1;               /* outside of the light's cone */
+      sum += lit;
+    }
+    copy3f(base, r2.base);
+    return sum / shadow_samples;
+  };
+
+  /* cosine weighted fraction of the hemisphere above the impact point which
+     is not blocked within occlusion_radius, from the occlusion bases */
+  auto ambient_visibility = [&](int except) -> float {
+    float sum = _0, sum_w = _0;
+    for(int bc = n_basis; bc < I->NBasis; bc++) {
+      CBasis *bp = I->Basis + bc;
+      float w = -dot_product3f(r1.surfnormal, bp->LightNormal);
+      if(w <= _0)
+        continue;
+      sum_w += w;
+      matrix_transform33f3f(bp->Matrix, r1.impact, r2.base);
+      r2.base[2] -= shadow_fudge;
+      BasisCall[bc].except2 = -1;
+      BasisCall[bc].except1 = except;
+      if((BasisHitShadow(&BasisCall[bc]) > -1) && (r2.dist < occlusion_radius)) {
+        w *= (float) pow(r2.trans, _p5);
+      }
+      sum += w;
+    }
+    return (sum_w > _0) ? (sum / sum_w) : _1;
+  };
+
   if(T->border) {
     border_offset = -1.50F + T->border / 2.0F;
   } else {
@@ -3523,7 +3652,7 @@ int RayTraceThread(CRayThreadInfo * T)
     unsigned int bkrd_value = 0;
     short isOutsideInY = 0;
 
-    if(I->G->Interrupt)
+    if(RayInterrupted(I))
       break;
 
     y = T->y_start + ((yy - T->y_start) + offset) % (render_height);    /* make sure threads write to different pages */
@@ -3627,13 +3756,24 @@ int RayTraceThread(CRayThreadInfo * T)
                              T->width, T->edging_cutoff, bkrd_value)) {
                   unsigned char *pixel_c = (unsigned char *) pixel;
                   unsigned int c1, c2, c3, c4;
-                  edge_cnt = 1;
                   edge_sampling = true;
+                  T->n_edge++;
 
-                  edge_avg[0] = (c1 = pixel_c[0]);
-                  edge_avg[1] = (c2 = pixel_c[1]);
-                  edge_avg[2] = (c3 = pixel_c[2]);
-                  edge_avg[3] = (c4 = pixel_c[3]);
+                  if(edge_samples) {
+                    edge_cnt = 0;
+                    c1 = c2 = c3 = c4 = 0;
+                  } else {
+                    edge_cnt = 1;
+                    c1 = pixel_c[0];
+                    c2 = pixel_c[1];
+                    c3 = pixel_c[2];
+                    c4 = pixel_c[3];
+                  }
+
+                  edge_avg[0] = c1;
+                  edge_avg[1] = c2;
+                  edge_avg[2] = c3;
+                  edge_avg[3] = c4;
 
                   edge_alpha_avg[0] = c1 * c4;
                   edge_alpha_avg[1] = c2 * c4;
@@ -3646,7 +3786,7 @@ int RayTraceThread(CRayThreadInfo * T)
               }
             }
             if(edge_sampling) {
-              if(edge_cnt == 5) {
+              if(edge_cnt == edge_total) {
                 /* done with edging, so store averaged value */
 
                 unsigned char *pixel_c = (unsigned char *) pixel;
@@ -3689,23 +3829,32 @@ int RayTraceThread(CRayThreadInfo * T)
               } else {
                 *pixel = 0;
 		//                *pixel = bkrd_value;
-                switch (edge_cnt) {
-                case 1:
-                  r1.base[0] = edge_base[0] + edge_width;
-                  r1.base[1] = edge_base[1] + edge_height;
-                  break;
-                case 2:
-                  r1.base[0] = edge_base[0] + edge_width;
-                  r1.base[1] = edge_base[1] - edge_height;
-                  break;
-                case 3:
-                  r1.base[0] = edge_base[0] - edge_width;
-                  r1.base[1] = edge_base[1] + edge_height;
-                  break;
-                case 4:
-                  r1.base[0] = edge_base[0] - edge_width;
-                  r1.base[1] = edge_base[1] - edge_height;
-                  break;
+                if(edge_samples) {
+                  /* regular subpixel grid, like antialias at edge_samples
+                     times the resolution */
+                  r1.base[0] = edge_base[0] + edge_pixel_width *
+                    ((edge_cnt % edge_samples + _p5) / edge_samples - _p5);
+                  r1.base[1] = edge_base[1] + edge_pixel_height *
+                    ((edge_cnt / edge_samples + _p5) / edge_samples - _p5);
+                } else {
+                  switch (edge_cnt) {
+                  case 1:
+                    r1.base[0] = edge_base[0] + edge_width;
+                    r1.base[1] = edge_base[1] + edge_height;
+                    break;
+                  case 2:
+                    r1.base[0] = edge_base[0] + edge_width;
+                    r1.base[1] = edge_base[1] - edge_height;
+                    break;
+                  case 3:
+                    r1.base[0] = edge_base[0] - edge_width;
+                    r1.base[1] = edge_base[1] + edge_height;
+                    break;
+                  case 4:
+                    r1.base[0] = edge_base[0] - edge_width;
+                    r1.base[1] = edge_base[1] - edge_height;
+                    break;
+                  }
                 }
 
               }
@@ -3802,7 +3951,7 @@ int RayTraceThread(CRayThreadInfo * T)
                   // Affects spheres+cylinders, but not surfaces+cartoon.
                   copy3f(r1.prim->c1, fc);
                 } else {
-                  copy3f(r1.prim->ic, fc);
+                  copy3f(I->IntColors[r1.prim->ic].data(), fc);
                 }
               } else {
                 if(!perspective)
@@ -3940,7 +4089,7 @@ int RayTraceThread(CRayThreadInfo * T)
                       // Affects surfaces+cartoon, but not spheres+cylinders.
                       copy3f(r1.prim->c1, fc);
                     } else {
-                      copy3f(r1.prim->ic, fc);
+                      copy3f(I->IntColors[r1.prim->ic].data(), fc);
                     }
                   }
                 }
@@ -3995,27 +4144,9 @@ int RayTraceThread(CRayThreadInfo * T)
                      ((r1.prim->type != cPrimCharacter) || (label_shadow_mode & 0x1))) {
                     matrix_transform33f3f(bp->Matrix, r1.impact, r2.base);
                     r2.base[2] -= shadow_fudge;
-                    BasisCall[bc].except2 = -1;
-                    BasisCall[bc].except1 = i;  /* exclude current prim from shadow comp */
-                    if(BasisHitShadow(&BasisCall[bc]) > -1) {
-                      if((!clip_shadows) || (bp->LightNormal[2] >= _0) ||
-                         ((T->front + r1.impact[2] - (r2.dist * bp->LightNormal[2])) <
-                          _0)) {
-                        lit = (float) pow(r2.trans, _p5);
-                        if((shadow_decay != _0) && (r2.dist > shadow_range)) {
-                          if(shadow_decay > 0) {
-                            lit +=
-                              ((_1 - lit) * (_1 -
-                                             _1 / exp((r2.dist - shadow_range) *
-                                                      shadow_decay)));
-                          } else {
-                            lit +=
-                              ((_1 - lit) * (_1 -
-                                             _1 / pow(r2.dist / shadow_range,
-                                                      -shadow_decay)));
-                          }
-                        }
-                      }
+                    lit = shadow_lit(bc, i);
+                    if(shadow_soft != _0) {
+                      lit = soft_shadow_lit(bc, i, lit, RayPixelHash(x, y));
                     }
                   }
 
@@ -4098,7 +4229,14 @@ int RayTraceThread(CRayThreadInfo * T)
                 ColorGetRamped(I->G, (int) (fc[0] - 0.1F), back_pact, fc, -1);
               }
 
-              bright = ambient + (((_1 - direct_shade) + direct_shade * lit) * direct * direct_cmp + lreflect * reflect_cmp * (legacy_1m + legacy * direct_cmp));       /* blend legacy */
+              occlusion_vis = _1;
+              if(I->NOcclusion && n_basis_tmp && (!interior_flag) &&
+                 (r1.prim->type != cPrimCharacter)) {
+                /* ambient occlusion darkens the ambient and the (unshadowed) direct light */
+                occlusion_vis = ambient_visibility(i);
+              }
+
+              bright = occlusion_vis * ambient + (((_1 - direct_shade) + direct_shade * lit) * direct * occlusion_vis * direct_cmp + lreflect * reflect_cmp * (legacy_1m + legacy * direct_cmp));       /* blend legacy */
               if(excess > _1)
                 excess = _1;
               if(bright > _1)
@@ -5505,6 +5643,36 @@ float *rayDepthPixels = nullptr;
 int rayVolume = 0, rayWidth = 0, rayHeight = 0;
 
 /*========================================================================*/
+/**
+ * Memory held by the primitives and the acceleration structures (bases and
+ * voxel maps) of all lights.
+ */
+static size_t RayGetMemoryUsage(const CRay* I)
+{
+  size_t bytes = VLAGetSize(I->Primitive) * sizeof(CPrimitive) +
+                 I->Vert2Prim.capacity() * sizeof(int) +
+                 I->IntColors.capacity() * sizeof(I->IntColors[0]);
+
+  for (int bc = 0; bc < I->NBasis; ++bc) {
+    const CBasis* basis = I->Basis + bc;
+    if (basis->Vertex) {
+      bytes += (VLAGetSize(basis->Vertex) + VLAGetSize(basis->Normal) +
+                   VLAGetSize(basis->Precomp) + VLAGetSize(basis->Radius) +
+                   VLAGetSize(basis->Radius2)) *
+                   sizeof(float) +
+               VLAGetSize(basis->Vert2Normal) * sizeof(int);
+    }
+    if (const MapType* map = basis->Map) {
+      bytes += (map->Head.capacity() + map->Link.capacity() +
+                   map->EHead.capacity() + map->EList.capacity() +
+                   map->EMask.capacity()) *
+               sizeof(int);
+    }
+  }
+
+  return bytes;
+}
+
 void RayRender(CRay * I, unsigned int *image, double timing,
                float angle, int antialias, unsigned int *return_bg)
 {
@@ -5523,6 +5691,7 @@ void RayRender(CRay * I, unsigned int *image, double timing,
   int n_thread;
   int mag = 1;
   int oversample_cutoff;
+  int edge_samples = 0;
   int perspective = SettingGetGlobal_i(I->G, cSetting_ray_orthoscopic);
   int n_light = SettingGetGlobal_i(I->G, cSetting_light_count);
   float ambient;
@@ -5587,6 +5756,15 @@ void RayRender(CRay * I, unsigned int *image, double timing,
   if(antialias > 4)
     antialias = 4;
 
+  if(antialias > 1 && !ray_trace_mode && oversample_cutoff &&
+      SettingGetGlobal_b(I->G, cSetting_ray_adaptive_antialias)) {
+    /* trace at the final resolution and only supersample pixels which
+       differ from their neighbors in color or depth (without a cutoff no
+       pixel is flagged, so fall back to full supersampling) */
+    edge_samples = antialias;
+    antialias = 1;
+  }
+
   if((!antialias) || ray_trace_mode)
     oversample_cutoff = 0;
 
@@ -5613,7 +5791,8 @@ void RayRender(CRay * I, unsigned int *image, double timing,
 
   bkrd_is_gradient = SettingGetGlobal_b(I->G, cSetting_bg_gradient);
   bg_image_filename = SettingGet_s(I->G, nullptr, nullptr, cSetting_bg_image_filename);
-  I->bkgrd_data = OrthoBackgroundDataGet(*I->G->Ortho);
+  if (!I->Detached) // otherwise taken by RayDetach
+    I->bkgrd_data = OrthoBackgroundDataGet(*I->G->Ortho);
   if (!I->bkgrd_data && bg_image_filename && bg_image_filename[0]){
     I->bkgrd_data = MyPNGRead(bg_image_filename);
     bkrd_is_gradient = 0;
@@ -5735,7 +5914,8 @@ void RayRender(CRay * I, unsigned int *image, double timing,
   } else {
     background = back_mask;
   }
-  OrthoBusyFast(I->G, 2, 20);
+  if(!I->Detached)
+    OrthoBusyFast(I->G, 2, 20);
 
   if (!bkrd_is_gradient) {
     PRINTFB(I->G, FB_Ray, FB_Blather)
@@ -5763,13 +5943,19 @@ void RayRender(CRay * I, unsigned int *image, double timing,
     } else {
       I->PrimSize = 0.0F;
     }
-    ok &= !I->G->Interrupt;
-    if (ok)
+    ok &= !RayInterrupted(I);
+
+    // all primitives are in, release the VLA growth reserve before the
+    // acceleration structures get allocated
+    VLASize(I->Primitive, CPrimitive, std::max(I->NPrimitive, 1));
+
+    if (ok && !I->Expanded)
       ok &= RayExpandPrimitives(I);
     if (ok)
       ok &= RayTransformFirst(I, perspective, false);
 
-    OrthoBusyFast(I->G, 3, 20);
+    if(!I->Detached)
+      OrthoBusyFast(I->G, 3, 20);
 
     now = UtilGetSeconds(I->G) - timing;
 
@@ -5849,15 +6035,64 @@ void RayRender(CRay * I, unsigned int *image, double timing,
           BasisSetupMatrix(I->Basis + bc);
           ok &= RayTransformBasis(I, I->Basis + bc);
         }
-	ok &= !I->G->Interrupt;
+	ok &= !RayInterrupted(I);
+      }
+    }
+
+    if (ok) {                           /* ambient occlusion directions */
+      int n_occlusion = SettingGetGlobal_i(I->G, cSetting_ray_ambient_occlusion);
+      if(n_occlusion > MAX_OCCLUSION_BASIS)
+        n_occlusion = MAX_OCCLUSION_BASIS;
+      I->NOcclusion = 0;
+      for(int k = 0; ok && k < n_occlusion; k++) {
+        CBasis *bp = I->Basis + I->NBasis;
+        float dir[3];
+        ok &= BasisInit(I->G, bp);
+        if(!ok)
+          break;
+        I->NBasis++;
+        I->NOcclusion++;
+
+        /* stratified (Fibonacci) directions on the sphere, fixed in model
+           space so that the pattern doesn't crawl over rotating scenes */
+        dir[2] = 1.0F - (2 * k + 1) / (float) n_occlusion;
+        {
+          float r = sqrt1f(1.0F - dir[2] * dir[2]);
+          float phi = k * 2.39996323F;    /* golden angle */
+          dir[0] = r * cosf(phi);
+          dir[1] = r * sinf(phi);
+        }
+        MatrixTransformC44fAs33f3f(I->ModelView, dir, dir);
+        if(angle) {
+          float temp[16];
+          identity44f(temp);
+          MatrixRotateC44f(temp, (float) -PI * angle / 180, 0.0F, 1.0F, 0.0F);
+          MatrixTransformC44fAs33f3f(temp, dir, dir);
+        }
+        normalize3f(dir);
+
+        /* like a light shining from dir */
+        invert3f3f(dir, bp->LightNormal);
+        copy3f(bp->LightNormal, bp->SpecNormal);
+        BasisSetupMatrix(bp);
+        ok &= RayTransformBasis(I, bp);
+	ok &= !RayInterrupted(I);
       }
     }
 
-    OrthoBusyFast(I->G, 4, 20);
+    /* bases which need a voxel map besides the rendering map (Basis[1]) */
+    std::vector<int> mapped_bases;
+    for(int bc = 2; bc < I->NBasis; bc++) {
+      if(shadows || bc >= I->NBasis - I->NOcclusion)
+        mapped_bases.push_back(bc);
+    }
+
+    if(!I->Detached)
+      OrthoBusyFast(I->G, 4, 20);
 #ifndef _PYMOL_NOPY
-    if(shadows && (n_thread > 1)) {     /* parallel execution */
+    if(!mapped_bases.empty() && (n_thread > 1)) {     /* parallel execution */
 
-      CRayHashThreadInfo *thread_info = pymol::calloc<CRayHashThreadInfo>(I->NBasis);
+      CRayHashThreadInfo *thread_info = pymol::calloc<CRayHashThreadInfo>(mapped_bases.size() + 1);
 
       /* rendering map */
       int* vert2prim_ptr = I->Vert2Prim.empty() ? nullptr : I->Vert2Prim.data();
@@ -5891,26 +6126,25 @@ void RayRender(CRay * I, unsigned int *image, double timing,
       /* shadow map */
 
       {
-        int bc;
         float factor = SettingGetGlobal_f(I->G, cSetting_ray_hint_shadow);
-        for(bc = 2; bc < I->NBasis; bc++) {
-          int* vert2prim_ptr = I->Vert2Prim.empty() ? nullptr : I->Vert2Prim.data();
-          thread_info[bc - 1].basis = I->Basis + bc;
-          thread_info[bc - 1].vert2prim = vert2prim_ptr;
-          thread_info[bc - 1].prim = I->Primitive;
-          thread_info[bc - 1].n_prim = I->NPrimitive;
-          thread_info[bc - 1].clipBox = nullptr;
-          thread_info[bc - 1].phase = bc - 1;
-          thread_info[bc - 1].perspective = false;
-          thread_info[bc - 1].front = _0;
+        for(size_t t = 1; t <= mapped_bases.size(); t++) {
+          int bc = mapped_bases[t - 1];
+          thread_info[t].basis = I->Basis + bc;
+          thread_info[t].vert2prim = vert2prim_ptr;
+          thread_info[t].prim = I->Primitive;
+          thread_info[t].n_prim = I->NPrimitive;
+          thread_info[t].clipBox = nullptr;
+          thread_info[t].phase = t;
+          thread_info[t].perspective = false;
+          thread_info[t].front = _0;
           /* allowing these maps to be more fine helps performance */
-          thread_info[bc - 1].size_hint = I->PrimSize * factor;
+          thread_info[t].size_hint = I->PrimSize * factor;
         }
       }
 
       /* NOTE that we're not limiting the number of threads in this phase
          under the assumption that it will usually just be a few threads */
-      RayHashSpawn(thread_info, n_thread, I->NBasis - 1);
+      RayHashSpawn(thread_info, n_thread, mapped_bases.size() + 1);
 
       FreeP(thread_info);
     } else
@@ -5922,12 +6156,13 @@ void RayRender(CRay * I, unsigned int *image, double timing,
       int* vert2prim_ptr = I->Vert2Prim.empty() ? nullptr : I->Vert2Prim.data();
       ok &= BasisMakeMap(I->Basis + 1, vert2prim_ptr, I->Primitive, I->NPrimitive,
 			 I->Volume, perspective, front, I->PrimSize);
-      if(ok && shadows) {
-        int bc;
+      if(ok && !mapped_bases.empty()) {
         float factor = SettingGetGlobal_f(I->G, cSetting_ray_hint_shadow);
-        for(bc = 2; ok && bc < I->NBasis; bc++) {
+        for(int bc : mapped_bases) {
           ok &= BasisMakeMap(I->Basis + bc, vert2prim_ptr, I->Primitive, I->NPrimitive,
 			     nullptr, false, _0, I->PrimSize * factor);
+          if(!ok)
+            break;
         }
       }
 
@@ -5946,7 +6181,8 @@ void RayRender(CRay * I, unsigned int *image, double timing,
       }
     }
 
-    OrthoBusyFast(I->G, 5, 20);
+    if(!I->Detached)
+      OrthoBusyFast(I->G, 5, 20);
     now = UtilGetSeconds(I->G) - timing;
 
     if (ok){
@@ -5964,6 +6200,11 @@ void RayRender(CRay * I, unsigned int *image, double timing,
 	  I->Basis[1].Map->Dim[1], I->Basis[1].Map->Dim[2], now ENDFB(I->G);
       }
     }
+    if (ok) {
+      // reported with the render time, see SceneRay
+      I->MemoryUsage = RayGetMemoryUsage(I);
+    }
+
     /* IMAGING */
 
     if (ok){
@@ -6081,6 +6322,7 @@ void RayRender(CRay * I, unsigned int *image, double timing,
         rt[a].n_thread = n_thread;
         rt[a].edging = nullptr;
         rt[a].edging_cutoff = oversample_cutoff;        /* info needed for busy indicator */
+        rt[a].edge_samples = edge_samples;
         rt[a].perspective = perspective;
         rt[a].fov = fov;
         rt[a].pos[2] = pos[2];
@@ -6118,6 +6360,16 @@ void RayRender(CRay * I, unsigned int *image, double timing,
           RayTraceThread(rt);
 
         FreeP(edging);
+
+        {
+          int n_edge = 0;
+          for(a = 0; a < n_thread; a++) {
+            n_edge += rt[a].n_edge;
+          }
+          PRINTFB(I->G, FB_Ray, FB_Details)
+            " Ray: supersampled %d of %d pixels (%1.1f%%).\n", n_edge,
+            (int) buffer_size, (100.f * n_edge) / buffer_size ENDFB(I->G);
+        }
       }
       FreeP(rt);
     }
@@ -6618,6 +6870,19 @@ void CRay::interiorColor3fv(const float *v, int passive)
     I->CheckInterior = true;
 }
 
+/**
+ * Index of the current interior color in `IntColors`. Primitives only store
+ * this index, the interior color rarely changes.
+ */
+int CRay::intColorIndex()
+{
+  std::array<float, 3> const color{IntColor[0], IntColor[1], IntColor[2]};
+  if (IntColors.empty() || IntColors.back() != color) {
+    IntColors.push_back(color);
+  }
+  return IntColors.size() - 1;
+}
+
 
 /*========================================================================*/
 void CRay::color3fv(const float *v)
@@ -6666,11 +6931,7 @@ int CRay::sphere3fv(const float *v, float r)
   (*vv++) = (*v++);
   (*vv++) = (*v++);
 
-  vv = p->ic;
-  v = I->IntColor;
-  (*vv++) = (*v++);
-  (*vv++) = (*v++);
-  (*vv++) = (*v++);
+  p->ic = I->intColorIndex();
 
   if(I->TTTFlag) {
     p->r1 *= length3f(glm::value_ptr(I->TTT));
@@ -6722,6 +6983,7 @@ int CRay::character(int char_id)
   int ok = true;
 
   v = TextGetPos(I->G);
+  I->ViewDependent = true;
   VLACheck2<CPrimitive>(I->Primitive, I->NPrimitive + 1);
   CHECKOK(ok, I->Primitive);
   if (!ok)
@@ -6819,19 +7081,8 @@ int CRay::character(int char_id)
     add3f(p->v1, yn, pp->v2);
     add3f(p->v1, xn, pp->v3);
 
-    {
-      float *v, *vv;
-      vv = p->ic;
-      v = I->IntColor;
-      (*vv++) = (*v++);
-      (*vv++) = (*v++);
-      (*vv++) = (*v++);
-      vv = pp->ic;
-      v = I->IntColor;
-      (*vv++) = (*v++);
-      (*vv++) = (*v++);
-      (*vv++) = (*v++);
-    }
+    p->ic = I->intColorIndex();
+    pp->ic = I->intColorIndex();
 
     /* encode integral character coordinates into the vertex colors  */
 
@@ -6910,14 +7161,7 @@ int CRay::cylinder3fv(const float *v1, const float *v2, float r, const float *c1
 
   // FIXME: alpha1 is not used
   p->trans = 1.0 - alpha2;
-  {
-    float *v;
-    vv = p->ic;
-    v = I->IntColor;
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-  }
+  p->ic = I->intColorIndex();
 
   I->NPrimitive++;
   return true;
@@ -7003,19 +7247,11 @@ int CRay::customCylinder3fv(const float *v1, const float *v2, float r,
   (*vv++) = (*c2++);
   (*vv++) = (*c2++);
   (*vv++) = (*c2++);
-  vv = p->ic;
 
   // FIXME: alpha1 is not used
   p->trans = 1.0f - alpha2;
 
-  {
-    float *v;
-    vv = p->ic;
-    v = I->IntColor;
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-  }
+  p->ic = I->intColorIndex();
 
   I->NPrimitive++;
   return true;
@@ -7089,15 +7325,7 @@ int CRay::cone3fv(const float *v1, const float *v2, float r1, float r2,
   (*vv++) = (*c2++);
   (*vv++) = (*c2++);
   (*vv++) = (*c2++);
-  vv = p->ic;
-  {
-    float *v;
-    vv = p->ic;
-    v = I->IntColor;
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-  }
+  p->ic = I->intColorIndex();
 
   I->NPrimitive++;
   return true;
@@ -7156,15 +7384,7 @@ int CRay::sausage3fv(const float *v1, const float *v2, float r, const float *c1,
   (*vv++) = (*c2++);
   (*vv++) = (*c2++);
   (*vv++) = (*c2++);
-  vv = p->ic;
-
-  {
-    float *v = I->IntColor;
-    vv = p->ic;
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-  }
+  p->ic = I->intColorIndex();
 
   I->NPrimitive++;
   return true;
@@ -7251,11 +7471,7 @@ int CRay::ellipsoid3fv(const float *v, float r, const float *n1, const float *n2
   (*vv++) = (*v++);
   (*vv++) = (*v++);
 
-  vv = p->ic;
-  v = I->IntColor;
-  (*vv++) = (*v++);
-  (*vv++) = (*v++);
-  (*vv++) = (*v++);
+  p->ic = I->intColorIndex();
 
   if(I->TTTFlag) {
     p->r1 *= length3f(glm::value_ptr(I->TTT));
@@ -7398,13 +7614,7 @@ int CRay::triangle3fv(
   (*vv++) = (*c3++);
   (*vv++) = (*c3++);
 
-  {
-    float *v = I->IntColor;
-    vv = p->ic;
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-    (*vv++) = (*v++);
-  }
+  p->ic = I->intColorIndex();
 
   if (normals_exist){
     vv = p->n1;
@@ -7496,7 +7706,7 @@ CRay *RayNew(PyMOLGlobals * G, int antialias)
   PRINTFB(I->G, FB_Ray, FB_Blather)
     " RayNew: BigEndian = %d\n", I->BigEndian ENDFB(I->G);
 
-  I->Basis = pymol::malloc<CBasis>(12);
+  I->Basis = pymol::malloc<CBasis>(MAX_BASIS + MAX_OCCLUSION_BASIS);
   BasisInit(I->G, I->Basis);
   BasisInit(I->G, I->Basis + 1);
   I->NBasis = 2;
@@ -7644,12 +7854,193 @@ void RayRelease(CRay * I)
 void RayFree(CRay * I)
 {
   RayRelease(I);
-  CharacterSetRetention(I->G, false);
+  if(!I->Detached)
+    CharacterSetRetention(I->G, false);
   FreeP(I->Basis);
   DeleteP(I);
 }
 
 
+/*========================================================================*/
+/**
+ * Session state seen by a detached ray: a copy of the globals with frozen
+ * settings and silent feedback.
+ */
+struct CRayDetached {
+  PyMOLGlobals G;
+  CSetting Setting;
+  CFeedback Feedback;
+  CColor Color;
+  const int *Interrupt; // the session's flag, see RayInterrupted
+
+  CRayDetached(PyMOLGlobals * G_)
+      : G(*G_)
+      , Setting(G_)
+      , Feedback(G_, true)
+      , Color(*G_->Color)
+      , Interrupt(&G_->Interrupt)
+  {
+    Setting = *G_->Setting;
+    for(auto& mask : Feedback.currentLayer())
+      mask = 0;
+    G.Setting = &Setting;
+    G.Feedback = &Feedback;
+    G.Color = &Color;
+  }
+};
+
+/**
+ * Detaches a prepared ray from the session, so that RayRender can run on a
+ * worker thread while the main thread moves on (e.g. to the next movie
+ * frame). Settings, colors and the background image are frozen, feedback
+ * and progress updates are disabled, and RayRender traces with a single
+ * thread since the ray thread spawn needs the Python interpreter. An
+ * interrupt of the session still aborts the detached ray.
+ *
+ * Must be called on the main thread, and only if RayCanDetach.
+ */
+void RayDetach(CRay * I)
+{
+  assert(!I->Detached);
+  assert(RayCanDetach(I));
+
+  CharacterSetRetention(I->G, false);
+
+  I->bkgrd_data = OrthoBackgroundDataGet(*I->G->Ortho);
+  I->Detached.reset(new CRayDetached(I->G));
+  I->G = &I->Detached->G;
+  SettingSetGlobal_i(I->G, cSetting_max_threads, 1);
+  SettingSetGlobal_b(I->G, cSetting_show_progress, false);
+
+  for(int a = 0; a < I->NBasis; a++) {
+    I->Basis[a].G = I->G;
+  }
+}
+
+/**
+ * False if tracing the ray needs live session data besides settings and
+ * colors: labels (character primitives) read the shared glyph cache, and
+ * ramped colors are looked up in the ramp objects at trace time.
+ */
+bool RayCanDetach(const CRay * I)
+{
+  for(int a = 0; a < I->NPrimitive; a++) {
+    auto const& prim = I->Primitive[a];
+    if(prim.type == cPrimCharacter || prim.ramped)
+      return false;
+  }
+  for(auto const& color : I->IntColors) {
+    if(color[0] <= cColorExtCutoff)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Interrupt flag of the session, also for a detached ray
+ */
+bool RayInterrupted(const CRay * I)
+{
+  return I->Detached ? *I->Detached->Interrupt : I->G->Interrupt;
+}
+
+
+/*========================================================================*/
+/**
+ * World space primitives of an expanded ray, with the view independent
+ * part of Basis[0]. See RayGetPrimitives.
+ */
+struct CRayPrimitives {
+  std::vector<CPrimitive> Primitive;
+  std::vector<std::array<float, 3>> IntColors;
+  std::vector<int> Vert2Prim;
+  std::vector<float> Vertex, Radius, Radius2, Normal;
+  std::vector<int> Vert2Normal;
+  float MaxRadius, MinVoxel;
+  double PrimSize;
+  int PrimSizeCnt;
+  int CheckInterior;
+};
+
+/**
+ * Expands the primitives (if not done yet) and returns a copy of them.
+ *
+ * Unless ViewDependent was set while the ray was filled, the copy can be
+ * handed to RaySetPrimitives of a ray with a different camera, as long as
+ * the pixel size (PixelRadius) is the same. The voxel maps are built in
+ * camera and light space by RayRender and are not part of the copy.
+ *
+ * @return nullptr on interrupt
+ */
+std::shared_ptr<const CRayPrimitives> RayGetPrimitives(CRay * I)
+{
+  if(!I->Expanded) {
+    VLASize(I->Primitive, CPrimitive, std::max(I->NPrimitive, 1));
+    if(!RayExpandPrimitives(I))
+      return nullptr;
+  }
+
+  const CBasis *basis = I->Basis;
+  std::size_t const nVert = basis->NVertex;
+  std::size_t const nNorm = basis->NNormal;
+
+  auto prims = std::make_shared<CRayPrimitives>();
+  prims->Primitive.assign(I->Primitive, I->Primitive + I->NPrimitive);
+  prims->IntColors = I->IntColors;
+  prims->Vert2Prim = I->Vert2Prim;
+  prims->Vertex.assign(basis->Vertex, basis->Vertex + 3 * nVert);
+  prims->Radius.assign(basis->Radius, basis->Radius + nVert);
+  prims->Radius2.assign(basis->Radius2, basis->Radius2 + nVert);
+  prims->Vert2Normal.assign(basis->Vert2Normal, basis->Vert2Normal + nVert);
+  prims->Normal.assign(basis->Normal, basis->Normal + 3 * nNorm);
+  prims->MaxRadius = basis->MaxRadius;
+  prims->MinVoxel = basis->MinVoxel;
+  prims->PrimSize = I->PrimSize;
+  prims->PrimSizeCnt = I->PrimSizeCnt;
+  prims->CheckInterior = I->CheckInterior;
+  return prims;
+}
+
+/**
+ * Fills a prepared (RayPrepare) but otherwise empty ray with primitives from
+ * RayGetPrimitives. RayRender will skip RayExpandPrimitives.
+ */
+void RaySetPrimitives(CRay * I, const CRayPrimitives & prims)
+{
+  CBasis *basis = I->Basis;
+  int const nVert = prims.Radius.size();
+  int const nNorm = prims.Normal.size() / 3;
+
+  assert(!I->NPrimitive);
+
+  I->NPrimitive = prims.Primitive.size();
+  VLASize(I->Primitive, CPrimitive, std::max(I->NPrimitive, 1));
+  std::copy(prims.Primitive.begin(), prims.Primitive.end(), I->Primitive);
+  I->IntColors = prims.IntColors;
+  I->Vert2Prim = prims.Vert2Prim;
+
+  VLASize2<float>(basis->Vertex, 3 * nVert);
+  VLASize2<float>(basis->Radius, nVert);
+  VLASize2<float>(basis->Radius2, nVert);
+  VLASize2<int>(basis->Vert2Normal, nVert);
+  VLASize2<float>(basis->Normal, 3 * nNorm);
+  std::copy(prims.Vertex.begin(), prims.Vertex.end(), basis->Vertex);
+  std::copy(prims.Radius.begin(), prims.Radius.end(), basis->Radius);
+  std::copy(prims.Radius2.begin(), prims.Radius2.end(), basis->Radius2);
+  std::copy(prims.Vert2Normal.begin(), prims.Vert2Normal.end(), basis->Vert2Normal);
+  std::copy(prims.Normal.begin(), prims.Normal.end(), basis->Normal);
+  basis->NVertex = nVert;
+  basis->NNormal = nNorm;
+  basis->MaxRadius = prims.MaxRadius;
+  basis->MinVoxel = prims.MinVoxel;
+
+  I->PrimSize = prims.PrimSize;
+  I->PrimSizeCnt = prims.PrimSizeCnt;
+  I->CheckInterior = prims.CheckInterior;
+  I->Expanded = true;
+}
+
+
 /*========================================================================*/
 void RayPushTTT(CRay * I)
 {
@@ -7736,6 +8127,7 @@ static void RayTransformInverseNormals33(unsigned int n, float3 * q, const float
   }
 }
 void RayGetScreenVertex(CRay * I, float *v, float *res){
+  I->ViewDependent = true;
   MatrixTransformC44f4f(I->ModelView, v, res);
   normalize4f(res);
 }
@@ -7748,6 +8140,7 @@ void RayAdjustZtoScreenZ(CRay * ray, float *pos, float zarg){
   float zInPreProj = -(z * clipRange + FrontSafe);
   float pos4[4], tpos[4], npos[4];
   float InvModMatrix[16];
+  ray->ViewDependent = true;
   copy3f(pos, pos4);
   pos4[3] = 1.f;
   MatrixTransformC44f4f(ray->ModelView, pos4, tpos);
@@ -7823,5 +8216,6 @@ float RayGetScaledAllAxesAtPoint(CRay * I, float *pt, float *xn, float *yn, floa
   return v_scale;
 }
 float* RayGetProMatrix(CRay * I){
+  I->ViewDependent = true;
   return I->ProMatrix;
 }
@@ -17,6 +17,7 @@ Z* -------------------------------------------------------------------
 #ifndef _H_Ray
 #define _H_Ray
 
+#include <array>
 #include <memory>
 #include <vector>
 #include <glm/vec3.hpp>
@@ -34,6 +35,8 @@ Z* -------------------------------------------------------------------
 typedef struct _CRayAntiThreadInfo CRayAntiThreadInfo;
 typedef struct _CRayHashThreadInfo CRayHashThreadInfo;
 typedef struct _CRayThreadInfo CRayThreadInfo;
+struct CRayDetached;
+struct CRayPrimitives;
 
 CRay *RayNew(PyMOLGlobals * G, int antialias);
 void RayFree(CRay * I);
@@ -46,6 +49,8 @@ void RayPrepare(CRay * I, float v0, float v1, float v2,
                 float back_ratio, float magnified);
 void RayRender(CRay * I, unsigned int *image,
                double timing, float angle, int antialias, unsigned int *return_bg);
+void RayRenderRaster(CRay * I, unsigned int *image, int antialias,
+                     unsigned int *return_bg);
 void RayRenderPOV(CRay * I, int width, int height, char **headerVLA,
                   char **charVLA, float front, float back, float fov, float angle,
                   int antialias);
@@ -70,6 +75,11 @@ void RayPushTTT(CRay * I);
 void RayPopTTT(CRay * I);
 void RaySetContext(CRay * I, pymol::RenderContext context);
 void RayRenderColorTable(CRay * I, int width, int height, int *image);
+void RayDetach(CRay * I);
+bool RayCanDetach(const CRay * I);
+bool RayInterrupted(const CRay * I);
+std::shared_ptr<const CRayPrimitives> RayGetPrimitives(CRay * I);
+void RaySetPrimitives(CRay * I, const CRayPrimitives & prims);
 int RayTraceThread(CRayThreadInfo * T);
 int RayGetNPrimitives(CRay * I);
 void RayGetScaledAxes(CRay * I, float *xn, float *yn);
@@ -136,6 +146,7 @@ struct _CRay {
   void interiorColor3fv(const float *v, int passive);
   int ellipsoid3fv(const float *v, float r, const float *n1, const float *n2, const float *n3);
   int setLastToNoLighting(char no_lighting);
+  int intColorIndex();
 
   /* everything below should be private */
   PyMOLGlobals *G;
@@ -143,8 +154,10 @@ struct _CRay {
   int NPrimitive;
   CBasis *Basis;
   int NBasis;
+  int NOcclusion;               /* ambient occlusion bases, after the lights */
   std::vector<int> Vert2Prim;
   float CurColor[3], IntColor[3];
+  std::vector<std::array<float, 3>> IntColors; // referenced by CPrimitive::ic
   float ModelView[16];
   float ProMatrix[16];
   glm::mat4 Rotation;
@@ -175,6 +188,10 @@ struct _CRay {
   float Fov;
   glm::vec3 Pos;
   std::shared_ptr<pymol::Image> bkgrd_data;
+  std::unique_ptr<CRayDetached> Detached; // see RayDetach
+  bool Expanded;      // RayExpandPrimitives done
+  bool ViewDependent; // primitives depend on the camera, see RayGetPrimitives
+  size_t MemoryUsage = 0; // primitives, bases and voxel maps, set by RayRender
 
 private:
   int cylinder3fv(const float *v1, const float *v2, float r, const float *c1, const float *c2,
@@ -0,0 +1,623 @@
+/**
+ * @file
+ * Software rasterizer for ray tracer primitives.
+ *
+ * Produces approximate "draw" quality images from a CRay without an OpenGL
+ * context. Primitives are binned into screen tiles and each tile is
+ * rendered independently with a depth buffer. Spheres, cylinders and
+ * triangles are intersected exactly per pixel (like GPU impostors), so
+ * perspective needs no special treatment. Shading is done once per pixel
+ * after all primitives of a tile are resolved and follows the OpenGL
+ * lighting model: ambient, head light and positional lights with specular
+ * highlights, plus depth cue. No shadows, no transparency and no labels.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Basis.h"
+#include "Color.h"
+#include "Feedback.h"
+#include "Ray.h"
+#include "Scene.h"
+#include "Setting.h"
+#include "Util.h"
+#include "Vector.h"
+
+namespace
+{
+
+constexpr int TileSize = 32; // in output pixels
+
+inline float Dot3(const float* a, const float* b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/**
+ * Camera rays through pixel centers. The ray direction always has z = -1,
+ * so the ray parameter equals the depth in front of the camera.
+ */
+struct RasterView {
+  bool perspective;
+  int width, height;
+  float front, back;
+  float x0, y0; //!< lower left image corner (ortho: camera space, perspective: slope)
+  float dx, dy; //!< pixel size (ortho: camera space, perspective: slope)
+
+  void ray(int x, int y, float* origin, float* dir) const
+  {
+    float const u = x0 + (x + 0.5f) * dx;
+    float const v = y0 + (y + 0.5f) * dy;
+    if (perspective) {
+      origin[0] = origin[1] = origin[2] = 0.f;
+      dir[0] = u;
+      dir[1] = v;
+    } else {
+      origin[0] = u;
+      origin[1] = v;
+      origin[2] = 0.f;
+      dir[0] = dir[1] = 0.f;
+    }
+    dir[2] = -1.f;
+  }
+
+  /// Pixel bounds of a camera space box, false if outside the view
+  bool bounds(const float* lo, const float* hi, int* rect) const
+  {
+    float dmin = -hi[2], dmax = -lo[2];
+    if (dmax < front || dmin > back)
+      return false;
+
+    float u[2], v[2];
+    if (perspective) {
+      dmin = std::max(dmin, front);
+      u[0] = std::min(lo[0] / dmin, lo[0] / dmax);
+      u[1] = std::max(hi[0] / dmin, hi[0] / dmax);
+      v[0] = std::min(lo[1] / dmin, lo[1] / dmax);
+      v[1] = std::max(hi[1] / dmin, hi[1] / dmax);
+    } else {
+      u[0] = lo[0];
+      u[1] = hi[0];
+      v[0] = lo[1];
+      v[1] = hi[1];
+    }
+
+    rect[0] = std::max(0, (int) std::floor((u[0] - x0) / dx - 0.5f));
+    rect[1] = std::max(0, (int) std::floor((v[0] - y0) / dy - 0.5f));
+    rect[2] = std::min(width - 1, (int) std::ceil((u[1] - x0) / dx - 0.5f));
+    rect[3] = std::min(height - 1, (int) std::ceil((v[1] - y0) / dy - 0.5f));
+    return rect[0] <= rect[2] && rect[1] <= rect[3];
+  }
+};
+
+struct Fragment {
+  float normal[3];
+  float color[3];
+};
+
+inline bool HitSphere(const float* center, float radius, const float* ro,
+    const float* rd, float tmin, float tmax, float& t)
+{
+  float const oc[3] = {ro[0] - center[0], ro[1] - center[1], ro[2] - center[2]};
+  float const a = Dot3(rd, rd);
+  float const b = Dot3(rd, oc);
+  float const h = b * b - a * (Dot3(oc, oc) - radius * radius);
+  if (h < 0.f)
+    return false;
+  float const sq = std::sqrt(h);
+  for (float root : {(-b - sq) / a, (-b + sq) / a}) {
+    if (root >= tmin && root <= tmax) {
+      t = root;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Cylinder from `v1` along the unit `axis` with length `len`. Round caps
+ * are tested separately as spheres.
+ * @param[out] s Axial position of the hit
+ * @param[out] on_cap True if a flat cap was hit
+ */
+inline bool HitCylinderBody(const float* v1, const float* axis, float len,
+    float radius, bool flat1, bool flat2, const float* ro, const float* rd,
+    float tmin, float tmax, float& t, float& s, bool& on_cap)
+{
+  float const w[3] = {ro[0] - v1[0], ro[1] - v1[1], ro[2] - v1[2]};
+  float const da = Dot3(rd, axis);
+  float const wa = Dot3(w, axis);
+  float const dp[3] = {
+      rd[0] - da * axis[0], rd[1] - da * axis[1], rd[2] - da * axis[2]};
+  float const wp[3] = {
+      w[0] - wa * axis[0], w[1] - wa * axis[1], w[2] - wa * axis[2]};
+  float const a = Dot3(dp, dp);
+  bool hit = false;
+
+  if (a > 1e-12f) {
+    float const b = Dot3(dp, wp);
+    float const h = b * b - a * (Dot3(wp, wp) - radius * radius);
+    if (h >= 0.f) {
+      float const sq = std::sqrt(h);
+      for (float root : {(-b - sq) / a, (-b + sq) / a}) {
+        if (root < tmin || root > tmax)
+          continue;
+        float const y = wa + root * da;
+        if (y >= 0.f && y <= len) {
+          t = tmax = root;
+          s = y;
+          on_cap = false;
+          hit = true;
+          break;
+        }
+      }
+    }
+  }
+
+  if ((flat1 || flat2) && std::fabs(da) > 1e-12f) {
+    for (int end = 0; end < 2; ++end) {
+      if (!(end ? flat2 : flat1))
+        continue;
+      float const y = end ? len : 0.f;
+      float const root = (y - wa) / da;
+      if (root < tmin || root > tmax)
+        continue;
+      float const p[3] = {wp[0] + root * dp[0], wp[1] + root * dp[1],
+          wp[2] + root * dp[2]};
+      if (Dot3(p, p) <= radius * radius) {
+        t = tmax = root;
+        s = y;
+        on_cap = true;
+        hit = true;
+      }
+    }
+  }
+
+  return hit;
+}
+
+/// Moeller-Trumbore, returns barycentric weights of v1 and v2 in u, v
+inline bool HitTriangle(const float* v0, const float* v1, const float* v2,
+    const float* ro, const float* rd, float tmin, float tmax, float& t,
+    float& u, float& v)
+{
+  float e1[3], e2[3], p[3], q[3], s[3];
+  subtract3f(v1, v0, e1);
+  subtract3f(v2, v0, e2);
+  cross_product3f(rd, e2, p);
+  float const det = Dot3(e1, p);
+  if (std::fabs(det) < 1e-12f)
+    return false;
+  float const inv = 1.f / det;
+  subtract3f(ro, v0, s);
+  u = Dot3(s, p) * inv;
+  if (u < 0.f || u > 1.f)
+    return false;
+  cross_product3f(s, e1, q);
+  v = Dot3(rd, q) * inv;
+  if (v < 0.f || u + v > 1.f)
+    return false;
+  float const root = Dot3(e2, q) * inv;
+  if (root < tmin || root > tmax)
+    return false;
+  t = root;
+  return true;
+}
+
+inline void Lerp3(const float* a, const float* b, float f, float* out)
+{
+  out[0] = a[0] + f * (b[0] - a[0]);
+  out[1] = a[1] + f * (b[1] - a[1]);
+  out[2] = a[2] + f * (b[2] - a[2]);
+}
+
+/// Offset the effect of gamma correction on a flat color (see RayRender)
+void GammaCompensate(float gamma, float* rgb)
+{
+  float const inp = (rgb[0] + rgb[1] + rgb[2]) / 3.f;
+  float const sig = (inp < R_SMALL4) ? 1.f : (float) pow(inp, gamma) / inp;
+  for (int i = 0; i < 3; ++i) {
+    rgb[i] = std::min(1.f, rgb[i] * sig);
+  }
+}
+
+inline unsigned int PackColor(
+    const float* rgb, unsigned int alpha, bool big_endian)
+{
+  unsigned int c[3];
+  for (int i = 0; i < 3; ++i) {
+    c[i] = 0xFF & (unsigned int) (std::min(1.f, std::max(0.f, rgb[i])) * 255 +
+                                  0.499f);
+  }
+  if (big_endian)
+    return (c[0] << 24) | (c[1] << 16) | (c[2] << 8) | alpha;
+  return (alpha << 24) | (c[2] << 16) | (c[1] << 8) | c[0];
+}
+
+struct RasterLights {
+  float ambient, direct;
+  float spec_reflect, spec_power, spec_direct, spec_direct_power;
+  float reflect;
+  int n_light;
+  float light[9][3]; //!< direction of the light rays
+  float half[9][3];  //!< half vectors for the specular term
+
+  explicit RasterLights(PyMOLGlobals* G)
+  {
+    ambient = SettingGetGlobal_f(G, cSetting_ambient);
+    direct = SettingGetGlobal_f(G, cSetting_direct);
+    reflect = SettingGetGlobal_f(G, cSetting_reflect) *
+              SceneGetReflectScaleValue(G, 10);
+    SceneGetAdjustedLightValues(
+        G, &spec_reflect, &spec_power, &spec_direct, &spec_direct_power, 10);
+
+    n_light = std::min(10, SettingGetGlobal_i(G, cSetting_light_count)) - 1;
+    n_light = std::max(0, n_light);
+    for (int i = 0; i < n_light; ++i) {
+      copy3f(SettingGetGlobal_3fv(G, light_setting_indices[i]), light[i]);
+      normalize3f(light[i]);
+      half[i][0] = -light[i][0];
+      half[i][1] = -light[i][1];
+      half[i][2] = 1.f - light[i][2];
+      normalize3f(half[i]);
+    }
+  }
+
+  void shade(const Fragment& frag, float* rgb) const
+  {
+    const float* n = frag.normal;
+    float const nv = std::max(0.f, n[2]);
+    float lum = ambient + direct * nv;
+    float spec = 0.f;
+    if (spec_direct > 0.f && nv > 0.f)
+      spec += spec_direct * (float) pow(nv, spec_direct_power);
+    for (int i = 0; i < n_light; ++i) {
+      float const nl = -Dot3(n, light[i]);
+      if (nl <= 0.f)
+        continue;
+      lum += reflect * nl;
+      float const nh = Dot3(n, half[i]);
+      if (spec_reflect > 0.f && nh > 0.f)
+        spec += spec_reflect * (float) pow(nh, spec_power);
+    }
+    for (int i = 0; i < 3; ++i) {
+      rgb[i] = frag.color[i] * lum + spec;
+    }
+  }
+};
+
+} // namespace
+
+/**
+ * Rasterize the primitives of `I` into `image` (I->Width x I->Height,
+ * bottom row first).
+ *
+ * @param antialias Supersampling factor (<0: antialias setting)
+ * @param[out] return_bg Background color, may be NULL
+ */
+void RayRenderRaster(CRay * I, unsigned int *image, int antialias,
+                     unsigned int *return_bg)
+{
+  PyMOLGlobals *G = I->G;
+  double const start = UtilGetSeconds(G);
+  int const width = I->Width, height = I->Height;
+  bool const big_endian = I->BigEndian;
+
+  if(antialias < 0)
+    antialias = SettingGetGlobal_i(G, cSetting_antialias);
+  int const mag = std::max(1, std::min(4, antialias));
+
+  int n_thread = SettingGetGlobal_i(G, cSetting_max_threads);
+  n_thread = std::max(1, std::min(n_thread, PYMOL_MAX_THREADS));
+
+  int ortho = SettingGetGlobal_i(G, cSetting_ray_orthoscopic);
+  if(ortho < 0)
+    ortho = SettingGetGlobal_b(G, cSetting_ortho);
+
+  /* background */
+  int opaque_back = SettingGetGlobal_i(G, cSetting_ray_opaque_background);
+  if(opaque_back < 0)
+    opaque_back = SettingGetGlobal_i(G, cSetting_opaque_background);
+  unsigned int const back_alpha = opaque_back ? 0xFF : 0x00;
+
+  bool const bkrd_is_gradient =
+      opaque_back && SettingGetGlobal_b(G, cSetting_bg_gradient);
+  float bkrd_top[3], bkrd_bottom[3];
+  float const gamma = SettingGetGlobal_f(G, cSetting_gamma);
+  copy3f(ColorGet(G, SettingGet_color(G, nullptr, nullptr,
+             bkrd_is_gradient ? cSetting_bg_rgb_top : cSetting_bg_rgb)),
+      bkrd_top);
+  GammaCompensate(gamma, bkrd_top);
+  if(bkrd_is_gradient) {
+    copy3f(ColorGet(G, SettingGet_color(G, nullptr, nullptr, cSetting_bg_rgb_bottom)),
+        bkrd_bottom);
+    GammaCompensate(gamma, bkrd_bottom);
+  } else {
+    copy3f(bkrd_top, bkrd_bottom);
+  }
+
+  if(return_bg)
+    *return_bg = bkrd_is_gradient ? (big_endian ? back_alpha : back_alpha << 24)
+                                  : PackColor(bkrd_top, back_alpha, big_endian);
+
+  /* depth cue */
+  float fog = SettingGetGlobal_f(G, cSetting_ray_trace_fog);
+  if(fog < 0.0F)
+    fog = SettingGetGlobal_b(G, cSetting_depth_cue) ?
+      SettingGetGlobal_f(G, cSetting_fog) : 0.0F;
+  float fog_start = SettingGetGlobal_f(G, cSetting_ray_trace_fog_start);
+  if(fog_start < 0.0F)
+    fog_start = SettingGetGlobal_f(G, cSetting_fog_start);
+  fog_start = std::min(fog_start, 1.0F - R_SMALL4);
+
+  RasterLights const lights(G);
+
+  /* camera */
+  RasterView view;
+  view.perspective = !ortho;
+  view.width = width * mag;
+  view.height = height * mag;
+  view.front = I->Volume[4];
+  view.back = I->Volume[5];
+  if(view.perspective) {
+    float const height_range = 2.0F * (float) tan((I->Fov / 2.0F) * PI / 180.0F);
+    float const width_range = height_range * (I->Range[0] / I->Range[1]);
+    view.x0 = -width_range / 2.0F;
+    view.y0 = -height_range / 2.0F;
+    view.dx = width_range / view.width;
+    view.dy = height_range / view.height;
+  } else {
+    view.x0 = I->Volume[0];
+    view.y0 = I->Volume[2];
+    view.dx = I->Range[0] / view.width;
+    view.dy = I->Range[1] / view.height;
+  }
+
+  if(I->NPrimitive && !I->Expanded)
+    RayExpandPrimitives(I);
+  RayTransformFirst(I, !ortho, false);
+
+  CBasis *base = I->Basis + 1;
+  int const n_prim = I->NPrimitive;
+
+  /* screen bounds and nearest depth */
+  std::vector<int> rects(4 * n_prim);
+  std::vector<float> nearest(n_prim);
+
+#pragma omp parallel for schedule(static) num_threads(n_thread) if (n_prim > 10000)
+  for(int a = 0; a < n_prim; ++a) {
+    const CPrimitive *prim = I->Primitive + a;
+    const float *vert = base->Vertex + 3 * prim->vert;
+    int *rect = rects.data() + 4 * a;
+    float lo[3], hi[3];
+
+    rect[0] = -1;
+    if(prim->trans >= 1.0F)
+      continue;
+
+    switch (prim->type) {
+    case cPrimSphere:
+    case cPrimEllipsoid:
+      for(int k = 0; k < 3; ++k) {
+        lo[k] = vert[k] - prim->r1;
+        hi[k] = vert[k] + prim->r1;
+      }
+      break;
+    case cPrimSausage:
+    case cPrimCylinder:
+    case cPrimCone: {
+      const float *axis = base->Normal + 3 * base->Vert2Normal[prim->vert];
+      // r2 is only set for cones, and cone3fv keeps the larger radius in r1
+      float const r = prim->r1;
+      for(int k = 0; k < 3; ++k) {
+        float const v2 = vert[k] + axis[k] * prim->l1;
+        lo[k] = std::min(vert[k], v2) - r;
+        hi[k] = std::max(vert[k], v2) + r;
+      }
+    } break;
+    case cPrimTriangle:
+      if(prim->cull)
+        continue;
+      for(int k = 0; k < 3; ++k) {
+        lo[k] = std::min({vert[k], vert[k + 3], vert[k + 6]});
+        hi[k] = std::max({vert[k], vert[k + 3], vert[k + 6]});
+      }
+      break;
+    default:
+      continue;
+    }
+
+    if(!view.bounds(lo, hi, rect))
+      rect[0] = -1;
+    nearest[a] = -hi[2];
+  }
+
+  /* binning, front to back so that hidden pixels are rejected by depth
+     before intersecting */
+  std::vector<int> order;
+  order.reserve(n_prim);
+  for(int a = 0; a < n_prim; ++a) {
+    if(rects[4 * a] >= 0)
+      order.push_back(a);
+  }
+  std::sort(order.begin(), order.end(),
+      [&nearest](int a, int b) { return nearest[a] < nearest[b]; });
+
+  int const tile = TileSize * mag;
+  int const tiles_x = (view.width + tile - 1) / tile;
+  int const tiles_y = (view.height + tile - 1) / tile;
+  std::vector<std::vector<int>> bins(tiles_x * tiles_y);
+
+  for(int a : order) {
+    const int *rect = rects.data() + 4 * a;
+    for(int ty = rect[1] / tile; ty <= rect[3] / tile; ++ty) {
+      for(int tx = rect[0] / tile; tx <= rect[2] / tile; ++tx) {
+        bins[tx + ty * tiles_x].push_back(a);
+      }
+    }
+  }
+
+  /* tiles */
+#pragma omp parallel for schedule(dynamic) num_threads(n_thread)
+  for(int t = 0; t < tiles_x * tiles_y; ++t) {
+    int const tx0 = (t % tiles_x) * tile;
+    int const ty0 = (t / tiles_x) * tile;
+    int const tw = std::min(tile, view.width - tx0);
+    int const th = std::min(tile, view.height - ty0);
+
+    std::vector<float> depth(tw * th, view.back);
+    std::vector<int> owner(tw * th, -1);
+    std::vector<Fragment> frags(tw * th);
+
+    for(int a : bins[t]) {
+      const CPrimitive *prim = I->Primitive + a;
+      const float *vert = base->Vertex + 3 * prim->vert;
+      const int *rect = rects.data() + 4 * a;
+      int const x0 = std::max(rect[0], tx0), x1 = std::min(rect[2], tx0 + tw - 1);
+      int const y0 = std::max(rect[1], ty0), y1 = std::min(rect[3], ty0 + th - 1);
+
+      for(int y = y0; y <= y1; ++y) {
+        for(int x = x0; x <= x1; ++x) {
+          int const i = (x - tx0) + (y - ty0) * tw;
+          if(depth[i] <= nearest[a])
+            continue;
+          float ro[3], rd[3], hit_t, p[3];
+          Fragment frag;
+          view.ray(x, y, ro, rd);
+
+          switch (prim->type) {
+          case cPrimSphere:
+          case cPrimEllipsoid: /* drawn as spheres */
+            if(!HitSphere(vert, prim->r1, ro, rd, view.front, depth[i], hit_t))
+              continue;
+            for(int k = 0; k < 3; ++k) {
+              p[k] = ro[k] + hit_t * rd[k];
+              frag.normal[k] = (p[k] - vert[k]) / prim->r1;
+            }
+            copy3f(prim->c1, frag.color);
+            break;
+          case cPrimSausage:
+          case cPrimCylinder:
+          case cPrimCone: { /* cones are drawn as cylinders */
+            const float *axis = base->Normal + 3 * base->Vert2Normal[prim->vert];
+            float const len = prim->l1;
+            float const r = prim->r1;
+            bool const round1 = prim->type == cPrimSausage || prim->cap1 == cCylCap::Round;
+            bool const round2 = prim->type == cPrimSausage || prim->cap2 == cCylCap::Round;
+            bool const flat1 = prim->type != cPrimSausage && prim->cap1 == cCylCap::Flat;
+            bool const flat2 = prim->type != cPrimSausage && prim->cap2 == cCylCap::Flat;
+            float tmax = depth[i];
+            float s = 0.0F;
+            bool flat_cap = false, hit = false;
+
+            if(HitCylinderBody(vert, axis, len, r, flat1, flat2, ro, rd,
+                   view.front, tmax, hit_t, s, flat_cap)) {
+              tmax = hit_t;
+              hit = true;
+            }
+            float v2[3];
+            scale3f(axis, len, v2);
+            add3f(vert, v2, v2);
+            if(round1 && HitSphere(vert, r, ro, rd, view.front, tmax, hit_t)) {
+              tmax = hit_t;
+              s = 0.0F;
+              flat_cap = false;
+              hit = true;
+            }
+            if(round2 && HitSphere(v2, r, ro, rd, view.front, tmax, hit_t)) {
+              tmax = hit_t;
+              s = len;
+              flat_cap = false;
+              hit = true;
+            }
+            if(!hit)
+              continue;
+            hit_t = tmax;
+
+            float c[3];
+            for(int k = 0; k < 3; ++k) {
+              p[k] = ro[k] + hit_t * rd[k];
+              c[k] = vert[k] + s * axis[k];
+              frag.normal[k] = p[k] - c[k];
+            }
+            if(flat_cap) {
+              copy3f(axis, frag.normal);
+            }
+            normalize3f(frag.normal);
+            Lerp3(prim->c1, prim->c2, len > 0.0F ? s / len : 0.0F, frag.color);
+          } break;
+          case cPrimTriangle: {
+            float u, v;
+            if(!HitTriangle(vert, vert + 3, vert + 6, ro, rd, view.front,
+                   depth[i], hit_t, u, v))
+              continue;
+            const float *n = base->Normal + 3 * (base->Vert2Normal[prim->vert] + 1);
+            float const w = 1.0F - u - v;
+            for(int k = 0; k < 3; ++k) {
+              frag.normal[k] = w * n[k] + u * n[k + 3] + v * n[k + 6];
+              frag.color[k] = w * prim->c1[k] + u * prim->c2[k] + v * prim->c3[k];
+            }
+            normalize3f(frag.normal);
+          } break;
+          default:
+            continue;
+          }
+
+          /* two sided lighting */
+          if(Dot3(frag.normal, rd) > 0.0F)
+            invert3f(frag.normal);
+
+          depth[i] = hit_t;
+          owner[i] = a;
+          frags[i] = frag;
+        }
+      }
+    }
+
+    /* shade and downsample into the output image */
+    float const inv_samples = 1.0F / (mag * mag);
+    float const inv_range = 1.0F / (view.back - view.front);
+    for(int y = 0; y < th; y += mag) {
+      for(int x = 0; x < tw; x += mag) {
+        float sum[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+        for(int sy = y; sy < y + mag; ++sy) {
+          float bkrd[3];
+          Lerp3(bkrd_bottom, bkrd_top,
+              (ty0 + sy) / (float) std::max(1, view.height - 1), bkrd);
+          for(int sx = x; sx < x + mag; ++sx) {
+            int const i = sx + sy * tw;
+            float rgb[3];
+            float alpha;
+            if(owner[i] < 0) {
+              copy3f(bkrd, rgb);
+              alpha = back_alpha / 255.0F;
+            } else {
+              lights.shade(frags[i], rgb);
+              if(fog != 0.0F) {
+                float f = ((depth[i] - view.front) * inv_range - fog_start) /
+                          (1.0F - fog_start);
+                f = fog * std::max(0.0F, std::min(1.0F, f));
+                Lerp3(rgb, bkrd, f, rgb);
+              }
+              alpha = 1.0F;
+            }
+            sum[0] += rgb[0];
+            sum[1] += rgb[1];
+            sum[2] += rgb[2];
+            sum[3] += alpha;
+          }
+        }
+        scale3f(sum, inv_samples, sum);
+        unsigned int const alpha = 0xFF & (unsigned int) (sum[3] * inv_samples * 255 + 0.499F);
+        image[(tx0 + x) / mag + ((ty0 + y) / mag) * width] =
+            PackColor(sum, alpha, big_endian);
+      }
+    }
+  }
+
+  PRINTFB(G, FB_Ray, FB_Blather)
+    " RayRenderRaster: %d primitives, %dx%d pixels, %4.3f sec.\n", n_prim,
+    width, height, UtilGetSeconds(G) - start ENDFB(G);
+}
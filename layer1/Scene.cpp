@@ -390,13 +390,23 @@ void SceneInvalidateCopy(PyMOLGlobals * G, int free_buffer)
   }
 }
 
-void SceneInvalidate(PyMOLGlobals * G)
+/**
+ * Like SceneInvalidate, for changes of the view only (doesn't count as a
+ * content change for the ray primitive cache)
+ */
+static void SceneInvalidateView(PyMOLGlobals * G)
 {
   SceneInvalidateCopy(G, false);
   SceneDirty(G);
   PyMOL_NeedRedisplay(G->PyMOL);
 }
 
+void SceneInvalidate(PyMOLGlobals * G)
+{
+  ++G->Scene->ChangeCount;
+  SceneInvalidateView(G);
+}
+
 void SceneLoadAnimation(PyMOLGlobals * G, double duration, int hand)
 {
   if(G->HaveGUI) {
@@ -1318,7 +1328,7 @@ static void SceneClipSetWithDirty(PyMOLGlobals * G, float front, float back, int
   UpdateFrontBackSafe(I);
 
   if(dirty)
-    SceneInvalidate(G);
+    SceneInvalidateView(G);
   else
     SceneInvalidateCopy(G, false);
 }
@@ -2060,7 +2070,11 @@ bool ScenePNG(PyMOLGlobals* G, pymol::zstring_view png, float dpi, int quiet,
       dpi = SettingGetGlobal_f(G, cSetting_image_dots_per_inch);
     auto screen_gamma = SettingGetGlobal_f(G, cSetting_png_screen_gamma);
     auto file_gamma = SettingGetGlobal_f(G, cSetting_png_file_gamma);
-    if(MyPNGWrite(png, *saveImage, dpi, format, quiet, screen_gamma, file_gamma, outbuf)) {
+    MyPNGEncoding encoding;
+    encoding.fast = SettingGet<bool>(G, cSetting_png_fast);
+    encoding.n_threads = SettingGet<int>(G, cSetting_max_threads);
+    if(MyPNGWrite(png, *saveImage, dpi, format, quiet, screen_gamma, file_gamma,
+          outbuf, encoding)) {
       if(!quiet) {
         PRINTFB(G, FB_Scene, FB_Actions)
           " %s: wrote %dx%d pixel image to file \"%s\".\n", __func__,
@@ -2272,6 +2286,7 @@ void SceneChanged(PyMOLGlobals * G)
 {
   CScene *I = G->Scene;
   I->ChangedFlag = true;
+  ++I->ChangeCount;
   SceneInvalidateCopy(G, false);
   SceneDirty(G);
   SeqChanged(G);
@@ -2301,10 +2316,15 @@ int SceneValidateImageMode(PyMOLGlobals * G, int mode, bool defaultdraw) {
       " %s-Warning: invalid mode %d\n", __FUNCTION__, mode ENDFB(G);
   }
 
-  if(!G->HaveGUI || SettingGetGlobal_b(G, cSetting_ray_trace_frames)) {
+  if(SettingGetGlobal_b(G, cSetting_ray_trace_frames)) {
     return cSceneImage_Ray;
   }
 
+  if(!G->HaveGUI) {
+    return SettingGetGlobal_b(G, cSetting_headless_draw) ? cSceneImage_Draw
+                                                         : cSceneImage_Ray;
+  }
+
   if(defaultdraw || SettingGetGlobal_b(G, cSetting_draw_frames)) {
     return cSceneImage_Draw;
   }
@@ -2341,6 +2361,12 @@ int SceneMakeMovieImage(PyMOLGlobals * G,
              nullptr, nullptr, 0.0F, 0.0F, false, nullptr, show_timing, -1);
     break;
   case cSceneImage_Draw:
+    if(!(G->HaveGUI && G->ValidContext)) {
+      /* no OpenGL, use the software rasterizer */
+      SceneRay(G, width, height, cSceneRay_MODE_RASTER, nullptr, nullptr, 0.0F,
+          0.0F, false, nullptr, show_timing, -1);
+      break;
+    }
     SceneMakeSizedImage(G, requestedExtent,
         SettingGet<int>(G, cSetting_antialias), /*excludeSelections*/ false);
     break;
@@ -2631,7 +2657,7 @@ void SceneOriginSet(PyMOLGlobals * G, const float *origin, int preserve)
     I->m_view.translate(v1);  /* offset view to compensate */
   }
   I->m_view.setOrigin(origin[0], origin[1], origin[2]); /* move origin */
-  SceneInvalidate(G);
+  SceneInvalidateView(G);
 }
 
 
@@ -4602,41 +4628,46 @@ int SceneRovingCheckDirty(PyMOLGlobals * G)
   return (I->RovingDirtyFlag);
 }
 
-struct CObjectUpdateThreadInfo {
-  pymol::CObject *obj;
-};
-
-void SceneObjectUpdateThread(CObjectUpdateThreadInfo * T)
+#ifndef _PYMOL_NOPY
+/**
+ * Updates all objects on up to `n_thread` threads. Molecular objects are
+ * split into one task per state, so that a single large trajectory and many
+ * small objects both keep all threads busy.
+ */
+static void SceneUpdateObjectsParallel(PyMOLGlobals* G,
+    const std::list<pymol::CObject*>& objects, int n_thread)
 {
-  if(T->obj) {
-    T->obj->update();
-  }
-}
+  struct UpdateTask {
+    pymol::CObject* obj;
+    int state; //!< -1 for the whole (non-molecular) object
+  };
 
-#ifndef _PYMOL_NOPY
-static void SceneObjectUpdateSpawn(PyMOLGlobals * G, CObjectUpdateThreadInfo * Thread,
-                                   int n_thread, int n_total)
-{
-  if(n_total == 1) {
-    SceneObjectUpdateThread(Thread);
-  } else if(n_total) {
-    int blocked;
-    PyObject *info_list;
-    int a, n = 0;
-    blocked = PAutoBlock(G);
-
-    PRINTFB(G, FB_Scene, FB_Blather)
-      " Scene: updating objects with %d threads...\n", n_thread ENDFB(G);
-    info_list = PyList_New(n_total);
-    for(a = 0; a < n_total; a++) {
-      PyList_SetItem(info_list, a, PyCapsule_New(Thread + a, nullptr, nullptr));
-      n++;
-    }
-    PXDecRef(PYOBJECT_CALLMETHOD
-             (G->P_inst->cmd, "_object_update_spawn", "Oi", info_list, n_thread));
-    Py_DECREF(info_list);
-    PAutoUnblock(G, blocked);
+  std::vector<UpdateTask> tasks;
+
+  for (auto* obj : objects) {
+    if (obj->type == cObjectMolecule) {
+      auto* objmol = static_cast<ObjectMolecule*>(obj);
+      OrthoBusyPrime(G);
+      for (int state : objmol->getStatesToUpdate()) {
+        tasks.push_back({obj, state});
+      }
+    } else {
+      tasks.push_back({obj, -1});
+    }
   }
+
+  PRINTFB(G, FB_Scene, FB_Blather)
+    " Scene: updating %d objects (%d tasks) with %d threads...\n",
+    int(objects.size()), int(tasks.size()), n_thread ENDFB(G);
+
+  PRunParallel(G, n_thread, tasks.size(), [&](size_t i) {
+    auto const& task = tasks[i];
+    if (task.state < 0) {
+      task.obj->update();
+    } else {
+      static_cast<ObjectMolecule*>(task.obj)->CSet[task.state]->update(task.state);
+    }
+  });
 }
 #endif
 
@@ -4701,59 +4732,9 @@ void SceneUpdate(PyMOLGlobals * G, int force)
 #ifndef _PYMOL_NOPY
         int n_thread = SettingGetGlobal_i(G, cSetting_max_threads);
         int multithread = SettingGetGlobal_i(G, cSetting_async_builds);
-        if(multithread && (n_thread > 1)) {
-          int min_start = -1;
-          int max_stop = -1;
-          int n_obj = 0;
-          for (auto& obj : I->Obj) {
-            int start = 0;
-            n_obj++;
-            int stop = obj->getNFrame();
-	    /* set start/stop to define the range for this object
-	     * depending upon various build settings */
-            ObjectAdjustStateRebuildRange(obj, &start, &stop);
-            if(min_start < 0) {
-              min_start = start;
-              max_stop = stop;
-            } else {
-              if(min_start > start)
-                min_start = start;
-              if(max_stop < stop)
-                max_stop = stop;
-            }
-          }
-
-          int n_frame = max_stop - min_start;
-
-          if(n_frame > n_thread) {
-            n_thread = 1;
-            /* prevent n_thread * n_thread -- only multithread within
-               individual object states (typically more balanced) */
-          } else if(n_frame > 1) {
-            n_thread = n_thread / n_frame;
-          }
-
-          if(n_thread < 1)
-            n_thread = 1;
-        }
-
-	/* Note: we might want to optimize this by doing multi-threaded updates
-	   for all objects. */
         if(multithread && (n_thread > 1)) {
           /* multi-threaded geometry update */
-          int cnt = I->NonGadgetObjs.size();
-
-          if(cnt) {
-            CObjectUpdateThreadInfo *thread_info = pymol::malloc<CObjectUpdateThreadInfo>(cnt);
-            if(thread_info) {
-              cnt = 0;
-              for (auto& NonGadgetObj : I->NonGadgetObjs) {
-                thread_info[cnt++].obj = NonGadgetObj;
-              }
-              SceneObjectUpdateSpawn(G, thread_info, n_thread, cnt);
-              FreeP(thread_info);
-            }
-          }
+          SceneUpdateObjectsParallel(G, I->NonGadgetObjs, n_thread);
         } else
 #endif
           /* single-threaded update */
@@ -5339,7 +5320,7 @@ void SceneRotate(
   I->m_view.setRotMatrix(glm::make_mat4(temp));
   SceneUpdateInvMatrix(G);
   if(dirty) {
-    SceneInvalidate(G);
+    SceneInvalidateView(G);
   }
 }
 
@@ -5381,7 +5362,7 @@ void SceneScale(PyMOLGlobals * G, float scale)
 {
   CScene *I = G->Scene;
   I->Scale *= scale;
-  SceneInvalidate(G);
+  SceneInvalidateView(G);
 }
 
 void SceneZoom(PyMOLGlobals * G, float scale){
@@ -5392,7 +5373,7 @@ void SceneZoom(PyMOLGlobals * G, float scale){
   I->m_view.m_clip().m_front -= factor;
   I->m_view.m_clip().m_back -= factor;
   UpdateFrontBackSafe(I);
-  SceneInvalidate(G);
+  SceneInvalidateView(G);
 }
 
 int SceneGetTwoSidedLighting(PyMOLGlobals * G){
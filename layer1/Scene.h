@@ -37,6 +37,7 @@ Z* -------------------------------------------------------------------
 
 // TODO: define remaining cSceneRay_MODEs (VRML, COLLADA, etc.)
 #define cSceneRay_MODE_IDTF 7
+#define cSceneRay_MODE_RASTER 9 // software rasterizer, see RayRenderRaster
 
 #define cSceneImage_Default -1
 #define cSceneImage_Normal 0
@@ -220,7 +221,6 @@ void SceneGetAdjustedLightValues(PyMOLGlobals * G,
     int limit = 8);
 
 void SceneAbortAnimation(PyMOLGlobals * G);
-void SceneObjectUpdateThread(CObjectUpdateThreadInfo * T);
 int SceneCaptureWindow(PyMOLGlobals * G);
 
 void SceneZoom(PyMOLGlobals * G, float scale);
@@ -38,6 +38,9 @@ Z* -------------------------------------------------------------------
 #define TRN_BKG 0x30
 #define MAX_ANI_ELEM 300
 
+struct SceneRayCache;
+struct ScenePickIndex;
+
 namespace pymol
 {
   struct CObject;
@@ -100,6 +103,7 @@ class CScene : public Block {
   double SweepTime{};
   bool DirtyFlag{true};
   bool ChangedFlag{};
+  unsigned ChangeCount{}; /* SceneChanged and SceneInvalidate, not view changes */
   int CopyType{};
   bool CopyNextFlag{true}, CopyForced{};
   int NFrame { 0 };
@@ -173,6 +177,8 @@ class CScene : public Block {
   int vp_times{}, vp_stereo_mode{};
   float vp_width_scale{};
   PickColorManager pickmgr;
+  std::shared_ptr<SceneRayCache> RayCache; // see SceneRayBuild
+  std::shared_ptr<ScenePickIndex> PickIndex; // see ScenePickCPU
 
   CScene(PyMOLGlobals * G) : Block(G), m_ScrollBar(G, false) {}
 
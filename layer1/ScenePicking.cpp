@@ -11,9 +11,35 @@
 #include "Err.h"
 #include "Picking.h"
 #include "Feedback.h"
+#include "CapsuleBVH.h"
+#include "ObjectMolecule.h"
+#include "CoordSet.h"
+#include "Matrix.h"
+#include "Vector.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <set>
 
 #define cRange 7
 
+/**
+ * True if picking should use the CPU pick index instead of rendering pick
+ * colors with OpenGL, see `pick_cpu`
+ */
+static bool ScenePickUsesCPU(PyMOLGlobals * G)
+{
+  switch (SettingGet<int>(G, cSetting_pick_cpu)) {
+  case 0:
+    return false;
+  case 1:
+    return !(G->HaveGUI && G->ValidContext);
+  default:
+    return true;
+  }
+}
+
 int SceneDoXYPick(PyMOLGlobals * G, int x, int y, ClickSide click_side)
 {
   CScene *I = G->Scene;
@@ -21,6 +47,11 @@ int SceneDoXYPick(PyMOLGlobals * G, int x, int y, ClickSide click_side)
 
   if(defer_builds_mode == 5)    /* force generation of a pickable version */
     SceneUpdate(G, true);
+
+  if (ScenePickUsesCPU(G)) {
+    return ScenePickCPU(G, x, y, &I->LastPicked);
+  }
+
   if (OrthoGetOverlayStatus(G) || SettingGet<int>(G, cSetting_text)) {
     SceneRenderInfo renderInfo{};
     SceneRender(G, renderInfo);       /* remove overlay if present */
@@ -337,6 +368,11 @@ int SceneMultipick(PyMOLGlobals * G, Multipick * smp)
   if(defer_builds_mode == 5)    /* force generation of a pickable version */
     SceneUpdate(G, true);
 
+  if (ScenePickUsesCPU(G)) {
+    SceneMultipickCPU(G, smp);
+    return (1);
+  }
+
   if (OrthoGetOverlayStatus(G) || SettingGet<int>(G, cSetting_text)) {
     SceneRenderInfo renderInfo{};
     SceneRender(G, renderInfo);       /* remove overlay if present */
@@ -358,3 +394,402 @@ int SceneMultipick(PyMOLGlobals * G, Multipick * smp)
   SceneDirty(G);
   return (1);
 }
+
+/*========================================================================*/
+/*
+ * CPU picking: ray casting against a bounding volume hierarchy of atom
+ * spheres and half bond cylinders. Works without an OpenGL context (headless
+ * and remote sessions) and doesn't need a render pass per pick.
+ */
+
+/**
+ * World space pick primitives of all molecular objects in the scene. The
+ * index only depends on the scene content, camera changes just transform
+ * the pick rays.
+ */
+struct ScenePickIndex {
+  struct ObjectKey {
+    const pymol::CObject* obj;
+    int state;
+    int ttt_flag;
+    float ttt[16];
+
+    bool operator==(const ObjectKey& other) const
+    {
+      return obj == other.obj && state == other.state &&
+             ttt_flag == other.ttt_flag &&
+             std::equal(ttt, ttt + 16, other.ttt);
+    }
+  };
+
+  /// Atom center, for rectangle picks
+  struct Atom {
+    Picking pick;
+    float v[3];
+  };
+
+  unsigned change_count{};
+  std::vector<ObjectKey> objects;
+
+  CapsuleBVH bvh;
+  std::vector<Picking> picks; //!< one per capsule
+  std::vector<Atom> atoms;
+};
+
+/**
+ * Add the spheres, nonbonded atoms, sticks and lines of one object state.
+ * Line widths are in pixels, those primitives are padded at query time.
+ */
+static void ScenePickIndexAddState(PyMOLGlobals * G, ObjectMolecule * obj,
+    int state, std::vector<CapsuleBVH::Capsule>& capsules,
+    ScenePickIndex& index)
+{
+  const CoordSet* cs = obj->getCoordSet(state);
+  if (!cs)
+    return;
+
+  const CSetting* set1 = cs->Setting.get();
+  const CSetting* set2 = obj->Setting.get();
+  bool const pickable = SettingGet<bool>(G, set1, set2, cSetting_pickable);
+  float const sphere_scale = SettingGet<float>(G, set1, set2, cSetting_sphere_scale);
+  float const nb_spheres_size = SettingGet<float>(G, set1, set2, cSetting_nb_spheres_size);
+  float const nonbonded_size = SettingGet<float>(G, set1, set2, cSetting_nonbonded_size);
+  float const stick_radius = SettingGet<float>(G, set1, set2, cSetting_stick_radius);
+
+  double matrix[16];
+  bool const has_matrix = ObjectGetTotalMatrix(obj, state, false, matrix);
+
+  int const n_index = cs->getNIndex();
+  std::vector<float> coords(3 * n_index);
+  for (int idx = 0; idx < n_index; ++idx) {
+    float* v = coords.data() + 3 * idx;
+    copy3f(cs->coordPtr(idx), v);
+    if (has_matrix)
+      transform44d3f(matrix, v, v);
+  }
+
+  std::vector<bool> has_primitive(n_index);
+
+  auto add = [&](int idx, int bond, const float* v1, const float* v2,
+                 float radius, bool padded) {
+    int const atm = cs->IdxToAtm[idx];
+    const AtomInfoType* ai = obj->AtomInfo + atm;
+
+    capsules.push_back({{v1[0], v1[1], v1[2]}, {v2[0], v2[1], v2[2]}, radius,
+        padded});
+
+    Picking pick;
+    pick.src.index = atm;
+    pick.src.bond = (pickable && !ai->masked) ? bond : cPickableNoPick;
+    pick.context.object = obj;
+    pick.context.state = state;
+    index.picks.push_back(pick);
+
+    has_primitive[idx] = true;
+  };
+
+  for (int idx = 0; idx < n_index; ++idx) {
+    const AtomInfoType* ai = obj->AtomInfo + cs->IdxToAtm[idx];
+    const float* v = coords.data() + 3 * idx;
+
+    if (ai->visRep & cRepSphereBit) {
+      float const scale = AtomSettingGetWD(G, ai, cSetting_sphere_scale, sphere_scale);
+      add(idx, cPickableAtom, v, v, ai->vdw * scale, false);
+    } else if (!ai->bonded) {
+      if (ai->visRep & cRepNonbondedSphereBit) {
+        add(idx, cPickableAtom, v, v, nb_spheres_size, false);
+      } else if (ai->visRep & cRepNonbondedBit) {
+        add(idx, cPickableAtom, v, v, nonbonded_size, true);
+      }
+    }
+  }
+
+  // half bonds, like the pick colors of RepCylBond and RepWireBond
+  for (int b = 0; b < obj->NBond; ++b) {
+    const BondType* bd = obj->Bond + b;
+    if (bd->hasSymOp())
+      continue;
+
+    int const idx[2] = {cs->atmToIdx(bd->index[0]), cs->atmToIdx(bd->index[1])};
+    if (idx[0] < 0 || idx[1] < 0)
+      continue;
+
+    const float* v[2] = {coords.data() + 3 * idx[0], coords.data() + 3 * idx[1]};
+    float mid[3];
+    average3f(v[0], v[1], mid);
+
+    for (int i = 0; i < 2; ++i) {
+      int const visRep = obj->AtomInfo[bd->index[i]].visRep;
+      if (visRep & cRepCylBit) {
+        add(idx[i], b, v[i], mid, stick_radius, false);
+      } else if (visRep & cRepLineBit) {
+        add(idx[i], b, v[i], mid, 0.f, true);
+      }
+    }
+  }
+
+  for (int idx = 0; idx < n_index; ++idx) {
+    if (!has_primitive[idx])
+      continue;
+    int const atm = cs->IdxToAtm[idx];
+    if (!pickable || obj->AtomInfo[atm].masked)
+      continue;
+
+    ScenePickIndex::Atom atom;
+    atom.pick.src.index = atm;
+    atom.pick.src.bond = cPickableAtom;
+    atom.pick.context.object = obj;
+    atom.pick.context.state = state;
+    copy3f(coords.data() + 3 * idx, atom.v);
+    index.atoms.push_back(atom);
+  }
+}
+
+/**
+ * Get the pick index of the current scene content, rebuilds it if anything
+ * but the camera has changed
+ */
+static const ScenePickIndex& ScenePickIndexGet(PyMOLGlobals * G)
+{
+  CScene *I = G->Scene;
+  auto index = std::make_shared<ScenePickIndex>();
+
+  index->change_count = I->ChangeCount;
+  for (auto* obj : I->Obj) {
+    if (obj->type != cObjectMolecule)
+      continue;
+    index->objects.emplace_back();
+    auto& item = index->objects.back();
+    item.obj = obj;
+    item.state = ObjectGetCurrentState(obj, false);
+    item.ttt_flag = obj->TTTFlag;
+    std::copy_n(obj->TTT, 16, item.ttt);
+  }
+
+  if (I->PickIndex && I->PickIndex->change_count == index->change_count &&
+      I->PickIndex->objects == index->objects) {
+    return *I->PickIndex;
+  }
+
+  std::vector<CapsuleBVH::Capsule> capsules;
+  for (auto const& item : index->objects) {
+    auto* obj = static_cast<ObjectMolecule*>(const_cast<pymol::CObject*>(item.obj));
+    if (item.state < 0) {
+      for (int state = 0; state < obj->NCSet; ++state) {
+        ScenePickIndexAddState(G, obj, state, capsules, *index);
+      }
+    } else {
+      ScenePickIndexAddState(G, obj, item.state, capsules, *index);
+    }
+  }
+  index->bvh = CapsuleBVH(std::move(capsules));
+
+  PRINTFD(G, FB_Scene)
+    " %s: %zu primitives, %zu atoms\n", __func__, index->bvh.size(),
+    index->atoms.size() ENDFD;
+
+  I->PickIndex = std::move(index);
+  return *I->PickIndex;
+}
+
+/**
+ * Camera of the current (mono) view, maps scene pixels to world space rays.
+ * Pick rays have unit length along the view axis, so the ray parameter is
+ * the camera space depth.
+ */
+struct ScenePickCamera {
+  const float* rot;
+  float pos[3];
+  float origin[3];
+  float scale; //!< world units per pixel at depth 1 (perspective) or any depth (ortho)
+  float front, back;
+  float width, height;
+  bool ortho;
+  float pad; //!< radius of pixel wide primitives (lines)
+
+  explicit ScenePickCamera(PyMOLGlobals * G)
+  {
+    CScene *I = G->Scene;
+    rot = glm::value_ptr(I->m_view.rotMatrix());
+    auto const& p = I->m_view.pos();
+    auto const& o = I->m_view.origin();
+    set3f(pos, p.x, p.y, p.z);
+    set3f(origin, o.x, o.y, o.z);
+    width = I->Width;
+    height = I->Height;
+    front = I->m_view.m_clipSafe().m_front;
+    back = I->m_view.m_clipSafe().m_back;
+    ortho = SettingGet<bool>(G, cSetting_ortho);
+    scale = GetFovWidth(G) / std::max(1, I->Height);
+    if (ortho)
+      scale *= -pos[2];
+    float const line_width = SettingGet<float>(G, cSetting_line_width);
+    pad = 0.5f * std::max(1.f, line_width) * scale * (ortho ? 1.f : -pos[2]);
+  }
+
+  /// Ray through scene pixel coordinates (x, y)
+  void ray(float x, float y, float* ray_origin, float* ray_dir) const
+  {
+    float const sx = (x - 0.5f * width) * scale;
+    float const sy = (y - 0.5f * height) * scale;
+    float cam_origin[3] = {0.f, 0.f, 0.f};
+    float cam_dir[3] = {0.f, 0.f, -1.f};
+    if (ortho) {
+      cam_origin[0] = sx;
+      cam_origin[1] = sy;
+    } else {
+      cam_dir[0] = sx;
+      cam_dir[1] = sy;
+    }
+    subtract3f(cam_origin, pos, cam_origin);
+    MatrixInvTransformC44fAs33f3f(rot, cam_origin, ray_origin);
+    add3f(origin, ray_origin, ray_origin);
+    MatrixInvTransformC44fAs33f3f(rot, cam_dir, ray_dir);
+  }
+
+  /// Scene pixel coordinates of `v`, false if `v` is clipped
+  bool project(const float* v, float& x, float& y) const
+  {
+    float rel[3], cam[3];
+    subtract3f(v, origin, rel);
+    MatrixTransformC44fAs33f3f(rot, rel, cam);
+    add3f(pos, cam, cam);
+    float const depth = -cam[2];
+    if (depth < front || depth > back)
+      return false;
+    float const s = ortho ? scale : depth * scale;
+    x = cam[0] / s + 0.5f * width;
+    y = cam[1] / s + 0.5f * height;
+    return true;
+  }
+
+  bool cast(const ScenePickIndex& index, float x, float y,
+      CapsuleBVH::Hit& hit) const
+  {
+    float ray_origin[3], ray_dir[3];
+    ray(x, y, ray_origin, ray_dir);
+    return index.bvh.intersect(ray_origin, ray_dir, front, back, pad, hit);
+  }
+};
+
+/**
+ * Pick a single point without OpenGL. Like the framebuffer pick, searches
+ * outwards in square rings of pixels around (x, y) for the nearest hit.
+ *
+ * @param x X position in the window to pick
+ * @param y Y position in the window to pick
+ * @param[out] pick Picking result
+ * @return True if something was picked
+ */
+bool ScenePickCPU(PyMOLGlobals * G, int x, int y, Picking * pick)
+{
+  CScene *I = G->Scene;
+  auto const& index = ScenePickIndexGet(G);
+  ScenePickCamera const camera(G);
+  int const range = DIP2PIXEL(cRange);
+
+  float const px = x - I->rect.left + 0.5f;
+  float const py = y - I->rect.bottom + 0.5f;
+
+  pick->context.object = nullptr;
+
+  CapsuleBVH::Hit hit;
+  for (int d = 0; d < range; ++d) {
+    for (int a = -d; a <= d; ++a) {
+      for (int b = -d; b <= d; ++b) {
+        // inner pixels were searched with smaller d
+        if (abs(a) != d && abs(b) != d)
+          continue;
+        if (camera.cast(index, px + a, py + b, hit)) {
+          *pick = index.picks[hit.id];
+          if (pick->src.bond == cPickableNoPick)
+            pick->context.object = nullptr;
+          return pick->context.object != nullptr;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Pick all atoms in a rectangle without OpenGL. An atom is picked if its
+ * center projects into the rectangle and isn't hidden by anything in front
+ * of it.
+ *
+ * @param[in,out] smp Defines the (x,y,w,h) rectangle (input), and takes the
+ * picking result in `smp->picked` (output)
+ */
+void SceneMultipickCPU(PyMOLGlobals * G, Multipick * smp)
+{
+  CScene *I = G->Scene;
+  auto const& index = ScenePickIndexGet(G);
+  ScenePickCamera const camera(G);
+
+  float const x0 = smp->x - I->rect.left;
+  float const y0 = smp->y - I->rect.bottom;
+  float const x1 = x0 + std::max(1, smp->w);
+  float const y1 = y0 + std::max(1, smp->h);
+
+  // all-states objects have one entry per state and atom
+  std::set<std::pair<const pymol::CObject*, int>> picked;
+
+  CapsuleBVH::Hit hit;
+  for (auto const& atom : index.atoms) {
+    float px, py;
+    if (!camera.project(atom.v, px, py) || px < x0 || px >= x1 || py < y0 ||
+        py >= y1)
+      continue;
+
+    if (!camera.cast(index, px, py, hit))
+      continue;
+
+    auto const& front = index.picks[hit.id];
+    if (front.context == atom.pick.context &&
+        front.src.index == atom.pick.src.index &&
+        front.src.bond != cPickableNoPick &&
+        picked.emplace(atom.pick.context.object, atom.pick.src.index).second) {
+      smp->picked.push_back(atom.pick);
+    }
+  }
+}
+
+/**
+ * Pick the atoms at a window position, or in a rectangle. Goes through
+ * SceneDoXYPick and SceneMultipick, so it uses the CPU pick index in
+ * headless sessions (see `pick_cpu`).
+ *
+ * @param x X position in the window (lower left corner of the rectangle)
+ * @param y Y position in the window (lower left corner of the rectangle)
+ * @param width Rectangle width, a point pick if width and height are <= 1
+ * @param height Rectangle height
+ * @return Picked atoms of molecular objects
+ */
+std::vector<Picking> ScenePickAtoms(
+    PyMOLGlobals * G, int x, int y, int width, int height)
+{
+  std::vector<Picking> picked;
+
+  if (width > 1 || height > 1) {
+    Multipick smp;
+    smp.x = x;
+    smp.y = y;
+    smp.w = width;
+    smp.h = height;
+    SceneMultipick(G, &smp);
+    picked = std::move(smp.picked);
+  } else if (SceneDoXYPick(G, x, y, ClickSide::None)) {
+    picked.push_back(G->Scene->LastPicked);
+  }
+
+  picked.erase(std::remove_if(picked.begin(), picked.end(),
+                   [](const Picking& pick) {
+                     return !pick.context.object ||
+                            pick.context.object->type != cObjectMolecule ||
+                            pick.src.bond == cPickableNoPick;
+                   }),
+      picked.end());
+
+  return picked;
+}
@@ -29,5 +29,10 @@ void SceneRenderPicking(PyMOLGlobals* G, int stereo_mode, ClickSide click_side,
     SceneUnitContext* context, GLenum render_buffer);
 int SceneMultipick(PyMOLGlobals * G, Multipick * smp);
 
+bool ScenePickCPU(PyMOLGlobals * G, int x, int y, Picking * pick);
+void SceneMultipickCPU(PyMOLGlobals * G, Multipick * smp);
+std::vector<Picking> ScenePickAtoms(
+    PyMOLGlobals * G, int x, int y, int width, int height);
+
 #endif
 
@@ -85,33 +85,274 @@ static void SceneRaySetRayView(PyMOLGlobals * G, CScene *I, int stereo_hand,
   }
 }
 
-bool SceneRay(PyMOLGlobals * G,
-              int ray_width, int ray_height, int mode,
-              char **headerVLA_ptr,
-              char **charVLA_ptr, float angle,
-              float shift, int quiet, G3dPrimitive ** g3d, int show_timing, int antialias)
+/**
+ * World space primitives of the last SceneRayBuild and what they were built
+ * from. A ray with only a different camera (e.g. rock and roll movie
+ * frames) gets a copy instead of rendering all objects again. Voxel maps
+ * are camera and light space in this tracer, they are always rebuilt by
+ * RayRender.
+ *
+ * Opt-in with ray_reuse_primitives: keeping the cache copies and holds all
+ * primitives of every ray. Turning the setting off frees it with the next
+ * ray.
+ */
+struct SceneRayCache {
+  struct ObjectKey {
+    const pymol::CObject* obj;
+    int state;
+    int color;
+    int ttt_flag;
+    float ttt[16];
+
+    bool operator==(const ObjectKey& other) const
+    {
+      return obj == other.obj && state == other.state &&
+             color == other.color && ttt_flag == other.ttt_flag &&
+             std::equal(ttt, ttt + 16, other.ttt);
+    }
+  };
+
+  unsigned change_count{};
+  std::vector<ObjectKey> objects;
+  float vertex_scale{};
+  float pixel_radius{};
+  int ortho{};
+  int sampling{};
+  CSetting setting;
+  std::shared_ptr<const CRayPrimitives> prims;
+
+  SceneRayCache(PyMOLGlobals * G) : setting(G) {}
+
+  /**
+   * Same key except for the settings, which are compared with
+   * settingsMatch
+   */
+  bool keyMatches(const SceneRayCache& other) const
+  {
+    return change_count == other.change_count && objects == other.objects &&
+           vertex_scale == other.vertex_scale &&
+           pixel_radius == other.pixel_radius && ortho == other.ortho &&
+           sampling == other.sampling;
+  }
+
+  /**
+   * Compares the global settings, except for the ones which change with
+   * every movie frame and are already covered by the object states.
+   */
+  bool settingsMatch(const CSetting& other) const
+  {
+    for(int index = 0; index < cSetting_INIT; ++index) {
+      if(index == cSetting_frame || index == cSetting_state)
+        continue;
+
+      auto const& a = setting.info[index];
+      auto const& b = other.info[index];
+
+      switch (SettingGetType(index)) {
+      case cSetting_string:
+        if((a.str_ ? *a.str_ : std::string()) !=
+           (b.str_ ? *b.str_ : std::string()))
+          return false;
+        break;
+      case cSetting_float3:
+        if(!std::equal(a.float3_, a.float3_ + 3, b.float3_))
+          return false;
+        break;
+      default:
+        if(a.int_ != b.int_)
+          return false;
+      }
+    }
+    return true;
+  }
+};
+
+static void SceneRayCacheSetKey(CScene * I, const CRay * ray,
+    float vertex_scale, SceneRayCache& key)
 {
-#ifdef _PYMOL_NO_RAY
-  FeedbackAdd(G, "" _PYMOL_NO_RAY);
-  return false;
-#else
+  key.change_count = I->ChangeCount;
+  key.vertex_scale = vertex_scale;
+  key.pixel_radius = ray->PixelRadius;
+  key.ortho = ray->Ortho;
+  key.sampling = ray->Sampling;
+
+  for (auto* obj : I->Obj) {
+    if (obj->type == cObjectGroup)
+      continue;
+    key.objects.emplace_back();
+    auto& item = key.objects.back();
+    item.obj = obj;
+    item.state = ObjectGetCurrentState(obj, false);
+    item.color = obj->Color;
+    item.ttt_flag = obj->TTTFlag;
+    std::copy_n(obj->TTT, 16, item.ttt);
+  }
+}
 
-  CScene *I = G->Scene;
-  CRay *ray = nullptr;
+/**
+ * Creates a ray for the current view and renders all visible objects of the
+ * current grid slot into it.
+ */
+static CRay* SceneRayBuild(PyMOLGlobals * G, CScene *I, int ray_width,
+    int ray_height, int tot_height, float aspRat, int antialias, int ortho,
+    int stereo_hand, float *angle, float shift, float fov)
+{
   float height, width;
-  float aspRat;
   float rayView[16];
-  double timing;
-  char *charVLA = nullptr;
-  char *headerVLA = nullptr;
-  float fov;
-  int stereo_hand = 0;
-  auto grid_mode = SettingGet<GridMode>(G, cSetting_grid_mode);
-  std::shared_ptr<pymol::Image> stereo_image;
-  OrthoLineType prefix = "";
-  int ortho = SettingGetGlobal_i(G, cSetting_ray_orthoscopic);
-  int last_grid_active = I->grid.active;
-  int grid_size = 0;
+
+  CRay *ray = RayNew(G, antialias);
+  if(!ray)
+    return nullptr;
+
+  SceneRaySetRayView(G, I, stereo_hand, rayView, angle, shift);
+
+  /* define the viewing volume */
+
+  height = (float) (fabs(I->m_view.pos().z) * tan((fov / 2.0) * cPI / 180.0));
+  width = height * aspRat;
+  PyMOL_SetBusy(G->PyMOL, true);
+  OrthoBusyFast(G, 0, 20);
+
+  {
+    float pixel_scale_value = SettingGetGlobal_f(G, cSetting_ray_pixel_scale);
+
+    if(pixel_scale_value < 0)
+      pixel_scale_value = 1.0F;
+
+    pixel_scale_value *= ((float) tot_height) / I->Height;
+
+    if(ortho) {
+      const float _1 = 1.0F;
+      RayPrepare(ray, -width, width, -height, height, I->m_view.m_clipSafe().m_front,
+                 I->m_view.m_clipSafe().m_back, fov, I->m_view.pos(), rayView, I->m_view.rotMatrix(),
+                 aspRat, ray_width, ray_height, 
+                 pixel_scale_value, ortho, _1, _1,      
+                 ((float) ray_height) / I->Height);
+    } else {
+      float back_ratio;
+      float back_height;
+      float back_width;
+      float pos;
+      pos = I->m_view.pos().z;
+
+      if((-pos) < I->m_view.m_clipSafe().m_front) {
+        pos = -I->m_view.m_clipSafe().m_front;
+      }
+
+      back_ratio = -I->m_view.m_clipSafe().m_back / pos;
+      back_height = back_ratio * height;
+      back_width = aspRat * back_height;
+      RayPrepare(ray,
+                 -back_width, back_width,
+                 -back_height, back_height,
+                 I->m_view.m_clipSafe().m_front, I->m_view.m_clipSafe().m_back,
+                 fov, I->m_view.pos(),
+                 rayView, I->m_view.rotMatrix(), aspRat,
+                 ray_width, ray_height,
+                 pixel_scale_value, ortho,
+                 height / back_height,
+                 I->m_view.m_clipSafe().m_front / I->m_view.m_clipSafe().m_back, ((float) ray_height) / I->Height);
+    }
+  }
+  {
+    auto slot_vla = I->m_slots.data();
+    int state = SceneGetState(G);
+    RenderInfo info;
+    info.ray = ray;
+    info.ortho = ortho;
+    info.vertex_scale = SceneGetScreenVertexScale(G, nullptr);
+	info.use_shaders = SettingGetGlobal_b(G, cSetting_use_shaders);
+
+    std::unique_ptr<SceneRayCache> key;
+
+    if(SettingGetGlobal_b(G, cSetting_ray_reuse_primitives) &&
+       !I->grid.active) {
+      key.reset(new SceneRayCache(G));
+      SceneRayCacheSetKey(I, ray, info.vertex_scale, *key);
+
+      auto const& cache = I->RayCache;
+      if(cache && cache->keyMatches(*key) &&
+         cache->settingsMatch(*G->Setting)) {
+        RaySetPrimitives(ray, *cache->prims);
+        PRINTFB(G, FB_Scene, FB_Blather)
+          " SceneRay: reusing %d primitives\n", RayGetNPrimitives(ray)
+          ENDFB(G);
+        return ray;
+      }
+    }
+
+    I->RayCache.reset();
+
+    if(SettingGetGlobal_b(G, cSetting_dynamic_width)) {
+      info.dynamic_width = true;
+      info.dynamic_width_factor =
+        SettingGetGlobal_f(G, cSetting_dynamic_width_factor);
+      info.dynamic_width_min = SettingGetGlobal_f(G, cSetting_dynamic_width_min);
+      info.dynamic_width_max = SettingGetGlobal_f(G, cSetting_dynamic_width_max);
+    }
+
+    for (auto* obj : I->Obj) {
+      // ObjectGroup used to have fRender = nullptr
+      if (obj->type != cObjectGroup) {
+        if(SceneGetDrawFlag(&I->grid, slot_vla, obj->grid_slot)) {
+          float color[3];
+          ColorGetEncoded(G, obj->Color, color);
+          RaySetContext(ray, obj->getRenderContext());
+          ray->color3fv(color);
+
+          auto icx = SettingGetWD<int>(
+              obj->Setting.get(), cSetting_ray_interior_color, cColorDefault);
+
+          if (icx == cColorDefault) {
+            ray->interiorColor3fv(color, true);
+          } else if (icx == cColorObject) {
+            ray->interiorColor3fv(color, false);
+          } else {
+            float icolor[3];
+            ColorGetEncoded(G, icx, icolor);
+            ray->interiorColor3fv(icolor, false);
+          }
+
+          if(!I->grid.active ||
+              I->grid.mode == GridMode::NoGrid ||
+              I->grid.mode == GridMode::ByObject) {
+            info.state = ObjectGetCurrentState(obj, false);
+            obj->render(&info);
+          } else if (I->grid.slot) {
+            if (I->grid.mode == GridMode::ByObjectStates) {
+              if((info.state = state + I->grid.slot - 1) >= 0)
+                obj->render(&info);
+            } else if (I->grid.mode == GridMode::ByObjectByState) {
+              info.state = I->grid.slot - obj->grid_slot - 1;
+              if (info.state >= 0 && info.state < obj->getNFrame())
+                obj->render(&info);
+            }
+          }
+        }
+      }
+    }
+
+    if(key && !ray->ViewDependent) {
+      key->prims = RayGetPrimitives(ray);
+      if(key->prims) {
+        key->setting = *G->Setting;
+        I->RayCache = std::move(key);
+      }
+    }
+  }
+
+  return ray;
+}
+
+/**
+ * Setup shared by SceneRay and SceneRayBuildFrame: updates deferred builds
+ * and the camera animation, and resolves the default projection, antialias
+ * level and image size.
+ */
+static void SceneRaySetup(PyMOLGlobals * G, CScene *I, int &ray_width,
+    int &ray_height, int &antialias, int &ortho)
+{
+  ortho = SettingGetGlobal_i(G, cSetting_ray_orthoscopic);
 
   if(SettingGetGlobal_i(G, cSetting_defer_builds_mode) == 5)
     SceneUpdate(G, true);
@@ -119,14 +360,8 @@ bool SceneRay(PyMOLGlobals * G,
   if(ortho < 0)
     ortho = SettingGetGlobal_b(G, cSetting_ortho);
 
-  if(mode != 0)
-    grid_mode = GridMode::NoGrid; /* only allow grid mode with PyMOL renderer */
-
   SceneUpdateAnimation(G);
 
-  if(mode == 0)
-    SceneInvalidateCopy(G, true);
-
   if(antialias < 0) {
     antialias = SettingGetGlobal_i(G, cSetting_antialias);
   }
@@ -144,6 +379,45 @@ bool SceneRay(PyMOLGlobals * G,
       ray_height = I->Height;
     }
   }
+}
+
+bool SceneRay(PyMOLGlobals * G,
+              int ray_width, int ray_height, int mode,
+              char **headerVLA_ptr,
+              char **charVLA_ptr, float angle,
+              float shift, int quiet, G3dPrimitive ** g3d, int show_timing, int antialias)
+{
+#ifdef _PYMOL_NO_RAY
+  FeedbackAdd(G, "" _PYMOL_NO_RAY);
+  return false;
+#else
+
+  CScene *I = G->Scene;
+  CRay *ray = nullptr;
+  size_t ray_memory = 0; // peak over grid cells, reported with the timing
+  int ray_memory_prims = 0;
+  float aspRat;
+  double timing;
+  char *charVLA = nullptr;
+  char *headerVLA = nullptr;
+  float fov;
+  int stereo_hand = 0;
+  auto grid_mode = SettingGet<GridMode>(G, cSetting_grid_mode);
+  std::shared_ptr<pymol::Image> stereo_image;
+  OrthoLineType prefix = "";
+  int ortho;
+  int last_grid_active = I->grid.active;
+  int grid_size = 0;
+
+  SceneRaySetup(G, I, ray_width, ray_height, antialias, ortho);
+
+  bool const image_mode = (mode == 0 || mode == cSceneRay_MODE_RASTER);
+
+  if(!image_mode)
+    grid_mode = GridMode::NoGrid; /* only allow grid mode with PyMOL renderer */
+
+  if(image_mode)
+    SceneInvalidateCopy(G, true);
 
   fov = SettingGetGlobal_f(G, cSetting_field_of_view);
 
@@ -210,119 +484,11 @@ bool SceneRay(PyMOLGlobals * G,
         OrthoBusySlow(G, slot, I->grid.last_slot);
       }
 
-      ray = RayNew(G, antialias);
+      ray = SceneRayBuild(G, I, ray_width, ray_height, tot_height, aspRat,
+          antialias, ortho, stereo_hand, &angle, shift, fov);
       if(!ray)
         break;
 
-      SceneRaySetRayView(G, I, stereo_hand, rayView, &angle, shift);
-
-      /* define the viewing volume */
-
-      height = (float) (fabs(I->m_view.pos().z) * tan((fov / 2.0) * cPI / 180.0));
-      width = height * aspRat;
-      PyMOL_SetBusy(G->PyMOL, true);
-      OrthoBusyFast(G, 0, 20);
-
-      {
-        float pixel_scale_value = SettingGetGlobal_f(G, cSetting_ray_pixel_scale);
-
-        if(pixel_scale_value < 0)
-          pixel_scale_value = 1.0F;
-
-        pixel_scale_value *= ((float) tot_height) / I->Height;
-
-        if(ortho) {
-          const float _1 = 1.0F;
-          RayPrepare(ray, -width, width, -height, height, I->m_view.m_clipSafe().m_front,
-                     I->m_view.m_clipSafe().m_back, fov, I->m_view.pos(), rayView, I->m_view.rotMatrix(),
-                     aspRat, ray_width, ray_height, 
-                     pixel_scale_value, ortho, _1, _1,      
-                     ((float) ray_height) / I->Height);
-        } else {
-          float back_ratio;
-          float back_height;
-          float back_width;
-          float pos;
-          pos = I->m_view.pos().z;
-
-          if((-pos) < I->m_view.m_clipSafe().m_front) {
-            pos = -I->m_view.m_clipSafe().m_front;
-          }
-
-          back_ratio = -I->m_view.m_clipSafe().m_back / pos;
-          back_height = back_ratio * height;
-          back_width = aspRat * back_height;
-          RayPrepare(ray,
-                     -back_width, back_width,
-                     -back_height, back_height,
-                     I->m_view.m_clipSafe().m_front, I->m_view.m_clipSafe().m_back,
-                     fov, I->m_view.pos(),
-                     rayView, I->m_view.rotMatrix(), aspRat,
-                     ray_width, ray_height,
-                     pixel_scale_value, ortho,
-                     height / back_height,
-                     I->m_view.m_clipSafe().m_front / I->m_view.m_clipSafe().m_back, ((float) ray_height) / I->Height);
-        }
-      }
-      {
-        auto slot_vla = I->m_slots.data();
-        int state = SceneGetState(G);
-        RenderInfo info;
-        info.ray = ray;
-        info.ortho = ortho;
-        info.vertex_scale = SceneGetScreenVertexScale(G, nullptr);
-	info.use_shaders = SettingGetGlobal_b(G, cSetting_use_shaders);
-
-        if(SettingGetGlobal_b(G, cSetting_dynamic_width)) {
-          info.dynamic_width = true;
-          info.dynamic_width_factor =
-            SettingGetGlobal_f(G, cSetting_dynamic_width_factor);
-          info.dynamic_width_min = SettingGetGlobal_f(G, cSetting_dynamic_width_min);
-          info.dynamic_width_max = SettingGetGlobal_f(G, cSetting_dynamic_width_max);
-        }
-
-        for (auto* obj : I->Obj) {
-          // ObjectGroup used to have fRender = nullptr
-          if (obj->type != cObjectGroup) {
-            if(SceneGetDrawFlag(&I->grid, slot_vla, obj->grid_slot)) {
-              float color[3];
-              ColorGetEncoded(G, obj->Color, color);
-              RaySetContext(ray, obj->getRenderContext());
-              ray->color3fv(color);
-
-              auto icx = SettingGetWD<int>(
-                  obj->Setting.get(), cSetting_ray_interior_color, cColorDefault);
-
-              if (icx == cColorDefault) {
-                ray->interiorColor3fv(color, true);
-              } else if (icx == cColorObject) {
-                ray->interiorColor3fv(color, false);
-              } else {
-                float icolor[3];
-                ColorGetEncoded(G, icx, icolor);
-                ray->interiorColor3fv(icolor, false);
-              }
-
-              if(!I->grid.active ||
-                  I->grid.mode == GridMode::NoGrid ||
-                  I->grid.mode == GridMode::ByObject) {
-                info.state = ObjectGetCurrentState(obj, false);
-                obj->render(&info);
-              } else if (I->grid.slot) {
-                if (I->grid.mode == GridMode::ByObjectStates) {
-                  if((info.state = state + I->grid.slot - 1) >= 0)
-                    obj->render(&info);
-                } else if (I->grid.mode == GridMode::ByObjectByState) {
-                  info.state = I->grid.slot - obj->grid_slot - 1;
-                  if (info.state >= 0 && info.state < obj->getNFrame())
-                    obj->render(&info);
-                }
-              }
-            }
-          }
-        }
-      }
-
       OrthoBusyFast(G, 1, 20);
 
       if(mode != 2) {           /* don't show pixel count for tests */
@@ -335,11 +501,20 @@ bool SceneRay(PyMOLGlobals * G,
       }
       switch (mode) {
       case 0:                  /* mode 0 is built-in */
+      case cSceneRay_MODE_RASTER:
         {
           auto image = std::make_unique<pymol::Image>(ray_width, ray_height);
           std::uint32_t background;
 
-          RayRender(ray, image->pixels(), timing, angle, antialias, &background);
+          if(mode == cSceneRay_MODE_RASTER) {
+            RayRenderRaster(ray, image->pixels(), antialias, &background);
+          } else {
+            RayRender(ray, image->pixels(), timing, angle, antialias, &background);
+            if(ray->MemoryUsage > ray_memory) {
+              ray_memory = ray->MemoryUsage;
+              ray_memory_prims = RayGetNPrimitives(ray);
+            }
+          }
 
           /*    RayRenderColorTable(ray,ray_width,ray_height,buffer); */
           if(!I->grid.active) {
@@ -499,7 +674,7 @@ bool SceneRay(PyMOLGlobals * G,
       ray_height = ray_rect.extent.height;
     }
 
-    if((mode == 0) && I->Image && !I->Image->empty()) {
+    if(image_mode && I->Image && !I->Image->empty()) {
       SceneApplyImageGamma(G, I->Image->pixels(), I->Image->getWidth(),
                            I->Image->getHeight());
     }
@@ -722,6 +897,12 @@ bool SceneRay(PyMOLGlobals * G,
         PRINTFB(G, FB_Ray, FB_Details)
           " Ray: render time: %4.2f sec. = %3.1f frames/hour (%4.2f sec. accum.).\n",
           timing, 3600 / timing, accumTiming ENDFB(G);
+        if(ray_memory && ray_memory_prims) {
+          PRINTFB(G, FB_Ray, FB_Details)
+            " Ray: render memory: %4.1f MB = %d bytes/primitive (%d bytes/record).\n",
+            ray_memory / 1048576.0, int(ray_memory / ray_memory_prims),
+            int(sizeof(CPrimitive)) ENDFB(G);
+        }
       } else {
         PRINTFB(G, FB_Ray, FB_Details)
           " Ray: render aborted.\n" ENDFB(G);
@@ -744,6 +925,75 @@ bool SceneRay(PyMOLGlobals * G,
 #endif
 }
 
+/**
+ * Builds the ray of the current frame with the built-in renderer. The ray
+ * is detached (see RayDetach) unless it has labels, so that it can be
+ * traced with SceneRayTraceFrame on a worker thread.
+ *
+ * @param[out] antialias Antialias level for SceneRayTraceFrame
+ * @return nullptr if the scene needs SceneRay (other renderer, grid mode,
+ * stereo, ray_volume)
+ */
+CRay* SceneRayBuildFrame(PyMOLGlobals * G, int ray_width, int ray_height,
+    int *antialias)
+{
+#ifdef _PYMOL_NO_RAY
+  return nullptr;
+#else
+  CScene *I = G->Scene;
+
+  if(SettingGetGlobal_i(G, cSetting_ray_default_renderer) != 0 ||
+     SettingGet<GridMode>(G, cSetting_grid_mode) != GridMode::NoGrid ||
+     SettingGet<bool>(G, cSetting_ray_volume) ||
+     I->StereoMode)
+    return nullptr;
+
+  int ortho;
+  float angle = 0.0F;
+
+  *antialias = -1;
+  SceneRaySetup(G, I, ray_width, ray_height, *antialias, ortho);
+
+  SceneUpdate(G, false);
+
+  CRay *ray = SceneRayBuild(G, I, ray_width, ray_height, ray_height,
+      ((float) ray_width) / ((float) ray_height), *antialias, ortho, 0,
+      &angle, 0.0F, SettingGetGlobal_f(G, cSetting_field_of_view));
+
+  PyMOL_SetBusy(G->PyMOL, false);
+
+  if(ray && RayCanDetach(ray))
+    RayDetach(ray);
+
+  return ray;
+#endif
+}
+
+/**
+ * Traces a ray from SceneRayBuildFrame and frees it. Thread safe for
+ * detached rays.
+ *
+ * @return nullptr if the session was interrupted while tracing
+ */
+std::shared_ptr<pymol::Image> SceneRayTraceFrame(CRay * ray, int antialias)
+{
+  PyMOLGlobals *G = ray->G;
+  auto image = std::make_shared<pymol::Image>(ray->Width, ray->Height);
+
+  RayRender(ray, image->pixels(), UtilGetSeconds(G), 0.0F, antialias, nullptr);
+  bool const interrupted = RayInterrupted(ray);
+  if(!interrupted) {
+    SceneApplyImageGamma(G, image->pixels(), image->getWidth(),
+                         image->getHeight());
+  }
+  RayFree(ray);
+
+  if(interrupted)
+    return nullptr;
+
+  return image;
+}
+
 int SceneDeferRay(PyMOLGlobals * G,
                   int ray_width,
                   int ray_height,
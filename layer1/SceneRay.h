@@ -30,6 +30,10 @@ bool SceneRay(PyMOLGlobals * G,
               float shift, int quiet, G3dPrimitive ** g3d,
               int show_timing, int antialias);
 
+CRay* SceneRayBuildFrame(PyMOLGlobals * G, int ray_width, int ray_height,
+    int *antialias);
+std::shared_ptr<pymol::Image> SceneRayTraceFrame(CRay * ray, int antialias);
+
 void SceneRenderRayVolume(PyMOLGlobals * G, CScene *I);
 
 #endif
@@ -905,6 +905,18 @@ enum {
   REC_f( 795, salt_bridge_distance                        , global    , 5.0f ),
   REC_b( 796, use_tessellation_shaders                , global    , true ),
   REC_c( 797, cell_color                              , ostate    , "-1" ),
+  REC_b( 798, assembly_instanced                      , global    , false ),
+  REC_b( 799, iterate_native                          , global    , true ),
+  REC_i( 800, movie_ray_frames                        , global    , 1 ),
+  REC_b( 801, ray_reuse_primitives                    , global    , false ),
+  REC_f( 802, ray_shadow_softness                     , global    , 0.0f ),
+  REC_i( 803, ray_shadow_samples                      , global    , 8 ),
+  REC_i( 804, ray_ambient_occlusion                   , global    , 0 ),
+  REC_f( 805, ray_ambient_occlusion_radius            , global    , 6.0f ),
+  REC_b( 806, ray_adaptive_antialias                  , global    , false ),
+  REC_i( 807, pick_cpu                                , global    , 1 ),
+  REC_b( 808, headless_draw                           , global    , false ),
+  REC_b( 809, png_fast                                , global    , false ),
 
 #ifdef SETTINGINFO_IMPLEMENTATION
 #undef SETTINGINFO_IMPLEMENTATION
@@ -39,6 +39,18 @@ CoordSet * CoordSetCopyFilterChains(
   return cset;
 }
 
+/**
+ * Append a rigid body instance (row-major 4x4 matrix) to a coordinate set,
+ * for the `assembly_instanced` mode which shares representations between
+ * all copies instead of transforming coordinate set copies.
+ */
+void CoordSetAppendInstance(CoordSet * cset, const float * matrix)
+{
+  double matrix_d[16];
+  copy44f44d(matrix, matrix_d);
+  cset->Instances.insert(cset->Instances.end(), matrix_d, matrix_d + 16);
+}
+
 /**
  * Replace coordinate sets and set all_states
  */
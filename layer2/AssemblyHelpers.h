@@ -18,6 +18,8 @@ CoordSet * CoordSetCopyFilterChains(
     const AtomInfoType * atInfo,
     const std::set<lexborrow_t> & chains_set);
 
+void CoordSetAppendInstance(CoordSet * cset, const float * matrix);
+
 void ObjectMoleculeSetAssemblyCSets(
     ObjectMolecule * I,
     CoordSet ** assembly_csets);
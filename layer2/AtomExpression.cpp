@@ -0,0 +1,1722 @@
+/**
+ * @file
+ * Native evaluator for alter/iterate expressions
+ */
+
+#include "AtomExpression.h"
+
+#include "AtomInfo.h"
+#include "CoordSet.h"
+#include "Lex.h"
+#include "ObjectMolecule.h"
+#include "P.h"
+#include "PyMOL.h"
+#include "Seeker.h"
+
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+enum class AtomExpression::Op : unsigned char {
+  Const,
+  Prop,
+  Neg,
+  Not,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  FloorDiv,
+  Mod,
+  Pow,
+  Eq,
+  Ne,
+  Lt,
+  Le,
+  Gt,
+  Ge,
+  And,
+  Or,
+  IfElse,
+  Int,
+  Float,
+  Str,
+  Abs,
+  Len,
+  Min,
+  Max,
+  Round,
+  Tuple, //!< only as argument of append()
+  List,  //!< only as argument of append()
+};
+
+struct AtomExpression::Node {
+  Op op;
+  Type type;
+  int a = -1, b = -1, c = -1;
+  const AtomPropertyInfo* prop = nullptr;
+  Value value;           //!< Op::Const
+  std::vector<int> args; //!< Op::Tuple, Op::List
+};
+
+struct AtomExpression::Statement {
+  const AtomPropertyInfo* prop = nullptr; //!< assignment target
+  int value = -1;                         //!< assigned or appended node
+  int target = -1;                        //!< append target
+  size_t source = 0;                      //!< offset in m_source
+};
+
+struct AtomExpression::Context {
+  ObjectMolecule* obj;
+  CoordSet* cs;
+  AtomInfoType* ai;
+  int atm;
+  int idx;
+  int state;
+};
+
+namespace
+{
+/// Thrown by the parser for anything outside of the supported subset
+struct Unsupported {
+};
+
+template <typename T>
+T* member_pointer(AtomInfoType* ai, size_t offset)
+{
+  return reinterpret_cast<T*>(reinterpret_cast<char*>(ai) + offset);
+}
+
+bool isNumeric(AtomExpression::Type type)
+{
+  return type != AtomExpression::Type::Str;
+}
+
+/// Trims ASCII whitespace like Python's int() and float()
+std::string stripped(const std::string& s)
+{
+  size_t begin = 0, end = s.size();
+  while (begin < end && isspace((unsigned char) s[begin]))
+    ++begin;
+  while (end > begin && isspace((unsigned char) s[end - 1]))
+    --end;
+  return s.substr(begin, end - begin);
+}
+
+/**
+ * Python's int(str) for base 10
+ *
+ * @param[out] too_large Valid literal which doesn't fit into `out`
+ */
+bool parseInt(const std::string& str, long long& out, bool& too_large)
+{
+  too_large = false;
+  auto s = stripped(str);
+  size_t i = 0;
+  bool negative = false;
+  if (i < s.size() && (s[i] == '+' || s[i] == '-')) {
+    negative = s[i++] == '-';
+  }
+  if (i == s.size()) {
+    return false;
+  }
+  unsigned long long value = 0;
+  bool digit_before = false;
+  for (; i < s.size(); ++i) {
+    if (s[i] == '_' && digit_before && i + 1 < s.size() &&
+        isdigit((unsigned char) s[i + 1])) {
+      continue;
+    }
+    if (!isdigit((unsigned char) s[i])) {
+      return false;
+    }
+    if (value <= (1ULL << 62)) {
+      value = value * 10 + (s[i] - '0');
+    }
+    digit_before = true;
+  }
+  if (value > (1ULL << 62)) {
+    too_large = true;
+    return false;
+  }
+  out = negative ? -(long long) value : (long long) value;
+  return true;
+}
+
+/// Python's float(str), without underscores and hexadecimal notation
+bool parseFloat(const std::string& str, double& out)
+{
+  auto s = stripped(str);
+  if (s.empty() || s.find_first_of("xX_(") != std::string::npos) {
+    return false;
+  }
+  char* end = nullptr;
+  out = strtod(s.c_str(), &end);
+  return end == s.c_str() + s.size();
+}
+
+/// True if the integral value `f` can be converted to long long
+bool isInt64(double f)
+{
+  return f >= -9223372036854775808.0 && f < 9223372036854775808.0;
+}
+
+long long floorDiv(long long a, long long b)
+{
+  long long q = a / b;
+  if ((a % b != 0) && ((a < 0) != (b < 0)))
+    --q;
+  return q;
+}
+
+long long floorMod(long long a, long long b)
+{
+  long long r = a % b;
+  if (r != 0 && ((r < 0) != (b < 0)))
+    r += b;
+  return r;
+}
+
+/// Python's float divmod (Objects/floatobject.c)
+void floatDivMod(double vx, double wx, double& floordiv, double& mod)
+{
+  mod = std::fmod(vx, wx);
+  double div = (vx - mod) / wx;
+  if (mod) {
+    if ((wx < 0) != (mod < 0)) {
+      mod += wx;
+      div -= 1.0;
+    }
+  } else {
+    mod = std::copysign(0.0, wx);
+  }
+  if (div) {
+    floordiv = std::floor(div);
+    if (div - floordiv > 0.5)
+      floordiv += 1.0;
+  } else {
+    floordiv = std::copysign(0.0, vx / wx);
+  }
+}
+
+} // namespace
+
+/*========================================================================*/
+
+/**
+ * Recursive descent parser for Python statements, following the precedence
+ * rules of the Python grammar.
+ */
+class AtomExpression::Parser
+{
+  enum class Tok { End, Name, Int, Float, Str, Op };
+
+  struct Token {
+    Tok kind = Tok::End;
+    size_t offset = 0; //!< in the source
+    std::string text;
+    long long i = 0;
+    double f = 0.0;
+  };
+
+  AtomExpression& I;
+  PyMOLGlobals* G;
+  bool m_read_only, m_with_state;
+  const Scope& m_scope;
+  std::vector<Token> m_tokens;
+  size_t m_pos = 0;
+
+public:
+  Parser(AtomExpression& expr, PyMOLGlobals* G_, bool read_only,
+      bool with_state, const Scope& scope)
+      : I(expr)
+      , G(G_)
+      , m_read_only(read_only)
+      , m_with_state(with_state)
+      , m_scope(scope)
+  {
+  }
+
+  void parse(const char* expr)
+  {
+    tokenize(expr);
+
+    while (peek().kind != Tok::End) {
+      if (accept(";") || accept("\n")) {
+        continue;
+      }
+      statement();
+      if (peek().kind != Tok::End && !accept(";") && !accept("\n")) {
+        throw Unsupported();
+      }
+    }
+
+    if (I.m_statements.empty()) {
+      throw Unsupported();
+    }
+  }
+
+private:
+  /*----------------------------------------------------------------------*/
+  // Tokens
+
+  void tokenize(const char* const expr)
+  {
+    const char* p = expr;
+
+    static const char* const ops[] = {"**=", "//=", "**", "//", "==", "!=",
+        "<=", ">=", "+=", "-=", "*=", "/=", "%=", "+", "-", "*", "/", "%", "<",
+        ">", "=", "(", ")", "[", "]", ",", ".", ";", "\n"};
+
+    while (*p) {
+      if (*p == ' ' || *p == '\t' || *p == '\r') {
+        ++p;
+        continue;
+      }
+
+      if (*p == '#' || *p == '\\') {
+        throw Unsupported();
+      }
+
+      Token tok;
+      tok.offset = p - expr;
+
+      if (isalpha((unsigned char) *p) || *p == '_') {
+        const char* start = p;
+        while (isalnum((unsigned char) *p) || *p == '_')
+          ++p;
+        tok.kind = Tok::Name;
+        tok.text.assign(start, p);
+        if (*p == '\'' || *p == '"') {
+          throw Unsupported(); // string prefix (r"", b"", f"", ...)
+        }
+      } else if (isdigit((unsigned char) *p) ||
+                 (*p == '.' && isdigit((unsigned char) p[1]))) {
+        const char* start = p;
+        bool is_float = false;
+        while (isdigit((unsigned char) *p))
+          ++p;
+        if (*p == '.') {
+          is_float = true;
+          ++p;
+          while (isdigit((unsigned char) *p))
+            ++p;
+        }
+        if (*p == 'e' || *p == 'E') {
+          is_float = true;
+          ++p;
+          if (*p == '+' || *p == '-')
+            ++p;
+          if (!isdigit((unsigned char) *p))
+            throw Unsupported();
+          while (isdigit((unsigned char) *p))
+            ++p;
+        }
+        if (isalnum((unsigned char) *p) || *p == '_' || *p == '.') {
+          throw Unsupported(); // hex, complex, underscores, ...
+        }
+        tok.text.assign(start, p);
+        if (is_float) {
+          tok.kind = Tok::Float;
+          tok.f = strtod(tok.text.c_str(), nullptr);
+        } else {
+          if ((tok.text.size() > 1 && tok.text[0] == '0') ||
+              tok.text.size() > 18) {
+            throw Unsupported();
+          }
+          tok.kind = Tok::Int;
+          tok.i = atoll(tok.text.c_str());
+        }
+      } else if (*p == '\'' || *p == '"') {
+        char const quote = *p++;
+        if (p[0] == quote && p[1] == quote) {
+          throw Unsupported(); // triple quotes
+        }
+        tok.kind = Tok::Str;
+        for (;; ++p) {
+          if (!*p || *p == '\n') {
+            throw Unsupported();
+          }
+          if (*p == quote) {
+            ++p;
+            break;
+          }
+          if (*p == '\\') {
+            switch (*++p) {
+            case '\\':
+            case '\'':
+            case '"':
+              tok.text += *p;
+              break;
+            case 'n':
+              tok.text += '\n';
+              break;
+            case 't':
+              tok.text += '\t';
+              break;
+            default:
+              throw Unsupported();
+            }
+            continue;
+          }
+          tok.text += *p;
+        }
+      } else {
+        for (const char* op : ops) {
+          size_t const len = strlen(op);
+          if (strncmp(p, op, len) == 0) {
+            tok.kind = Tok::Op;
+            tok.text = op;
+            p += len;
+            break;
+          }
+        }
+        if (tok.kind != Tok::Op) {
+          throw Unsupported();
+        }
+      }
+
+      m_tokens.push_back(std::move(tok));
+    }
+  }
+
+  const Token& peek(size_t ahead = 0) const
+  {
+    static const Token end;
+    size_t const pos = m_pos + ahead;
+    return pos < m_tokens.size() ? m_tokens[pos] : end;
+  }
+
+  bool isOp(const char* op, size_t ahead = 0) const
+  {
+    auto const& tok = peek(ahead);
+    return tok.kind == Tok::Op && tok.text == op;
+  }
+
+  bool isKeyword(const char* kw) const
+  {
+    auto const& tok = peek();
+    return tok.kind == Tok::Name && tok.text == kw;
+  }
+
+  bool accept(const char* op)
+  {
+    if (isOp(op)) {
+      ++m_pos;
+      return true;
+    }
+    return false;
+  }
+
+  bool acceptKeyword(const char* kw)
+  {
+    if (isKeyword(kw)) {
+      ++m_pos;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(const char* op)
+  {
+    if (!accept(op)) {
+      throw Unsupported();
+    }
+  }
+
+  static bool isReservedName(const std::string& name)
+  {
+    static const char* const keywords[] = {"None", "as", "assert", "async",
+        "await", "break", "class", "continue", "def", "del", "elif", "except",
+        "finally", "for", "from", "global", "import", "in", "is", "lambda",
+        "nonlocal", "pass", "raise", "return", "try", "while", "with", "yield",
+        "and", "or", "not", "if", "else", "True", "False"};
+    for (const char* kw : keywords) {
+      if (name == kw)
+        return true;
+    }
+    return false;
+  }
+
+  /*----------------------------------------------------------------------*/
+  // Atom properties
+
+  const AtomPropertyInfo* atomProperty(const std::string& name) const
+  {
+    return PyMOL_GetAtomPropertyInfo(G->PyMOL, name.c_str());
+  }
+
+  /// Type of a readable property
+  Type readType(const AtomPropertyInfo* ap) const
+  {
+#ifdef _PYMOL_IP_EXTRAS
+    if (ap->id == ATOM_PROP_STEREO || ap->id == ATOM_PROP_TEXT_TYPE)
+      throw Unsupported();
+#endif
+    switch (ap->Ptype) {
+    case cPType_string:
+    case cPType_int_as_string:
+    case cPType_char_as_type:
+    case cPType_model:
+      return Type::Str;
+    case cPType_schar:
+    case cPType_int:
+    case cPType_uint32:
+    case cPType_index:
+    case cPType_state:
+      return Type::Int;
+    case cPType_float:
+      return Type::Float;
+    case cPType_xyz_float:
+      if (m_with_state)
+        return Type::Float;
+      break;
+    case 0:
+      if (ap->id == ATOM_PROP_RESI || ap->id == ATOM_PROP_ONELETTER)
+        return Type::Str;
+      break;
+    }
+    throw Unsupported();
+  }
+
+  /// Checks that `type` can be assigned like WrapperObjectAssignSubScript
+  void checkWritable(const AtomPropertyInfo* ap, Type type) const
+  {
+    if (m_read_only) {
+      throw Unsupported(); // Python raises TypeError
+    }
+#ifdef _PYMOL_IP_EXTRAS
+    if (ap->id == ATOM_PROP_STEREO || ap->id == ATOM_PROP_TEXT_TYPE)
+      throw Unsupported();
+#endif
+    switch (ap->Ptype) {
+    case cPType_string:
+    case cPType_int_as_string:
+    case cPType_char_as_type:
+    case cPType_float:
+      return;
+    case cPType_schar:
+    case cPType_int:
+    case cPType_uint32:
+      if (type == Type::Int || type == Type::Bool)
+        return;
+      break;
+    case cPType_xyz_float:
+      if (m_with_state)
+        return;
+      break;
+    case 0:
+      if (ap->id == ATOM_PROP_RESI)
+        return;
+      break;
+    }
+    throw Unsupported();
+  }
+
+  /*----------------------------------------------------------------------*/
+  // Nodes
+
+  int add(Node&& node)
+  {
+    I.m_nodes.push_back(std::move(node));
+    return int(I.m_nodes.size()) - 1;
+  }
+
+  /// Type of a node which must be a scalar (not a tuple or list)
+  Type scalar(int n) const
+  {
+    auto const& node = I.m_nodes[n];
+    if (node.op == Op::Tuple || node.op == Op::List) {
+      throw Unsupported();
+    }
+    return node.type;
+  }
+
+  bool isConstInt(int n) const
+  {
+    auto const& node = I.m_nodes[n];
+    return node.op == Op::Const && node.type == Type::Int;
+  }
+
+  int makeConst(Value&& value)
+  {
+    Node node{Op::Const, value.type};
+    node.value = std::move(value);
+    return add(std::move(node));
+  }
+
+  int makeUnary(Op op, int a)
+  {
+    Type ta = scalar(a);
+    Type type = Type::Bool;
+    if (op == Op::Neg) {
+      if (!isNumeric(ta))
+        throw Unsupported();
+      type = (ta == Type::Float) ? Type::Float : Type::Int;
+    }
+    Node node{op, type};
+    node.a = a;
+    return add(std::move(node));
+  }
+
+  int makeBinary(Op op, int a, int b)
+  {
+    Type const ta = scalar(a), tb = scalar(b);
+    bool const num = isNumeric(ta) && isNumeric(tb);
+    bool const str = ta == Type::Str && tb == Type::Str;
+    bool const any_float = ta == Type::Float || tb == Type::Float;
+    Type type;
+
+    switch (op) {
+    case Op::Add:
+      if (str) {
+        type = Type::Str;
+        break;
+      }
+      // fall-through
+    case Op::Sub:
+    case Op::Mul:
+    case Op::FloorDiv:
+    case Op::Mod:
+      if (!num)
+        throw Unsupported();
+      type = any_float ? Type::Float : Type::Int;
+      break;
+    case Op::Div:
+      if (!num)
+        throw Unsupported();
+      type = Type::Float;
+      break;
+    case Op::Pow:
+      if (!num)
+        throw Unsupported();
+      if (any_float) {
+        type = Type::Float;
+      } else if (isConstInt(b) && I.m_nodes[b].value.i >= 0) {
+        type = Type::Int;
+      } else {
+        throw Unsupported(); // int ** negative int is float
+      }
+      break;
+    case Op::Eq:
+    case Op::Ne:
+    case Op::Lt:
+    case Op::Le:
+    case Op::Gt:
+    case Op::Ge:
+      if (!num && !str)
+        throw Unsupported();
+      type = Type::Bool;
+      break;
+    case Op::And:
+    case Op::Or:
+      // Python returns one of the operands, only equivalent for bools
+      if (ta != Type::Bool || tb != Type::Bool)
+        throw Unsupported();
+      type = Type::Bool;
+      break;
+    default:
+      throw Unsupported();
+    }
+
+    Node node{op, type};
+    node.a = a;
+    node.b = b;
+    return add(std::move(node));
+  }
+
+  int makeCall(const std::string& name, const std::vector<int>& args)
+  {
+    static const struct {
+      const char* name;
+      Op op;
+    } builtins[] = {
+        {"int", Op::Int},
+        {"float", Op::Float},
+        {"str", Op::Str},
+        {"abs", Op::Abs},
+        {"len", Op::Len},
+        {"min", Op::Min},
+        {"max", Op::Max},
+        {"round", Op::Round},
+    };
+
+    // shadowed builtins
+    Value dummy;
+    if (atomProperty(name) ||
+        (m_scope.lookup && m_scope.lookup(name, dummy) != Lookup::NotFound)) {
+      throw Unsupported();
+    }
+
+    for (auto const& builtin : builtins) {
+      if (name != builtin.name)
+        continue;
+
+      Op const op = builtin.op;
+
+      if (op == Op::Min || op == Op::Max) {
+        if (args.size() < 2)
+          throw Unsupported();
+        Type const type = scalar(args[0]);
+        if (type == Type::Bool)
+          throw Unsupported();
+        int n = args[0];
+        for (size_t i = 1; i < args.size(); ++i) {
+          if (scalar(args[i]) != type)
+            throw Unsupported(); // Python returns the original object
+          Node node{op, type};
+          node.a = n;
+          node.b = args[i];
+          n = add(std::move(node));
+        }
+        return n;
+      }
+
+      if (args.size() != 1)
+        throw Unsupported();
+
+      Type const ta = scalar(args[0]);
+      Type type;
+
+      switch (op) {
+      case Op::Int:
+      case Op::Round:
+        if (op == Op::Round && !isNumeric(ta))
+          throw Unsupported();
+        type = Type::Int;
+        break;
+      case Op::Float:
+        type = Type::Float;
+        break;
+      case Op::Str:
+        type = Type::Str;
+        break;
+      case Op::Abs:
+        if (!isNumeric(ta))
+          throw Unsupported();
+        type = (ta == Type::Float) ? Type::Float : Type::Int;
+        break;
+      case Op::Len:
+        if (ta != Type::Str)
+          throw Unsupported();
+        type = Type::Int;
+        break;
+      default:
+        throw Unsupported();
+      }
+
+      Node node{op, type};
+      node.a = args[0];
+      return add(std::move(node));
+    }
+
+    throw Unsupported();
+  }
+
+  /*----------------------------------------------------------------------*/
+  // Grammar
+
+  void statement()
+  {
+    auto const& first = peek();
+    size_t const source = first.offset;
+    if (first.kind != Tok::Name || isReservedName(first.text)) {
+      throw Unsupported(); // expression statements would print their value
+    }
+
+    if (isOp(".", 1)) {
+      appendStatement();
+      return;
+    }
+
+    auto const* ap = atomProperty(first.text);
+    if (!ap) {
+      throw Unsupported(); // local variable
+    }
+
+    ++m_pos;
+
+    static const struct {
+      const char* token;
+      Op op;
+    } augmented[] = {
+        {"+=", Op::Add},
+        {"-=", Op::Sub},
+        {"*=", Op::Mul},
+        {"/=", Op::Div},
+        {"//=", Op::FloorDiv},
+        {"%=", Op::Mod},
+        {"**=", Op::Pow},
+    };
+
+    int value = -1;
+
+    if (accept("=")) {
+      value = expr();
+    } else {
+      for (auto const& aug : augmented) {
+        if (accept(aug.token)) {
+          Node prop{Op::Prop, readType(ap)};
+          prop.prop = ap;
+          value = makeBinary(aug.op, add(std::move(prop)), expr());
+          break;
+        }
+      }
+      if (value == -1) {
+        throw Unsupported();
+      }
+    }
+
+    checkWritable(ap, scalar(value));
+
+    Statement st;
+    st.prop = ap;
+    st.value = value;
+    st.source = source;
+    I.m_statements.push_back(st);
+  }
+
+  /// name.attr.append(value)
+  void appendStatement()
+  {
+    size_t const source = peek().offset;
+    std::string dotted = peek().text;
+    if (atomProperty(dotted)) {
+      throw Unsupported();
+    }
+    ++m_pos;
+
+    for (bool found = false; !found;) {
+      expect(".");
+      auto const& tok = peek();
+      if (tok.kind != Tok::Name || isReservedName(tok.text)) {
+        throw Unsupported();
+      }
+      ++m_pos;
+      found = tok.text == "append" && isOp("(");
+      if (!found) {
+        dotted += '.';
+        dotted += tok.text;
+      }
+    }
+
+    expect("(");
+    int const value = expr();
+    expect(")");
+
+    if (!m_scope.canAppend || !m_scope.canAppend(dotted)) {
+      throw Unsupported();
+    }
+
+    Statement st;
+    st.value = value;
+    st.source = source;
+
+    for (size_t i = 0; i < I.m_appendTargets.size(); ++i) {
+      if (I.m_appendTargets[i] == dotted) {
+        st.target = i;
+      }
+    }
+
+    if (st.target == -1) {
+      st.target = I.m_appendTargets.size();
+      I.m_appendTargets.push_back(dotted);
+    }
+
+    I.m_statements.push_back(st);
+  }
+
+  int expr()
+  {
+    int const a = orExpr();
+    if (!acceptKeyword("if")) {
+      return a;
+    }
+    int const cond = orExpr();
+    if (!acceptKeyword("else")) {
+      throw Unsupported();
+    }
+    int const b = expr();
+    scalar(cond);
+    Type const type = scalar(a);
+    if (scalar(b) != type) {
+      throw Unsupported();
+    }
+    Node node{Op::IfElse, type};
+    node.a = a;
+    node.b = b;
+    node.c = cond;
+    return add(std::move(node));
+  }
+
+  int orExpr()
+  {
+    int a = andExpr();
+    while (acceptKeyword("or")) {
+      a = makeBinary(Op::Or, a, andExpr());
+    }
+    return a;
+  }
+
+  int andExpr()
+  {
+    int a = notExpr();
+    while (acceptKeyword("and")) {
+      a = makeBinary(Op::And, a, notExpr());
+    }
+    return a;
+  }
+
+  int notExpr()
+  {
+    if (acceptKeyword("not")) {
+      return makeUnary(Op::Not, notExpr());
+    }
+    return comparison();
+  }
+
+  int comparison()
+  {
+    static const struct {
+      const char* token;
+      Op op;
+    } ops[] = {
+        {"==", Op::Eq},
+        {"!=", Op::Ne},
+        {"<", Op::Lt},
+        {"<=", Op::Le},
+        {">", Op::Gt},
+        {">=", Op::Ge},
+    };
+
+    int result = -1;
+    int a = arith();
+
+    for (bool found = true; found;) {
+      found = false;
+      for (auto const& cmp : ops) {
+        if (accept(cmp.token)) {
+          // chained: a < b < c -> (a < b) and (b < c)
+          int const b = arith();
+          int const c = makeBinary(cmp.op, a, b);
+          result = (result == -1) ? c : makeBinary(Op::And, result, c);
+          a = b;
+          found = true;
+          break;
+        }
+      }
+    }
+
+    return (result == -1) ? a : result;
+  }
+
+  int arith()
+  {
+    int a = term();
+    for (;;) {
+      if (accept("+")) {
+        a = makeBinary(Op::Add, a, term());
+      } else if (accept("-")) {
+        a = makeBinary(Op::Sub, a, term());
+      } else {
+        return a;
+      }
+    }
+  }
+
+  int term()
+  {
+    int a = factor();
+    for (;;) {
+      if (accept("*")) {
+        a = makeBinary(Op::Mul, a, factor());
+      } else if (accept("/")) {
+        a = makeBinary(Op::Div, a, factor());
+      } else if (accept("//")) {
+        a = makeBinary(Op::FloorDiv, a, factor());
+      } else if (accept("%")) {
+        a = makeBinary(Op::Mod, a, factor());
+      } else {
+        return a;
+      }
+    }
+  }
+
+  int factor()
+  {
+    if (accept("-")) {
+      return makeUnary(Op::Neg, factor());
+    }
+    if (accept("+")) {
+      int const a = factor();
+      if (!isNumeric(scalar(a)))
+        throw Unsupported();
+      if (scalar(a) != Type::Bool)
+        return a;
+      Value zero;
+      return makeBinary(Op::Add, makeConst(std::move(zero)), a);
+    }
+    return power();
+  }
+
+  int power()
+  {
+    int const a = atom();
+    if (accept("**")) {
+      return makeBinary(Op::Pow, a, factor());
+    }
+    return a;
+  }
+
+  int atom()
+  {
+    auto const& tok = peek();
+
+    switch (tok.kind) {
+    case Tok::Int: {
+      ++m_pos;
+      Value value;
+      value.i = tok.i;
+      return makeConst(std::move(value));
+    }
+    case Tok::Float: {
+      ++m_pos;
+      Value value;
+      value.type = Type::Float;
+      value.f = tok.f;
+      return makeConst(std::move(value));
+    }
+    case Tok::Str: {
+      Value value;
+      value.type = Type::Str;
+      // implicit concatenation of adjacent literals
+      while (peek().kind == Tok::Str) {
+        value.s += peek().text;
+        ++m_pos;
+      }
+      return makeConst(std::move(value));
+    }
+    case Tok::Name:
+      return name();
+    case Tok::Op:
+      if (accept("(")) {
+        int const a = expr();
+        if (accept(")")) {
+          return a;
+        }
+        return sequence(Op::Tuple, a, ")");
+      }
+      if (accept("[")) {
+        if (accept("]"))
+          throw Unsupported();
+        return sequence(Op::List, expr(), "]");
+      }
+      break;
+    default:
+      break;
+    }
+
+    throw Unsupported();
+  }
+
+  /// Tuple or list display, `first` was already parsed
+  int sequence(Op op, int first, const char* close)
+  {
+    Node node{op, Type::Int};
+    node.args.push_back(first);
+    while (!accept(close)) {
+      expect(",");
+      if (accept(close))
+        break;
+      node.args.push_back(expr());
+    }
+    for (int n : node.args) {
+      scalar(n);
+    }
+    return add(std::move(node));
+  }
+
+  int name()
+  {
+    std::string const name = peek().text;
+    ++m_pos;
+
+    if (name == "True" || name == "False") {
+      Value value;
+      value.type = Type::Bool;
+      value.i = (name == "True");
+      return makeConst(std::move(value));
+    }
+
+    if (isReservedName(name)) {
+      throw Unsupported();
+    }
+
+    if (accept("(")) {
+      std::vector<int> args;
+      while (!accept(")")) {
+        if (!args.empty()) {
+          expect(",");
+          if (accept(")"))
+            break;
+        }
+        args.push_back(expr());
+      }
+      return makeCall(name, args);
+    }
+
+    if (isOp(".") || isOp("[")) {
+      throw Unsupported(); // attribute access, subscripts
+    }
+
+    if (auto const* ap = atomProperty(name)) {
+      Node node{Op::Prop, readType(ap)};
+      node.prop = ap;
+      return add(std::move(node));
+    }
+
+    Value value;
+    if (m_scope.lookup && m_scope.lookup(name, value) == Lookup::Found) {
+      return makeConst(std::move(value));
+    }
+
+    throw Unsupported();
+  }
+};
+
+/*========================================================================*/
+
+std::unique_ptr<AtomExpression> AtomExpression::compile(PyMOLGlobals* G,
+    const char* expr, bool read_only, bool with_state, const Scope& scope)
+{
+  std::unique_ptr<AtomExpression> result(new AtomExpression());
+  result->m_G = G;
+  result->m_source = expr;
+
+  try {
+    Parser(*result, G, read_only, with_state, scope).parse(expr);
+  } catch (const Unsupported&) {
+    return nullptr;
+  }
+
+  return result;
+}
+
+AtomExpression::~AtomExpression() = default;
+
+void AtomExpression::clearAppended()
+{
+  m_appended.clear();
+  m_appendedValues.clear();
+}
+
+bool AtomExpression::setError(Error error, const char* message)
+{
+  if (m_error == Error::None) {
+    m_error = error;
+    m_errorMessage = message;
+  }
+  return false;
+}
+
+/**
+ * Error for int(f) or round(f) of a float which is not in the int64 range.
+ * Finite values are valid Python ints and need the Python evaluator.
+ */
+bool AtomExpression::floatToIntError(double f)
+{
+  if (std::isnan(f))
+    return setError(Error::Value, "cannot convert float NaN to integer");
+  if (std::isinf(f))
+    return setError(Error::Overflow, "cannot convert float infinity to integer");
+  return setError(Error::Fallback, "integer overflow");
+}
+
+std::string AtomExpression::floatRepr(double value)
+{
+  if (std::isnan(value))
+    return "nan";
+  if (std::isinf(value))
+    return value < 0 ? "-inf" : "inf";
+
+  // shortest round-tripping digits
+  char buf[40];
+  for (int prec = 0; prec < 17; ++prec) {
+    snprintf(buf, sizeof(buf), "%.*e", prec, value);
+    if (strtod(buf, nullptr) == value)
+      break;
+  }
+
+  std::string result;
+  const char* p = buf;
+  if (*p == '-') {
+    result += '-';
+    ++p;
+  }
+
+  std::string digits;
+  for (; *p != 'e'; ++p) {
+    if (*p != '.')
+      digits += *p;
+  }
+  int const exp = atoi(p + 1);
+
+  while (digits.size() > 1 && digits.back() == '0')
+    digits.pop_back();
+
+  if (exp < -4 || exp >= 16) {
+    result += digits[0];
+    if (digits.size() > 1) {
+      result += '.';
+      result.append(digits, 1, std::string::npos);
+    }
+    snprintf(buf, sizeof(buf), "e%c%02d", exp < 0 ? '-' : '+', std::abs(exp));
+    result += buf;
+  } else if (exp < 0) {
+    result += "0.";
+    result.append(-exp - 1, '0');
+    result += digits;
+  } else {
+    if (digits.size() <= size_t(exp) + 1) {
+      digits.append(exp + 1 - digits.size(), '0');
+      result += digits;
+      result += ".0";
+    } else {
+      result.append(digits, 0, exp + 1);
+      result += '.';
+      result.append(digits, exp + 1, std::string::npos);
+    }
+  }
+
+  return result;
+}
+
+/*========================================================================*/
+// Evaluation
+
+bool AtomExpression::truth(int n, const Context& ctx)
+{
+  switch (m_nodes[n].type) {
+  case Type::Float:
+    return evalFloat(n, ctx) != 0.0;
+  case Type::Str: {
+    std::string s;
+    evalStr(n, ctx, s);
+    return !s.empty();
+  }
+  default:
+    return evalInt(n, ctx) != 0;
+  }
+}
+
+bool AtomExpression::evalBool(int n, const Context& ctx)
+{
+  auto const& node = m_nodes[n];
+  Type const ta = m_nodes[node.a].type;
+  Type const tb = node.b == -1 ? ta : m_nodes[node.b].type;
+
+  switch (node.op) {
+  case Op::Not:
+    return !truth(node.a, ctx);
+  case Op::And:
+    return evalInt(node.a, ctx) && evalInt(node.b, ctx);
+  case Op::Or:
+    return evalInt(node.a, ctx) || evalInt(node.b, ctx);
+  default:
+    break;
+  }
+
+  int cmp;
+  if (ta == Type::Str) {
+    std::string a, b;
+    evalStr(node.a, ctx, a);
+    evalStr(node.b, ctx, b);
+    cmp = a.compare(b);
+  } else if (ta == Type::Float || tb == Type::Float) {
+    double const a = evalFloat(node.a, ctx), b = evalFloat(node.b, ctx);
+    if (std::isnan(a) || std::isnan(b))
+      return node.op == Op::Ne;
+    cmp = (a < b) ? -1 : (a > b) ? 1 : 0;
+  } else {
+    long long const a = evalInt(node.a, ctx), b = evalInt(node.b, ctx);
+    cmp = (a < b) ? -1 : (a > b) ? 1 : 0;
+  }
+
+  switch (node.op) {
+  case Op::Eq:
+    return cmp == 0;
+  case Op::Ne:
+    return cmp != 0;
+  case Op::Lt:
+    return cmp < 0;
+  case Op::Le:
+    return cmp <= 0;
+  case Op::Gt:
+    return cmp > 0;
+  case Op::Ge:
+    return cmp >= 0;
+  default:
+    return false;
+  }
+}
+
+long long AtomExpression::evalInt(int n, const Context& ctx)
+{
+  auto const& node = m_nodes[n];
+
+  if (node.type == Type::Bool && node.op != Op::Const && node.op != Op::IfElse) {
+    return evalBool(n, ctx);
+  }
+
+  switch (node.op) {
+  case Op::Const:
+    return node.value.i;
+  case Op::Prop: {
+    auto const* ap = node.prop;
+    switch (ap->Ptype) {
+    case cPType_schar:
+      return *member_pointer<signed char>(ctx.ai, ap->offset);
+    case cPType_int:
+      return *member_pointer<int>(ctx.ai, ap->offset);
+    case cPType_uint32:
+      return *member_pointer<uint32_t>(ctx.ai, ap->offset);
+    case cPType_index:
+      return ctx.atm + 1;
+    case cPType_state:
+      return ctx.state;
+    }
+    return 0;
+  }
+  case Op::Neg: {
+    long long const a = evalInt(node.a, ctx);
+    if (a == LLONG_MIN)
+      return setError(Error::Fallback, "integer overflow");
+    return -a;
+  }
+  case Op::Add:
+  case Op::Sub:
+  case Op::Mul: {
+    long long const a = evalInt(node.a, ctx), b = evalInt(node.b, ctx);
+    long long result = 0;
+    bool const overflow =
+        (node.op == Op::Add)   ? __builtin_add_overflow(a, b, &result)
+        : (node.op == Op::Sub) ? __builtin_sub_overflow(a, b, &result)
+                               : __builtin_mul_overflow(a, b, &result);
+    if (overflow)
+      return setError(Error::Fallback, "integer overflow");
+    return result;
+  }
+  case Op::FloorDiv:
+  case Op::Mod: {
+    long long const a = evalInt(node.a, ctx), b = evalInt(node.b, ctx);
+    if (b == 0)
+      return setError(Error::ZeroDivision, "integer division or modulo by zero");
+    if (b == -1) { // LLONG_MIN / -1 traps
+      if (node.op == Op::Mod)
+        return 0;
+      if (a == LLONG_MIN)
+        return setError(Error::Fallback, "integer overflow");
+      return -a;
+    }
+    return node.op == Op::Mod ? floorMod(a, b) : floorDiv(a, b);
+  }
+  case Op::Pow: {
+    // square-and-multiply, the exponent is a non-negative constant
+    long long base = evalInt(node.a, ctx);
+    long long result = 1;
+    for (long long e = m_nodes[node.b].value.i; e > 0; e >>= 1) {
+      if ((e & 1) && __builtin_mul_overflow(result, base, &result))
+        return setError(Error::Fallback, "integer overflow");
+      if (e > 1 && __builtin_mul_overflow(base, base, &base))
+        return setError(Error::Fallback, "integer overflow");
+    }
+    return result;
+  }
+  case Op::IfElse:
+    return truth(node.c, ctx) ? evalInt(node.a, ctx) : evalInt(node.b, ctx);
+  case Op::Int: {
+    switch (m_nodes[node.a].type) {
+    case Type::Float: {
+      double const f = std::trunc(evalFloat(node.a, ctx));
+      if (!isInt64(f))
+        return floatToIntError(f);
+      return (long long) f;
+    }
+    case Type::Str: {
+      std::string s;
+      long long value = 0;
+      evalStr(node.a, ctx, s);
+      bool too_large = false;
+      if (m_error == Error::None && !parseInt(s, value, too_large)) {
+        if (too_large) {
+          setError(Error::Fallback, "integer overflow");
+        } else {
+          setError(Error::Value,
+              ("invalid literal for int() with base 10: '" + s + "'").c_str());
+        }
+      }
+      return value;
+    }
+    default:
+      return evalInt(node.a, ctx);
+    }
+  }
+  case Op::Round: {
+    if (m_nodes[node.a].type != Type::Float)
+      return evalInt(node.a, ctx);
+    double const f = std::nearbyint(evalFloat(node.a, ctx));
+    if (!isInt64(f))
+      return floatToIntError(f);
+    return (long long) f;
+  }
+  case Op::Abs: {
+    long long const a = evalInt(node.a, ctx);
+    if (a == LLONG_MIN)
+      return setError(Error::Fallback, "integer overflow");
+    return a < 0 ? -a : a;
+  }
+  case Op::Len: {
+    std::string s;
+    evalStr(node.a, ctx, s);
+    long long len = 0;
+    for (unsigned char c : s) {
+      if ((c & 0xC0) != 0x80) // count UTF-8 code points
+        ++len;
+    }
+    return len;
+  }
+  case Op::Min:
+  case Op::Max: {
+    long long const a = evalInt(node.a, ctx), b = evalInt(node.b, ctx);
+    return (node.op == Op::Min) ? (b < a ? b : a) : (b > a ? b : a);
+  }
+  default:
+    return 0;
+  }
+}
+
+double AtomExpression::evalFloat(int n, const Context& ctx)
+{
+  auto const& node = m_nodes[n];
+
+  if (node.type != Type::Float) {
+    return double(evalInt(n, ctx));
+  }
+
+  switch (node.op) {
+  case Op::Const:
+    return node.value.f;
+  case Op::Prop: {
+    auto const* ap = node.prop;
+    if (ap->Ptype == cPType_xyz_float)
+      return ctx.cs->coordPtr(ctx.idx)[ap->offset];
+    return *member_pointer<float>(ctx.ai, ap->offset);
+  }
+  case Op::Neg:
+    return -evalFloat(node.a, ctx);
+  case Op::Add:
+    return evalFloat(node.a, ctx) + evalFloat(node.b, ctx);
+  case Op::Sub:
+    return evalFloat(node.a, ctx) - evalFloat(node.b, ctx);
+  case Op::Mul:
+    return evalFloat(node.a, ctx) * evalFloat(node.b, ctx);
+  case Op::Div: {
+    double const a = evalFloat(node.a, ctx), b = evalFloat(node.b, ctx);
+    if (b == 0.0)
+      return setError(Error::ZeroDivision, "division by zero");
+    return a / b;
+  }
+  case Op::FloorDiv:
+  case Op::Mod: {
+    double const a = evalFloat(node.a, ctx), b = evalFloat(node.b, ctx);
+    if (b == 0.0)
+      return setError(Error::ZeroDivision, "float modulo or division by zero");
+    double div, mod;
+    floatDivMod(a, b, div, mod);
+    return node.op == Op::Mod ? mod : div;
+  }
+  case Op::Pow: {
+    double const a = evalFloat(node.a, ctx), b = evalFloat(node.b, ctx);
+    if (a == 0.0 && b < 0.0)
+      return setError(Error::ZeroDivision,
+          "0.0 cannot be raised to a negative power");
+    if (a < 0.0 && b != std::floor(b))
+      return setError(Error::Value,
+          "negative number cannot be raised to a fractional power");
+    double const result = std::pow(a, b);
+    if (std::isinf(result) && std::isfinite(a) && std::isfinite(b))
+      return setError(Error::Overflow, "numerical result out of range");
+    return result;
+  }
+  case Op::IfElse:
+    return truth(node.c, ctx) ? evalFloat(node.a, ctx)
+                              : evalFloat(node.b, ctx);
+  case Op::Float: {
+    if (m_nodes[node.a].type != Type::Str)
+      return evalFloat(node.a, ctx);
+    std::string s;
+    double value = 0.0;
+    evalStr(node.a, ctx, s);
+    if (m_error == Error::None && !parseFloat(s, value)) {
+      setError(Error::Value,
+          ("could not convert string to float: '" + s + "'").c_str());
+    }
+    return value;
+  }
+  case Op::Abs:
+    return std::fabs(evalFloat(node.a, ctx));
+  case Op::Min:
+  case Op::Max: {
+    double const a = evalFloat(node.a, ctx), b = evalFloat(node.b, ctx);
+    return (node.op == Op::Min) ? (b < a ? b : a) : (b > a ? b : a);
+  }
+  default:
+    return 0.0;
+  }
+}
+
+void AtomExpression::evalStr(int n, const Context& ctx, std::string& out)
+{
+  auto const& node = m_nodes[n];
+
+  switch (node.op) {
+  case Op::Const:
+    out = node.value.s;
+    break;
+  case Op::Prop: {
+    auto const* ap = node.prop;
+    auto* ai = ctx.ai;
+    switch (ap->Ptype) {
+    case cPType_string:
+      out = member_pointer<char>(ai, ap->offset);
+      break;
+    case cPType_int_as_string:
+      out = LexStr(m_G, *member_pointer<lexidx_t>(ai, ap->offset));
+      break;
+    case cPType_char_as_type:
+      out = ai->hetatm ? "HETATM" : "ATOM";
+      break;
+    case cPType_model:
+      out = ctx.obj->Name;
+      break;
+    default:
+      if (ap->id == ATOM_PROP_RESI) {
+        char resi[8];
+        AtomResiFromResv(resi, sizeof(resi), ai);
+        out = resi;
+      } else {
+        out.assign(1, SeekerGetAbbr(m_G, LexStr(m_G, ai->resn), 'O', 'X'));
+      }
+    }
+  } break;
+  case Op::Add: {
+    std::string b;
+    evalStr(node.a, ctx, out);
+    evalStr(node.b, ctx, b);
+    out += b;
+  } break;
+  case Op::IfElse:
+    evalStr(truth(node.c, ctx) ? node.a : node.b, ctx, out);
+    break;
+  case Op::Str:
+    toStr(node.a, ctx, out);
+    break;
+  case Op::Min:
+  case Op::Max: {
+    std::string b;
+    evalStr(node.a, ctx, out);
+    evalStr(node.b, ctx, b);
+    if ((node.op == Op::Min) ? (b < out) : (b > out))
+      out.swap(b);
+  } break;
+  default:
+    out.clear();
+  }
+}
+
+void AtomExpression::toStr(int n, const Context& ctx, std::string& out)
+{
+  switch (m_nodes[n].type) {
+  case Type::Str:
+    evalStr(n, ctx, out);
+    break;
+  case Type::Float:
+    out = floatRepr(evalFloat(n, ctx));
+    break;
+  case Type::Bool:
+    out = evalInt(n, ctx) ? "True" : "False";
+    break;
+  case Type::Int:
+    out = std::to_string(evalInt(n, ctx));
+    break;
+  }
+}
+
+void AtomExpression::evalValue(int n, const Context& ctx, Value& out)
+{
+  out.type = m_nodes[n].type;
+  switch (out.type) {
+  case Type::Str:
+    evalStr(n, ctx, out.s);
+    break;
+  case Type::Float:
+    out.f = evalFloat(n, ctx);
+    break;
+  default:
+    out.i = evalInt(n, ctx);
+  }
+}
+
+/**
+ * Assignment of an atom property, equivalent to WrapperObjectAssignSubScript
+ */
+void AtomExpression::assign(const Statement& st, const Context& ctx)
+{
+  auto const* ap = st.prop;
+  auto* ai = ctx.ai;
+  int const n = st.value;
+  Type const type = m_nodes[n].type;
+  bool changed = true;
+
+  std::string s;
+  double f = 0.0;
+  long long i = 0;
+
+  // evaluate before modifying anything
+  switch (ap->Ptype) {
+  case cPType_schar:
+  case cPType_int:
+  case cPType_uint32:
+    i = evalInt(n, ctx);
+    if (ap->Ptype == cPType_uint32 && i < 0)
+      setError(Error::Overflow, "can't convert negative int to unsigned");
+    break;
+  case cPType_float:
+  case cPType_xyz_float:
+    if (type == Type::Str) {
+      evalStr(n, ctx, s);
+      if (m_error == Error::None && !parseFloat(s, f))
+        setError(Error::Value,
+            ("could not convert string to float: '" + s + "'").c_str());
+    } else {
+      f = evalFloat(n, ctx);
+    }
+    break;
+  default:
+    if (ap->id == ATOM_PROP_RESI && type != Type::Str &&
+        type != Type::Float) {
+      i = evalInt(n, ctx);
+    } else {
+      toStr(n, ctx, s);
+    }
+  }
+
+  if (m_error != Error::None) {
+    return;
+  }
+
+  switch (ap->Ptype) {
+  case cPType_string: {
+    char* dest = member_pointer<char>(ai, ap->offset);
+    if (s.size() > size_t(ap->maxlen)) {
+      strncpy(dest, s.c_str(), ap->maxlen);
+    } else {
+      strcpy(dest, s.c_str());
+    }
+  } break;
+  case cPType_schar:
+    *member_pointer<signed char>(ai, ap->offset) = i;
+    break;
+  case cPType_int:
+    *member_pointer<int>(ai, ap->offset) = i;
+    break;
+  case cPType_uint32:
+    *member_pointer<uint32_t>(ai, ap->offset) = i;
+    break;
+  case cPType_int_as_string:
+    LexAssign(m_G, *member_pointer<lexidx_t>(ai, ap->offset), s.c_str());
+    break;
+  case cPType_float:
+    *member_pointer<float>(ai, ap->offset) = f;
+    break;
+  case cPType_char_as_type:
+    ai->hetatm = (s[0] == 'h' || s[0] == 'H');
+    break;
+  case cPType_xyz_float:
+    ctx.cs->coordPtr(ctx.idx)[ap->offset] = f;
+    changed = false;
+    break;
+  default: // ATOM_PROP_RESI
+    if (type != Type::Str && type != Type::Float) {
+      ai->resv = i;
+      ai->inscode = '\0';
+    } else {
+      ai->setResi(s.c_str());
+    }
+    changed = false;
+  }
+
+  if (changed) {
+    switch (ap->id) {
+    case ATOM_PROP_ELEM:
+      ai->protons = 0;
+      ai->vdw = 0;
+      AtomInfoAssignParameters(m_G, ai);
+      break;
+    case ATOM_PROP_RESV:
+      ai->inscode = '\0';
+      break;
+    case ATOM_PROP_SS:
+      ai->ssType[0] = toupper(ai->ssType[0]);
+      break;
+    case ATOM_PROP_FORMAL_CHARGE:
+      ai->chemFlag = false;
+      break;
+    }
+  }
+}
+
+bool AtomExpression::eval(
+    ObjectMolecule* obj, CoordSet* cs, int atm, int idx, int state)
+{
+  Context const ctx{obj, cs, obj->AtomInfo + atm, atm, idx, state};
+
+  m_error = Error::None;
+
+  for (size_t i = 0; i < m_statements.size(); ++i) {
+    auto const& st = m_statements[i];
+    if (st.prop) {
+      assign(st, ctx);
+    } else {
+      auto const& node = m_nodes[st.value];
+      bool const sequence = node.op == Op::Tuple || node.op == Op::List;
+      Appended rec{st.target, node.op == Op::Tuple, sequence,
+          unsigned(m_appendedValues.size()), 0};
+      if (sequence) {
+        for (int arg : node.args) {
+          m_appendedValues.emplace_back();
+          evalValue(arg, ctx, m_appendedValues.back());
+        }
+      } else {
+        m_appendedValues.emplace_back();
+        evalValue(st.value, ctx, m_appendedValues.back());
+      }
+      if (m_error != Error::None) {
+        m_appendedValues.resize(rec.begin);
+      } else {
+        rec.end = m_appendedValues.size();
+        m_appended.push_back(rec);
+      }
+    }
+
+    if (m_error != Error::None) {
+      m_fallbackSource = m_source.c_str() + st.source;
+      return false;
+    }
+  }
+
+  return true;
+}
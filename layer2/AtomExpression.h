@@ -0,0 +1,142 @@
+/**
+ * @file
+ * Native evaluator for alter/iterate expressions
+ *
+ * Covers the common subset of the Python expression language which is used
+ * with alter, iterate, alter_state and iterate_state:
+ *
+ *   - assignments (also augmented) of atom properties
+ *   - literals, atom properties and plain (int/float/str) global names
+ *   - arithmetic, comparison, boolean operators, conditional expressions
+ *   - builtins int, float, str, abs, len, min, max, round
+ *   - `name.attr.append(...)` for collecting values into Python lists
+ *
+ * Types are resolved at compile time. Anything which can't be proven to
+ * behave exactly like Python makes compile() fail, so the caller falls back
+ * to the Python interpreter. Ints are 64 bit, results which would need a
+ * Python long make eval() fail with Error::Fallback.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct AtomInfoType;
+struct CoordSet;
+struct ObjectMolecule;
+struct PyMOLGlobals;
+
+class AtomExpression
+{
+public:
+  enum class Type : unsigned char { Bool, Int, Float, Str };
+
+  struct Value {
+    Type type = Type::Int;
+    long long i = 0; //!< Bool and Int
+    double f = 0.0;
+    std::string s;
+  };
+
+  enum class Lookup { NotFound, Found, Unsupported };
+
+  /// Python exception types for runtime errors. `Fallback` is not an error
+  /// in Python (e.g. int overflow), the Python evaluator has to take over.
+  enum class Error { None, ZeroDivision, Value, Overflow, Fallback };
+
+  /**
+   * Access to the Python namespace during compilation
+   */
+  struct Scope {
+    /// Value of a global name
+    std::function<Lookup(const std::string& name, Value& value)> lookup;
+    /// True if `dotted_name.append(...)` may be collected and appended later
+    std::function<bool(const std::string& dotted_name)> canAppend;
+  };
+
+  /**
+   * @param expr Python statement(s)
+   * @param read_only iterate (true) or alter (false)
+   * @param with_state iterate_state/alter_state, x/y/z are available
+   * @return nullptr if the expression is not supported
+   */
+  static std::unique_ptr<AtomExpression> compile(PyMOLGlobals* G,
+      const char* expr, bool read_only, bool with_state, const Scope& scope);
+
+  /**
+   * Evaluates the expression for one atom.
+   *
+   * @param cs Coordinate set (may be null unless compiled `with_state`)
+   * @param idx Coordinate index in `cs` (-1 without state)
+   * @param state State as exposed to the expression (1-based, 0 for none)
+   * Statements before a failing one have been applied, and their appended
+   * values are kept.
+   *
+   * @return false on runtime error, see error() and errorMessage()
+   */
+  bool eval(ObjectMolecule* obj, CoordSet* cs, int atm, int idx, int state);
+
+  Error error() const { return m_error; }
+  const std::string& errorMessage() const { return m_errorMessage; }
+
+  /// Source of the failed statement and all statements after it
+  const char* fallbackSource() const { return m_fallbackSource; }
+
+  /**
+   * Values collected by append statements, in evaluation order
+   */
+  struct Appended {
+    int target;    //!< index into appendTargets()
+    bool tuple;    //!< (a, b) vs. [a, b], only relevant if values > 1
+    bool sequence; //!< tuple/list argument (even with a single value)
+    unsigned begin, end; //!< range in appendedValues()
+  };
+
+  const std::vector<std::string>& appendTargets() const
+  {
+    return m_appendTargets;
+  }
+  const std::vector<Appended>& appended() const { return m_appended; }
+  const std::vector<Value>& appendedValues() const { return m_appendedValues; }
+  void clearAppended();
+
+  /// Python's str(float)
+  static std::string floatRepr(double value);
+
+  ~AtomExpression();
+
+private:
+  AtomExpression() = default;
+
+  enum class Op : unsigned char;
+  struct Node;
+  struct Statement;
+  struct Context;
+  class Parser;
+
+  PyMOLGlobals* m_G = nullptr;
+  std::string m_source;
+  const char* m_fallbackSource = nullptr;
+  std::vector<Node> m_nodes;
+  std::vector<Statement> m_statements;
+  std::vector<std::string> m_appendTargets;
+  std::vector<Appended> m_appended;
+  std::vector<Value> m_appendedValues;
+  Error m_error = Error::None;
+  std::string m_errorMessage;
+
+  bool setError(Error error, const char* message);
+  bool floatToIntError(double f);
+
+  bool evalBool(int n, const Context& ctx);
+  long long evalInt(int n, const Context& ctx);
+  double evalFloat(int n, const Context& ctx);
+  void evalStr(int n, const Context& ctx, std::string& out);
+  void evalValue(int n, const Context& ctx, Value& out);
+  void toStr(int n, const Context& ctx, std::string& out);
+  bool truth(int n, const Context& ctx);
+  void assign(const Statement& st, const Context& ctx);
+};
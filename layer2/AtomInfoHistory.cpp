@@ -95,6 +95,18 @@ void AtomInfoTypeConverter::copy(AtomInfoType *dest, const void *src, int srcver
   }
 }
 
+size_t AtomInfoTypeConverter::sizeofVersion(int version) {
+  switch (version){
+  case 176:
+    return sizeof(AtomInfoType_1_7_6);
+  case 177:
+    return sizeof(AtomInfoType_1_7_7);
+  case 181:
+    return sizeof(AtomInfoType_1_8_1);
+  }
+  return 0;
+}
+
 template <typename D>
 D * AtomInfoTypeConverter::allocCopy(const AtomInfoType *src) {
   D * dest = VLACalloc(D, NAtom);
@@ -273,6 +273,9 @@ public:
   void copy(AtomInfoType * dest, const void *src, int srcversion);
   void * allocCopy(int destversion, const AtomInfoType * src);
 
+  /// Size of one atom record of `version`, 0 for unknown versions
+  static size_t sizeofVersion(int version);
+
   /*
    * For copying Lex strings
    */
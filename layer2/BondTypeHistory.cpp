@@ -92,6 +92,21 @@ void Copy_Into_BondType_From_Version(const void *src, int bondInfo_version, Bond
   }
 }
 
+/*
+ * Size of one bond record of bondInfo_version, 0 for unknown versions
+ */
+size_t Sizeof_BondType_Version(int bondInfo_version){
+  switch (bondInfo_version){
+  case 176:
+    return sizeof(BondType_1_7_6);
+  case 177:
+    return sizeof(BondType_1_7_7);
+  case 181:
+    return sizeof(BondType_1_8_1);
+  }
+  return 0;
+}
+
 void *Copy_To_BondType_Version(int bondInfo_version, BondType *Bond, int NBond){
   switch (bondInfo_version){
   case 176:
@@ -67,4 +67,5 @@ static_assert(sizeof(BondType_1_8_1) == 20,
 
 void Copy_Into_BondType_From_Version(const void *binstr, int bondInfo_version, BondType *Bond, int NBond);
 void *Copy_To_BondType_Version(int bondInfo_version, BondType *Bond, int NBond);
+size_t Sizeof_BondType_Version(int bondInfo_version);
 #endif
@@ -710,6 +710,8 @@ static bool get_assembly_chains(PyMOLGlobals * G,
  * atInfo: atom info array to use for chain check
  * cset: template coordinate set to create assembly coordsets from
  * assembly_id: assembly identifier
+ * instanced: one coordinate set per assembly_gen row, with the operators as
+ *            instances, instead of one transformed copy per operator
  *
  * return: assembly coordinates as VLA of coordinate sets
  */
@@ -718,7 +720,8 @@ CoordSet ** read_pdbx_struct_assembly(PyMOLGlobals * G,
     const pymol::cif_data * data,
     const AtomInfoType * atInfo,
     const CoordSet * cset,
-    const char * assembly_id) {
+    const char * assembly_id,
+    bool instanced) {
 
   const cif_array *arr_id, *arr_assembly_id, *arr_oper_expr, *arr_asym_id_list;
 
@@ -779,6 +782,36 @@ CoordSet ** read_pdbx_struct_assembly(PyMOLGlobals * G,
       }
     }
 
+    if (instanced) {
+      // cartesian product of the operators, in the same order as below
+      std::vector<std::array<float, 16>> matrices(1);
+      identity44f(matrices[0].data());
+
+      for (auto c_it = collection.rbegin(); c_it != collection.rend(); ++c_it) {
+        std::vector<std::array<float, 16>> product;
+        for (auto& s_item : *c_it) {
+          for (auto matrix : matrices) {
+            left_multiply44f44f(oper_list[s_item].data(), matrix.data());
+            product.push_back(matrix);
+          }
+        }
+        matrices = std::move(product);
+      }
+
+      if (!csets) {
+        csets = VLACalloc(CoordSet*, 1);
+      } else {
+        VLASize(csets, CoordSet*, VLAGetSize(csets) + 1);
+      }
+
+      auto* inst_cset = CoordSetCopyFilterChains(cset, atInfo, chains_set);
+      for (auto& matrix : matrices) {
+        CoordSetAppendInstance(inst_cset, matrix.data());
+      }
+      csets[VLAGetSize(csets) - 1] = inst_cset;
+      continue;
+    }
+
     // new coord set VLA
     int ncsets = 1;
     for (const auto& c_item : collection) {
@@ -2224,7 +2257,8 @@ ObjectMolecule *ObjectMoleculeReadCifData(PyMOLGlobals * G,
       " ExecutiveLoad-Detail: Creating assembly '%s'\n", assembly_id ENDFB(G);
 
     CoordSet **assembly_csets = read_pdbx_struct_assembly(G, datablock,
-        I->AtomInfo, cset, assembly_id);
+        I->AtomInfo, cset, assembly_id,
+        SettingGet<bool>(G, cSetting_assembly_instanced));
 
     ObjectMoleculeSetAssemblyCSets(I, assembly_csets);
   }
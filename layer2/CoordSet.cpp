@@ -235,10 +235,31 @@ int CoordSetFromPyList(PyMOLGlobals * G, PyObject * list, CoordSet ** cs)
        Always check ll when adding new PyList_GetItem's */
     if(ok)
       ok = PConvPyIntToInt(PyList_GetItem(list, 0), &I->NIndex);
-    if(ok)
-      ok = PConvPyListToFloatVLA(PyList_GetItem(list, 2), &I->Coord);
+    if(ok) {
+      PyObject* item = PyList_GetItem(list, 2);
+      if (auto section = PConvPyRefToSessionSection(
+              G, item, pymol::SessionSection::Coords)) {
+        ok = section->size == sizeof(float) * 3 * I->NIndex;
+        if (ok) {
+          I->Coord = pymol::vla<float>(3 * I->NIndex);
+          memcpy(I->Coord.data(), section->data, section->size);
+        }
+      } else {
+        ok = PConvPyListToFloatVLA(item, &I->Coord);
+      }
+    }
     if(ok){
-      PConvFromPyListItem(G, list, 3, I->IdxToAtm);
+      PyObject* item = PyList_GetItem(list, 3);
+      if (auto section = PConvPyRefToSessionSection(
+              G, item, pymol::SessionSection::IdxToAtm)) {
+        ok = section->size == sizeof(int) * I->NIndex;
+        if (ok) {
+          auto const* src = static_cast<const int*>(section->data);
+          I->IdxToAtm.assign(src, src + I->NIndex);
+        }
+      } else {
+        PConvFromPyListItem(G, list, 3, I->IdxToAtm);
+      }
     }
     if(ok && (ll > 5))
       ok = CPythonVal_PConvPyStrToStr_From_List(G, list, 5, I->Name, sizeof(WordType));
@@ -309,6 +330,16 @@ int CoordSetFromPyList(PyMOLGlobals * G, PyObject * list, CoordSet ** cs)
       CPythonVal_Free(val);
     }
 
+    if (ll > 13) {
+      CPythonVal* val = CPythonVal_PyList_GetItem(G, list, 13);
+      if (!CPythonVal_IsNone(val) &&
+          (!PConvFromPyObject(G, val, I->Instances) ||
+              I->Instances.size() % 16 != 0)) {
+        I->Instances.clear();
+      }
+      CPythonVal_Free(val);
+    }
+
     if(!ok) {
       delete I;
       *cs = nullptr;
@@ -368,12 +399,18 @@ PyObject *CoordSetAsPyList(CoordSet * I)
     auto G = I->G;
     int pse_export_version = SettingGet<float>(G, cSetting_pse_export_version) * 1000;
     bool dump_binary = SettingGet<bool>(G, cSetting_pse_binary_dump) && (!pse_export_version || pse_export_version >= 1765);
-    result = PyList_New(13);
+    result = PyList_New(14);
     PyList_SetItem(result, 0, PyInt_FromLong(I->NIndex));
     int const NAtIndex = I->AtmToIdx.size();
     PyList_SetItem(result, 1, PyInt_FromLong(NAtIndex ? NAtIndex : I->Obj->NAtom)); // legacy
-    PyList_SetItem(result, 2, PConvFloatArrayToPyList(I->Coord, I->NIndex * 3, dump_binary));
-    PyList_SetItem(result, 3, PConvIntArrayToPyList(I->IdxToAtm.data(), I->NIndex, dump_binary));
+    PyObject* coords = PConvSessionSectionToPyRef(G,
+        pymol::SessionSection::Coords, 0, I->Coord.data(),
+        sizeof(float) * 3 * I->NIndex);
+    PyObject* idx_to_atm = PConvSessionSectionToPyRef(G,
+        pymol::SessionSection::IdxToAtm, 0, I->IdxToAtm.data(),
+        sizeof(int) * I->NIndex);
+    PyList_SetItem(result, 2, coords ? coords : PConvFloatArrayToPyList(I->Coord, I->NIndex * 3, dump_binary));
+    PyList_SetItem(result, 3, idx_to_atm ? idx_to_atm : PConvIntArrayToPyList(I->IdxToAtm.data(), I->NIndex, dump_binary));
     if (!I->AtmToIdx.empty()
         && pse_export_version < 1770)
       PyList_SetItem(result, 4, PConvIntArrayToPyList(I->AtmToIdx.data(), NAtIndex, dump_binary));
@@ -410,6 +447,9 @@ PyObject *CoordSetAsPyList(CoordSet * I)
       PyList_SetItem(result, 11, PConvAutoNone(nullptr));
     }
     PyList_SetItem(result, 12, SymmetryAsPyList(I->Symmetry.get()));
+    PyList_SetItem(result, 13, I->Instances.empty()
+                                   ? PConvAutoNone(nullptr)
+                                   : PConvToPyObject(I->Instances));
     /* TODO spheroid, periodic box ... */
   }
   return (PConvAutoNone(result));
@@ -981,11 +1021,11 @@ void CoordSetAtomToPDBStrVLA(PyMOLGlobals * G, char **charVLA, int *c,
 
   if((!pdb_info) || (!pdb_info->is_pqr_file())) { /* relying upon short-circuit */
     short linelen;
-    sprintf(x, "%8.3f", v[0]);
+    UtilFormatFixed(x, v[0], 8, 3);
     x[8] = 0;
-    sprintf(y, "%8.3f", v[1]);
+    UtilFormatFixed(y, v[1], 8, 3);
     y[8] = 0;
-    sprintf(z, "%8.3f", v[2]);
+    UtilFormatFixed(z, v[2], 8, 3);
     z[8] = 0;
     linelen =
       sprintf((*charVLA) + (*c),
@@ -1519,6 +1559,7 @@ CoordSet::CoordSet(const CoordSet& cs)
   std::copy(std::begin(cs.Name), std::end(cs.Name), std::begin(this->Name));
   this->PeriodicBoxType = cs.PeriodicBoxType;
   this->tmp_index = cs.tmp_index;
+  this->Instances = cs.Instances;
   this->Coord2IdxReq = cs.Coord2IdxReq;
   this->Coord2IdxDiv = cs.Coord2IdxDiv;
   this->objMolOpInvalidated = cs.objMolOpInvalidated;
@@ -118,6 +118,17 @@ struct CoordSet : CObjectState {
   int PeriodicBoxType = NoPeriodicity;
   int tmp_index = 0;                /* for saving */
 
+  /**
+   * Rigid body copies (e.g. symmetry mates or assembly operators) as
+   * row-major 4x4 matrices, 16 values per instance. If not empty, the
+   * representations are built once and rendered for each instance (applied
+   * before the state matrix) instead of at the original coordinates.
+   */
+  std::vector<double> Instances;
+
+  size_t getNInstances() const { return Instances.size() / 16; }
+  const double* getInstanceMatrix(size_t i) const { return Instances.data() + 16 * i; }
+
   /* not saved in state */
 
   pymol::vla<RefPosType> RefPos;
@@ -223,10 +234,6 @@ void CoordSetUpdateCoord2IdxMap(CoordSet * I, float cutoff);
 bool CoordSetFindOpenValenceVector(const CoordSet*, int atm, float* out,
     const float* seek = nullptr, int ignore_atm = -1);
 
-typedef struct _CCoordSetUpdateThreadInfo CCoordSetUpdateThreadInfo;
-
-void CoordSetUpdateThread(CCoordSetUpdateThreadInfo * T);
-
 void LabPosTypeCopy(const LabPosType * src, LabPosType * dst);
 void RefPosTypeCopy(const RefPosType * src, RefPosType * dst);
 
@@ -14,6 +14,7 @@
 #include <mmtf_parser.h>
 
 #include <algorithm>
+#include <map>
 #include <vector>
 
 #include "pymol/zstring_view.h"
@@ -75,8 +76,12 @@ CoordSet ** get_assembly_csets(PyMOLGlobals * G,
   PRINTFB(G, FB_Executive, FB_Details)
     " ExecutiveLoad-Detail: Creating assembly '%s'\n", assembly_id ENDFB(G);
 
+  bool const instanced = SettingGet<bool>(G, cSetting_assembly_instanced);
+  std::map<std::set<lexborrow_t>, CoordSet*> instanced_csets;
+
   int ncsets = assembly->transformListCount;
   CoordSet ** csets = VLACalloc(CoordSet *, ncsets);
+  int n_instanced = 0;
 
   for (int state = 0; state < ncsets; ++state) {
     auto trans = assembly->transformList + state;
@@ -93,11 +98,26 @@ CoordSet ** get_assembly_csets(PyMOLGlobals * G,
       }
     }
 
+    if (instanced) {
+      // one coordinate set per set of chains, transforms become instances
+      auto& inst_cset = instanced_csets[chains_set];
+      if (!inst_cset) {
+        inst_cset = csets[n_instanced++] =
+            CoordSetCopyFilterChains(cset, atInfo, chains_set);
+      }
+      CoordSetAppendInstance(inst_cset, trans->matrix);
+      continue;
+    }
+
     // copy and transform
     csets[state] = CoordSetCopyFilterChains(cset, atInfo, chains_set);
     CoordSetTransform44f(csets[state], trans->matrix);
   }
 
+  if (instanced) {
+    VLASize(csets, CoordSet *, n_instanced);
+  }
+
   return csets;
 }
 #endif
@@ -45,6 +45,7 @@ Z* -------------------------------------------------------------------
 #include"File.h"
 #include"Executive.h"
 #include"Field.h"
+#include "FieldFFT.h"
 #include "Feedback.h"
 #include "Util2.h"
 
@@ -955,6 +956,92 @@ pymol::Result<> ObjectMapHalve(ObjectMap * I, int state, int smooth)
   return {};
 }
 
+/**
+ * Grid geometry of a map state for reciprocal space operations. Crystal maps
+ * which cover exactly one unit cell (including the redundant boundary plane)
+ * are treated as periodic.
+ */
+static pymol::Result<FieldFFTGrid> ObjectMapStateGetFFTGrid(
+    const ObjectMapState* ms)
+{
+  FieldFFTGrid grid;
+  if (ObjectMapStateValidXtal(const_cast<ObjectMapState*>(ms))) {
+    const float* f2r = ms->Symmetry->Crystal.fracToReal();
+    grid.periodic = true;
+    for (int a = 0; a < 3; a++) {
+      for (int b = 0; b < 3; b++) {
+        grid.step[b * 3 + a] = f2r[b * 3 + a] / ms->Div[a];
+      }
+      if (ms->FDim[a] != ms->Div[a] + 1)
+        grid.periodic = false;
+    }
+  } else if (ms->Grid.size() == 3) {
+    std::fill_n(grid.step, 9, 0.f);
+    for (int a = 0; a < 3; a++) {
+      grid.step[a * 3 + a] = ms->Grid[a];
+    }
+  } else {
+    return pymol::make_error("Map has no grid spacing.");
+  }
+  return grid;
+}
+
+static pymol::Result<> ObjectMapStateFFTFilter(
+    PyMOLGlobals* G, ObjectMapState* ms, float bfactor, float resolution)
+{
+  auto grid = ObjectMapStateGetFFTGrid(ms);
+  if (!grid) {
+    return grid.error_move();
+  }
+  FieldFFTFilter(ms->Field->data.get(), *grid, bfactor, resolution,
+      SettingGetGlobal_i(G, cSetting_max_threads));
+  ms->have_range = false;
+  return {};
+}
+
+pymol::Result<> ObjectMapFFTFilter(
+    ObjectMap* I, int state, float bfactor, float resolution)
+{
+  if (state < 0) {
+    for (auto& ms : I->State) {
+      if (ms.Active) {
+        auto result = ObjectMapStateFFTFilter(I->G, &ms, bfactor, resolution);
+        if (!result)
+          return result;
+      }
+    }
+  } else if ((state >= 0) && (state < I->State.size()) &&
+             (I->State[state].Active)) {
+    return ObjectMapStateFFTFilter(
+        I->G, &I->State[state], bfactor, resolution);
+  } else {
+    return pymol::make_error("Invalid state.");
+  }
+  return {};
+}
+
+pymol::Result<float> ObjectMapFFTCorrelation(ObjectMap* I1, int state1,
+    ObjectMap* I2, int state2, float resolution)
+{
+  auto ms1 = I1->getObjectMapState(state1);
+  auto ms2 = I2->getObjectMapState(state2);
+  if (!ms1 || !ms1->Active || !ms2 || !ms2->Active) {
+    return pymol::make_error("Invalid state.");
+  }
+  for (int a = 0; a < 3; a++) {
+    if (ms1->FDim[a] != ms2->FDim[a]) {
+      return pymol::make_error("Maps must have identical grid dimensions.");
+    }
+  }
+  auto grid = ObjectMapStateGetFFTGrid(ms1);
+  if (!grid) {
+    return grid.error_move();
+  }
+  return float(FieldFFTCorrelation(ms1->Field->data.get(),
+      ms2->Field->data.get(), *grid, resolution,
+      SettingGetGlobal_i(I1->G, cSetting_max_threads)));
+}
+
 int ObjectMapStateContainsPoint(ObjectMapState * ms, float *point)
 {
   int result = false;
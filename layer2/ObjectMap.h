@@ -164,6 +164,21 @@ ObjectMap *ObjectMapLoadChemPyMap(PyMOLGlobals * G, ObjectMap * I, PyObject * Ma
 pymol::Result<> ObjectMapDouble(ObjectMap * I, int state);
 pymol::Result<> ObjectMapHalve(ObjectMap * I, int state, int smooth);
 pymol::Result<> ObjectMapTrim(ObjectMap * I, int state, float *mn, float *mx, int quiet);
+
+/**
+ * Reciprocal space (FFT) filter: F(s) *= exp(-B s^2 / 4), truncated at
+ * 1/resolution if resolution > 0. Positive B blurs, negative B sharpens.
+ * @param state map state, or -1 for all states
+ */
+pymol::Result<> ObjectMapFFTFilter(
+    ObjectMap* I, int state, float bfactor, float resolution);
+
+/**
+ * Correlation coefficient of two maps on identical grids, computed in
+ * reciprocal space up to the given resolution (0 = all terms).
+ */
+pymol::Result<float> ObjectMapFFTCorrelation(ObjectMap* I1, int state1,
+    ObjectMap* I2, int state2, float resolution);
 int ObjectMapSetBorder(ObjectMap * I, float level, int state);
 int ObjectMapStateSetBorder(ObjectMapState * I, float level);
 void ObjectMapStatePurge(PyMOLGlobals * G, ObjectMapState * I);
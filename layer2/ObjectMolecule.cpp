@@ -46,6 +46,7 @@ Z* -------------------------------------------------------------------
 #include "Lex.h"
 #include "MolV3000.h"
 #include "HydrogenAdder.h"
+#include "AtomExpression.h"
 #include "Feedback.h"
 #include "Util2.h"
 
@@ -3477,6 +3478,33 @@ int ObjectMoleculeVerifyChemistry(ObjectMolecule * I, int state)
   return (result);
 }
 
+/*========================================================================*/
+/**
+ * ObjectMoleculeVerifyChemistry for many objects, e.g. a multiplexed ligand
+ * library. Objects are independent of each other, so once the bond graphs
+ * (neighbor arrays) are built, chemistry is inferred in parallel.
+ *
+ * @param objs Objects, may contain duplicates
+ * @param state Same as for ObjectMoleculeVerifyChemistry
+ */
+void ObjectMoleculeVerifyChemistryBatch(
+    const std::vector<ObjectMolecule*>& objs, int state)
+{
+  std::vector<ObjectMolecule*> todo(objs);
+  std::sort(todo.begin(), todo.end());
+  todo.erase(std::unique(todo.begin(), todo.end()), todo.end());
+
+  for (auto* obj : todo) {
+    // lazy neighbor array must not be built inside the parallel region
+    obj->getNeighborArray();
+  }
+
+#pragma omp parallel for schedule(dynamic) if (todo.size() > 1)
+  for (int i = 0; i < int(todo.size()); ++i) {
+    ObjectMoleculeVerifyChemistry(todo[i], state);
+  }
+}
+
 
 /*========================================================================*/
 int ObjectMoleculeAttach(ObjectMolecule * I, int index,
@@ -4798,6 +4826,145 @@ typedef struct {
   int cyclic, planer, aromatic;
 } ObservedInfo;
 
+/*
+ * True if all atoms and bonds of the ring are already flagged planer, so
+ * that another look at the ring geometry cannot add anything. Each ring is
+ * found once per member and direction.
+ */
+static bool ring_is_planer(const ObservedInfo* obs_atom,
+    const ObservedInfo* obs_bond, const int* neighbor, int n_atom,
+    const int* mem, const int* nbr)
+{
+  for(int i = 0; i < n_atom; i++) {
+    if(!obs_atom[mem[i]].planer || !obs_bond[neighbor[nbr[i] + 1]].planer)
+      return false;
+  }
+  return true;
+}
+
+/*
+ * Flags atoms and bonds of the five- and six-cycles through atom "a" as
+ * cyclic, and as planer if the ring is flat. Only atoms and bonds of the
+ * molecule (connected component) which contains "a" are touched.
+ *
+ * @return false if the search was given up (unreasonable connectivity)
+ */
+static bool guess_valences_observe_rings(ObjectMolecule* I, CoordSet* cs,
+    const int* neighbor, int a, ObservedInfo* obs_atom, ObservedInfo* obs_bond)
+{
+  const float planer_cutoff = 0.96F;
+
+/* WORKAROUND of a possible -funroll-loops inlining optimizer bug in gcc 3.3.3 */
+
+  float (*compute_avg_ring_dot_cross) (ObjectMolecule *, CoordSet *, int, int *, float *);
+
+  compute_avg_ring_dot_cross = compute_avg_ring_dot_cross_fn;
+
+/* end WORKAROUND */
+
+  /*  determine whether or not atom participates in a planer system with 5 or 6 atoms */
+
+  {
+    int mem[9];
+    int nbr[7];
+    const int ESCAPE_MAX = 500;
+
+    const int* atmToIdx = I->DiscreteFlag ? nullptr : cs->AtmToIdx.data();
+
+    int escape_count = ESCAPE_MAX;    /* don't get bogged down with structures 
+                                     that have unreasonable connectivity */
+    mem[0] = a;
+    nbr[0] = neighbor[mem[0]] + 1;
+    while(((mem[1] = neighbor[nbr[0]]) >= 0) &&
+          ((!atmToIdx) || (atmToIdx[mem[0]] >= 0))) {
+      nbr[1] = neighbor[mem[1]] + 1;
+      while(((mem[2] = neighbor[nbr[1]]) >= 0) &&
+            ((!atmToIdx) || (atmToIdx[mem[1]] >= 0))) {
+        if(mem[2] != mem[0]) {
+          nbr[2] = neighbor[mem[2]] + 1;
+          while(((mem[3] = neighbor[nbr[2]]) >= 0) &&
+                ((!atmToIdx) || (atmToIdx[mem[2]] >= 0))) {
+            if(mem[3] != mem[1]) {
+              nbr[3] = neighbor[mem[3]] + 1;
+              while(((mem[4] = neighbor[nbr[3]]) >= 0) &&
+                    ((!atmToIdx) || (atmToIdx[mem[3]] >= 0))) {
+                if((mem[4] != mem[2]) && (mem[4] != mem[1]) && (mem[4] != mem[0])) {
+                  nbr[4] = neighbor[mem[4]] + 1;
+                  while(((mem[5] = neighbor[nbr[4]]) >= 0) &&
+                        ((!atmToIdx) || (atmToIdx[mem[4]] >= 0))) {
+                    if(!(escape_count--))
+                      return false;
+                    if((mem[5] != mem[3]) && (mem[5] != mem[2])
+                       && (mem[5] != mem[1])) {
+                      if(mem[5] == mem[0]) {      /* five-cycle */
+                        int i;
+                        for(i = 0; i < 5; i++) {
+                          obs_atom[mem[i]].cyclic = true;
+                          obs_bond[neighbor[nbr[0] + 1]].cyclic = true;
+                        }
+                        if(!ring_is_planer(obs_atom, obs_bond, neighbor, 5, mem, nbr)) {
+                          float dir[] = { 0.f, 0.f, 0.f } ;
+                          float avg_dot_cross =
+                            compute_avg_ring_dot_cross(I, cs, 5, mem, dir);
+                          if(avg_dot_cross > planer_cutoff) {
+                            if(verify_planer_bonds
+                               (I, cs, 5, mem, neighbor, dir, 0.35F)) {
+                              for(i = 0; i < 5; i++) {
+                                obs_atom[mem[i]].planer = true;
+                                obs_bond[neighbor[nbr[i] + 1]].planer = true;
+                              }
+                            }
+                          }
+                        }
+                      }
+
+                      nbr[5] = neighbor[mem[5]] + 1;
+                      while(((mem[6] = neighbor[nbr[5]]) >= 0) &&
+                            ((!atmToIdx) || (atmToIdx[mem[5]] >= 0))) {
+                        if((mem[6] != mem[4]) && (mem[6] != mem[3])
+                           && (mem[6] != mem[2]) && (mem[6] != mem[1])) {
+                          if(mem[6] == mem[0]) {  /* six-cycle */
+                            int i;
+                            for(i = 0; i < 6; i++) {
+                              obs_atom[mem[i]].cyclic = true;
+                              obs_bond[neighbor[nbr[i] + 1]].cyclic = true;
+                            }
+                            if(!ring_is_planer(obs_atom, obs_bond, neighbor, 6, mem, nbr)) {
+                              float dir[3] = { 0.f, 0.f, 0.f } ;
+                              float avg_dot_cross =
+                                compute_avg_ring_dot_cross(I, cs, 6, mem, dir);
+                              if(avg_dot_cross > planer_cutoff) {
+                                if(verify_planer_bonds
+                                   (I, cs, 6, mem, neighbor, dir, 0.35F)) {
+                                  for(i = 0; i < 6; i++) {
+                                    obs_atom[mem[i]].planer = true;
+                                    obs_bond[neighbor[nbr[i] + 1]].planer = true;
+                                  }
+                                }
+                              }
+                            }
+                          }
+                        }
+                        nbr[5] += 2;
+                      }
+                    }
+                    nbr[4] += 2;
+                  }
+                }
+                nbr[3] += 2;
+              }
+            }
+            nbr[2] += 2;
+          }
+        }
+        nbr[1] += 2;
+      }
+      nbr[0] += 2;
+    }
+  }
+  return true;
+}
+
 void ObjectMoleculeGuessValences(ObjectMolecule * I, int state, int *flag1, int *flag2,
                                  int reset)
 {
@@ -4814,10 +4981,8 @@ void ObjectMoleculeGuessValences(ObjectMolecule * I, int state, int *flag1, int
 /* WORKAROUND of a possible -funroll-loops inlining optimizer bug in gcc 3.3.3 */
 
   float (*compute_avg_center_dot_cross) (ObjectMolecule *, CoordSet *, int, int *);
-  float (*compute_avg_ring_dot_cross) (ObjectMolecule *, CoordSet *, int, int *, float *);
 
   compute_avg_center_dot_cross = compute_avg_center_dot_cross_fn;
-  compute_avg_ring_dot_cross = compute_avg_ring_dot_cross_fn;
 
 
 /* end WORKAROUND */
@@ -4883,111 +5048,46 @@ void ObjectMoleculeGuessValences(ObjectMolecule * I, int state, int *flag1, int
     AtomInfoType *atomInfo = I->AtomInfo.data();
     BondType *bondInfo = I->Bond.data();
 
-    for(a = 0; a < I->NAtom; a++) {
-      AtomInfoType *ai = atomInfo + a;
-      if((!ai->chemFlag) && (flag[a])) {
-        /*  determine whether or not atom participates in a planer system with 5 or 6 atoms */
-
-        {
-          int mem[9];
-          int nbr[7];
-          const int ESCAPE_MAX = 500;
-
-          const int* atmToIdx = I->DiscreteFlag ? nullptr : cs->AtmToIdx.data();
-
-          int escape_count = ESCAPE_MAX;    /* don't get bogged down with structures 
-                                           that have unreasonable connectivity */
-          mem[0] = a;
-          nbr[0] = neighbor[mem[0]] + 1;
-          while(((mem[1] = neighbor[nbr[0]]) >= 0) &&
-                ((!atmToIdx) || (atmToIdx[mem[0]] >= 0))) {
-            nbr[1] = neighbor[mem[1]] + 1;
-            while(((mem[2] = neighbor[nbr[1]]) >= 0) &&
-                  ((!atmToIdx) || (atmToIdx[mem[1]] >= 0))) {
-              if(mem[2] != mem[0]) {
-                nbr[2] = neighbor[mem[2]] + 1;
-                while(((mem[3] = neighbor[nbr[2]]) >= 0) &&
-                      ((!atmToIdx) || (atmToIdx[mem[2]] >= 0))) {
-                  if(mem[3] != mem[1]) {
-                    nbr[3] = neighbor[mem[3]] + 1;
-                    while(((mem[4] = neighbor[nbr[3]]) >= 0) &&
-                          ((!atmToIdx) || (atmToIdx[mem[3]] >= 0))) {
-                      if((mem[4] != mem[2]) && (mem[4] != mem[1]) && (mem[4] != mem[0])) {
-                        nbr[4] = neighbor[mem[4]] + 1;
-                        while(((mem[5] = neighbor[nbr[4]]) >= 0) &&
-                              ((!atmToIdx) || (atmToIdx[mem[4]] >= 0))) {
-                          if(!(escape_count--))
-                            goto escape;
-                          if((mem[5] != mem[3]) && (mem[5] != mem[2])
-                             && (mem[5] != mem[1])) {
-                            if(mem[5] == mem[0]) {      /* five-cycle */
-                              int i;
-                              float dir[] = { 0.f, 0.f, 0.f } ;
-                              float avg_dot_cross =
-                                compute_avg_ring_dot_cross(I, cs, 5, mem, dir);
-                              for(i = 0; i < 5; i++) {
-                                obs_atom[mem[i]].cyclic = true;
-                                obs_bond[neighbor[nbr[0] + 1]].cyclic = true;
-                              }
-                              if(avg_dot_cross > planer_cutoff) {
-                                if(verify_planer_bonds
-                                   (I, cs, 5, mem, neighbor, dir, 0.35F)) {
-                                  for(i = 0; i < 5; i++) {
-                                    obs_atom[mem[i]].planer = true;
-                                    obs_bond[neighbor[nbr[i] + 1]].planer = true;
-                                  }
-                                }
-                              }
-                            }
-
-                            nbr[5] = neighbor[mem[5]] + 1;
-                            while(((mem[6] = neighbor[nbr[5]]) >= 0) &&
-                                  ((!atmToIdx) || (atmToIdx[mem[5]] >= 0))) {
-                              if((mem[6] != mem[4]) && (mem[6] != mem[3])
-                                 && (mem[6] != mem[2]) && (mem[6] != mem[1])) {
-                                if(mem[6] == mem[0]) {  /* six-cycle */
-                                  int i;
-                                  float dir[3] = { 0.f, 0.f, 0.f } ;
-                                  float avg_dot_cross =
-                                    compute_avg_ring_dot_cross(I, cs, 6, mem, dir);
-                                  for(i = 0; i < 6; i++) {
-                                    obs_atom[mem[i]].cyclic = true;
-                                    obs_bond[neighbor[nbr[i] + 1]].cyclic = true;
-                                  }
-                                  if(avg_dot_cross > planer_cutoff) {
-                                    if(verify_planer_bonds
-                                       (I, cs, 6, mem, neighbor, dir, 0.35F)) {
-                                      for(i = 0; i < 6; i++) {
-                                        obs_atom[mem[i]].planer = true;
-                                        obs_bond[neighbor[nbr[i] + 1]].planer = true;
-                                      }
-                                    }
-                                  }
-                                }
-                              }
-                              nbr[5] += 2;
-                            }
-                          }
-                          nbr[4] += 2;
-                        }
-                      }
-                      nbr[3] += 2;
-                    }
-                  }
-                  nbr[2] += 2;
-                }
-              }
-              nbr[1] += 2;
+    /* ring perception dominates the run time. Rings never span two
+       molecules, so molecules (connected components) are searched in
+       parallel, each atom in the same order as before. */
+    std::vector<int> starts, comp_start;
+    {
+      std::vector<bool> visited(I->NAtom);
+      std::vector<int> members;
+      for(a = 0; a < I->NAtom; a++) {
+        if(visited[a] || atomInfo[a].chemFlag || !flag[a])
+          continue;
+        members.assign(1, a);
+        visited[a] = true;
+        for(size_t m = 0; m < members.size(); m++) {
+          int n = neighbor[members[m]] + 1;
+          int a1;
+          while((a1 = neighbor[n]) >= 0) {
+            n += 2;
+            if(!visited[a1]) {
+              visited[a1] = true;
+              members.push_back(a1);
             }
-            nbr[0] += 2;
           }
-
-        escape:
-          escape_count = ESCAPE_MAX;    /* don't get bogged down with structures 
-                                           that have unreasonable connectivity */
-	  warning1 = 1;
+        }
+        std::sort(members.begin(), members.end());
+        comp_start.push_back(starts.size());
+        for(int a1 : members) {
+          if((!atomInfo[a1].chemFlag) && flag[a1])
+            starts.push_back(a1);
         }
       }
+      comp_start.push_back(starts.size());
+    }
+
+#pragma omp parallel for schedule(dynamic) reduction(|:warning1) \
+    if (comp_start.size() > 2)
+    for(int c = 0; c < int(comp_start.size()) - 1; c++) {
+      for(int i = comp_start[c]; i < comp_start[c + 1]; i++) {
+        if(!guess_valences_observe_rings(I, cs, neighbor, starts[i], obs_atom, obs_bond))
+          warning1 = 1;
+      }
     }
 
     for(a = 0; a < I->NAtom; a++) {
@@ -9012,7 +9112,9 @@ bool ObjectMoleculeSeleOp(ObjectMolecule * I, int sele, ObjectMoleculeOpRec * op
     case OMOP_AlterState:
       // assume blocked interpreter
 
-      if (op->s1 && op->s1[0]){
+      if (op->atom_expr) {
+        // compiled for native evaluation
+      } else if (op->s1 && op->s1[0]){
 #ifndef _PYMOL_NOPY
 	expr_co = Py_CompileString(op->s1, "", compileType);
 	if(expr_co == nullptr) {
@@ -9738,9 +9840,15 @@ bool ObjectMoleculeSeleOp(ObjectMolecule * I, int sele, ObjectMoleculeOpRec * op
                 if((cs = i_CSet[b]))
                   a1 = cs->AtmToIdx[a];
               }
-              if(cs && (a1 >= 0)) {
+              /* with instances, the transformed extent covers all copies */
+              size_t const n_inst = (cs && op_i2) ? cs->getNInstances() : 0;
+              for(size_t inst = 0; cs && (a1 >= 0) && (inst == 0 || inst < n_inst); ++inst) {
                 coord = cs->coordPtr(a1);
                 if(op_i2) {     /* do we want transformed coordinates? */
+                  if(n_inst) {
+                    transform44d3f(cs->getInstanceMatrix(inst), coord, v1);
+                    coord = v1;
+                  }
                   if(use_matrices) {
                     if(!cs->Matrix.empty()) {      /* state transformation */
                       transform44d3f(cs->Matrix.data(), coord, v1);
@@ -9952,6 +10060,16 @@ bool ObjectMoleculeSeleOp(ObjectMolecule * I, int sele, ObjectMoleculeOpRec * op
 		  } else if (I->NCSet == 1){
 		    cs = I->CSet[0];
 		  }
+                  if (op->atom_expr) {
+                    int const state = I->DiscreteFlag ? ai->discrete_state : 0;
+                    if (PAtomExpressionEval(G, op->atom_expr, I, cs, a, -1,
+                            state - 1, op->i2, op->py_ob1)) {
+                      op->i1++;
+                    } else {
+                      ok = false;
+                    }
+                    break;
+                  }
 #ifndef _PYMOL_NOPY
                   if(PAlterAtom
                      (I->G, I, cs, expr_co, op->i2, a,
@@ -9970,7 +10088,15 @@ bool ObjectMoleculeSeleOp(ObjectMolecule * I, int sele, ObjectMoleculeOpRec * op
                     cs = I->CSet[op->i2];
                     if(cs) {
                       a1 = cs->atmToIdx(a);
-                      if(a1 >= 0) {
+                      if(a1 >= 0 && op->atom_expr) {
+                        if (PAtomExpressionEval(G, op->atom_expr, I, cs, a, a1,
+                                op->i2, op->i3, op->py_ob1)) {
+                          op->i1++;
+                          hit_flag = true;
+                        } else {
+                          ok = false;
+                        }
+                      } else if(a1 >= 0) {
 #ifndef _PYMOL_NOPY
                         if(PAlterAtomState(I->G, expr_co, op->i3,
                                            I, cs, a, a1, op->i2, op->py_ob1)) {
@@ -10505,54 +10631,12 @@ int ObjectMolecule::getNFrame() const
   return NCSet;
 }
 
-struct _CCoordSetUpdateThreadInfo {
-  CoordSet *cs;
-  int a;
-};
-
-void CoordSetUpdateThread(CCoordSetUpdateThreadInfo * T)
-{
-  if(T->cs) {
-    T->cs->update(T->a);
-  }
-}
-
-#ifndef _PYMOL_NOPY
-static void ObjMolCoordSetUpdateSpawn(PyMOLGlobals * G,
-                                      CCoordSetUpdateThreadInfo * Thread, int n_thread,
-                                      int n_total)
-{
-  if(n_total == 1) {
-    CoordSetUpdateThread(Thread);
-  } else if(n_total) {
-    int blocked;
-    PyObject *info_list;
-    int a, n = 0;
-    blocked = PAutoBlock(G);
-
-    PRINTFB(G, FB_Scene, FB_Blather)
-      " Scene: updating coordinate sets with %d threads...\n", n_thread ENDFB(G);
-    info_list = PyList_New(n_total);
-    for(a = 0; a < n_total; a++) {
-      PyList_SetItem(info_list, a, PyCapsule_New(Thread + a, nullptr, nullptr));
-      n++;
-    }
-    PXDecRef(PYOBJECT_CALLMETHOD
-             (G->P_inst->cmd, "_coordset_update_spawn", "Oi", info_list, n_thread));
-    Py_DECREF(info_list);
-    PAutoUnblock(G, blocked);
-  }
-}
-#endif
-
-
 /*========================================================================*/
-void ObjectMolecule::update()
+std::vector<int> ObjectMolecule::getStatesToUpdate()
 {
   auto I = this;
-  int a; /*, ok; */
+  int a;
 
-  OrthoBusyPrime(G);
   /* if the cached representation is invalid, reset state */
   if(!I->RepVisCacheValid) {
     /* note which representations are active */
@@ -10571,69 +10655,69 @@ void ObjectMolecule::update()
     }
     I->RepVisCacheValid = true;
   }
-  {
-    /* determine the start/stop states */
-    int start = 0;
-    int stop = I->NCSet;
-    /* set start and stop given an object */
-    ObjectAdjustStateRebuildRange(I, &start, &stop);
-    if((I->NCSet == 1)
-       && (SettingGet_b(G, I->Setting.get(), nullptr, cSetting_static_singletons))) {
-      start = 0;
-      stop = 1;
-    }
-    if(stop > I->NCSet)
-      stop = I->NCSet;
 
-    /* single and multithreaded coord set updates */
-    {
-#ifndef _PYMOL_NOPY
-      int n_thread = SettingGetGlobal_i(G, cSetting_max_threads);
-      int multithread = SettingGetGlobal_i(G, cSetting_async_builds);
+  /* determine the start/stop states */
+  int start = 0;
+  int stop = I->NCSet;
+  /* set start and stop given an object */
+  ObjectAdjustStateRebuildRange(I, &start, &stop);
+  if((I->NCSet == 1)
+     && (SettingGet_b(G, I->Setting.get(), nullptr, cSetting_static_singletons))) {
+    start = 0;
+    stop = 1;
+  }
+  if(stop > I->NCSet)
+    stop = I->NCSet;
+
+  std::vector<int> states;
+  for(a = start; a < stop; a++) {
+    if(I->CSet[a])
+      states.push_back(a);
+  }
 
-      if(multithread && (n_thread) && (stop - start) > 1) {
-        int cnt = 0;
+  if(states.size() > 1) {
+    /* must precalculate to avoid race-condition since this isn't
+       mutexed yet and neighbors are needed by cartoons */
+    this->getNeighborArray();
+  }
 
-        /* must precalculate to avoid race-condition since this isn't
-           mutexed yet and neighbors are needed by cartoons */
-        this->getNeighborArray();
+  return states;
+}
 
-        for(a = start; a < stop; a++)
-          if((a<I->NCSet) && I->CSet[a])
-            cnt++;
-        {
-          CCoordSetUpdateThreadInfo *thread_info = pymol::malloc<CCoordSetUpdateThreadInfo>(cnt);
-          if(thread_info) {
-            cnt = 0;
-            for(a = start; a < stop; a++) {
-              if((a<I->NCSet) && I->CSet[a]) {
-                thread_info[cnt].cs = I->CSet[a];
-                thread_info[cnt].a = a;
-                cnt++;
-              }
-            }
-            ObjMolCoordSetUpdateSpawn(G, thread_info, n_thread, cnt);
-            FreeP(thread_info);
-          }
+/*========================================================================*/
+void ObjectMolecule::update()
+{
+  auto I = this;
 
-        }
+  OrthoBusyPrime(G);
 
-      } else
+  auto const states = getStatesToUpdate();
+
+  /* single and multithreaded coord set updates */
+#ifndef _PYMOL_NOPY
+  int n_thread = SettingGetGlobal_i(G, cSetting_max_threads);
+  int multithread = SettingGetGlobal_i(G, cSetting_async_builds);
+
+  if(multithread && n_thread > 1 && states.size() > 1) {
+    PRINTFB(G, FB_Scene, FB_Blather)
+      " Scene: updating coordinate sets with %d threads...\n", n_thread ENDFB(G);
+    PRunParallel(G, n_thread, states.size(), [&](size_t i) {
+      I->CSet[states[i]]->update(states[i]);
+    });
+  } else
 #endif
-      {                         /* single thread */
-        for(a = start; a < stop; a++) {
-          if((a<I->NCSet) && I->CSet[a] && (!G->Interrupt)) {
-	    /* status bar */
-            OrthoBusySlow(G, a, I->NCSet);
-            PRINTFB(G, FB_ObjectMolecule, FB_Blather)
-              " ObjectMolecule-DEBUG: updating representations for state %d of \"%s\".\n",
-              a + 1, I->Name ENDFB(G);
-            I->CSet[a]->update(a);
-          }
-        }
-      }
+  {                             /* single thread */
+    for(int a : states) {
+      if(G->Interrupt)
+        break;
+      /* status bar */
+      OrthoBusySlow(G, a, I->NCSet);
+      PRINTFB(G, FB_ObjectMolecule, FB_Blather)
+        " ObjectMolecule-DEBUG: updating representations for state %d of \"%s\".\n",
+        a + 1, I->Name ENDFB(G);
+      I->CSet[a]->update(a);
     }
-  } /* end block */
+  }
 
   PRINTFD(G, FB_ObjectMolecule)
     " ObjectMolecule: updates complete for object %s.\n", I->Name ENDFD;
@@ -11047,7 +11131,19 @@ void ObjectMolecule::render(RenderInfo * info)
 
   for(StateIterator iter(G, I->Setting.get(), state, I->NCSet); iter.next();) {
     cs = I->CSet[iter.state];
-    if(cs) {
+    if(cs && cs->getNInstances()) {
+      /* one set of representations, rendered for each instance */
+      for(size_t i = 0, n = cs->getNInstances(); i < n; ++i) {
+        double matrix[16];
+        copy44d(cs->getInstanceMatrix(i), matrix);
+        if(use_matrices && !cs->Matrix.empty())
+          left_multiply44d44d(cs->Matrix.data(), matrix);
+        pop_matrix = ObjectPushAndApplyMatrix(G, info, matrix);
+        cs->render(info);
+        if(pop_matrix)
+          ObjectPopMatrix(G, info);
+      }
+    } else if(cs) {
       if(use_matrices)
         pop_matrix = ObjectStatePushAndApplyMatrix(cs, info);
       cs->render(info);
@@ -46,6 +46,8 @@ Z* -------------------------------------------------------------------
 #define cUndoMask 0xF
 enum cLoadType_t : int;
 
+class AtomExpression;
+
 /**
  * ObjectMolecule's Bond Path (BP) Record
  */
@@ -116,6 +118,13 @@ public:
 
   // virtual methods
   void update() override;
+
+  /**
+   * Prepares for a representation update and returns the states which need
+   * to be updated. CoordSet::update() can then be called concurrently for
+   * those states.
+   */
+  std::vector<int> getStatesToUpdate();
   void render(RenderInfo* info) override;
   void invalidate(cRep_t rep, cRepInv_t level, int state) override;
   int getNFrame() const override;
@@ -149,6 +158,7 @@ struct ObjectMoleculeOpRec {
   float ttt[16], *mat1;
   int nvv1, nvv2;
   int include_static_singletons;
+  AtomExpression* atom_expr; //!< native alternative to s1 for OMOP_ALTR/OMOP_AlterState
 };
 
 struct HBondCriteria{
@@ -417,6 +427,8 @@ int ObjectMoleculePreposReplAtom(ObjectMolecule * I, int index, AtomInfoType * a
 void ObjectMoleculeCreateSpheroid(ObjectMolecule * I, int average);
 int ObjectMoleculeSetAtomVertex(ObjectMolecule * I, int state, int index, float *v);
 int ObjectMoleculeVerifyChemistry(ObjectMolecule * I, int state);
+void ObjectMoleculeVerifyChemistryBatch(
+    const std::vector<ObjectMolecule*>& objs, int state);
 int ObjectMoleculeFillOpenValences(ObjectMolecule * I, int index);
 int ObjectMoleculeAdjustBonds(ObjectMolecule * I, int sele0, int sele1, int mode,
                               int order, pymol::zstring_view symop = "");
@@ -2975,7 +2975,7 @@ int ObjectMoleculeGetCheckHBond(AtomInfoType **h_real,
           vAccPlane = &accPlane[0];
         }
         result = ObjectMoleculeTestHBond(donToAcc, donToH, hToAcc, vAccPlane, hbc);
-        if(result && h_crd_ret && h_real && *h_real)
+        if(result && h_crd_ret)
           copy3f(bestH, h_crd_ret);
       }
     }
@@ -3070,9 +3070,12 @@ static PyObject *ObjectMoleculeBondAsPyList(ObjectMolecule * I)
     auto blob = Copy_To_BondType_Version(version, I->Bond.data(), I->NBond);
     auto blobsize = VLAGetByteSize(blob);
 
+    PyObject* blobref = PConvSessionSectionToPyRef(
+        G, pymol::SessionSection::Bonds, version, blob, blobsize);
+
     result = PyList_New(2);
     PyList_SetItem(result, 0, PyInt_FromLong(version));
-    PyList_SetItem(result, 1, PyBytes_FromStringAndSize(reinterpret_cast<const char*>(blob), blobsize));
+    PyList_SetItem(result, 1, blobref ? blobref : PyBytes_FromStringAndSize(reinterpret_cast<const char*>(blob), blobsize));
 
     VLAFreeP(blob);
 
@@ -3116,12 +3119,14 @@ static int ObjectMoleculeBondFromPyList(ObjectMolecule * I, PyObject * list)
     ll = PyList_Size(list);
 
   bool pse_binary_dump = false;
+  const pymol::SessionFile::Section* section = nullptr;
 
   if (ll >= 2) {
     // checking if from pse_binary_dump
     // pse_binary_dump saves 2 values: bondInfo_version, BondType binary
     CPythonVal *val1 = CPythonVal_PyList_GetItem(G, list, 1);
-    pse_binary_dump = PyBytes_Check(val1);
+    section = PConvPyRefToSessionSection(G, val1, pymol::SessionSection::Bonds);
+    pse_binary_dump = section || PyBytes_Check(val1);
     CPythonVal_Free(val1);
   }
   if (pse_binary_dump){
@@ -3130,12 +3135,39 @@ static int ObjectMoleculeBondFromPyList(ObjectMolecule * I, PyObject * list)
     ok = PConvPyIntToInt(verobj, &bondInfo_version);
 
     CPythonVal *strobj = CPythonVal_PyList_GetItem(G, list, 1);
-    auto strval = PyBytes_AsSomeString(strobj);
+    auto strval = section ? SomeString(static_cast<const char*>(section->data),
+                                section->size)
+                          : PyBytes_AsSomeString(strobj);
+
+    // sections come straight from the file, check them before copying
+    if (ok && section) {
+      ok = section->version == unsigned(bondInfo_version) && I->NBond >= 0 &&
+           section->size == Sizeof_BondType_Version(bondInfo_version) *
+                                size_t(I->NBond);
+      if (!ok) {
+        PRINTFB(G, FB_ObjectMolecule, FB_Errors)
+          " Error: bond section size does not match %d bonds\n", I->NBond
+          ENDFB(G);
+      }
+    }
 
     if(ok)
       ok = bool((I->Bond = pymol::vla<BondType>(I->NBond)));
 
-    Copy_Into_BondType_From_Version(strval.data(), bondInfo_version, I->Bond.data(), I->NBond);
+    if (ok)
+      Copy_Into_BondType_From_Version(strval.data(), bondInfo_version, I->Bond.data(), I->NBond);
+
+    if (ok && section) {
+      for (a = 0; ok && a < I->NBond; ++a) {
+        auto const* index = I->Bond[a].index;
+        ok = index[0] >= 0 && index[0] < I->NAtom && index[1] >= 0 &&
+             index[1] < I->NAtom;
+      }
+      if (!ok) {
+        PRINTFB(G, FB_ObjectMolecule, FB_Errors)
+          " Error: bond section has atom indices out of range\n" ENDFB(G);
+      }
+    }
 
     CPythonVal_Free(verobj);
     CPythonVal_Free(strobj);
@@ -3333,10 +3365,17 @@ static PyObject *ObjectMoleculeAtomAsPyList(ObjectMolecule * I)
     }
 #endif
 
+    PyObject* blobref = PConvSessionSectionToPyRef(
+        G, pymol::SessionSection::AtomInfo, version, blob, blobsize);
+    PyObject* strinforef = blobref ? PConvSessionSectionToPyRef(G,
+                                         pymol::SessionSection::AtomStrings,
+                                         0, strinfo, strinfolen)
+                                   : nullptr;
+
     result = PyList_New(result_size);
     PyList_SetItem(result, 0, PyInt_FromLong(version));
-    PyList_SetItem(result, 1, PyBytes_FromStringAndSize(reinterpret_cast<const char*>(blob), blobsize));
-    PyList_SetItem(result, 2, PyBytes_FromStringAndSize(reinterpret_cast<const char*>(strinfo), strinfolen));
+    PyList_SetItem(result, 1, blobref ? blobref : PyBytes_FromStringAndSize(reinterpret_cast<const char*>(blob), blobsize));
+    PyList_SetItem(result, 2, strinforef ? strinforef : PyBytes_FromStringAndSize(reinterpret_cast<const char*>(strinfo), strinfolen));
 
     if (result_size > 3) {
       PyList_SetItem(result, 3, PConvAutoNone(prop_list));
@@ -3369,13 +3408,18 @@ static int ObjectMoleculeAtomFromPyList(ObjectMolecule * I, PyObject * list)
     ll = PyList_Size(list);
 
   bool pse_binary_dump = false;
+  const pymol::SessionFile::Section* section = nullptr;
+  const pymol::SessionFile::Section* strsection = nullptr;
 
   if (ll >= 3) {
     // checking if from pse_binary_dump
     // pse_binary_dump saves 3 values: atomInfo_version, AtomInfo binary, and strings array
     CPythonVal *val1 = CPythonVal_PyList_GetItem(G, list, 1);
     CPythonVal *val2 = CPythonVal_PyList_GetItem(G, list, 2);
-    pse_binary_dump = PyBytes_Check(val1) && PyBytes_Check(val2);
+    section = PConvPyRefToSessionSection(G, val1, pymol::SessionSection::AtomInfo);
+    strsection = PConvPyRefToSessionSection(G, val2, pymol::SessionSection::AtomStrings);
+    pse_binary_dump = (section || PyBytes_Check(val1)) &&
+                      (strsection || PyBytes_Check(val2));
     CPythonVal_Free(val1);
     CPythonVal_Free(val2);
   }
@@ -3385,52 +3429,90 @@ static int ObjectMoleculeAtomFromPyList(ObjectMolecule * I, PyObject * list)
     ok = PConvPyIntToInt(verobj, &atomInfo_version);
 
     CPythonVal *strlookupobj = CPythonVal_PyList_GetItem(G, list, 2);
-    auto strval_1 = PyBytes_AsSomeString(strlookupobj);
+    auto strval_1 = strsection ? SomeString(static_cast<const char*>(
+                                                strsection->data),
+                                     strsection->size)
+                               : PyBytes_AsSomeString(strlookupobj);
     int *strval = (int*)strval_1.data();
 
+    CPythonVal *strobj = CPythonVal_PyList_GetItem(G, list, 1);
+    auto strval_2 = section ? SomeString(static_cast<const char*>(
+                                             section->data),
+                                  section->size)
+                            : PyBytes_AsSomeString(strobj);
+
+    // sections come straight from the file, check them before parsing
+    if (ok && section) {
+      ok = section->version == unsigned(atomInfo_version) && I->NAtom >= 0 &&
+           section->size == AtomInfoTypeConverter::sizeofVersion(
+                                atomInfo_version) * size_t(I->NAtom);
+      if (!ok) {
+        PRINTFB(G, FB_ObjectMolecule, FB_Errors)
+          " Error: atom section size does not match %d atoms\n", I->NAtom
+          ENDFB(G);
+      }
+    }
+    if (ok && strsection) {
+      // int nstrings, int oldidx[nstrings], nstrings null terminated strings
+      size_t const nbytes = strsection->size;
+      const char* const end = strval_1.data() + nbytes;
+      int const nstrings = nbytes >= sizeof(int) ? strval[0] : -1;
+      ok = nstrings >= 0 &&
+           (nbytes / sizeof(int)) - 1 >= size_t(nstrings);
+      const char* p = ok ? (const char*) (strval + 1 + nstrings) : end;
+      for (int i = 0; ok && i < nstrings; ++i) {
+        auto const* term = (const char*) memchr(p, '\0', end - p);
+        ok = term != nullptr;
+        p = ok ? term + 1 : end;
+      }
+      if (!ok) {
+        PRINTFB(G, FB_ObjectMolecule, FB_Errors)
+          " Error: malformed atom string section\n" ENDFB(G);
+      }
+    }
+
     AtomInfoTypeConverter converter(G, I->NAtom);
 
-    auto& oldIDtoLexID = converter.lexidxmap;
-    int nstrings = *(strval++);
-    char *strpl = (char*)(strval + nstrings);
-    int strcnt = nstrings;
-    int stlen;
-    // populate oldIDtoLexID with nstrings from binary string data (3rd entry in list)
-    while (strcnt){
-      lexidx_t idx = LexIdx(G, strpl); // increments ref count, need to take into account
-      int oldidx = *(strval++);
-      oldIDtoLexID[oldidx] = idx;
-      stlen = strlen(strpl);
-      strpl += stlen + 1;
-      strcnt--;
-    }
+    if (ok) {
+      auto& oldIDtoLexID = converter.lexidxmap;
+      int nstrings = *(strval++);
+      char *strpl = (char*)(strval + nstrings);
+      int strcnt = nstrings;
+      int stlen;
+      // populate oldIDtoLexID with nstrings from binary string data (3rd entry in list)
+      while (strcnt){
+        lexidx_t idx = LexIdx(G, strpl); // increments ref count, need to take into account
+        int oldidx = *(strval++);
+        oldIDtoLexID[oldidx] = idx;
+        stlen = strlen(strpl);
+        strpl += stlen + 1;
+        strcnt--;
+      }
 
-    CPythonVal *strobj = CPythonVal_PyList_GetItem(G, list, 1);
-    auto strval_2 = PyBytes_AsSomeString(strobj);
-
-    VLACheck(I->AtomInfo, AtomInfoType, I->NAtom + 1);
-    converter.copy(I->AtomInfo.data(), strval_2.data(), atomInfo_version);
-
-    // go through AtomInfo array, swap new strings, convert colors, convert settings
-    // (everything that AtomInfoFromPyList does except set properties, which are currently 
-    //  not saved for pse_binary_dump) 
-    AtomInfoType *ai = I->AtomInfo.data();
-    for(a = 0; a < I->NAtom; ++a, ++ai) {
-      ai->color = ColorConvertOldSessionIndex(G, ai->color);
-      if (ai->unique_id){
-        ai->unique_id = SettingUniqueConvertOldSessionID(G, ai->unique_id);
+      VLACheck(I->AtomInfo, AtomInfoType, I->NAtom + 1);
+      converter.copy(I->AtomInfo.data(), strval_2.data(), atomInfo_version);
+
+      // go through AtomInfo array, swap new strings, convert colors, convert settings
+      // (everything that AtomInfoFromPyList does except set properties, which are currently 
+      //  not saved for pse_binary_dump) 
+      AtomInfoType *ai = I->AtomInfo.data();
+      for(a = 0; a < I->NAtom; ++a, ++ai) {
+        ai->color = ColorConvertOldSessionIndex(G, ai->color);
+        if (ai->unique_id){
+          ai->unique_id = SettingUniqueConvertOldSessionID(G, ai->unique_id);
+        }
+      }
+      // need to decrement since we call LexIdx() above on each
+      for (auto it = oldIDtoLexID.begin(); it != oldIDtoLexID.end(); ++it){
+        LexDec(G, it->second);
       }
-    }
-    // need to decrement since we call LexIdx() above on each
-    for (auto it = oldIDtoLexID.begin(); it != oldIDtoLexID.end(); ++it){
-      LexDec(G, it->second);
     }
     CPythonVal_Free(verobj);
     CPythonVal_Free(strobj);
     CPythonVal_Free(strlookupobj);
 
 #ifdef _PYMOL_IP_PROPERTIES
-    if (ll > 3) {
+    if (ok && ll > 3) {
       // Restore atom properties
       AtomColumnFromPyList(*I, PyList_GetItem(list, 3), //
           [G](AtomInfoType& atom, PyObject* value) {
@@ -1216,6 +1216,8 @@ void ObjectSlice::render(RenderInfo* info)
       continue;
     }
     if (ray) {
+      if (track_camera)
+        ray->ViewDependent = true;
       ObjectSliceStateRenderRay(I, oss, info);
       continue;
     }
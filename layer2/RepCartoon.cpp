@@ -16,7 +16,9 @@ I* Additional authors of this source file include:
 Z* -------------------------------------------------------------------
 */
 
+#include <algorithm>
 #include <set>
+#include <vector>
 
 #include"os_predef.h"
 #include"os_std.h"
@@ -156,10 +158,13 @@ static int RepCartoonCGOGenerate(RepCartoon * I, RenderInfo * info)
     if (hasAlpha &&
         (SettingGetGlobal_i(G, cSetting_transparency_mode) != 3)){
       // some transparency
-      std::unique_ptr<CGO> simplified(CGOSimplify(I->preshader));
+      std::unique_ptr<CGO> simplified;
+      if (CGOHasSimplifyOperations(I->preshader)) {
+        simplified.reset(CGOSimplify(I->preshader));
+      }
       std::unique_ptr<CGO> optimized(
           CGOOptimizeToVBOIndexedWithColorEmbedTransparentInfo(
-              simplified.get(), 0, nullptr, true));
+              simplified ? simplified.get() : I->preshader, 0, nullptr, true));
 
       CGO* tmp2CGO = CGONew(G);
       CGOEnable(tmp2CGO, GL_BACK_FACE_CULLING);
@@ -202,11 +207,15 @@ static int RepCartoonCGOGenerate(RepCartoon * I, RenderInfo * info)
       }
 
       /* For the rest of the primitives that exist, simplify them into Geometry
-       * (should probably be no more, but do this anyway) */
-      std::unique_ptr<CGO> leftOverCGOSimplified(CGOSimplify(leftOverCGOBorrowed));
-      if (leftOverCGOSimplified) {
+       * (should usually be no more, in which case skip the copy) */
+      std::unique_ptr<CGO> leftOverCGOSimplified;
+      if (CGOHasSimplifyOperations(leftOverCGOBorrowed)) {
+        leftOverCGOSimplified.reset(CGOSimplify(leftOverCGOBorrowed));
+        leftOverCGOBorrowed = leftOverCGOSimplified.get();
+      }
+      if (leftOverCGOBorrowed) {
         std::unique_ptr<CGO> optimized(
-            CGOOptimizeToVBONotIndexed(leftOverCGOSimplified.get()));
+            CGOOptimizeToVBONotIndexed(leftOverCGOBorrowed));
         if (optimized) {
           convertcgo->move_append(std::move(*optimized));
         }
@@ -2067,98 +2076,93 @@ void ComputeCartoonAtomColors(PyMOLGlobals *G, ObjectMolecule *obj, CoordSet *cs
   *c2a = c2;
 }
 
+/**
+ * Spline interpolation weights for one sampling value. They only depend on
+ * the sampling and the cartoon_power/cartoon_power_b settings, so they are
+ * computed once per representation instead of once per segment.
+ */
+struct CartoonSampleWeights {
+  std::vector<float> f0; //!< smoothed fraction of completion
+  std::vector<float> f1; //!< 1 - f0
+  std::vector<float> f2; //!< smooth(f0, power_b)
+  std::vector<float> f3; //!< smooth(f1, power_b)
+  int n_first = 0;       //!< samples which take color/index from atom 1
+
+  CartoonSampleWeights(int sampling, float power_a, float power_b)
+      : f0(sampling + 1), f1(sampling + 1), f2(sampling + 1), f3(sampling + 1)
+  {
+    for (int k = 0; k <= sampling; ++k) {
+      float f = ((float) k) / sampling; /* fraction of completion */
+      if (f <= 0.5)
+        n_first = k + 1;
+      f0[k] = smooth(f, power_a); /* bias sampling towards the center of the curve */
+      f1[k] = 1.0F - f0[k];
+      f2[k] = smooth(f0[k], power_b);
+      f3[k] = smooth(f1[k], power_b);
+    }
+  }
+
+  int sampling() const { return int(f0.size()) - 1; }
+};
+
+/**
+ * Evaluates the spline for all sample points of one segment and appends
+ * colors, alpha, atom indices, points and orientation vectors to the output
+ * arrays. The first segment of an extrusion also emits the starting point.
+ */
 static
-void CartoonGenerateSample(PyMOLGlobals *G, int sampling, int *n_p, float dev, float *vo,
-                           float *v1,
-                           float *v2, int c1, int c2, float alpha1, float alpha2,
+void CartoonGenerateSample(PyMOLGlobals *G, const CartoonSampleWeights &w, int *n_p, float dev, const float *vo,
+                           const float *v1,
+                           const float *v2, int c1, int c2, float alpha1, float alpha2,
                            int atom_index1, int atom_index2,
-                           float power_a, float power_b, float **vc_p, float **valpha_p,
+                           float **vc_p, float **valpha_p,
                            unsigned int **vi_p, float **v_p, float **vn_p){
-  int b, i0;
-  float f0, f1, f2, f3, f4;
-  float a0;
-  const float *v0;
+  int const sampling = w.sampling();
+  int const k0 = (*n_p == 0) ? 0 : 1; /* provide starting point on first point in segment only... */
+  int const n_out = sampling + 1 - k0;
+  int const n_first = std::max(w.n_first - k0, 0);
+  const float *f0 = w.f0.data() + k0;
+  const float *f1 = w.f1.data() + k0;
+  const float *f2 = w.f2.data() + k0;
+  const float *f3 = w.f3.data() + k0;
+  float *vc = *vc_p, *valpha = *valpha_p, *v = *v_p, *vn = *vn_p;
   unsigned int *vi = *vi_p;
-  float *valpha = *valpha_p;
-  float *vc = *vc_p, *v = *v_p, *vn = *vn_p;
-  for(b = 0; b < sampling; b++) {       /* needs optimization */
-    if(*n_p == 0) {
-      /* provide starting point on first point in segment only... */
-      f0 = ((float) b) / sampling;      /* fraction of completion */
-      if(f0 <= 0.5) {
-        v0 = ColorGet(G, c1);
-        i0 = atom_index1;
-        a0 = alpha1;
-      } else {
-        v0 = ColorGet(G, c2);
-        i0 = atom_index2;
-        a0 = alpha2;
-      }
-      f0 = smooth(f0, power_a); /* bias sampling towards the center of the curve */
-      /* store colors and alpha*/
-      *(vc++) = *(v0++);
-      *(vc++) = *(v0++);
-      *(vc++) = *(v0++);
-      *(valpha++) = a0;
-      *(vi++) = i0;
-      /* start of line/cylinder */
-      f1 = 1.0F - f0;
-      f2 = smooth(f0, power_b);
-      f3 = smooth(f1, power_b);
-      f4 = dev * f2 * f3;       /* displacement magnitude */
-      
-      *(v++) = f1 * v1[0] + f0 * v1[3] + f4 * (f3 * v2[0] - f2 * v2[3]);
-      *(v++) = f1 * v1[1] + f0 * v1[4] + f4 * (f3 * v2[1] - f2 * v2[4]);
-      *(v++) = f1 * v1[2] + f0 * v1[5] + f4 * (f3 * v2[2] - f2 * v2[5]);
-      vn += 9;
-      copy3f(vo, vn - 6);       /* starter... */
-      (*n_p)++;
-    }
-    f0 = ((float) b + 1) / sampling;
-    if(f0 <= 0.5) {
-      v0 = ColorGet(G, c1);
-      i0 = atom_index1;
-      a0 = alpha1;
-    } else {
-      v0 = ColorGet(G, c2);
-      i0 = atom_index2;
-      a0 = alpha2;
-    }
-    f0 = smooth(f0, power_a);   /* bias sampling towards the center of the curve */
-    
-    /* store colors and alpha*/
-    *(vc++) = *(v0++);
-    *(vc++) = *(v0++);
-    *(vc++) = *(v0++);
-    *(valpha++) = a0;
-    *(vi++) = i0;
-    
-    /* end of line/cylinder */
-    f1 = 1.0F - f0;
-    f2 = smooth(f0, power_b);
-    f3 = smooth(f1, power_b);
-    f4 = dev * f2 * f3; /* displacement magnitude */
-    
-    *(v++) = f1 * v1[0] + f0 * v1[3] + f4 * (f3 * v2[0] - f2 * v2[3]);
-    *(v++) = f1 * v1[1] + f0 * v1[4] + f4 * (f3 * v2[1] - f2 * v2[4]);
-    *(v++) = f1 * v1[2] + f0 * v1[5] + f4 * (f3 * v2[2] - f2 * v2[5]);
-    /*                remove_component3f(vo,v2,o0);
-                      remove_component3f(vo+3,v2,o0+3); */
-    vn += 3;
-    *(vn++) = f1 * (vo[0] * f2) + f0 * (vo[3] * f3);
-    *(vn++) = f1 * (vo[1] * f2) + f0 * (vo[4] * f3);
-    *(vn++) = f1 * (vo[2] * f2) + f0 * (vo[5] * f3);
-    vn += 3;
-    
-    if(b == sampling - 1)
-      copy3f(vo + 3, vn - 6);   /* starter... */
-    (*n_p)++;
-  }
-  (*vc_p) = vc;
-  (*valpha_p) = valpha;
-  (*vi_p) = vi;
-  (*v_p) = v;
-  (*vn_p) = vn;
+
+  /* store colors and alpha */
+  const float *col1 = ColorGet(G, c1);
+  const float *col2 = ColorGet(G, c2);
+  for(int k = 0; k < n_out; k++) {
+    const float *col = (k < n_first) ? col1 : col2;
+    copy3f(col, vc + 3 * k);
+    valpha[k] = (k < n_first) ? alpha1 : alpha2;
+    vi[k] = (k < n_first) ? atom_index1 : atom_index2;
+  }
+
+  /* points along the curve */
+  for(int k = 0; k < n_out; k++) {
+    float f4 = dev * f2[k] * f3[k];     /* displacement magnitude */
+    v[3 * k + 0] = f1[k] * v1[0] + f0[k] * v1[3] + f4 * (f3[k] * v2[0] - f2[k] * v2[3]);
+    v[3 * k + 1] = f1[k] * v1[1] + f0[k] * v1[4] + f4 * (f3[k] * v2[1] - f2[k] * v2[4]);
+    v[3 * k + 2] = f1[k] * v1[2] + f0[k] * v1[5] + f4 * (f3[k] * v2[2] - f2[k] * v2[5]);
+  }
+
+  /* orientation vectors (middle row of each frame) */
+  for(int k = 0; k < n_out; k++) {
+    float *o = vn + 9 * k + 3;
+    o[0] = f1[k] * (vo[0] * f2[k]) + f0[k] * (vo[3] * f3[k]);
+    o[1] = f1[k] * (vo[1] * f2[k]) + f0[k] * (vo[4] * f3[k]);
+    o[2] = f1[k] * (vo[2] * f2[k]) + f0[k] * (vo[5] * f3[k]);
+  }
+  if(k0 == 0)
+    copy3f(vo, vn + 3);       /* starter... */
+  copy3f(vo + 3, vn + 9 * (n_out - 1) + 3);
+
+  (*n_p) += n_out;
+  (*vc_p) = vc + 3 * n_out;
+  (*valpha_p) = valpha + n_out;
+  (*vi_p) = vi + n_out;
+  (*v_p) = v + 3 * n_out;
+  (*vn_p) = vn + 9 * n_out;
 }
 
 static
@@ -2529,10 +2533,16 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
     SettingGet_i(G, cs->Setting.get(), obj->Setting.get(), cSetting_cartoon_cylindrical_helices);
   int const sampling_cylindrical_helices = sampling / 8 + 1;
 
+  CartoonSampleWeights const sample_weights(sampling, power_a, power_b);
+  CartoonSampleWeights const sample_weights_cylindrical_helices(
+      sampling_cylindrical_helices, power_a, power_b);
+
   sampling_tmp = pymol::malloc<float>(sampling * 3);
   cartoon_debug = SettingGet_i(G, cs->Setting.get(), obj->Setting.get(), cSetting_cartoon_debug);
 
   cgo = CGONew(G);
+  // extrusions write their BEGIN/END blocks as draw arrays right away
+  CGOSetCombineBeginEnd(cgo, true);
   if(alpha != 1.0F)
     CGOAlpha(cgo, alpha);
   /* debugging output */
@@ -2591,14 +2601,14 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
           ComputeCartoonAtomColors(G, obj, cs, nuc_flag, atom_index1, atom_index2, &c1, &c2, atp, cc, cur_car, cartoon_color, alpha1, alpha2, nucleic_color, discrete_colors, n_p, contigFlag);
           dev = throw_ * (*d);
 
-          auto const cur_sampling = (cur_car == cCartoon_cylinder)
-                                        ? sampling_cylindrical_helices
-                                        : sampling;
+          auto const& cur_weights = (cur_car == cCartoon_cylinder)
+                                        ? sample_weights_cylindrical_helices
+                                        : sample_weights;
+          auto const cur_sampling = cur_weights.sampling();
 
-          CartoonGenerateSample(G, cur_sampling, &n_p, dev, vo, v1, v2, c1, c2,
+          CartoonGenerateSample(G, cur_weights, &n_p, dev, vo, v1, v2, c1, c2,
               alpha1, alpha2, ai1->masked ? -1 : atom_index1,
-              ai2->masked ? -1 : atom_index2, power_a, power_b, &vc, &valpha,
-              &vi, &v, &vn);
+              ai2->masked ? -1 : atom_index2, &vc, &valpha, &vi, &v, &vn);
 
           /* now do a smoothing pass along orientation 
              vector to smooth helices, etc... */
@@ -2700,6 +2710,7 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
   if(ok && ndata->ring_anchor && ndata->n_ring) {
     ok = GenerateRepCartoonDrawRings(G, ndata, obj, cs, cgo, ring_width, cartoon_color, alpha);
   }
+  CGOSetCombineBeginEnd(cgo, false);
   if (ok)
     CGOStop(cgo);
 
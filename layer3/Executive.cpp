@@ -24,6 +24,7 @@
 #include <map>
 #include <optional>
 #include <set>
+#include <tuple>
 #include <vector>
 
 #include "pymol/type_traits.h"
@@ -32,6 +33,8 @@
 #include <omp.h>
 #endif
 
+#include "AssemblyHelpers.h"
+#include "AtomExpression.h"
 #include "AtomIterators.h"
 #include "Base.h"
 #include "ButMode.h"
@@ -71,15 +74,18 @@
 #include "PlugIOManager.h"
 #include "PyMOL.h"
 #include "PyMOLOptions.h"
-#include "RepDot.h"
+#include "RMSMatrix.h"
 #include "Scene.h"
 #include "ScenePicking.h"
 #include "SceneRay.h"
 #include "ScrollBar.h"
 #include "SculptCache.h"
+#include "SASA.h"
+#include "SessionFile.h"
 #include "Selector.h"
 #include "Seq.h"
 #include "Setting.h"
+#include "Sphere.h"
 #include "SpecRec.h"
 #include "TTT.h"
 #include "Text.h"
@@ -5660,6 +5666,66 @@ static void ExecutiveMigrateSession(PyMOLGlobals* G, int session_version)
   }
 }
 
+pymol::Result<> ExecutiveSessionFileCreate(
+    PyMOLGlobals* G, const char* filename)
+{
+  if (G->SessionFile) {
+    return pymol::make_error("Another session file is open");
+  }
+
+  auto file = pymol::SessionFile::create(filename);
+  p_return_if_error(file);
+
+  G->SessionFile = file.result().release();
+  return {};
+}
+
+pymol::Result<> ExecutiveSessionFileFinish(
+    PyMOLGlobals* G, const void* pickle, std::size_t size)
+{
+  std::unique_ptr<pymol::SessionFile> file(G->SessionFile);
+  G->SessionFile = nullptr;
+
+  if (!file || !file->isWriting()) {
+    return pymol::make_error("No session file open for writing");
+  }
+
+  if (!pickle) {
+    // aborted, file gets removed
+    return {};
+  }
+
+  // write errors are reported by finish()
+  file->write(pymol::SessionSection::Pickle, 0, pickle, size);
+
+  return file->finish();
+}
+
+pymol::Result<std::pair<const void*, std::size_t>> ExecutiveSessionFileOpen(
+    PyMOLGlobals* G, const char* filename)
+{
+  if (G->SessionFile) {
+    return pymol::make_error("Another session file is open");
+  }
+
+  auto file = pymol::SessionFile::open(filename);
+  p_return_if_error(file);
+
+  auto const* section = file.result()->find(pymol::SessionSection::Pickle);
+  if (!section) {
+    return pymol::make_error("Binary session has no session dictionary");
+  }
+
+  G->SessionFile = file.result().release();
+  return std::make_pair(section->data, section->size);
+}
+
+void ExecutiveSessionFileClose(PyMOLGlobals* G)
+{
+  delete G->SessionFile;
+  G->SessionFile = nullptr;
+}
+
 int ExecutiveSetSessionNoMLock(PyMOLGlobals* G, PyObject* session)
 {
   auto mLocked = MovieLocked(G);
@@ -7340,6 +7406,55 @@ pymol::Result<> ExecutiveMapHalve(
   return {};
 }
 
+pymol::Result<> ExecutiveMapFFTFilter(PyMOLGlobals* G, const char* name,
+    float bfactor, float resolution, int state, int quiet)
+{
+  CExecutive* I = G->Executive;
+  CTracker* I_Tracker = I->Tracker;
+  int list_id = ExecutiveGetNamesListFromPattern(G, name, true, true);
+  int iter_id = TrackerNewIter(I_Tracker, 0, list_id);
+  SpecRec* rec;
+  pymol::Result<> result;
+
+  while (TrackerIterNextCandInList(
+      I_Tracker, iter_id, (TrackerRef**) (void*) &rec)) {
+    if (rec && rec->type == cExecObject && rec->obj->type == cObjectMap) {
+      ObjectMap* obj = (ObjectMap*) rec->obj;
+      result = ObjectMapFFTFilter(obj, state, bfactor, resolution);
+      if (!result) {
+        break;
+      }
+      if (!quiet) {
+        PRINTFB(G, FB_Executive, FB_Actions)
+          " MapFilter: %s filtered (B=%.2f, resolution=%.2f).\n", obj->Name,
+          bfactor, resolution ENDFB(G);
+      }
+      ExecutiveInvalidateMapDependents(G, obj->Name);
+      if (rec->visible)
+        SceneChanged(G);
+    }
+  }
+
+  TrackerDelList(I_Tracker, list_id);
+  TrackerDelIter(I_Tracker, iter_id);
+  return result;
+}
+
+pymol::Result<float> ExecutiveMapCorrelation(PyMOLGlobals* G,
+    const char* name1, const char* name2, int state1, int state2,
+    float resolution)
+{
+  auto obj1 = ExecutiveFindObject<ObjectMap>(G, name1);
+  if (!obj1) {
+    return pymol::make_error("Map object \"", name1, "\" not found.");
+  }
+  auto obj2 = ExecutiveFindObject<ObjectMap>(G, name2);
+  if (!obj2) {
+    return pymol::make_error("Map object \"", name2, "\" not found.");
+  }
+  return ObjectMapFFTCorrelation(obj1, state1, obj2, state2, resolution);
+}
+
 pymol::Result<> ExecutiveMapTrim(PyMOLGlobals* G, const char* name,
     const char* sele, float buffer, int map_state, int sele_state, int quiet)
 {
@@ -8760,6 +8875,44 @@ pymol::Result<> ExecutiveSetDihe(PyMOLGlobals* G, const char* s1,
 }
 
 /*========================================================================*/
+/**
+ * Per-atom surface areas of one coordinate set. Uses the same settings
+ * (dot_solvent, solvent_radius, dot_density) and atom flags as the dot
+ * representation in area mode.
+ *
+ * @param[out] area Area by coordinate index
+ */
+static void CoordSetGetAtomAreas(const CoordSet* cs, std::vector<float>& area)
+{
+  PyMOLGlobals* G = cs->G;
+  auto const* obj = cs->Obj;
+
+  float solv_rad = 0.f;
+  if (SettingGet<bool>(G, cs->Setting.get(), obj->Setting.get(), cSetting_dot_solvent)) {
+    solv_rad = SettingGet<float>(G, cs->Setting.get(), obj->Setting.get(), cSetting_solvent_radius);
+  }
+
+  auto ds = SettingGet<int>(G, cs->Setting.get(), obj->Setting.get(), cSetting_dot_density);
+  SphereRec const* sp = G->Sphere->Sphere[std::clamp(ds, 0, 4)];
+  SASADots const dots(sp->dot[0], sp->area, sp->nDot);
+
+  auto const n = cs->NIndex;
+  std::vector<float> radii(n);
+  std::unique_ptr<bool[]> surface(new bool[n]);
+  std::unique_ptr<bool[]> occluder(new bool[n]);
+
+  for (int idx = 0; idx < n; ++idx) {
+    auto const& ai = obj->AtomInfo[cs->IdxToAtm[idx]];
+    radii[idx] = ai.vdw + solv_rad;
+    surface[idx] = !(ai.flags & (cAtomFlag_exfoliate | cAtomFlag_ignore));
+    occluder[idx] = !(ai.flags & cAtomFlag_ignore);
+  }
+
+  area.resize(n);
+  SASAAtomAreas(dots, cs->Coord.data(), radii.data(), n, surface.get(),
+      occluder.get(), area.data());
+}
+
 pymol::Result<float> ExecutiveGetArea(
     PyMOLGlobals* G, const char* sele, int state, bool load_b)
 {
@@ -8776,9 +8929,8 @@ pymol::Result<float> ExecutiveGetArea(
   if (!cs)
     return pymol::make_error("Invalid state");
 
-  auto rep = (RepDot*) RepDotDoNew(cs, cRepDotAreaType, state);
-  if (!rep)
-    return pymol::make_error("Can't get dot representation.");
+  std::vector<float> area;
+  CoordSetGetAtomAreas(cs, area);
 
   if (load_b) {
     /* zero out B-values within selection */
@@ -8790,29 +8942,89 @@ pymol::Result<float> ExecutiveGetArea(
     ExecutiveObjMolSeleOp(G, sele0, &op);
   }
 
-  float const* const area = rep->A;
-  int const* const ati = rep->Atom;
-
-  AtomInfoType* ai = nullptr;
-  int known_member = -1;
-  bool is_member = false;
   float result = 0.f;
 
-  for (int a = 0; a < rep->N; ++a) {
-    if (known_member != ati[a]) {
-      known_member = ati[a];
-      ai = obj0->AtomInfo + known_member;
-      is_member = SelectorIsMember(G, ai->selEntry, sele0);
+  for (int idx = 0; idx < cs->NIndex; ++idx) {
+    auto* ai = obj0->AtomInfo + cs->IdxToAtm[idx];
+    if (SelectorIsMember(G, ai->selEntry, sele0)) {
+      result += area[idx];
+      if (load_b)
+        ai->b += area[idx];
+    }
+  }
+
+  return result;
+}
+
+/**
+ * Per-atom surface areas for one or all states.
+ *
+ * @param state Object state or cStateAll
+ * @param load_b Store per-atom areas (average over states) in b-factors
+ * @return Areas by state, then by selected atom (in atom order). Atoms
+ * without coordinates in a state have zero area.
+ */
+pymol::Result<std::vector<std::vector<float>>> ExecutiveGetAtomAreas(
+    PyMOLGlobals* G, const char* sele, int state, bool load_b)
+{
+  SETUP_SELE(sele, tmpsele0, sele0);
+
+  auto obj0 = SelectorGetSingleObjectMolecule(G, sele0);
+  if (!obj0) {
+    return pymol::make_error("Selection must be within a single object");
+  }
+
+  std::vector<int> atoms;
+  for (int atm = 0; atm < obj0->NAtom; ++atm) {
+    if (SelectorIsMember(G, obj0->AtomInfo[atm].selEntry, sele0)) {
+      atoms.push_back(atm);
     }
+  }
 
-    if (is_member) {
-      result += area[a];
-      if (load_b)
-        ai->b += area[a];
+  std::vector<const CoordSet*> csets;
+  if (state == cStateAll) {
+    for (int s = 0; s < obj0->NCSet; ++s) {
+      csets.push_back(obj0->getCoordSet(s));
+    }
+  } else {
+    csets.push_back(obj0->getCoordSet(state));
+    if (!csets.back()) {
+      return pymol::make_error("Invalid state");
+    }
+  }
+
+  std::vector<std::vector<float>> result(
+      csets.size(), std::vector<float>(atoms.size(), 0.f));
+
+  // trajectory sweep: states in parallel (SASAAtomAreas is serial when nested)
+#pragma omp parallel for schedule(dynamic) if (csets.size() > 1)
+  for (int k = 0; k < int(csets.size()); ++k) {
+    auto const* cs = csets[k];
+    if (!cs) {
+      continue;
+    }
+
+    std::vector<float> area;
+    CoordSetGetAtomAreas(cs, area);
+
+    for (size_t a = 0; a < atoms.size(); ++a) {
+      auto const idx = cs->atmToIdx(atoms[a]);
+      if (idx >= 0) {
+        result[k][a] = area[idx];
+      }
+    }
+  }
+
+  if (load_b && !csets.empty()) {
+    for (size_t a = 0; a < atoms.size(); ++a) {
+      double sum = 0.0;
+      for (auto const& areas : result) {
+        sum += areas[a];
+      }
+      obj0->AtomInfo[atoms[a]].b = sum / csets.size();
     }
   }
 
-  delete rep;
   return result;
 }
 
@@ -9827,6 +10039,40 @@ pymol::Result<float> ExecutiveDistance(PyMOLGlobals* G, const char* nam,
   return result;
 }
 
+/**
+ * Per-state interaction tables (H-bonds, salt bridges, halogen bonds, pi-pi,
+ * pi-cation) for analysis, without creating a measurement object.
+ *
+ * @param s1: selection expression
+ * @param s2: selection expression or "same" keyword (shortcut for s1 = s2)
+ * @param state: object state, or cStateAll for all states
+ * @param types: pymol::InteractionType bit mask
+ */
+pymol::Result<pymol::InteractionTable> ExecutiveInteractionTable(
+    PyMOLGlobals* G, const char* s1, const char* s2, int state, int types,
+    int quiet)
+{
+  if (strcmp(s1, s2) == 0) {
+    s2 = cKeywordSame;
+  }
+
+  SETUP_SELE_DEFAULT_PREFIXED(1, cSelectionInvalid);
+  SETUP_SELE_DEFAULT_PREFIXED(2, sele1);
+
+  if (state == cStateCurrent) {
+    state = SceneGetState(G);
+  }
+
+  auto table = pymol::FindInteractionTable(G, sele1, sele2, state, types);
+
+  if (!quiet) {
+    PRINTFB(G, FB_Executive, FB_Results)
+      " Executive: found %zu interactions.\n", table.records.size() ENDFB(G);
+  }
+
+  return table;
+}
+
 /*========================================================================*/
 char* ExecutiveNameToSeqAlignStrVLA(
     PyMOLGlobals* G, const char* name, int state, int format, int quiet)
@@ -10168,7 +10414,13 @@ pymol::Result<int> ExecutiveIterate(PyMOLGlobals* G, const char* str1,
     op1.py_ob1 = space;
 #endif
 
-    if (!ExecutiveObjMolSeleOp(G, sele1, &op1)) {
+    std::unique_ptr<AtomExpression> atom_expr =
+        PAtomExpressionCompile(G, expr, read_only, false, space);
+    op1.atom_expr = atom_expr.get();
+
+    // flush also after an error, Python keeps the values appended so far
+    bool const ok = ExecutiveObjMolSeleOp(G, sele1, &op1);
+    if (!PAtomExpressionFlush(G, atom_expr.get(), space) || !ok) {
       return pymol::Error();
     }
 
@@ -10435,6 +10687,10 @@ pymol::Result<int> ExecutiveIterateState(PyMOLGlobals* G, int state,
     ObjectMoleculeOpRecInit(&op1);
     op1.i1 = 0;
 
+    std::unique_ptr<AtomExpression> atom_expr =
+        PAtomExpressionCompile(G, expr, read_only, true, space);
+    op1.atom_expr = atom_expr.get();
+
     for (state = start_state; state < stop_state; state++) {
       op1.code = OMOP_AlterState;
 #ifdef _WEBGL
@@ -10445,9 +10701,14 @@ pymol::Result<int> ExecutiveIterateState(PyMOLGlobals* G, int state,
       op1.i2 = state;
       op1.i3 = read_only;
       if (!ExecutiveObjMolSeleOp(G, sele1, &op1)) {
+        PAtomExpressionFlush(G, atom_expr.get(), space);
         return pymol::Error();
       }
     }
+
+    if (!PAtomExpressionFlush(G, atom_expr.get(), space)) {
+      return pymol::Error();
+    }
     if (!read_only) {
       // for dynamic_measures
       ExecutiveUpdateCoordDepends(G, nullptr);
@@ -11313,6 +11574,457 @@ pymol::Result<pymol::vla<float>> ExecutiveRMSStates(PyMOLGlobals* G,
   return pymol::vla_take_ownership(result);
 }
 
+namespace
+{
+/**
+ * Coordinates of selected atoms in all (non-empty) states of one object
+ */
+struct StateConformations {
+  ObjectMolecule* obj = nullptr;
+  std::vector<int> states;
+  std::vector<QCPConformation> confs;
+};
+} // namespace
+
+static pymol::Result<StateConformations> ExecutiveGetStateConformations(
+    PyMOLGlobals* G, const char* s1)
+{
+  SelectorTmp tmpsele1(G, s1);
+  int sele1 = tmpsele1.getIndex();
+  if (sele1 < 0) {
+    return pymol::make_error("Invalid selection");
+  }
+
+  StateConformations result;
+  auto* obj = result.obj = SelectorGetSingleObjectMolecule(G, sele1);
+  if (!obj) {
+    return pymol::make_error("Selection must be within a single object");
+  }
+
+  std::vector<int> atoms;
+  for (int atm = 0; atm < obj->NAtom; ++atm) {
+    if (SelectorIsMember(G, obj->AtomInfo[atm].selEntry, sele1)) {
+      atoms.push_back(atm);
+    }
+  }
+
+  if (atoms.empty()) {
+    return pymol::make_error("No atoms selected");
+  }
+
+  std::vector<float> xyz(atoms.size() * 3);
+
+  for (int state = 0; state < obj->NCSet; ++state) {
+    auto const* cs = obj->CSet[state];
+    if (!cs) {
+      continue;
+    }
+    for (size_t i = 0; i < atoms.size(); ++i) {
+      int const idx = cs->atmToIdx(atoms[i]);
+      if (idx < 0) {
+        return pymol::make_error(
+            "Selected atoms are missing in state ", state + 1);
+      }
+      copy3f(cs->coordPtr(idx), xyz.data() + i * 3);
+    }
+    result.states.push_back(state);
+    result.confs.emplace_back(xyz.data(), atoms.size());
+  }
+
+  return result;
+}
+
+/**
+ * Number of matrix rows per tile when processing the RMSD matrix in tiles
+ * (limits memory to 64 MB per tile).
+ */
+static size_t RMSMatrixTileRows(size_t n)
+{
+  return std::max<size_t>(1, (size_t(1) << 24) / std::max<size_t>(n, 1));
+}
+
+/**
+ * Writes the header of a (n x n) float32 NumPy .npy file.
+ */
+static void WriteNpyHeader(FILE* fp, size_t n)
+{
+  auto dict = pymol::string_format(
+      "{'descr': '<f4', 'fortran_order': False, 'shape': (%zu, %zu), }", n, n);
+  // magic (6) + version (2) + header length (2) + dict + newline,
+  // padded to a multiple of 64 bytes
+  size_t const len = 10 + dict.size() + 1;
+  dict.append((64 - len % 64) % 64, ' ');
+  dict += '\n';
+  unsigned short const hlen = dict.size();
+  unsigned char const hlen_le[2] = {
+      (unsigned char) (hlen & 0xFF), (unsigned char) (hlen >> 8)};
+  fwrite("\x93NUMPY\x01\x00", 1, 8, fp);
+  fwrite(hlen_le, 1, 2, fp);
+  fwrite(dict.data(), 1, dict.size(), fp);
+}
+
+/**
+ * Pairwise RMSD matrix (after optimal superposition) between all states of
+ * a single object.
+ *
+ * @param s1 Atom selection
+ * @param filename If not empty, stream the matrix tile by tile into this
+ * NumPy (.npy) file instead of returning it
+ * @return n_state * n_state matrix, row-major (empty if written to file)
+ */
+pymol::Result<std::vector<float>> ExecutiveRMSMatrix(
+    PyMOLGlobals* G, const char* s1, const char* filename, int quiet)
+{
+  auto conformations = ExecutiveGetStateConformations(G, s1);
+  p_return_if_error(conformations);
+  auto const& confs = conformations->confs;
+  size_t const n = confs.size();
+
+  std::vector<float> matrix;
+
+  if (!filename || !filename[0]) {
+    matrix.resize(n * n);
+    QCPRMSDMatrix(confs, matrix.data());
+  } else {
+    FILE* fp = pymol_fopen(filename, "wb");
+    if (!fp) {
+      return pymol::make_error("Cannot open file for writing: ", filename);
+    }
+
+    WriteNpyHeader(fp, n);
+
+    size_t const tile_rows = RMSMatrixTileRows(n);
+    std::vector<float> tile(tile_rows * n);
+    for (size_t row = 0; row < n; row += tile_rows) {
+      size_t const row_end = std::min(row + tile_rows, n);
+      QCPRMSDMatrixRows(confs, row, row_end, tile.data());
+      fwrite(tile.data(), sizeof(float), (row_end - row) * n, fp);
+    }
+
+    bool const ok = !ferror(fp);
+    fclose(fp);
+
+    if (!ok) {
+      return pymol::make_error("Writing failed: ", filename);
+    }
+  }
+
+  if (!quiet) {
+    PRINTFB(G, FB_Executive, FB_Actions)
+      " RMSMatrix: %zu x %zu RMSD matrix over %zu atoms\n", n, n,
+      n ? confs[0].size() : 0 ENDFB(G);
+  }
+
+  return matrix;
+}
+
+/**
+ * Clusters the states of a single object by pairwise RMSD with the GROMOS
+ * method and writes the cluster numbers as state titles ("cluster 1" is the
+ * largest cluster). The RMSD matrix is processed in tiles and never held in
+ * memory entirely, but the neighbor lists are: their size is the number of
+ * state pairs within the cutoff, which approaches n_state^2 for a cutoff
+ * larger than the spread of the ensemble.
+ *
+ * @param s1 Atom selection
+ * @param cutoff RMSD cutoff for cluster membership
+ * @return cluster number (starting at 1) for each non-empty state
+ */
+pymol::Result<std::vector<int>> ExecutiveClusterStates(
+    PyMOLGlobals* G, const char* s1, float cutoff, int quiet)
+{
+  auto conformations = ExecutiveGetStateConformations(G, s1);
+  p_return_if_error(conformations);
+  auto const& confs = conformations->confs;
+  size_t const n = confs.size();
+
+  std::vector<std::vector<int>> neighbors(n);
+
+  size_t const tile_rows = RMSMatrixTileRows(n);
+  std::vector<float> tile(tile_rows * n);
+  for (size_t row = 0; row < n; row += tile_rows) {
+    size_t const row_end = std::min(row + tile_rows, n);
+    QCPRMSDMatrixRows(confs, row, row_end, tile.data());
+    for (size_t i = row; i < row_end; ++i) {
+      const float* rms = tile.data() + (i - row) * n;
+      for (size_t j = 0; j < n; ++j) {
+        if (j != i && rms[j] <= cutoff) {
+          neighbors[i].push_back(j);
+        }
+      }
+    }
+  }
+
+  auto clusters = ClusterGromos(neighbors);
+  int n_clusters = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto* cs = conformations->obj->CSet[conformations->states[i]];
+    cs->setTitle(pymol::string_format("cluster %d", ++clusters[i]));
+    n_clusters = std::max(n_clusters, clusters[i]);
+  }
+
+  if (!quiet) {
+    PRINTFB(G, FB_Executive, FB_Actions)
+      " ClusterStates: %zu states in %d clusters (cutoff %.3f)\n", n,
+      n_clusters, cutoff ENDFB(G);
+  }
+
+  SceneChanged(G);
+
+  return clusters;
+}
+
+namespace
+{
+/**
+ * Atom identifiers for matching mobile and target atoms, same fields as
+ * AtomInfoMatch
+ */
+struct FitAtomKey {
+  lexidx_t segi, chain, resn, name;
+  int resv;
+  char inscode, alt;
+
+  bool operator<(const FitAtomKey& other) const
+  {
+    return std::tie(segi, chain, resv, inscode, resn, name, alt) <
+           std::tie(other.segi, other.chain, other.resv, other.inscode,
+               other.resn, other.name, other.alt);
+  }
+};
+
+/**
+ * Makes FitAtomKeys, with case folding according to the "ignore_case" and
+ * "ignore_case_chain" settings (like AtomInfoMatch)
+ */
+class FitAtomKeyMaker
+{
+  PyMOLGlobals* m_G;
+  bool m_ignore_case, m_ignore_case_chain;
+  std::map<lexidx_t, lexidx_t> m_folded;
+  std::map<std::string, lexidx_t> m_byUpper;
+
+  /// First seen string which is equal to `idx` when ignoring case
+  lexidx_t fold(lexidx_t idx)
+  {
+    auto it = m_folded.find(idx);
+    if (it == m_folded.end()) {
+      std::string upper = LexStr(m_G, idx);
+      for (auto& c : upper) {
+        c = toupper((unsigned char) c);
+      }
+      auto const folded = m_byUpper.emplace(std::move(upper), idx).first->second;
+      it = m_folded.emplace(idx, folded).first;
+    }
+    return it->second;
+  }
+
+public:
+  explicit FitAtomKeyMaker(PyMOLGlobals* G)
+      : m_G(G)
+      , m_ignore_case(SettingGet<bool>(G, cSetting_ignore_case))
+      , m_ignore_case_chain(SettingGet<bool>(G, cSetting_ignore_case_chain))
+  {
+  }
+
+  FitAtomKey operator()(const AtomInfoType& ai)
+  {
+    FitAtomKey key{ai.segi, ai.chain, ai.resn, ai.name, ai.resv, ai.inscode,
+        ai.alt[0]};
+    if (m_ignore_case_chain) {
+      key.segi = fold(key.segi);
+      key.chain = fold(key.chain);
+    }
+    if (m_ignore_case) {
+      key.resn = fold(key.resn);
+      key.name = fold(key.name);
+      key.inscode = toupper((unsigned char) key.inscode);
+      key.alt = toupper((unsigned char) key.alt);
+    }
+    return key;
+  }
+};
+
+/**
+ * One state of a mobile object
+ */
+struct FitBatchItem {
+  size_t obj;    //!< index into the mobile object list
+  CoordSet* cs;
+  int state;
+  float rms = -1.f;
+  float matrix[16];
+};
+} // namespace
+
+/**
+ * Superposes many objects and/or states onto one reference. Atoms are
+ * matched by identifiers (segi, chain, resi, resn, name, alt, see
+ * AtomInfoMatch) once per object, all
+ * superpositions are computed (QCP) and applied in parallel.
+ *
+ * Stored coordinates are transformed, like with intra_fit.
+ *
+ * @param s1 Mobile atom selection (may span multiple objects)
+ * @param s2 Target atom selection (single object)
+ * @param state1 Mobile state (0-based) or cStateAll or cStateCurrent
+ * @param state2 Target state (0-based) or cStateCurrent
+ * @return RMSD for each state of each mobile object by object name (-1 for
+ * states which were not fitted)
+ */
+pymol::Result<std::map<std::string, std::vector<float>>> ExecutiveFitBatch(PyMOLGlobals* G, const char* s1, const char* s2, int state1,
+    int state2, int quiet)
+{
+  SelectorTmp tmpsele1(G, s1);
+  SelectorTmp tmpsele2(G, s2);
+  int const sele1 = tmpsele1.getIndex();
+  int const sele2 = tmpsele2.getIndex();
+  if (sele1 < 0 || sele2 < 0) {
+    return pymol::make_error("Invalid selection");
+  }
+
+  auto* target = SelectorGetSingleObjectMolecule(G, sele2);
+  if (!target) {
+    return pymol::make_error("Target selection must be within a single object");
+  }
+
+  auto const* target_cs = target->getCoordSet(state2);
+  if (!target_cs) {
+    return pymol::make_error("Target state not found");
+  }
+
+  // target coordinates by atom identifiers
+  FitAtomKeyMaker make_key(G);
+  std::map<FitAtomKey, const float*> target_coords;
+  for (int atm = 0; atm < target->NAtom; ++atm) {
+    auto const& ai = target->AtomInfo[atm];
+    if (SelectorIsMember(G, ai.selEntry, sele2)) {
+      int const idx = target_cs->atmToIdx(atm);
+      if (idx >= 0) {
+        target_coords.emplace(make_key(ai), target_cs->coordPtr(idx));
+      }
+    }
+  }
+
+  if (target_coords.empty()) {
+    return pymol::make_error("No target atoms selected");
+  }
+
+  auto objects = pymol::vla_take_ownership(SelectorGetObjectMoleculeVLA(G, sele1));
+  if (!objects) {
+    return pymol::make_error("No mobile atoms selected");
+  }
+
+  size_t const n_obj = objects.size();
+  std::vector<std::vector<int>> mobile_atoms(n_obj);
+  std::vector<QCPConformation> target_confs;
+  std::vector<FitBatchItem> items;
+  std::vector<float> xyz;
+
+  // match atoms once per object
+  for (size_t i = 0; i < n_obj; ++i) {
+    auto* obj = objects[i];
+    xyz.clear();
+    for (int atm = 0; atm < obj->NAtom; ++atm) {
+      auto const& ai = obj->AtomInfo[atm];
+      if (!SelectorIsMember(G, ai.selEntry, sele1)) {
+        continue;
+      }
+      auto it = target_coords.find(make_key(ai));
+      if (it != target_coords.end()) {
+        mobile_atoms[i].push_back(atm);
+        xyz.insert(xyz.end(), it->second, it->second + 3);
+      }
+    }
+
+    target_confs.emplace_back(xyz.data(), mobile_atoms[i].size());
+
+    if (mobile_atoms[i].empty()) {
+      PRINTFB(G, FB_Executive, FB_Warnings)
+        " Executive-Warning: No matching atoms in object \"%s\".\n",
+        obj->Name ENDFB(G);
+      continue;
+    }
+
+    int const state = (state1 == cStateCurrent) ? obj->getCurrentState() : state1;
+    for (int b = 0; b < obj->NCSet; ++b) {
+      if (obj->CSet[b] && (state < 0 || state == b) &&
+          !(obj == target && obj->CSet[b] == target_cs)) {
+        items.push_back({i, obj->CSet[b], b});
+      }
+    }
+  }
+
+  // superpose and transform in parallel
+#pragma omp parallel
+  {
+    std::vector<float> xyz_mobile;
+
+#pragma omp for schedule(dynamic, 16)
+    for (long k = 0; k < long(items.size()); ++k) {
+      auto& item = items[k];
+      auto const& atoms = mobile_atoms[item.obj];
+      xyz_mobile.resize(atoms.size() * 3);
+
+      bool complete = true;
+      for (size_t a = 0; a < atoms.size(); ++a) {
+        int const idx = item.cs->atmToIdx(atoms[a]);
+        if (idx < 0) {
+          complete = false;
+          break;
+        }
+        copy3f(item.cs->coordPtr(idx), xyz_mobile.data() + a * 3);
+      }
+
+      if (!complete) {
+        continue;
+      }
+
+      QCPConformation mobile(xyz_mobile.data(), atoms.size());
+      item.rms = QCPSuperpose(target_confs[item.obj], mobile, item.matrix);
+      CoordSetTransform44f(item.cs, item.matrix);
+    }
+  }
+
+  std::vector<std::vector<float>> rms(n_obj);
+  for (size_t i = 0; i < n_obj; ++i) {
+    rms[i].assign(objects[i]->NCSet, -1.f);
+  }
+
+  size_t n_fitted = 0;
+  for (auto& item : items) {
+    if (item.rms < 0.f) {
+      PRINTFB(G, FB_Executive, FB_Warnings)
+        " Executive-Warning: Missing atoms in state %d of \"%s\".\n",
+        item.state + 1, objects[item.obj]->Name ENDFB(G);
+      continue;
+    }
+    item.cs->invalidateRep(cRepAll, cRepInvCoord);
+    CoordSetRecordTxfApplied(item.cs, item.matrix, true);
+    rms[item.obj][item.state] = item.rms;
+    ++n_fitted;
+  }
+
+  for (auto* obj : objects) {
+    ExecutiveUpdateCoordDepends(G, obj);
+  }
+
+  if (!quiet) {
+    PRINTFB(G, FB_Executive, FB_Actions)
+      " FitBatch: %zu states in %zu objects fitted.\n", n_fitted,
+      n_obj ENDFB(G);
+  }
+
+  SceneChanged(G);
+
+  std::map<std::string, std::vector<float>> result;
+  for (size_t i = 0; i < n_obj; ++i) {
+    result[objects[i]->Name] = std::move(rms[i]);
+  }
+  return result;
+}
+
 /*========================================================================*/
 float ExecutiveRMSPairs(
     PyMOLGlobals* G, const std::vector<SelectorTmp>& sele, int mode, bool quiet)
@@ -14219,9 +14931,11 @@ static std::string make_symexp_segi_label(int a, int x, int y, int z)
  * @param cutoff Distance cutoff from selection
  * @param segi (bool) If true, write symmetry operation code to segment
  * identifier
+ * @param instanced If true, create a single object @a name which renders all
+ * mates as instances of one set of representations
  */
 void ExecutiveSymExp(PyMOLGlobals* G, const char* name, const char* oname,
-    const char* s1, float cutoff, int segi, int quiet)
+    const char* s1, float cutoff, int segi, int quiet, bool instanced)
 { /* TODO state */
   SelectorTmp tmpsele1(G, s1);
   auto sele = tmpsele1.getIndex();
@@ -14299,22 +15013,30 @@ void ExecutiveSymExp(PyMOLGlobals* G, const char* name, const char* oname,
     }
   }
 
+  // instanced mode: a single copy which renders all mates as instances
+  ObjectMolecule* inst_obj = nullptr;
+  if (instanced) {
+    inst_obj = ObjectMoleculeCopy(obj);
+  }
+
   /* go out no more than one lattice step in each direction: -1, 0, +1 */
   for (int x = -1; x < 2; ++x) {
     for (int y = -1; y < 2; ++y) {
       for (int z = -1; z < 2; ++z) {
         for (int a = 0; a < nsymmat; a++) {
-          /* make a copy of the original */
-          auto new_obj = ObjectMoleculeCopy(obj);
+          // per-state symmetry matrices
+          std::vector<std::array<float, 16>> mats(obj->NCSet);
+          std::vector<bool> is_identity(obj->NCSet, true);
+          std::vector<glm::vec3> shifts(obj->NCSet);
           bool keepFlag = false;
 
-          for (int b = 0; b < new_obj->NCSet; ++b) {
-            auto* cs = new_obj->CSet[b];
+          for (int b = 0; b < obj->NCSet; ++b) {
+            auto const* cs = obj->CSet[b];
             if (!cs) {
               continue;
             }
 
-            float mat[16];
+            float* mat = mats[b].data();
             copy33f44f(sym->Crystal.realToFrac(), mat);
             left_multiply44f44f(sym->getSymMat(a), mat);
 
@@ -14328,7 +15050,10 @@ void ExecutiveSymExp(PyMOLGlobals* G, const char* name, const char* oname,
             for (int c = 0; c < 3; c++) {
               ts[c] = std::round(tc[c] - ts[c]);
             }
-            float const shift[3] = {ts[0] + x, ts[1] + y, ts[2] + z};
+            float* shift = glm::value_ptr(shifts[b]);
+            shift[0] = ts[0] + x;
+            shift[1] = ts[1] + y;
+            shift[2] = ts[2] + z;
             float m[16];
             identity44f(m);
             m[3] = shift[0];
@@ -14343,13 +15068,7 @@ void ExecutiveSymExp(PyMOLGlobals* G, const char* name, const char* oname,
               continue;
             }
 
-            double mat_d[16];
-            copy44f44d(mat, mat_d);
-            ObjectStateLeftCombineMatrixR44d(cs, mat_d);
-
-            if (!matrix_mode) {
-              CoordSetTransform44f(cs, mat);
-            }
+            is_identity[b] = false;
 
             if (keepFlag) {
               continue;
@@ -14357,29 +15076,51 @@ void ExecutiveSymExp(PyMOLGlobals* G, const char* name, const char* oname,
 
             /* for each coordinate in this coordinate set */
             for (unsigned idx = 0; idx < cs->NIndex; ++idx) {
-              const auto* v2 = cs->coordPtr(idx);
+              transform44f3f(mat, cs->coordPtr(idx), ts);
 
-              if (matrix_mode) {
-                transform44f3f(mat, v2, ts);
-                v2 = ts;
-              }
-
-              if (MapAnyWithin(*map, vv1.data(), v2, cutoff)) {
+              if (MapAnyWithin(*map, vv1.data(), ts, cutoff)) {
                 keepFlag = true;
                 break;
               }
             }
-
-            // CIF-style symop label (e.g. "1_555")
-            cs->setTitle(pymol::string_format("%d_%.0f%.0f%.0f", a + 1,
-                shift[0] + 5, shift[1] + 5, shift[2] + 5));
           }
 
           if (!keepFlag) {
-            DeleteP(new_obj);
             continue;
           }
 
+          if (inst_obj) {
+            for (int b = 0; b < inst_obj->NCSet; ++b) {
+              if (inst_obj->CSet[b] && !is_identity[b]) {
+                CoordSetAppendInstance(inst_obj->CSet[b], mats[b].data());
+              }
+            }
+            continue;
+          }
+
+          auto new_obj = ObjectMoleculeCopy(obj);
+
+          for (int b = 0; b < new_obj->NCSet; ++b) {
+            auto* cs = new_obj->CSet[b];
+            if (!cs || is_identity[b]) {
+              continue;
+            }
+
+            const float* mat = mats[b].data();
+            double mat_d[16];
+            copy44f44d(mat, mat_d);
+            ObjectStateLeftCombineMatrixR44d(cs, mat_d);
+
+            if (!matrix_mode) {
+              CoordSetTransform44f(cs, mat);
+            }
+
+            // CIF-style symop label (e.g. "1_555")
+            auto const& shift = shifts[b];
+            cs->setTitle(pymol::string_format("%d_%.0f%.0f%.0f", a + 1,
+                shift[0] + 5, shift[1] + 5, shift[2] + 5));
+          }
+
           if (segi) {
             auto seg = make_symexp_segi_label(a, x, y, z);
             lexidx_t segi = LexIdx(G, seg.c_str());
@@ -14405,6 +15146,24 @@ void ExecutiveSymExp(PyMOLGlobals* G, const char* name, const char* oname,
       }
     }
   }
+
+  if (inst_obj) {
+    bool has_instances = false;
+    for (int b = 0; b < inst_obj->NCSet; ++b) {
+      if (inst_obj->CSet[b] && inst_obj->CSet[b]->getNInstances()) {
+        has_instances = true;
+      }
+    }
+
+    if (!has_instances) {
+      DeleteP(inst_obj);
+      return;
+    }
+
+    ObjectSetName(inst_obj, name);
+    ExecutiveDelete(G, inst_obj->Name);
+    ExecutiveManageObject(G, inst_obj, false, quiet);
+  }
 }
 
 void ExecutivePurgeSpec(PyMOLGlobals* G, SpecRec* rec, bool save)
@@ -16662,6 +17421,7 @@ int ExecutiveInit(PyMOLGlobals* G)
 void ExecutiveFree(PyMOLGlobals* G)
 {
   CExecutive* I = G->Executive;
+  ExecutiveSessionFileClose(G);
   SpecRec* rec = nullptr;
   CGOFree(I->selIndicatorsCGO);
   while (ListIterate(I->Spec, rec, next)) {
@@ -16765,61 +17525,47 @@ PyObject* ExecutiveCEAlign(PyMOLGlobals* G, PyObject* listA, PyObject* listB,
 #ifdef _PYMOL_NOPY
   return nullptr;
 #else
-  int i = 0;
-  int smaller;
-  double **dmA, **dmB, **S;
-  int bufferSize;
-  pcePoint coordsA, coordsB;
-  pathCache paths = nullptr;
-  PyObject* result;
-
-  smaller = lenA < lenB ? lenA : lenB;
-
   /* get the coodinates from the Python objects */
-  coordsA = (pcePoint) getCoords(listA, lenA);
-  coordsB = (pcePoint) getCoords(listB, lenB);
-
-  /* calculate the distance matrix for each protein */
-  dmA = (double**) calcDM(coordsA, lenA);
-  dmB = (double**) calcDM(coordsB, lenB);
-
-  /* calculate the CE Similarity matrix */
-  S = (double**) calcS(dmA, dmB, lenA, lenB, windowSize);
+  auto coordsA = getCoords(listA, lenA);
+  auto coordsB = getCoords(listB, lenB);
 
-  /* find the best path through the CE Sim. matrix */
-  bufferSize = 0;
+  /* calculate the distance matrix for the target */
+  auto dmA = calcDM(coordsA.data(), lenA);
 
-  /* the following line HANGS PyMOL */
-  paths = (pathCache) findPath(
-      S, dmA, dmB, lenA, lenB, d0, d1, windowSize, gapMax, &bufferSize);
-
-  /* Get the optimal superposition here... */
-  result = (PyObject*) findBest(
-      coordsA, coordsB, paths, bufferSize, smaller, windowSize);
-
-  /* release memory */
-  free(coordsA);
-  free(coordsB);
-  for (i = 0; i < bufferSize; ++i)
-    free(paths[i]);
-  free(paths);
+  /* distance and similarity matrices, path search and superposition */
+  ceAlignment result;
+  if (!ceAlign(coordsA, dmA, coordsB, d0, d1, windowSize, gapMax, result)) {
+    return nullptr;
+  }
 
-  /* distance matrices	 */
-  for (i = 0; i < lenA; i++)
-    free(dmA[i]);
-  free(dmA);
+  return ceAlignmentAsPyList(result);
+#endif
+}
 
-  for (i = 0; i < lenB; i++)
-    free(dmB[i]);
-  free(dmB);
+std::vector<std::optional<ceAlignment>> ExecutiveCEAlignBatch(
+    PyMOLGlobals* G, const std::vector<cePoint>& coordsA,
+    const std::vector<std::vector<cePoint>>& coordsB, float d0, float d1,
+    int windowSize, int gapMax)
+{
+  int const nMobile = coordsB.size();
+  std::vector<std::optional<ceAlignment>> results(nMobile);
 
-  /* similarity matrix */
-  for (i = 0; i < lenA; i++)
-    free(S[i]);
-  free(S);
+#ifndef _PYMOL_NOPY
+  /* the target distance matrix is shared by all alignments */
+  auto dmA = calcDM(coordsA.data(), coordsA.size());
 
-  return (PyObject*) result;
+  /* one alignment per thread, nested parallel regions run serially */
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < nMobile; ++i) {
+    ceAlignment result;
+    if (!coordsB[i].empty() && ceAlign(coordsA, dmA, coordsB[i], d0, d1,
+                                   windowSize, gapMax, result)) {
+      results[i] = std::move(result);
+    }
+  }
 #endif
+
+  return results;
 }
 
 char* ExecutiveGetObjectNames(
@@ -17,13 +17,17 @@ Z* -------------------------------------------------------------------
 #ifndef _H_Executive
 #define _H_Executive
 
+#include <map>
+#include <optional>
 #include <string>
+#include <utility>
 #include <unordered_set>
 
 #include "os_python.h"
 #include "pymol/zstring_view.h"
 
 #include "Field.h"
+#include "Interactions.h"
 #include "ObjectMolecule.h"
 #include "PyMOLGlobals.h"
 #include "PyMOLObject.h"
@@ -39,6 +43,7 @@ Z* -------------------------------------------------------------------
 #include "Tracker.h"
 #include "TrackerList.h"
 #include "Word.h"
+#include "ce_types.h"
 #include "vla.h"
 
 enum cLoadType_t : int {
@@ -261,6 +266,9 @@ pymol::Result<float> ExecutiveDistance(PyMOLGlobals* G, const char* nam,
     const char* s1, const char* s2, int mode, float cutoff, int labels,
     int quiet, int reset, int state, int zoom, int state1 = -4,
     int state2 = -4);
+pymol::Result<pymol::InteractionTable> ExecutiveInteractionTable(
+    PyMOLGlobals* G, const char* s1, const char* s2, int state, int types,
+    int quiet);
 pymol::Result<> ExecutiveBond(PyMOLGlobals* G, const char* s1, const char* s2,
     int order, int mode, int quiet, pymol::zstring_view symop = "");
 pymol::Result<> ExecutiveAddBondByIndices(PyMOLGlobals* G,
@@ -413,6 +421,13 @@ float ExecutiveRMSPairs(PyMOLGlobals* G, const std::vector<SelectorTmp>& sele,
     int mode, bool quiet);
 pymol::Result<pymol::vla<float>> ExecutiveRMSStates(PyMOLGlobals* G,
     const char* s1, int target, int mode, int quiet, int mix, bool pbc = true);
+pymol::Result<std::vector<float>> ExecutiveRMSMatrix(
+    PyMOLGlobals* G, const char* s1, const char* filename, int quiet);
+pymol::Result<std::vector<int>> ExecutiveClusterStates(
+    PyMOLGlobals* G, const char* s1, float cutoff, int quiet);
+pymol::Result<std::map<std::string, std::vector<float>>> ExecutiveFitBatch(
+    PyMOLGlobals* G, const char* s1, const char* s2, int state1, int state2,
+    int quiet);
 int ExecutiveIndex(PyMOLGlobals* G, const char* s1, int mode, int** indexVLA,
     ObjectMolecule*** objVLA);
 pymol::Result<> ExecutiveReset(PyMOLGlobals*, pymol::zstring_view);
@@ -489,7 +504,8 @@ float ExecutiveOverlap(PyMOLGlobals* G, const char* s1, int state1,
     const char* s2, int state2, float adjust);
 int ExecutiveCountStates(PyMOLGlobals* G, const char* s1);
 void ExecutiveSymExp(PyMOLGlobals* G, const char* name, const char* obj,
-    const char* sele, float cutoff, int segi, int quiet);
+    const char* sele, float cutoff, int segi, int quiet,
+    bool instanced = false);
 int ExecutiveGetExtent(PyMOLGlobals* G, const char* name, float* mn, float* mx,
     int transformed, int state, int weighted);
 int ExecutiveGetCameraExtent(PyMOLGlobals* G, const char* name, float* mn,
@@ -528,6 +544,8 @@ pymol::Result<char const*> ExecutiveGetType(PyMOLGlobals* G, const char* name);
 
 pymol::Result<float> ExecutiveGetArea(
     PyMOLGlobals*, const char* sele, int state, bool load_b);
+pymol::Result<std::vector<std::vector<float>>> ExecutiveGetAtomAreas(
+    PyMOLGlobals* G, const char* sele, int state, bool load_b);
 
 void ExecutiveInvalidateSceneMembers(PyMOLGlobals* G);
 
@@ -621,6 +639,11 @@ pymol::Result<> ExecutiveMapDouble(
     PyMOLGlobals* G, const char* name, int state);
 pymol::Result<> ExecutiveMapHalve(
     PyMOLGlobals* G, const char* name, int state, int smooth);
+pymol::Result<> ExecutiveMapFFTFilter(PyMOLGlobals* G, const char* name,
+    float bfactor, float resolution, int state, int quiet);
+pymol::Result<float> ExecutiveMapCorrelation(PyMOLGlobals* G,
+    const char* name1, const char* name2, int state1, int state2,
+    float resolution);
 
 int ExecutiveIdentifyObjects(PyMOLGlobals* G, const char* s1, int mode,
     int** indexVLA, ObjectMolecule*** objVLA);
@@ -671,6 +694,26 @@ int ExecutiveSetSession(
     PyMOLGlobals* G, PyObject* session, int partial_restore, int quiet);
 int ExecutiveSetSessionNoMLock(PyMOLGlobals* G, PyObject* session);
 
+/**
+ * Binary session files (.pseb): While a file is open for writing, large
+ * blocks of ExecutiveGetSession are stored as sections. The pickled session
+ * dictionary is written last, by ExecutiveSessionFileFinish.
+ */
+pymol::Result<> ExecutiveSessionFileCreate(
+    PyMOLGlobals* G, const char* filename);
+/**
+ * @param pickle Pickled session dictionary, or nullptr to abort
+ */
+pymol::Result<> ExecutiveSessionFileFinish(
+    PyMOLGlobals* G, const void* pickle, std::size_t size);
+/**
+ * Opens a binary session file for ExecutiveSetSession.
+ * @return Pickled session dictionary (valid until ExecutiveSessionFileClose)
+ */
+pymol::Result<std::pair<const void*, std::size_t>> ExecutiveSessionFileOpen(
+    PyMOLGlobals* G, const char* filename);
+void ExecutiveSessionFileClose(PyMOLGlobals* G);
+
 pymol::Result<> ExecutiveUnsetSetting(PyMOLGlobals* G, int index,
     pymol::zstring_view preSele, int state, int quiet, int updates);
 
@@ -823,6 +866,16 @@ int ExecutiveAssignAtomTypes(
 PyObject* ExecutiveCEAlign(PyMOLGlobals* G, PyObject* listA, PyObject* listB,
     int lenA, int lenB, float d0, float d1, int windowSize, int gapMax);
 
+/**
+ * Aligns one target against many mobile coordinate lists in parallel.
+ * Doesn't use Python, the caller should unblock the interpreter.
+ * @return one alignment (or none on failure) per mobile
+ */
+std::vector<std::optional<ceAlignment>> ExecutiveCEAlignBatch(
+    PyMOLGlobals* G, const std::vector<cePoint>& coordsA,
+    const std::vector<std::vector<cePoint>>& coordsB, float d0, float d1,
+    int windowSize, int gapMax);
+
 pymol::Result<> ExecutiveSetFeedbackMask(
     PyMOLGlobals* G, int action, unsigned int sysmod, unsigned char mask);
 pymol::Result<> ExecutiveClip(PyMOLGlobals* G, pymol::zstring_view clipStr);
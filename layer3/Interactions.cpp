@@ -19,6 +19,8 @@
 #include <glm/vec3.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <set>
 #include <vector>
@@ -137,6 +139,15 @@ struct CNRing {
   }
 };
 
+// These constants are borrowed from mmshare/include/structureinteraction.h
+constexpr auto RING_ALIGNMENT_MAX_ANGLE = 40.0;
+constexpr auto DEFAULT_PI_CATION_MAXIMUM_DISTANCE = 6.6;
+constexpr auto DEFAULT_PI_CATION_MAXIMUM_ANGLE = 30.0;
+constexpr auto PIPI_FACE_TO_FACE_MAXIMUM_DISTANCE = 4.4;
+constexpr auto PIPI_FACE_TO_FACE_MAXIMUM_ANGLE = 30.0;
+constexpr auto PIPI_EDGE_TO_FACE_MAXIMUM_DISTANCE = 5.5;
+constexpr auto PIPI_EDGE_TO_FACE_MINIMUM_ANGLE = 60.0;
+
 /**
  * Helper function to convert atom indices to simplified ring structures.
  */
@@ -271,15 +282,6 @@ DistSet* FindPiInteractions(PyMOLGlobals* G,
     bool pipi,             //
     InteractionDir picat)
 {
-  // These constants are borrowed from mmshare/include/structureinteraction.h
-  constexpr auto RING_ALIGNMENT_MAX_ANGLE = 40.0;
-  constexpr auto DEFAULT_PI_CATION_MAXIMUM_DISTANCE = 6.6;
-  constexpr auto DEFAULT_PI_CATION_MAXIMUM_ANGLE = 30.0;
-  constexpr auto PIPI_FACE_TO_FACE_MAXIMUM_DISTANCE = 4.4;
-  constexpr auto PIPI_FACE_TO_FACE_MAXIMUM_ANGLE = 30.0;
-  constexpr auto PIPI_EDGE_TO_FACE_MAXIMUM_DISTANCE = 5.5;
-  constexpr auto PIPI_EDGE_TO_FACE_MINIMUM_ANGLE = 60.0;
-
   const bool sele_is_same = sele1 == sele2 && state1 == state2;
 
   auto rings1 = cnrings_from_objrings(FindRings(G, sele1, true), state1);
@@ -1090,4 +1092,440 @@ DistSet* FindSaltBridgeInteractions(PyMOLGlobals* G, DistSet* ds, int sele1,
   return ds;
 }
 
+/**
+ * State independent input of FindInteractionTable
+ */
+struct InteractionContext {
+  PyMOLGlobals* G;
+  int types;
+
+  /// Participating atoms (object, atom index)
+  std::vector<std::pair<ObjectMolecule*, int>> atoms;
+  std::vector<bool> in1, in2;
+
+  /// Rings as atom table indices
+  std::vector<AtomIndices> rings;
+  std::vector<bool> ring_in1, ring_in2;
+
+  /// Cations as atom table indices
+  AtomIndices cations;
+
+  HBondCriteria hbc;
+  HalogenBondCriteria halogen;
+  float hbond_cutoff;
+  float salt_bridge_cutoff;
+
+  /// Neighbor grid cutoff, maximum of all atom pair detectors
+  float cutoff;
+
+  InteractionContext(PyMOLGlobals* G_, int types_)
+      : G(G_)
+      , types(types_)
+      , halogen(G_)
+  {
+  }
+};
+
+/**
+ * Angle at `center` in degrees
+ */
+static float AngleDegrees(const float* center, const float* v1, const float* v2)
+{
+  float d1[3], d2[3];
+  subtract3f(v1, center, d1);
+  subtract3f(v2, center, d2);
+  return rad_to_deg(get_angle3f(d1, d2));
+}
+
+/**
+ * H-bond, salt bridge and halogen bond detection for one atom pair
+ */
+static void FindPairInteractions(const InteractionContext& ctx, int state,
+    int i, int j, float dist, const float* const* vptr,
+    std::vector<InteractionRecord>& records)
+{
+  auto* obj1 = ctx.atoms[i].first;
+  auto* obj2 = ctx.atoms[j].first;
+  int const at1 = ctx.atoms[i].second;
+  int const at2 = ctx.atoms[j].second;
+  auto const* ai1 = obj1->AtomInfo + at1;
+  auto const* ai2 = obj2->AtomInfo + at2;
+
+  if ((ctx.types & cInteractionHBond) && dist < ctx.hbond_cutoff) {
+    HBondCriteria hbc = ctx.hbc;
+    float h_crd[3];
+    int don = -1, acc = -1;
+
+    if (ai1->hb_donor && ai2->hb_acceptor &&
+        ObjectMoleculeGetCheckHBond(
+            nullptr, h_crd, obj1, at1, state, obj2, at2, state, &hbc)) {
+      don = i;
+      acc = j;
+    } else if (ai1->hb_acceptor && ai2->hb_donor &&
+               ObjectMoleculeGetCheckHBond(
+                   nullptr, h_crd, obj2, at2, state, obj1, at1, state, &hbc)) {
+      don = j;
+      acc = i;
+    }
+
+    if (don != -1) {
+      records.push_back({state, cInteractionHBond, don, acc, dist,
+          AngleDegrees(h_crd, vptr[don], vptr[acc])});
+    }
+  }
+
+  if ((ctx.types & cInteractionSaltBridge) && dist < ctx.salt_bridge_cutoff &&
+      ai1->formalCharge * ai2->formalCharge < 0 && !ai1->isHydrogen() &&
+      !ai2->isHydrogen()) {
+    bool const anion_first = ai1->formalCharge < 0;
+    records.push_back({state, cInteractionSaltBridge, anion_first ? i : j,
+        anion_first ? j : i, dist, NAN});
+  }
+
+  if ((ctx.types & cInteractionHalogenBond) &&
+      dist < ctx.halogen.m_distance) {
+    HalogenBondCriteria hbc = ctx.halogen;
+    int don = -1, acc = -1;
+
+    if (ai1->hb_donor) {
+      if (CheckHalogenBondAsAcceptor(
+              obj1, at1, state, obj2, at2, state, &hbc)) {
+        don = i;
+        acc = j;
+      }
+    } else if (ai2->hb_donor) {
+      if (CheckHalogenBondAsAcceptor(
+              obj2, at2, state, obj1, at1, state, &hbc)) {
+        don = j;
+        acc = i;
+      }
+    }
+
+    if (don == -1) {
+      if (ai2->hb_acceptor) {
+        if (CheckHalogenBondAsDonor(obj1, at1, state, obj2, at2, state, &hbc)) {
+          don = i;
+          acc = j;
+        }
+      } else if (ai1->hb_acceptor) {
+        if (CheckHalogenBondAsDonor(obj2, at2, state, obj1, at1, state, &hbc)) {
+          don = j;
+          acc = i;
+        }
+      }
+    }
+
+    if (don != -1) {
+      float v_d[3];
+      float angle = NAN;
+      if (ObjectMoleculeGetNeighborVector(ctx.atoms[don].first,
+              ctx.atoms[don].second, state, v_d)) {
+        angle = AngleDegrees(vptr[don], v_d, vptr[acc]);
+      }
+      records.push_back(
+          {state, cInteractionHalogenBond, don, acc, dist, angle});
+    }
+  }
+}
+
+/**
+ * All interactions of one state
+ */
+static void FindStateInteractions(const InteractionContext& ctx, int state,
+    std::vector<InteractionRecord>& records)
+{
+  int const n_atom = ctx.atoms.size();
+
+  std::vector<const float*> vptr(n_atom, nullptr);
+  for (int i = 0; i < n_atom; ++i) {
+    auto const* cs = ctx.atoms[i].first->getCoordSet(state);
+    if (cs) {
+      auto const idx = cs->atmToIdx(ctx.atoms[i].second);
+      if (idx >= 0) {
+        vptr[i] = cs->coordPtr(idx);
+      }
+    }
+  }
+
+  // one grid for all atom pair detectors
+  if (ctx.types & (cInteractionHBond | cInteractionSaltBridge |
+                      cInteractionHalogenBond)) {
+    std::vector<float> coords;
+    AtomIndices vert_atom;
+    for (int j = 0; j < n_atom; ++j) {
+      if (vptr[j] && ctx.in2[j]) {
+        coords.insert(coords.end(), vptr[j], vptr[j] + 3);
+        vert_atom.push_back(j);
+      }
+    }
+
+    if (!vert_atom.empty()) {
+      MapType map(ctx.G, -ctx.cutoff, coords.data(), vert_atom.size());
+      MapSetupExpress(&map);
+
+      for (int i = 0; i < n_atom; ++i) {
+        if (!vptr[i] || !ctx.in1[i]) {
+          continue;
+        }
+
+        for (int v : MapEIter(map, vptr[i])) {
+          int const j = vert_atom[v];
+
+          // eliminate self and reverse duplicates
+          if (j == i || (j < i && ctx.in1[j] && ctx.in2[i])) {
+            continue;
+          }
+
+          float const dist = diff3f(vptr[i], vptr[j]);
+          if (dist < ctx.cutoff) {
+            FindPairInteractions(ctx, state, i, j, dist, vptr.data(), records);
+          }
+        }
+      }
+    }
+  }
+
+  if (!(ctx.types & (cInteractionPiPi | cInteractionPiCation))) {
+    return;
+  }
+
+  // rings with all atoms present in this state
+  std::vector<CNRing> rings;
+  AtomIndices ring_id;
+  for (int r = 0; r < int(ctx.rings.size()); ++r) {
+    Coords ringcoords;
+    for (int a : ctx.rings[r]) {
+      if (vptr[a]) {
+        ringcoords.emplace_back(vptr[a][0], vptr[a][1], vptr[a][2]);
+      }
+    }
+    if (ringcoords.size() == ctx.rings[r].size()) {
+      rings.emplace_back(ringcoords);
+      ring_id.push_back(r);
+    }
+  }
+
+  if (rings.empty()) {
+    return;
+  }
+
+  // one ring center grid for pi-pi and pi-cation
+  MapType centers(ctx.G, -DEFAULT_PI_CATION_MAXIMUM_DISTANCE,
+      flatten_ring_centers(rings).data(), rings.size(), nullptr);
+  MapSetupExpress(&centers);
+
+  if (ctx.types & cInteractionPiPi) {
+    for (int a = 0; a < int(rings.size()); ++a) {
+      int const ra = ring_id[a];
+      if (!ctx.ring_in1[ra]) {
+        continue;
+      }
+
+      for (int b : MapEIter(centers, glm::value_ptr(rings[a].center))) {
+        int const rb = ring_id[b];
+        if (b == a || !ctx.ring_in2[rb] ||
+            (b < a && ctx.ring_in1[rb] && ctx.ring_in2[ra])) {
+          continue;
+        }
+
+        auto const v = rings[b].center - rings[a].center;
+        auto const distance = glm::length(v);
+
+        if (distance < 1e-2 || distance > PIPI_EDGE_TO_FACE_MAXIMUM_DISTANCE) {
+          continue;
+        }
+
+        if (angle_acute_degrees(rings[a].normal, v) >
+                RING_ALIGNMENT_MAX_ANGLE &&
+            angle_acute_degrees(rings[b].normal, v) >
+                RING_ALIGNMENT_MAX_ANGLE) {
+          // collinear
+          continue;
+        }
+
+        auto const angle = angle_acute_degrees(rings[a].normal, rings[b].normal);
+
+        if ((angle < PIPI_FACE_TO_FACE_MAXIMUM_ANGLE &&
+                distance < PIPI_FACE_TO_FACE_MAXIMUM_DISTANCE) ||
+            angle > PIPI_EDGE_TO_FACE_MINIMUM_ANGLE) {
+          records.push_back({state, cInteractionPiPi, ctx.rings[ra][0],
+              ctx.rings[rb][0], distance, angle});
+        }
+      }
+    }
+  }
+
+  if (ctx.types & cInteractionPiCation) {
+    for (int c : ctx.cations) {
+      if (!vptr[c]) {
+        continue;
+      }
+
+      glm::vec3 const cation(vptr[c][0], vptr[c][1], vptr[c][2]);
+
+      for (int b : MapEIter(centers, vptr[c])) {
+        int const rb = ring_id[b];
+        if (!(ctx.ring_in1[rb] && ctx.in2[c]) &&
+            !(ctx.ring_in2[rb] && ctx.in1[c])) {
+          continue;
+        }
+
+        auto const v = cation - rings[b].center;
+        auto const distance = glm::length(v);
+
+        if (distance > DEFAULT_PI_CATION_MAXIMUM_DISTANCE) {
+          continue;
+        }
+
+        auto const angle = angle_acute_degrees(rings[b].normal, v);
+
+        if (angle <= DEFAULT_PI_CATION_MAXIMUM_ANGLE) {
+          records.push_back({state, cInteractionPiCation, ctx.rings[rb][0], c,
+              distance, angle});
+        }
+      }
+    }
+  }
+}
+
+InteractionTable FindInteractionTable(
+    PyMOLGlobals* G, int sele1, int sele2, int state, int types)
+{
+  InteractionContext ctx(G, types);
+  CSelector* I = G->Selector;
+
+  ObjRings rings1, rings2;
+  ObjAtoms cations1, cations2;
+
+  if (types & (cInteractionPiPi | cInteractionPiCation)) {
+    rings1 = FindRings(G, sele1, true);
+    rings2 = sele1 == sele2 ? rings1 : FindRings(G, sele2, true);
+  }
+
+  if (types & cInteractionPiCation) {
+    cations1 = FindCations(G, sele1);
+    cations2 = sele1 == sele2 ? cations1 : FindCations(G, sele2);
+  }
+
+  SelectorUpdateTable(G, cSelectorUpdateTableAllStates, -1);
+
+  // object atom index to table index
+  std::map<const ObjectMolecule*, AtomIndices> lookup;
+  int n_state = 0;
+
+  for (SelectorAtomIterator iter(I); iter.next();) {
+    int const s = iter.getAtomInfo()->selEntry;
+    bool const is1 = SelectorIsMember(G, s, sele1);
+    bool const is2 = SelectorIsMember(G, s, sele2);
+
+    if (!is1 && !is2) {
+      continue;
+    }
+
+    auto& obj_lookup = lookup[iter.obj];
+    if (obj_lookup.empty()) {
+      // neighbors and donor/acceptor flags must be ready before going parallel
+      ObjectMoleculeVerifyChemistry(iter.obj, -1);
+      iter.obj->getNeighborArray();
+      obj_lookup.assign(iter.obj->NAtom, -1);
+      n_state = std::max(n_state, iter.obj->NCSet);
+    }
+
+    obj_lookup[iter.getAtm()] = ctx.atoms.size();
+    ctx.atoms.emplace_back(iter.obj, iter.getAtm());
+    ctx.in1.push_back(is1);
+    ctx.in2.push_back(is2);
+  }
+
+  // table index, adds atoms outside of the selections (e.g. ring atoms)
+  auto table_index = [&](const ObjectMolecule* obj, int atm) {
+    auto& obj_lookup = lookup[obj];
+    if (obj_lookup.empty()) {
+      obj_lookup.assign(obj->NAtom, -1);
+    }
+    if (obj_lookup[atm] == -1) {
+      obj_lookup[atm] = ctx.atoms.size();
+      ctx.atoms.emplace_back(const_cast<ObjectMolecule*>(obj), atm);
+      ctx.in1.push_back(false);
+      ctx.in2.push_back(false);
+    }
+    return obj_lookup[atm];
+  };
+
+  std::map<AtomIndices, int> ring_index;
+  for (auto* objrings : {&rings1, &rings2}) {
+    for (auto& objitem : *objrings) {
+      for (auto& ring : objitem.second) {
+        AtomIndices ring_atoms;
+        for (int atm : ring) {
+          ring_atoms.push_back(table_index(objitem.first, atm));
+        }
+        auto it = ring_index.find(ring_atoms);
+        if (it == ring_index.end()) {
+          it = ring_index.emplace(ring_atoms, ctx.rings.size()).first;
+          ctx.rings.push_back(std::move(ring_atoms));
+          ctx.ring_in1.push_back(false);
+          ctx.ring_in2.push_back(false);
+        }
+        (objrings == &rings1 ? ctx.ring_in1 : ctx.ring_in2)[it->second] = true;
+      }
+    }
+  }
+
+  std::set<int> cations;
+  for (auto* objatoms : {&cations1, &cations2}) {
+    for (auto& objitem : *objatoms) {
+      for (int atm : objitem.second) {
+        cations.insert(table_index(objitem.first, atm));
+      }
+    }
+  }
+  ctx.cations.assign(cations.begin(), cations.end());
+
+  ObjectMoleculeInitHBondCriteria(G, &ctx.hbc);
+  ctx.hbond_cutoff = std::max(ctx.hbc.maxDistAtMaxAngle, ctx.hbc.maxDistAtZero);
+  ctx.salt_bridge_cutoff = SaltBridgeCriteria(G).m_distance;
+
+  constexpr float max_cutoff = 1000.0f;
+  for (float* cutoff : {&ctx.hbond_cutoff, &ctx.salt_bridge_cutoff,
+           &ctx.halogen.m_distance}) {
+    if (*cutoff < 0.0f) {
+      *cutoff = max_cutoff;
+    }
+  }
+
+  ctx.cutoff = 0.0f;
+  if (types & cInteractionHBond)
+    ctx.cutoff = std::max(ctx.cutoff, ctx.hbond_cutoff);
+  if (types & cInteractionSaltBridge)
+    ctx.cutoff = std::max(ctx.cutoff, ctx.salt_bridge_cutoff);
+  if (types & cInteractionHalogenBond)
+    ctx.cutoff = std::max(ctx.cutoff, ctx.halogen.m_distance);
+
+  AtomIndices states;
+  if (state == cStateAll) {
+    for (int s = 0; s < n_state; ++s) {
+      states.push_back(s);
+    }
+  } else {
+    states.push_back(state);
+  }
+
+  std::vector<std::vector<InteractionRecord>> state_records(states.size());
+
+#pragma omp parallel for schedule(dynamic)
+  for (int k = 0; k < int(states.size()); ++k) {
+    FindStateInteractions(ctx, states[k], state_records[k]);
+  }
+
+  InteractionTable table;
+  table.atoms.assign(ctx.atoms.begin(), ctx.atoms.end());
+
+  for (auto& records : state_records) {
+    table.records.insert(table.records.end(), records.begin(), records.end());
+  }
+
+  return table;
+}
+
 } // namespace pymol
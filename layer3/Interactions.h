@@ -2,7 +2,11 @@
 
 #include "PyMOLGlobals.h"
 
+#include <utility>
+#include <vector>
+
 struct DistSet;
+struct ObjectMolecule;
 
 namespace pymol
 {
@@ -101,4 +105,58 @@ DistSet* FindHalogenBondInteractions(PyMOLGlobals* G, DistSet* ds, int sele1,
  */
 DistSet* FindSaltBridgeInteractions(PyMOLGlobals* G, DistSet* ds, int sele1,
     int state1, int sele2, int state2, float cutoff, float* result);
+
+/**
+ * Interaction types for FindInteractionTable (bit mask)
+ */
+enum InteractionType {
+  cInteractionHBond = 0x01,
+  cInteractionSaltBridge = 0x02,
+  cInteractionHalogenBond = 0x04,
+  cInteractionPiPi = 0x08,
+  cInteractionPiCation = 0x10,
+  cInteractionAll = 0x1F,
+};
+
+/**
+ * One detected interaction
+ */
+struct InteractionRecord {
+  int state;      //!< 0-based state index
+  int type;       //!< single InteractionType bit
+  int atom1;      //!< donor, anion, or ring (index into InteractionTable::atoms)
+  int atom2;      //!< acceptor, cation, or ring
+  float distance; //!< heavy atom (or ring center) distance
+  float angle;    //!< see FindInteractionTable, NaN for salt bridges
+};
+
+/**
+ * Per-frame interaction fingerprints, without display geometry
+ */
+struct InteractionTable {
+  /// (object, 0-based atom index) for all atoms referenced by records
+  std::vector<std::pair<const ObjectMolecule*, int>> atoms;
+  /// Ordered by state
+  std::vector<InteractionRecord> records;
+};
+
+/**
+ * Find interactions between two selections in every requested state.
+ * States are processed in parallel and one neighbor grid per state is shared
+ * by the H-bond, salt bridge and halogen bond detectors (a ring center grid
+ * by the pi detectors). Uses the same criteria and settings as the
+ * respective `distance` modes.
+ *
+ * Angles: D-H...A at H for H-bonds, neighbor-D...A at the donor for halogen
+ * bonds, between ring normals for pi-pi and between ring normal and
+ * center-cation vector for pi-cation. Rings are represented by their first
+ * atom.
+ *
+ * @param sele1 Selection index
+ * @param sele2 Selection index
+ * @param state Object state or cStateAll
+ * @param types InteractionType bit mask
+ */
+InteractionTable FindInteractionTable(
+    PyMOLGlobals* G, int sele1, int sele2, int state, int types);
 }
@@ -7,8 +7,10 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <array>
 #include <cstdarg>
 #include <clocale>
+#include <cstring>
 #include <memory>
 
 #ifndef _PYMOL_NO_MSGPACKC
@@ -19,6 +21,7 @@
 #include "os_std.h"
 
 #include "MoleculeExporter.h"
+#include "File.h"
 #include "Selector.h"
 #include "SelectorDef.h"
 #include "Executive.h"
@@ -107,6 +110,13 @@ int VLAprintf(pymol::vla<char>& vla, int offset, const char * format, ...) {
   return n;
 }
 
+// buffer limits for flushing (see MoleculeExporter::execute)
+constexpr int FlushSize = 1 << 22;
+constexpr std::size_t FlushAtoms = 1 << 16;
+
+// number of atom records per parallel formatting task
+constexpr int ChunkSize = 1024;
+
 // for "multisave" behavior
 enum {
   cMolExportGlobal     = 0,
@@ -133,9 +143,32 @@ struct AtomRef {
 struct MoleculeExporter {
   pymol::vla<char> m_buffer; //!< Out buffer and final result
 
+  /// If not null, the buffer is flushed to this file periodically
+  FILE* m_sink = nullptr;
+
+  /// True if writing to `m_sink` failed
+  bool m_sink_error = false;
+
 protected:
   int m_offset = 0; //!< Offset into `m_buffer`
 
+  /// Flushed output (no sink), moved to `m_buffer` when done
+  pymol::vla<char> m_result;
+  int m_result_size = 0;
+
+  /// Atom record which is formatted later (in parallel) by formatAtoms()
+  struct DeferredAtom {
+    const AtomInfoType* ai;
+    float coord[3];
+    int id;     //!< getTmpID()
+    int state;  //!< object state (0-based)
+    int offset; //!< insert position in `m_buffer`
+    int matrix; //!< index into `m_deferred_matrices` (ANISOU) or -1
+  };
+
+  std::vector<DeferredAtom> m_deferred;
+  std::vector<std::array<double, 16>> m_deferred_matrices;
+
   CoordSet* m_last_cs = nullptr;
   ObjectMolecule* m_last_obj = nullptr;
   int m_last_state = -1;
@@ -182,7 +215,8 @@ public:
   virtual ~MoleculeExporter() = default;
 
   /**
-   * Do the export (e.g. populate "m_buffer" with file contents)
+   * Do the export (e.g. populate "m_buffer" with file contents, or write
+   * them to "m_sink")
    */
   void execute(int sele, int state);
 
@@ -247,7 +281,38 @@ private:
    */
   void populateBondRefs();
 
+  /**
+   * Format the deferred atoms and move the buffer contents to the sink (or
+   * the result).
+   */
+  void flush();
+
+  void output(const char* data, int size);
+
 protected:
+  /**
+   * Defer formatting of the current atom's record. The record will be
+   * inserted at the current buffer position.
+   */
+  void deferAtom();
+
+  /**
+   * Format deferred atom records. Called concurrently for different ranges
+   * of atoms, so implementations must not modify the exporter.
+   *
+   * @param atoms Atoms to format
+   * @param n Number of atoms
+   * @param[out] out Buffer to write to
+   * @param[out] ends Offset in `out` after each atom's record
+   */
+  virtual void formatAtoms(const DeferredAtom* atoms, int n,
+      pymol::vla<char>& out, int* ends) const {}
+
+  /**
+   * False while the buffer contains a placeholder which is filled in later
+   */
+  virtual bool canFlush() const { return true; }
+
   // functions to be implemented by derived classes
   virtual int getMultiDefault() const = 0;
   virtual bool isExcludedBond(int atm1, int atm2);
@@ -354,6 +419,12 @@ void MoleculeExporter::execute(int sele, int state) {
     }
 
     writeAtom();
+
+    // bounded memory for large exports
+    if ((m_offset > FlushSize || m_deferred.size() >= FlushAtoms) &&
+        canFlush()) {
+      flush();
+    }
   }
 
   if (m_last_cs)
@@ -368,7 +439,87 @@ void MoleculeExporter::execute(int sele, int state) {
     writeBonds();
   }
 
-  m_buffer.resize(m_offset);
+  if (!m_sink && !m_result_size && m_deferred.empty()) {
+    // everything in one piece
+    m_buffer.resize(m_offset);
+    return;
+  }
+
+  flush();
+
+  if (!m_sink) {
+    m_result.resize(m_result_size);
+    m_buffer = std::move(m_result);
+    m_offset = m_result_size;
+  }
+}
+
+void MoleculeExporter::deferAtom() {
+  const auto ai = m_iter.getAtomInfo();
+  int matrix = -1;
+
+  if (ai->has_anisou() && m_mat_full.ptr) {
+    if (m_deferred_matrices.empty() ||
+        memcmp(m_deferred_matrices.back().data(), m_mat_full.ptr,
+            sizeof(double) * 16) != 0) {
+      m_deferred_matrices.emplace_back();
+      std::copy_n(m_mat_full.ptr, 16, m_deferred_matrices.back().data());
+    }
+    matrix = m_deferred_matrices.size() - 1;
+  }
+
+  m_deferred.push_back({ai, {m_coord[0], m_coord[1], m_coord[2]}, getTmpID(),
+      m_iter.state, m_offset, matrix});
+}
+
+void MoleculeExporter::output(const char* data, int size) {
+  if (size <= 0)
+    return;
+
+  if (!m_sink) {
+    m_result.reserve(m_result_size + size);
+    memcpy(m_result + m_result_size, data, size);
+    m_result_size += size;
+  } else if (!m_sink_error && fwrite(data, 1, size, m_sink) != size_t(size)) {
+    m_sink_error = true;
+  }
+}
+
+void MoleculeExporter::flush() {
+  int const n = m_deferred.size();
+  int const n_chunks = (n + ChunkSize - 1) / ChunkSize;
+
+  std::vector<pymol::vla<char>> chunks(n_chunks);
+  std::vector<int> ends(n);
+
+  // format records in parallel, concatenate in order
+#pragma omp parallel for schedule(dynamic)
+  for (int c = 0; c < n_chunks; ++c) {
+    int const begin = c * ChunkSize;
+    int const count = std::min(ChunkSize, n - begin);
+    chunks[c] = pymol::vla<char>(count * 96);
+    formatAtoms(m_deferred.data() + begin, count, chunks[c], ends.data() + begin);
+  }
+
+  int pos = 0;
+
+  for (int c = 0; c < n_chunks; ++c) {
+    int start = 0;
+    for (int i = c * ChunkSize, i_end = std::min(i + ChunkSize, n); i != i_end;
+         ++i) {
+      int const offset = m_deferred[i].offset;
+      output(m_buffer + pos, offset - pos);
+      output(chunks[c] + start, ends[i] - start);
+      pos = offset;
+      start = ends[i];
+    }
+  }
+
+  output(m_buffer + pos, m_offset - pos);
+
+  m_offset = 0;
+  m_deferred.clear();
+  m_deferred_matrices.clear();
 }
 
 void MoleculeExporter::setRefObject(const char * ref_object, int ref_state) {
@@ -496,9 +647,19 @@ struct MoleculeExporterPDB : public MoleculeExporter {
 
   void writeAtom() override {
     writeTER(m_iter.getAtomInfo());
-
-    CoordSetAtomToPDBStrVLA(G, &m_buffer, &m_offset, m_iter.getAtomInfo(),
-        m_coord, getTmpID() - 1, &m_pdb_info, m_mat_full.ptr);
+    deferAtom();
+  }
+
+  void formatAtoms(const DeferredAtom* atoms, int n, pymol::vla<char>& out,
+      int* ends) const override {
+    int offset = 0;
+    for (int i = 0; i < n; ++i) {
+      const auto& atom = atoms[i];
+      CoordSetAtomToPDBStrVLA(G, &out, &offset, atom.ai, atom.coord,
+          atom.id - 1, &m_pdb_info,
+          atom.matrix < 0 ? nullptr : m_deferred_matrices[atom.matrix].data());
+      ends[i] = offset;
+    }
   }
 
   void writeBonds() override {
@@ -705,39 +866,57 @@ struct MoleculeExporterCIF : public MoleculeExporter {
   }
 
   void writeAtom() override {
-    const AtomInfoType * ai = m_iter.getAtomInfo();
-    const char * entity_id = nullptr;
+    deferAtom();
+  }
+
+  void formatAtoms(const DeferredAtom* atoms, int n, pymol::vla<char>& out,
+      int* ends) const override {
+    // `cifrepr` is not thread-safe
+    CifDataValueFormatter repr(10);
+    char x[32], y[32], z[32];
+    int offset = 0;
+
+    for (int i = 0; i < n; ++i) {
+      const AtomInfoType * ai = atoms[i].ai;
+      const float * coord = atoms[i].coord;
+      const char * entity_id = nullptr;
 
 #ifdef _PYMOL_IP_PROPERTIES
-    char entity_id_buf[16];
-    if (ai->prop_id) {
-      entity_id = PropertyGetAsString(G, ai->prop_id, "entity_id", entity_id_buf);
-    }
+      char entity_id_buf[16];
+      if (ai->prop_id) {
+        entity_id = PropertyGetAsString(G, ai->prop_id, "entity_id", entity_id_buf);
+      }
 #endif
 
-    if (!entity_id) {
-      entity_id = LexStr(G, ai->custom);
-    }
+      if (!entity_id) {
+        entity_id = LexStr(G, ai->custom);
+      }
 
-    m_offset += VLAprintf(m_buffer, m_offset,
-        "%-6s %-3d %s %-3s " // type .. name
-        "%s %-3s %s %s " // alt .. entity_id
-        "%d %s %6.3f %6.3f %6.3f " // resv .. z
-        "%4.2f %6.2f %d %s %d\n",  // q .. state
-        ai->hetatm ? "HETATM" : "ATOM",
-        getTmpID(),
-        cifrepr(ai->elem),
-        cifrepr(LexStr(G, ai->name)),
-        cifrepr(ai->alt),
-        cifrepr(LexStr(G, ai->resn)),
-        cifrepr(LexStr(G, ai->segi)),
-        cifrepr(entity_id),
-        ai->resv,
-        cifrepr(ai->inscode, "?"),
-        m_coord[0], m_coord[1], m_coord[2],
-        ai->q, ai->b, ai->formalCharge,
-        cifrepr(LexStr(G, ai->chain)),
-        m_iter.state + 1);
+      UtilFormatFixed(x, coord[0], 6, 3);
+      UtilFormatFixed(y, coord[1], 6, 3);
+      UtilFormatFixed(z, coord[2], 6, 3);
+
+      offset += VLAprintf(out, offset,
+          "%-6s %-3d %s %-3s " // type .. name
+          "%s %-3s %s %s " // alt .. entity_id
+          "%d %s %s %s %s " // resv .. z
+          "%4.2f %6.2f %d %s %d\n",  // q .. state
+          ai->hetatm ? "HETATM" : "ATOM",
+          atoms[i].id,
+          repr(ai->elem),
+          repr(LexStr(G, ai->name)),
+          repr(ai->alt),
+          repr(LexStr(G, ai->resn)),
+          repr(LexStr(G, ai->segi)),
+          repr(entity_id),
+          ai->resv,
+          repr(ai->inscode, "?"),
+          x, y, z,
+          ai->q, ai->b, ai->formalCharge,
+          repr(LexStr(G, ai->chain)),
+          atoms[i].state + 1);
+      ends[i] = offset;
+    }
   }
 
   /**
@@ -976,7 +1155,7 @@ static const char MOL2_bondTypes[][3] = {
 
 struct MoleculeExporterMOL2 : public MoleculeExporter {
   int m_n_atoms; // atom count
-  int m_counts_offset; // offset for deferred counts writing
+  int m_counts_offset = -1; // offset for deferred counts writing
   std::vector<MOL2_SubSt> m_substs; // substructures
 
   int getMultiDefault() const override {
@@ -984,6 +1163,8 @@ struct MoleculeExporterMOL2 : public MoleculeExporter {
     return cMolExportByCoordSet;
   }
 
+  bool canFlush() const override { return m_counts_offset == -1; }
+
   void beginFile() override {
     m_offset += VLAprintf(m_buffer, m_offset,
         "# created with PyMOL " _PyMOL_VERSION "\n");
@@ -1043,6 +1224,7 @@ struct MoleculeExporterMOL2 : public MoleculeExporter {
     m_counts_offset += sprintf(m_buffer + m_counts_offset, "%d %d %d",
         m_n_atoms, (int) m_bonds.size(), (int) m_substs.size());
     m_buffer[m_counts_offset] = ' '; // overwrite terminator
+    m_counts_offset = -1;
 
     // RTI BOND
     // bond_id origin_atom_id target_atom_id bond_type [status_bits]
@@ -1087,7 +1269,7 @@ struct MoleculeExporterMOL2 : public MoleculeExporter {
 
 struct MoleculeExporterMAE : public MoleculeExporter {
   int m_n_atoms;
-  int m_n_atoms_offset;
+  int m_n_atoms_offset = -1;
   int m_n_arom_bonds = 0;
   std::map<int, const AtomInfoType *> m_atoms;
   bool m_has_anisou;
@@ -1096,6 +1278,8 @@ struct MoleculeExporterMAE : public MoleculeExporter {
 #ifdef _PYMOL_MAE_PROP_EXPORT
 #endif
 
+  bool canFlush() const override { return m_n_atoms_offset == -1; }
+
   /** Check if current object has any ANISOU data
    */
   bool currentObjectHasAnisou() const {
@@ -1382,6 +1566,7 @@ struct MoleculeExporterMAE : public MoleculeExporter {
     // atom count
     m_n_atoms_offset += sprintf(m_buffer + m_n_atoms_offset, "m_atom[%d]", m_n_atoms);
     m_buffer[m_n_atoms_offset] = ' '; // overwrite terminator
+    m_n_atoms_offset = -1;
 
     if (!m_bonds.empty()) {
       // table with zero rows not allowed
@@ -1437,13 +1622,15 @@ struct MoleculeExporterMAE : public MoleculeExporter {
 
 struct MoleculeExporterXYZ : public MoleculeExporter {
   int m_n_atoms;
-  int m_n_atoms_offset;
+  int m_n_atoms_offset = -1;
 
   int getMultiDefault() const override {
     // multi-entry format
     return cMolExportByCoordSet;
   }
 
+  bool canFlush() const override { return m_n_atoms_offset == -1; }
+
   void beginMolecule() override {
     MoleculeExporter::beginMolecule();
 
@@ -1470,6 +1657,7 @@ struct MoleculeExporterXYZ : public MoleculeExporter {
     // atom count
     m_n_atoms_offset += sprintf(m_buffer + m_n_atoms_offset, "%d", m_n_atoms);
     m_buffer[m_n_atoms_offset] = ' '; // overwrite terminator
+    m_n_atoms_offset = -1;
   }
 
   bool isExcludedBond(int atm1, int atm2) override {
@@ -1608,36 +1796,29 @@ public:
 /*========================================================================*/
 
 /**
- * Export the given selection to a molecular file format.
- *
- * @return File contents or nullptr if the format is not known.
+ * Create an exporter for the given format and export the selection.
  *
- * @param format      pdb, sdf, ...
- * @param selection   atom selection expression
- * @param state       object state (-1 for all, -2/-3 for current)
- * @param ref_object  name of a reference object which defines the frame of
- *              reference for exported coordinates
- * @param ref_state   reference object state
- * @param multi       defines how to handle selections which span multiple objects
- *              -1: use format-specific default
- *               0: one global "molecule" (default for PDB)
- *               1: molecules per objects
- *               2: molecules per states (default for sdf, mol2)
+ * @param filename If not null, write to this file (as `m_sink`) instead of
+ * `m_buffer`. The file is only opened after the selection and the format
+ * have been validated. The caller must close `m_sink`.
+ * @return error if the selection or the format is not valid, or if the
+ * file can't be opened
  */
-pymol::vla<char> MoleculeExporterGetStr(PyMOLGlobals * G,
+static pymol::Result<std::unique_ptr<MoleculeExporter>> MoleculeExporterExecute(
+    PyMOLGlobals * G,
     const char *format,
     const char *selection,
     int state,
     const char *ref_object,
     int ref_state,
     int multi,
-    bool quiet)
+    const char *filename = nullptr)
 {
   SelectorTmp tmpsele1(G, selection);
   int sele = tmpsele1.getIndex();
 
   if (sele < 0)
-    return {};
+    return pymol::make_error("Invalid selection: ", selection);
 
   std::unique_ptr<MoleculeExporter> exporter;
 
@@ -1672,12 +1853,19 @@ pymol::vla<char> MoleculeExporterGetStr(PyMOLGlobals * G,
 #else
     PRINTFB(G, FB_ObjectMolecule, FB_Errors)
       " Error: This build has no fast MMTF support.\n" ENDFB(G);
-    return {};
+    return pymol::make_error("No fast MMTF support");
 #endif
   } else {
     PRINTFB(G, FB_ObjectMolecule, FB_Errors)
       " Error: unknown format: '%s'\n", format ENDFB(G);
-    return {};
+    return pymol::make_error("Unknown format: ", format);
+  }
+
+  if (filename) {
+    exporter->m_sink = pymol_fopen(filename, "wb");
+    if (!exporter->m_sink) {
+      return pymol::make_error("Cannot open file for writing: ", filename);
+    }
   }
 
   // Ensure "." decimal point in printf. It's possible to change this from
@@ -1689,7 +1877,76 @@ pymol::vla<char> MoleculeExporterGetStr(PyMOLGlobals * G,
   exporter->setRefObject(ref_object, ref_state);
   exporter->execute(sele, state);
 
-  return std::move(exporter->m_buffer);
+  return exporter;
+}
+
+/**
+ * Export the given selection to a molecular file format.
+ *
+ * @return File contents or nullptr if the format is not known.
+ *
+ * @param format      pdb, sdf, ...
+ * @param selection   atom selection expression
+ * @param state       object state (-1 for all, -2/-3 for current)
+ * @param ref_object  name of a reference object which defines the frame of
+ *              reference for exported coordinates
+ * @param ref_state   reference object state
+ * @param multi       defines how to handle selections which span multiple objects
+ *              -1: use format-specific default
+ *               0: one global "molecule" (default for PDB)
+ *               1: molecules per objects
+ *               2: molecules per states (default for sdf, mol2)
+ */
+pymol::vla<char> MoleculeExporterGetStr(PyMOLGlobals * G,
+    const char *format,
+    const char *selection,
+    int state,
+    const char *ref_object,
+    int ref_state,
+    int multi,
+    bool quiet)
+{
+  auto exporter = MoleculeExporterExecute(
+      G, format, selection, state, ref_object, ref_state, multi);
+
+  if (!exporter)
+    return {};
+
+  return std::move((*exporter)->m_buffer);
+}
+
+/**
+ * Export the given selection to a file. Like MoleculeExporterGetStr, but
+ * the output is written in chunks while exporting, so memory use doesn't
+ * scale with the number of states.
+ *
+ * @param filename    output file name
+ */
+pymol::Result<> MoleculeExporterSave(PyMOLGlobals * G,
+    const char *filename,
+    const char *format,
+    const char *selection,
+    int state,
+    const char *ref_object,
+    int ref_state,
+    int multi,
+    bool quiet)
+{
+  auto exporter = MoleculeExporterExecute(
+      G, format, selection, state, ref_object, ref_state, multi, filename);
+  p_return_if_error(exporter);
+
+  auto& ex = *exporter;
+  bool const write_error = (fclose(ex->m_sink) != 0) || ex->m_sink_error;
+  ex->m_sink = nullptr;
+
+  if (write_error) {
+    // incomplete output
+    std::remove(filename);
+    return pymol::make_error("Write failed: ", filename);
+  }
+
+  return {};
 }
 
 /*========================================================================*/
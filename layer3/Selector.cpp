@@ -5607,16 +5607,29 @@ int SelectorAssignAtomTypes(PyMOLGlobals * G, int sele, int state, int quiet, in
 
   SelectorUpdateTable(G, state, -1);
 
-  ObjectMolecule *obj = nullptr;
+  std::vector<ObjectMolecule*> objs;
+  std::vector<std::pair<ObjectMolecule*, int>> atoms;
 
   for (SeleAtomIterator iter(G, sele); iter.next();) {
-    if (obj != iter.obj) {
-      obj = iter.obj;
-      ObjectMoleculeVerifyChemistry(obj, state);
+    if (objs.empty() || objs.back() != iter.obj) {
+      objs.push_back(iter.obj);
     }
+    atoms.emplace_back(iter.obj, iter.getAtm());
+  }
+
+  ObjectMoleculeVerifyChemistryBatch(objs, state);
+
+  // typing is read-only, only the lexicon update must be serial
+  std::vector<const char*> types(atoms.size());
+
+#pragma omp parallel for schedule(static) if (atoms.size() > 1000)
+  for (int i = 0; i < int(atoms.size()); ++i) {
+    types[i] = getMOL2Type(atoms[i].first, atoms[i].second);
+  }
 
-    LexAssign(G, iter.getAtomInfo()->textType,
-        getMOL2Type(obj, iter.getAtm()));
+  for (size_t i = 0; i != atoms.size(); ++i) {
+    auto* ai = atoms[i].first->AtomInfo + atoms[i].second;
+    LexAssign(G, ai->textType, types[i]);
   }
   return 1;
 #endif
@@ -7480,14 +7493,8 @@ static int SelectorSelect0(PyMOLGlobals * G, EvalElem * passed_base)
   case SELE_DESz:
     {
       /* first, verify chemistry for all atoms... */
-      ObjectMolecule *lastObj = nullptr, *obj;
-      for(a = cNDummyAtoms; a < I->Table.size(); a++) {
-        obj = I->Obj[I->Table[a].model];
-        if(obj != lastObj) {
-          ObjectMoleculeVerifyChemistry(obj, -1);
-          lastObj = obj;
-        }
-      }
+      ObjectMoleculeVerifyChemistryBatch(
+          {I->Obj.begin() + cNDummyModels, I->Obj.end()}, -1);
     }
     switch (base->code) {
     case SELE_HBAs:
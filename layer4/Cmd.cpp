@@ -59,6 +59,7 @@ Z* -------------------------------------------------------------------
 #include"main.h"
 #include"Scene.h"
 #include"SceneRay.h"
+#include"ScenePicking.h"
 #include"Setting.h"
 #include"Movie.h"
 #include"P.h"
@@ -496,40 +497,6 @@ static PyObject *CmdRayTraceThread(PyObject * self, PyObject * args)
   return APISuccess();
 }
 
-static PyObject *CmdCoordSetUpdateThread(PyObject * self, PyObject * args)
-{
-  PyMOLGlobals *G = nullptr;
-  PyObject *py_thread_info;
-  API_SETUP_ARGS(G, self, args, "OO", &self, &py_thread_info);
-
-  auto thread_info = reinterpret_cast<CCoordSetUpdateThreadInfo*>(
-      PyCapsule_GetPointer(py_thread_info, nullptr));
-  API_ASSERT(thread_info);
-
-  PUnblock(G);
-  CoordSetUpdateThread(thread_info);
-  PBlock(G);
-
-  return APISuccess();
-}
-
-static PyObject *CmdObjectUpdateThread(PyObject * self, PyObject * args)
-{
-  PyMOLGlobals *G = nullptr;
-  PyObject *py_thread_info;
-  API_SETUP_ARGS(G, self, args, "OO", &self, &py_thread_info);
-
-  auto thread_info = reinterpret_cast<CObjectUpdateThreadInfo*>(
-      PyCapsule_GetPointer(py_thread_info, nullptr));
-  API_ASSERT(thread_info);
-
-  PUnblock(G);
-  SceneObjectUpdateThread(thread_info);
-  PBlock(G);
-
-  return APISuccess();
-}
-
 static PyObject *CmdGetMovieLocked(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -1020,6 +987,57 @@ static PyObject *CmdSetSession(PyObject * self, PyObject * args)
   return APIResultOk(G, ok);
 }
 
+static PyObject* CmdSessionFileCreate(PyObject* self, PyObject* args)
+{
+  PyMOLGlobals* G = nullptr;
+  const char* filename;
+  API_SETUP_ARGS(G, self, args, "Os", &self, &filename);
+  APIEnterBlocked(G);
+  auto result = ExecutiveSessionFileCreate(G, filename);
+  APIExitBlocked(G);
+  return APIResult(G, result);
+}
+
+static PyObject* CmdSessionFileFinish(PyObject* self, PyObject* args)
+{
+  PyMOLGlobals* G = nullptr;
+  PyObject* pickle;
+  API_SETUP_ARGS(G, self, args, "OO", &self, &pickle);
+  API_ASSERT(pickle == Py_None || PyBytes_Check(pickle));
+  APIEnterBlocked(G);
+  auto result = (pickle == Py_None)
+                    ? ExecutiveSessionFileFinish(G, nullptr, 0)
+                    : ExecutiveSessionFileFinish(G, PyBytes_AsString(pickle),
+                          PyBytes_Size(pickle));
+  APIExitBlocked(G);
+  return APIResult(G, result);
+}
+
+static PyObject* CmdSessionFileOpen(PyObject* self, PyObject* args)
+{
+  PyMOLGlobals* G = nullptr;
+  const char* filename;
+  API_SETUP_ARGS(G, self, args, "Os", &self, &filename);
+  APIEnterBlocked(G);
+  auto result = ExecutiveSessionFileOpen(G, filename);
+  APIExitBlocked(G);
+  if (!result) {
+    return APIFailure(G, result.error());
+  }
+  return PyBytes_FromStringAndSize(
+      static_cast<const char*>(result->first), result->second);
+}
+
+static PyObject* CmdSessionFileClose(PyObject* self, PyObject* args)
+{
+  PyMOLGlobals* G = nullptr;
+  API_SETUP_ARGS(G, self, args, "O", &self);
+  APIEnterBlocked(G);
+  ExecutiveSessionFileClose(G);
+  APIExitBlocked(G);
+  return APISuccess();
+}
+
 static PyObject *CmdSetName(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -1625,6 +1643,36 @@ static PyObject *CmdMapHalve(PyObject * self, PyObject * args)
   return APIResult(G, result);
 }
 
+static PyObject *CmdMapFilter(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  char *name;
+  float bfactor, resolution;
+  int state, quiet;
+  API_SETUP_ARGS(G, self, args, "Osffii", &self, &name, &bfactor, &resolution,
+      &state, &quiet);
+  API_ASSERT(APIEnterNotModal(G));
+  auto result =
+      ExecutiveMapFFTFilter(G, name, bfactor, resolution, state, quiet);
+  APIExit(G);
+  return APIResult(G, result);
+}
+
+static PyObject *CmdGetMapCorrelation(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  char *name1, *name2;
+  int state1, state2;
+  float resolution;
+  API_SETUP_ARGS(G, self, args, "Ossiif", &self, &name1, &name2, &state1,
+      &state2, &resolution);
+  APIEnter(G);
+  auto result =
+      ExecutiveMapCorrelation(G, name1, name2, state1, state2, resolution);
+  APIExit(G);
+  return APIResult(G, result);
+}
+
 static PyObject *CmdGetRenderer(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -2179,6 +2227,18 @@ static PyObject *CmdGetArea(PyObject * self, PyObject * args)
   return APIResult(G, res);
 }
 
+static PyObject *CmdGetAtomAreas(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  const char *str1;
+  int state, load_b;
+  API_SETUP_ARGS(G, self, args, "Osii", &self, &str1, &state, &load_b);
+  APIEnter(G);
+  auto res = ExecutiveGetAtomAreas(G, str1, state, load_b);
+  APIExit(G);
+  return APIResult(G, res);
+}
+
 static PyObject *CmdPushUndo(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -2930,11 +2990,12 @@ static PyObject *CmdSymExp(PyObject * self, PyObject * args)
   pymol::CObject *mObj;
   int segi;
   int quiet;
+  int instanced = 0;
   /* oper 0 = all, 1 = sele + buffer, 2 = vector */
 
   int ok = false;
   ok =
-    PyArg_ParseTuple(args, "Osssfii", &self, &str1, &str2, &str3, &cutoff, &segi, &quiet);
+    PyArg_ParseTuple(args, "Osssfii|i", &self, &str1, &str2, &str3, &cutoff, &segi, &quiet, &instanced);
   if(ok) {
     API_SETUP_PYMOL_GLOBALS;
     ok = (G != nullptr);
@@ -2950,7 +3011,7 @@ static PyObject *CmdSymExp(PyObject * self, PyObject * args)
       }
     }
     if(mObj) {
-      ExecutiveSymExp(G, str1, str2, str3, cutoff, segi, quiet);        /* TODO STATUS */
+      ExecutiveSymExp(G, str1, str2, str3, cutoff, segi, quiet, instanced);        /* TODO STATUS */
     }
     APIExit(G);
   }
@@ -3751,6 +3812,29 @@ static PyObject *CmdIndex(PyObject * self, PyObject * args)
   return result;
 }
 
+/**
+ * Atoms at window position (x, y), or in the rectangle with lower left
+ * corner (x, y), as (model, 1-based index) tuples.
+ */
+static PyObject *CmdPick(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  int x, y, width, height;
+
+  API_SETUP_ARGS(G, self, args, "Oiiii", &self, &x, &y, &width, &height);
+  API_ASSERT(APIEnterNotModal(G));
+  auto const picked = ScenePickAtoms(G, x, y, width, height);
+  APIExit(G);
+
+  PyObject* result = PyList_New(picked.size());
+  for (size_t a = 0; a < picked.size(); ++a) {
+    auto tuple = Py_BuildValue("si", picked[a].context.object->Name,
+        picked[a].src.index + 1 /* 1-based */);
+    PyList_SetItem(result, a, tuple);
+  }
+  return result;
+}
+
 static PyObject *CmdFindPairs(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -3901,6 +3985,28 @@ static PyObject *CmdGetStr(PyObject * self, PyObject * args)
   return APIAutoNone(result);
 }
 
+static PyObject *CmdSaveStr(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  const char *filename;
+  const char *format;
+  const char *sele;
+  int state;
+  const char *ref;
+  int ref_state;
+  int quiet;
+  int multi;
+
+  API_SETUP_ARGS(G, self, args, "Osssisiii", &self, &filename, &format, &sele,
+      &state, &ref, &ref_state, &multi, &quiet);
+  APIEnter(G);
+  auto result = MoleculeExporterSave(G, filename, format, sele, state,
+      ref, ref_state, multi, quiet);
+  APIExit(G);
+
+  return APIResult(G, result);
+}
+
 static PyObject *CmdGetModel(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -3984,6 +4090,31 @@ static PyObject *CmdFitPairs(PyObject * self, PyObject * args)
   return APIResult(G, result);
 }
 
+static PyObject *CmdRMSMatrix(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  const char *sele, *filename;
+  int quiet;
+  API_SETUP_ARGS(G, self, args, "Ossi", &self, &sele, &filename, &quiet);
+  API_ASSERT(APIEnterNotModal(G));
+  auto result = ExecutiveRMSMatrix(G, sele, filename, quiet);
+  APIExit(G);
+  return APIResult(G, result);
+}
+
+static PyObject *CmdClusterStates(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  const char *sele;
+  float cutoff;
+  int quiet;
+  API_SETUP_ARGS(G, self, args, "Osfi", &self, &sele, &cutoff, &quiet);
+  API_ASSERT(APIEnterNotModal(G));
+  auto result = ExecutiveClusterStates(G, sele, cutoff, quiet);
+  APIExit(G);
+  return APIResult(G, result);
+}
+
 static PyObject *CmdIntraFit(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -4039,6 +4170,20 @@ static PyObject *CmdFit(PyObject * self, PyObject * args)
   }
 }
 
+static PyObject *CmdFitBatch(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  const char *str1, *str2;
+  int state1, state2;
+  int quiet;
+  API_SETUP_ARGS(G, self, args, "Ossiii", &self, &str1, &str2, &state1,
+      &state2, &quiet);
+  API_ASSERT(APIEnterNotModal(G));
+  auto result = ExecutiveFitBatch(G, str1, str2, state1, state2, quiet);
+  APIExit(G);
+  return APIResult(G, result);
+}
+
 static PyObject *CmdUpdate(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -4094,6 +4239,55 @@ static PyObject *CmdGetObjectList(PyObject * self, PyObject * args)
   return APIResult(G, res);
 }
 
+/**
+ * Column-wise conversion of an interaction table:
+ * (atoms, state, type, atom1, atom2, distance, angle)
+ * with atoms as (model, 1-based index) tuples.
+ */
+static PyObject* _interactionTableAsPyTuple(const pymol::InteractionTable& table)
+{
+  auto atoms = PyList_New(table.atoms.size());
+  for (size_t i = 0; i < table.atoms.size(); ++i) {
+    auto const& atom = table.atoms[i];
+    PyList_SET_ITEM(
+        atoms, i, Py_BuildValue("(si)", atom.first->Name, atom.second + 1));
+  }
+
+  auto const n = table.records.size();
+  std::vector<int> state(n), type(n), atom1(n), atom2(n);
+  std::vector<float> distance(n), angle(n);
+  for (size_t i = 0; i < n; ++i) {
+    auto const& rec = table.records[i];
+    state[i] = rec.state + 1;
+    type[i] = rec.type;
+    atom1[i] = rec.atom1;
+    atom2[i] = rec.atom2;
+    distance[i] = rec.distance;
+    angle[i] = rec.angle;
+  }
+
+  return Py_BuildValue("(NNNNNNN)", atoms,
+      PConvToPyObject(state), PConvToPyObject(type), PConvToPyObject(atom1),
+      PConvToPyObject(atom2), PConvToPyObject(distance),
+      PConvToPyObject(angle));
+}
+
+static PyObject *CmdInteractionTable(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  const char *str1, *str2;
+  int state, types, quiet;
+  API_SETUP_ARGS(G, self, args, "Ossiii", &self, &str1, &str2, &state, &types,
+      &quiet);
+  API_ASSERT(APIEnterNotModal(G));
+  auto result = ExecutiveInteractionTable(G, str1, str2, state, types, quiet);
+  APIExit(G);
+  if (!result) {
+    return APIFailure(G, result.error());
+  }
+  return _interactionTableAsPyTuple(result.result());
+}
+
 static PyObject *CmdGetDistance(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -4745,7 +4939,10 @@ static PyObject *CmdPNG(PyObject * self, PyObject * args)
 
     if(!prior) {
       if(ray || (!G->HaveGUI && (!SceneGetCopyType(G) || width || height))) {
-        prior = SceneRay(G, width, height, SettingGetGlobal_i(G, cSetting_ray_default_renderer),
+        int mode = SettingGetGlobal_i(G, cSetting_ray_default_renderer);
+        if(!ray && SettingGetGlobal_b(G, cSetting_headless_draw))
+          mode = cSceneRay_MODE_RASTER;
+        prior = SceneRay(G, width, height, mode,
                  nullptr, nullptr, 0.0F, 0.0F, quiet, nullptr, true, -1);
       } else if(width || height) {
         Extent2D extent{static_cast<std::uint32_t>(width),
@@ -6059,6 +6256,47 @@ static PyObject *CmdCEAlign(PyObject *self, PyObject *args)
   return result;
 }
 
+static PyObject *CmdCEAlignBatch(PyObject *self, PyObject *args)
+{
+  PyMOLGlobals * G = nullptr;
+  int windowSize = 8, gap_max=30;
+  float d0=3.0, d1=4.0;
+  PyObject *listA, *listsB;
+  API_SETUP_ARGS(G, self, args, "OO!O!|ffii", &self, &PyList_Type, &listA,
+      &PyList_Type, &listsB, &d0, &d1, &windowSize, &gap_max);
+
+  API_ASSERT(PyList_Size(listA) > 0);
+  for (Py_ssize_t i = 0, n = PyList_Size(listsB); i < n; ++i) {
+    API_ASSERT(PyList_Check(PyList_GetItem(listsB, i)));
+  }
+
+  Py_ssize_t const nMobile = PyList_Size(listsB);
+  auto coordsA = getCoords(listA, PyList_Size(listA));
+  std::vector<std::vector<cePoint>> coordsB(nMobile);
+  for (Py_ssize_t i = 0; i < nMobile; ++i) {
+    PyObject* listB = PyList_GetItem(listsB, i);
+    coordsB[i] = getCoords(listB, PyList_Size(listB));
+  }
+
+  // pure C++, other Python threads may run meanwhile
+  APIEnter(G);
+  auto alignments = ExecutiveCEAlignBatch(
+      G, coordsA, coordsB, d0, d1, windowSize, gap_max);
+  APIExit(G);
+
+  PyObject* result = PyList_New(nMobile);
+  for (Py_ssize_t i = 0; i < nMobile; ++i) {
+    PyObject* item = Py_None;
+    if (alignments[i]) {
+      item = ceAlignmentAsPyList(*alignments[i]);
+    } else {
+      Py_INCREF(item);
+    }
+    PyList_SET_ITEM(result, i, item);
+  }
+  return result;
+}
+
 static PyObject *CmdVolume(PyObject *self, PyObject *args)
 { 
   PyMOLGlobals *G = nullptr;
@@ -6270,14 +6508,15 @@ static PyMethodDef Cmd_methods[] = {
   /*  {"cache",                 CmdCache,                METH_VARARGS }, */
   {"cartoon", CmdCartoon, METH_VARARGS},
   {"cealign", CmdCEAlign, METH_VARARGS},
+  {"cealign_batch", CmdCEAlignBatch, METH_VARARGS},
   {"center", CmdCenter, METH_VARARGS},
   {"cif_get_array", CmdCifGetArray, METH_VARARGS},
   {"clip", CmdClip, METH_VARARGS},
+  {"cluster_states", CmdClusterStates, METH_VARARGS},
   {"cls", CmdCls, METH_VARARGS},
   {"color", CmdColor, METH_VARARGS},
   {"colordef", CmdColorDef, METH_VARARGS},
   {"combine_object_ttt", CmdCombineObjectTTT, METH_VARARGS},
-  {"coordset_update_thread", CmdCoordSetUpdateThread, METH_VARARGS},
   {"copy", CmdCopy, METH_VARARGS},
   {"create", CmdCreate, METH_VARARGS},
   {"count_states", CmdCountStates, METH_VARARGS},
@@ -6306,6 +6545,7 @@ static PyMethodDef Cmd_methods[] = {
   {"find_molfile_plugin", CmdFindMolfilePlugin, METH_VARARGS},
   {"finish_object", CmdFinishObject, METH_VARARGS},
   {"fit", CmdFit, METH_VARARGS},
+  {"fit_batch", CmdFitBatch, METH_VARARGS},
   {"fit_pairs", CmdFitPairs, METH_VARARGS},
   {"fix_chemistry", CmdFixChemistry, METH_VARARGS},
   {"flag", CmdFlag, METH_VARARGS},
@@ -6317,6 +6557,7 @@ static PyMethodDef Cmd_methods[] = {
   {"fuse", CmdFuse, METH_VARARGS},
   {"get_angle", CmdGetAngle, METH_VARARGS},
   {"get_area", CmdGetArea, METH_VARARGS},
+  {"get_atom_areas", CmdGetAtomAreas, METH_VARARGS},
   {"get_atom_coords", CmdGetAtomCoords, METH_VARARGS},
   {"get_bond_print", CmdGetBondPrint, METH_VARARGS},
   {"get_busy", CmdGetBusy, METH_VARARGS},
@@ -6336,6 +6577,7 @@ static PyMethodDef Cmd_methods[] = {
   {"get_feedback", CmdGetFeedback, METH_VARARGS},
   {"get_idtf", CmdGetIdtf, METH_VARARGS},
   {"get_legal_name", CmdGetLegalName, METH_VARARGS},
+  {"get_map_correlation", CmdGetMapCorrelation, METH_VARARGS},
   {"get_m2io_first_block_properties", CmdM2ioFirstBlockProperties, METH_VARARGS},
 //  {"get_matrix", CmdGetMatrix, METH_VARARGS},
   {"get_min_max", CmdGetMinMax, METH_VARARGS},
@@ -6392,6 +6634,7 @@ static PyMethodDef Cmd_methods[] = {
   {"h_fix", CmdHFix, METH_VARARGS},
   {"identify", CmdIdentify, METH_VARARGS},
   {"index", CmdIndex, METH_VARARGS},
+  {"interaction_table", CmdInteractionTable, METH_VARARGS},
   {"intrafit", CmdIntraFit, METH_VARARGS},
   {"invert", CmdInvert, METH_VARARGS},
   {"interrupt", CmdInterrupt, METH_VARARGS},
@@ -6414,6 +6657,7 @@ static PyMethodDef Cmd_methods[] = {
   {"map_new", CmdMapNew, METH_VARARGS},
   {"map_double", CmdMapDouble, METH_VARARGS},
   {"map_halve", CmdMapHalve, METH_VARARGS},
+  {"map_filter", CmdMapFilter, METH_VARARGS},
   {"map_set", CmdMapSet, METH_VARARGS},
   {"map_set_border", CmdMapSetBorder, METH_VARARGS},
   {"map_trim", CmdMapTrim, METH_VARARGS},
@@ -6432,7 +6676,6 @@ static PyMethodDef Cmd_methods[] = {
   {"mmatrix", CmdMMatrix, METH_VARARGS},
   {"move_on_curve", CmdMoveOnCurve, METH_VARARGS},
   {"mview", CmdMView, METH_VARARGS},
-  {"object_update_thread", CmdObjectUpdateThread, METH_VARARGS},
   {"origin", CmdOrigin, METH_VARARGS},
   {"orient", CmdOrient, METH_VARARGS},
   {"onoff", CmdOnOff, METH_VARARGS},
@@ -6441,6 +6684,7 @@ static PyMethodDef Cmd_methods[] = {
   {"scrollto", CmdScrollTo, METH_VARARGS},
   {"overlap", CmdOverlap, METH_VARARGS},
   {"paste", CmdPaste, METH_VARARGS},
+  {"pick", CmdPick, METH_VARARGS},
   {"png", CmdPNG, METH_VARARGS},
   {"pop", CmdPop, METH_VARARGS},
   {"protect", CmdProtect, METH_VARARGS},
@@ -6473,8 +6717,10 @@ static PyMethodDef Cmd_methods[] = {
   {"reset_rate", CmdResetRate, METH_VARARGS},
   {"reset_matrix", CmdResetMatrix, METH_VARARGS},
   {"revalence", CmdRevalence, METH_VARARGS},
+  {"rms_matrix", CmdRMSMatrix, METH_VARARGS},
   {"rock", CmdRock, METH_VARARGS},
   {"runpymol", CmdRunPyMOL, METH_VARARGS},
+  {"save_str", CmdSaveStr, METH_VARARGS},
   {"select", CmdSelect, METH_VARARGS},
   {"select_list", CmdSelectList, METH_VARARGS},
   {"set", CmdSet, METH_VARARGS},
@@ -6490,6 +6736,10 @@ static PyMethodDef Cmd_methods[] = {
   {"sculpt_activate", CmdSculptActivate, METH_VARARGS},
   {"sculpt_iterate", CmdSculptIterate, METH_VARARGS},
   {"sculpt_purge", CmdSculptPurge, METH_VARARGS},
+  {"session_file_close", CmdSessionFileClose, METH_VARARGS},
+  {"session_file_create", CmdSessionFileCreate, METH_VARARGS},
+  {"session_file_finish", CmdSessionFileFinish, METH_VARARGS},
+  {"session_file_open", CmdSessionFileOpen, METH_VARARGS},
   {"set_raw_alignment", CmdSetRawAlignment, METH_VARARGS},
   {"set_busy", CmdSetBusy, METH_VARARGS},
   {"set_colorection", CmdSetColorection, METH_VARARGS},
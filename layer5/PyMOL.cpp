@@ -33,6 +33,7 @@
 #include "Color.h"
 #include "Ortho.h"
 #include "Scene.h"
+#include "ScenePicking.h"
 #include "PyMOLObject.h"
 #include "Executive.h"
 #include "Word.h"
@@ -992,6 +993,32 @@ PyMOLreturn_status PyMOL_CmdSelectList(CPyMOL * I, const char *name, const char
   PYMOL_API_UNLOCK return result;
 }
 
+PyMOLreturn_string_array PyMOL_CmdPick(CPyMOL * I, int x, int y, int width, int height,
+                                       int quiet)
+{
+  PyMOLreturn_string_array result = { PyMOLstatus_FAILURE };
+  PYMOL_API_LOCK
+  auto const picked = ScenePickAtoms(I->G, x, y, width, height);
+
+  std::vector<std::string> names;
+  for (auto const& pick : picked) {
+    names.push_back(std::string(pick.context.object->Name) + "`" +
+                    std::to_string(pick.src.index + 1));
+  }
+
+  std::vector<const char*> ptrs;
+  for (auto const& name : names) {
+    ptrs.push_back(name.c_str());
+  }
+  result = return_result(pymol::Result<std::vector<const char*>>(ptrs));
+
+  if (!quiet) {
+    PRINTFB(I->G, FB_Scene, FB_Details)
+      " Pick: %zu atom(s)\n", names.size() ENDFB(I->G);
+  }
+  PYMOL_API_UNLOCK return result;
+}
+
 PyMOLreturn_status PyMOL_CmdShow(CPyMOL * I,
                                  const char *representation,
                                  const char *selection,
@@ -448,6 +448,12 @@ PyMOLreturn_status PyMOL_CmdSelect(CPyMOL * I, const char *name, const char *sel
 PyMOLreturn_status PyMOL_CmdSelectList(CPyMOL * I, const char *name, const char *object, int *list,
                                        int list_len, int state, const char *mode, int quiet);
 
+/* atoms at window position (x,y), or in the rectangle with lower left corner
+   (x,y) if width or height is greater than one, as "object`index" (1-based).
+   Doesn't need an OpenGL context, see the pick_cpu setting. */
+PyMOLreturn_string_array PyMOL_CmdPick(CPyMOL * I, int x, int y, int width, int height,
+                                       int quiet);
+
 PyMOLreturn_int PyMOL_CmdGetMovieLength(CPyMOL * I,int quiet);
 
 PyMOLreturn_float PyMOL_CmdGetDistance(CPyMOL * I,
@@ -0,0 +1,120 @@
+#include "Test.h"
+
+#include "CGO.h"
+
+#include <cstring>
+
+using namespace pymol;
+
+// a few BEGIN/END blocks like the cartoon extrusions write them
+static void emitBlocks(CGO* cgo)
+{
+  const float n[3] = {0.f, 1.f, 0.f};
+
+  CGOAlpha(cgo, 0.5f);
+
+  // strip with per-vertex colors and pick colors
+  CGOBegin(cgo, GL_TRIANGLE_STRIP);
+  for (int a = 0; a < 4; ++a) {
+    const float c[3] = {0.1f * a, 0.2f, 0.3f};
+    const float v[3] = {float(a), 0.f, 1.f};
+    CGOColorv(cgo, c);
+    CGOAlpha(cgo, 1.f);
+    CGOPickColor(cgo, a, cPickableAtom);
+    CGONormalv(cgo, n);
+    CGOVertexv(cgo, v);
+    CGOVertex(cgo, v[0], 1.f, 1.f);
+  }
+  CGOEnd(cgo);
+  CGOPickColor(cgo, -1, cPickableNoPick);
+
+  // fan with a single color set before the first vertex
+  CGOBegin(cgo, GL_TRIANGLE_FAN);
+  CGOColor(cgo, 1.f, 0.f, 0.f);
+  CGONormal(cgo, 0.f, 0.f, 1.f);
+  for (int a = 0; a < 5; ++a) {
+    CGOVertex(cgo, a, a * a, 0.f);
+  }
+  CGOEnd(cgo);
+
+  // empty block
+  CGOBegin(cgo, GL_TRIANGLES);
+  CGOColor(cgo, 0.f, 1.f, 0.f);
+  CGOEnd(cgo);
+
+  // triangles with accessibility
+  CGOBegin(cgo, GL_TRIANGLES);
+  for (int a = 0; a < 6; ++a) {
+    CGOAccessibility(cgo, a / 6.f);
+    CGOVertex(cgo, a, 0.f, -a);
+  }
+  CGOEnd(cgo);
+
+  CGOStop(cgo);
+}
+
+static bool equalOps(const CGO* lhs, const CGO* rhs)
+{
+  auto it1 = lhs->begin();
+  auto it2 = rhs->begin();
+  for (; !it1.is_stop() && !it2.is_stop(); ++it1, ++it2) {
+    if (it1.op_code() != it2.op_code()) {
+      return false;
+    }
+    if (it1.op_code() != CGO_DRAW_ARRAYS) {
+      auto const sz = CGO_sz[it1.op_code()];
+      if (memcmp(it1.data(), it2.data(), sz * sizeof(float))) {
+        return false;
+      }
+      continue;
+    }
+    auto sp1 = it1.cast<cgo::draw::arrays>();
+    auto sp2 = it2.cast<cgo::draw::arrays>();
+    if (sp1->mode != sp2->mode || sp1->arraybits != sp2->arraybits ||
+        sp1->nverts != sp2->nverts) {
+      return false;
+    }
+    // skip the pick color RGBA slots, they are only filled for rendering
+    int pick_rgba = -1;
+    if (sp1->arraybits & CGO_PICK_COLOR_ARRAY) {
+      pick_rgba = sp1->nverts * 3;
+      if (sp1->arraybits & CGO_NORMAL_ARRAY)
+        pick_rgba += sp1->nverts * 3;
+      if (sp1->arraybits & CGO_COLOR_ARRAY)
+        pick_rgba += sp1->nverts * 4;
+    }
+    for (int k = 0; k < sp1->get_data_length(); ++k) {
+      if (k >= pick_rgba && k < pick_rgba + sp1->nverts) {
+        continue;
+      }
+      if (memcmp(sp1->floatdata + k, sp2->floatdata + k, sizeof(float))) {
+        return false;
+      }
+    }
+  }
+  return it1.is_stop() && it2.is_stop();
+}
+
+TEST_CASE("CGOSetCombineBeginEnd matches CGOCombineBeginEnd", "[CGO]")
+{
+  PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  CGO* combined = CGONew(G);
+  emitBlocks(combined);
+  REQUIRE(combined->has_begin_end);
+  REQUIRE(CGOCombineBeginEnd(&combined));
+
+  CGO* streamed = CGONew(G);
+  CGOSetCombineBeginEnd(streamed, true);
+  emitBlocks(streamed);
+  CGOSetCombineBeginEnd(streamed, false);
+  REQUIRE(!streamed->has_begin_end);
+  REQUIRE(!streamed->begin_end_streams);
+
+  REQUIRE(CGOCountNumberOfOperationsOfType(streamed, CGO_DRAW_ARRAYS) == 3);
+  REQUIRE(equalOps(combined, streamed));
+
+  CGOFree(combined);
+  CGOFree(streamed);
+}
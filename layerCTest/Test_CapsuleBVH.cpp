@@ -0,0 +1,84 @@
+#include "Test.h"
+
+#include "CapsuleBVH.h"
+
+#include <cmath>
+
+using namespace pymol::test;
+
+static CapsuleBVH::Capsule make_sphere(float x, float y, float z, float radius)
+{
+  return {{x, y, z}, {x, y, z}, radius, false};
+}
+
+TEST_CASE("CapsuleBVH nearest sphere", "[CapsuleBVH]")
+{
+  std::vector<CapsuleBVH::Capsule> capsules;
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      capsules.push_back(make_sphere(i * 3.f, j * 3.f, -float(i + j), 1.f));
+    }
+  }
+  CapsuleBVH bvh(capsules);
+  REQUIRE(bvh.size() == 100);
+
+  float const dir[3] = {0.f, 0.f, -2.f}; // not normalized
+  CapsuleBVH::Hit hit;
+
+  float const origin1[3] = {6.f, 9.f, 10.f};
+  REQUIRE(bvh.intersect(origin1, dir, 0.f, 100.f, 0.f, hit));
+  REQUIRE(hit.id == 2 * 10 + 3);
+  // front of the sphere at z = -5 + 1
+  REQUIRE(hit.t == Approx(7.f));
+
+  // between spheres
+  float const origin2[3] = {7.5f, 9.f, 10.f};
+  REQUIRE(!bvh.intersect(origin2, dir, 0.f, 100.f, 0.f, hit));
+
+  // padding closes the gap
+  capsules[2 * 10 + 3].padded = true;
+  CapsuleBVH padded(capsules);
+  REQUIRE(padded.intersect(origin2, dir, 0.f, 100.f, 0.6f, hit));
+  REQUIRE(hit.id == 2 * 10 + 3);
+
+  // clipped by tmax
+  REQUIRE(!bvh.intersect(origin1, dir, 0.f, 6.5f, 0.f, hit));
+}
+
+TEST_CASE("CapsuleBVH capsule body and caps", "[CapsuleBVH]")
+{
+  std::vector<CapsuleBVH::Capsule> capsules = {
+      {{-5.f, 0.f, 0.f}, {5.f, 0.f, 0.f}, 0.5f, false},
+      make_sphere(0.f, 0.f, -3.f, 1.f),
+  };
+  CapsuleBVH bvh(capsules);
+
+  float const dir[3] = {0.f, 0.f, -1.f};
+  CapsuleBVH::Hit hit;
+
+  // body hides the sphere
+  float const origin1[3] = {0.f, 0.f, 10.f};
+  REQUIRE(bvh.intersect(origin1, dir, 0.f, 100.f, 0.f, hit));
+  REQUIRE(hit.id == 0);
+  REQUIRE(hit.t == Approx(9.5f));
+
+  // tmin behind the body
+  REQUIRE(bvh.intersect(origin1, dir, 10.6f, 100.f, 0.f, hit));
+  REQUIRE(hit.id == 1);
+  REQUIRE(hit.t == Approx(12.f));
+
+  // round cap beyond the segment end
+  float const origin2[3] = {5.3f, 0.f, 10.f};
+  REQUIRE(bvh.intersect(origin2, dir, 0.f, 100.f, 0.f, hit));
+  REQUIRE(hit.id == 0);
+  REQUIRE(hit.t == Approx(10.f - std::sqrt(0.25f - 0.09f)));
+
+  // along the axis
+  float const origin3[3] = {10.f, 0.f, 0.f};
+  float const dir3[3] = {-1.f, 0.f, 0.f};
+  REQUIRE(bvh.intersect(origin3, dir3, 0.f, 100.f, 0.f, hit));
+  REQUIRE(hit.id == 0);
+  REQUIRE(hit.t == Approx(4.5f));
+
+  REQUIRE(!CapsuleBVH().intersect(origin1, dir, 0.f, 100.f, 0.f, hit));
+}
@@ -199,6 +199,34 @@ TEST_CASE("Image Make Image", "[Image]")
   REQUIRE(iFILE.good());
 }
 
+TEST_CASE("Image PNG Encoding Roundtrip", "[Image]")
+{
+  // large enough for several compression bands
+  Image img(256, 1024);
+  for (int i = 0; i < img.getSizeInBytes(); i++) {
+    img.bits()[i] = (i % 4 == Image::Channel::ALPHA) ? 0xff : (i * 7 / 5) & 0xff;
+  }
+
+  for (bool fast : {false, true}) {
+    for (int n_threads : {1, 4}) {
+      MyPNGEncoding encoding;
+      encoding.fast = fast;
+      encoding.n_threads = n_threads;
+
+      png_outbuf_t outbuf;
+      REQUIRE(MyPNGWrite("", img, 72.f, cMyPNG_FormatPNG, true, 1.f, 1.f,
+          &outbuf, encoding));
+
+      TmpFILE tmpfile;
+      std::ofstream(tmpfile.getFilename(), std::ios::binary)
+          .write(reinterpret_cast<const char*>(outbuf.data()), outbuf.size());
+      auto decoded = MyPNGRead(tmpfile.getFilename());
+      REQUIRE(decoded);
+      REQUIRE(*decoded == img);
+    }
+  }
+}
+
 TEST_CASE("Image Deinterlace Data", "[Image]")
 {
   auto test_folder = get_test_folder();
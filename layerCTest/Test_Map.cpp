@@ -0,0 +1,127 @@
+#include "Test.h"
+
+#include "Map.h"
+#include "Vector.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace pymol;
+
+static std::vector<float> randomPoints(int n, float density = 0.1f)
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> dist(0.f, std::cbrt(n / density));
+  std::vector<float> v(3 * n);
+  for (auto& x : v) {
+    x = dist(rng);
+  }
+  return v;
+}
+
+TEST_CASE("MapEIter finds all neighbors", "[Map]")
+{
+  PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  int const n = 5000;
+  float const cutoff = 4.f;
+  auto const v = randomPoints(n);
+
+  MapType map(G, -cutoff, v.data(), n);
+
+  for (int i = 0; i < n; i += 37) {
+    const float* q = v.data() + 3 * i;
+    std::vector<int> expected, found;
+    for (int j = 0; j < n; ++j) {
+      if (within3f(v.data() + 3 * j, q, cutoff)) {
+        expected.push_back(j);
+      }
+    }
+    for (int j : MapEIter(map, q)) {
+      if (within3f(v.data() + 3 * j, q, cutoff)) {
+        found.push_back(j);
+      }
+    }
+    std::sort(found.begin(), found.end());
+    REQUIRE(found == expected);
+    REQUIRE(MapAnyWithin(map, v.data(), q, cutoff));
+  }
+
+  float const far[3] = {-100.f, -100.f, -100.f};
+  REQUIRE(!MapAnyWithin(map, v.data(), far, cutoff));
+}
+
+TEST_CASE("MapEIter express list follows voxel lists", "[Map]")
+{
+  PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  int const n = 2000;
+  auto const v = randomPoints(n);
+  std::vector<int> flag(n);
+  for (int i = 0; i < n; ++i) {
+    flag[i] = i % 3;
+  }
+
+  MapType map(G, -3.f, v.data(), n, nullptr, flag.data());
+  auto* I = &map;
+  MapSetupExpress(I);
+
+  int a, b, c;
+  MapLocus(I, v.data() + 3 * 1, &a, &b, &c);
+  int const st = *MapEStart(I, a, b, c);
+  REQUIRE(st > 0);
+
+  // express list of a voxel is the concatenation of its 3x3x3 voxel lists
+  std::vector<int> expected;
+  for (int d = a - 1; d <= a + 1; ++d) {
+    for (int e = b - 1; e <= b + 1; ++e) {
+      for (int f = c - 1; f <= c + 1; ++f) {
+        for (int i = *MapFirst(I, d, e, f); i >= 0; i = MapNext(I, i)) {
+          REQUIRE(flag[i]);
+          expected.push_back(i);
+        }
+      }
+    }
+  }
+  std::vector<int> found;
+  for (int k = st; I->EList[k] >= 0; ++k) {
+    found.push_back(I->EList[k]);
+  }
+  REQUIRE(found == expected);
+}
+
+TEST_CASE("Map build and query throughput", "[.][Map][benchmark]")
+{
+  PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  using clock = std::chrono::steady_clock;
+  auto const ms = [](clock::time_point t0, clock::time_point t1) {
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+  };
+
+  for (int n : {100000, 1000000, 10000000}) {
+    auto const v = randomPoints(n);
+
+    auto const t0 = clock::now();
+    MapType map(G, -5.f, v.data(), n);
+    MapSetupExpress(&map);
+    auto const t1 = clock::now();
+
+    int const n_query = 100000;
+    size_t hits = 0;
+    for (int q = 0; q < n_query; ++q) {
+      const float* v_query = v.data() + 3 * (q * (n / n_query));
+      for (int j : MapEIter(map, v_query)) {
+        hits += within3f(v.data() + 3 * j, v_query, 5.f);
+      }
+    }
+    auto const t2 = clock::now();
+
+    std::cout << n << " points: build " << ms(t0, t1) << " ms, " << n_query
+              << " queries " << ms(t1, t2) << " ms (" << hits << " hits)\n";
+  }
+}
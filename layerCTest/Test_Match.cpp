@@ -0,0 +1,57 @@
+#include "Test.h"
+
+#include "Match.h"
+
+using namespace pymol;
+
+TEST_CASE("MatchAlign identical", "[Match]")
+{
+  PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  int const n = 50;
+  auto match = MatchNew(G, n, n, false);
+  REQUIRE(match);
+
+  for (int a = 0; a < n; ++a) {
+    for (int b = 0; b < n; ++b) {
+      match->mat[a][b] = (a == b) ? 5.f : -1.f;
+    }
+  }
+
+  REQUIRE(MatchAlign(match, -10.f, -0.5f, 50, 0, true, 0, 0.f));
+  REQUIRE(match->score == Approx(250.f));
+  REQUIRE(match->n_pair == n);
+  for (int i = 0; i < n; ++i) {
+    REQUIRE(match->pair[i * 2] == i);
+    REQUIRE(match->pair[i * 2 + 1] == i);
+  }
+
+  MatchFree(match);
+}
+
+TEST_CASE("MatchAlign insertion", "[Match]")
+{
+  PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  // three residues inserted into the second sequence at position 20
+  int const na = 50, nb = 53;
+  auto match = MatchNew(G, na, nb, false);
+  REQUIRE(match);
+
+  for (int a = 0; a < na; ++a) {
+    for (int b = 0; b < nb; ++b) {
+      bool const same = (b < 20) ? (a == b) : (b >= 23 && a == b - 3);
+      match->mat[a][b] = same ? 5.f : -1.f;
+    }
+  }
+
+  REQUIRE(MatchAlign(match, -10.f, -0.5f, 50, 0, true, 0, 0.f));
+  REQUIRE(match->score == Approx(250.f - 10.f - 0.5f * 2));
+  REQUIRE(match->n_pair == na);
+  REQUIRE(match->pair[19 * 2 + 1] == 19);
+  REQUIRE(match->pair[20 * 2 + 1] == 23);
+
+  MatchFree(match);
+}
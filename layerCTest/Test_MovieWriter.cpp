@@ -0,0 +1,108 @@
+#include "Test.h"
+
+#include "MovieWriter.h"
+#include "MyPNG.h"
+
+#include <fstream>
+#include <iterator>
+
+using namespace pymol::test;
+using pymol::Image;
+using pymol::MovieWriter;
+
+static std::shared_ptr<const Image> makeFrame(int width, int height, int value)
+{
+  auto img = std::make_shared<Image>(width, height);
+  auto* bits = img->bits();
+  for (int row = 0; row < height; ++row) {
+    for (int col = 0; col < width; ++col) {
+      auto* p = bits + (row * width + col) * 4;
+      p[0] = value;
+      p[1] = row; // bottom-up row index
+      p[2] = col;
+      p[3] = 255;
+    }
+  }
+  return img;
+}
+
+static std::string readFile(const std::string& filename)
+{
+  std::ifstream in(filename, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), {}};
+}
+
+TEST_CASE("MovieWriter writes numbered frames", "[MovieWriter]")
+{
+  std::vector<TmpFILE> files(10);
+
+  MovieWriter::Options options;
+  options.format = cMyPNG_FormatPPM;
+  MovieWriter writer(options, 3, 2);
+
+  for (int i = 0; i < files.size(); ++i) {
+    writer.push(files[i].getFilenameStr(), makeFrame(4, 3, i));
+  }
+  REQUIRE(writer.finish());
+  REQUIRE(writer.takeErrors().empty());
+
+  for (int i = 0; i < files.size(); ++i) {
+    auto const data = readFile(files[i].getFilenameStr());
+    std::string const header = "P6\n4 3\n255\n";
+    REQUIRE(data.size() == header.size() + 4 * 3 * 3);
+    REQUIRE(data.compare(0, header.size(), header) == 0);
+    // first pixel is the top left one
+    REQUIRE(data[header.size() + 0] == char(i));
+    REQUIRE(data[header.size() + 1] == char(2));
+  }
+}
+
+TEST_CASE("MovieWriter Y4M stream", "[MovieWriter]")
+{
+  TmpFILE tmpfile;
+
+  MovieWriter::Options options;
+  options.format = cMyPNG_FormatY4M;
+  options.fps = 25.f;
+  MovieWriter writer(options, 4, 1);
+
+  for (int i = 0; i < 5; ++i) {
+    writer.push(tmpfile.getFilenameStr(), makeFrame(8, 2, 255));
+  }
+  REQUIRE(writer.finish());
+
+  auto const data = readFile(tmpfile.getFilenameStr());
+  std::string const header = "YUV4MPEG2 W8 H2 F25000:1000 Ip A1:1 C444\n";
+  std::size_t const frame_size = 6 + 3 * 8 * 2;
+  REQUIRE(data.size() == header.size() + 5 * frame_size);
+  REQUIRE(data.compare(0, header.size(), header) == 0);
+  REQUIRE(data.compare(header.size(), 6, "FRAME\n") == 0);
+  REQUIRE(data.compare(header.size() + 4 * frame_size, 6, "FRAME\n") == 0);
+}
+
+TEST_CASE("MovieWriter RGBA stream keeps frame order", "[MovieWriter]")
+{
+  TmpFILE tmpfile;
+
+  MovieWriter::Options options;
+  options.format = cMyPNG_FormatRGBA;
+  MovieWriter writer(options, 4, 3);
+
+  int const n_frame = 20;
+  for (int i = 0; i < n_frame; ++i) {
+    writer.push(tmpfile.getFilenameStr(), makeFrame(3, 2, i));
+  }
+
+  // mismatching size is reported, but doesn't end the stream
+  writer.push(tmpfile.getFilenameStr(), makeFrame(5, 5, 0));
+  REQUIRE(!writer.finish());
+  REQUIRE(writer.takeErrors().size() == 1);
+
+  auto const data = readFile(tmpfile.getFilenameStr());
+  std::size_t const frame_size = 4 * 3 * 2;
+  REQUIRE(data.size() == n_frame * frame_size);
+  for (int i = 0; i < n_frame; ++i) {
+    REQUIRE(data[i * frame_size + 0] == char(i));
+    REQUIRE(data[i * frame_size + 1] == char(1)); // top row first
+  }
+}
@@ -0,0 +1,125 @@
+#include "Test.h"
+
+#include "RMSMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace pymol::test;
+
+static std::vector<float> make_coords(std::size_t n)
+{
+  std::vector<float> xyz(n * 3);
+  for (std::size_t i = 0; i < xyz.size(); ++i) {
+    xyz[i] = std::sin(float(i) * 1.3f) * 5.f;
+  }
+  return xyz;
+}
+
+TEST_CASE("QCP RMSD is invariant to superposition", "[RMSMatrix]")
+{
+  std::size_t const n = 21;
+  auto xyz = make_coords(n);
+
+  // rotate about z by 30 degrees and translate
+  float const c = std::cos(0.5236f), s = std::sin(0.5236f);
+  std::vector<float> moved(xyz.size());
+  for (std::size_t i = 0; i < n; ++i) {
+    moved[i * 3 + 0] = c * xyz[i * 3 + 0] - s * xyz[i * 3 + 1] + 3.f;
+    moved[i * 3 + 1] = s * xyz[i * 3 + 0] + c * xyz[i * 3 + 1] - 1.f;
+    moved[i * 3 + 2] = xyz[i * 3 + 2] + 2.f;
+  }
+
+  QCPConformation a(xyz.data(), n), b(moved.data(), n);
+  REQUIRE(QCPRMSD(a, b) < 1e-3f);
+
+  // displacing one atom by d gives RMSD <= d / sqrt(n)
+  moved[0] += 2.f;
+  QCPConformation d(moved.data(), n);
+  float const rms = QCPRMSD(a, d);
+  REQUIRE(rms > 0.f);
+  REQUIRE(rms <= 2.f / std::sqrt(float(n)) + 1e-4f);
+}
+
+TEST_CASE("QCP superposition", "[RMSMatrix]")
+{
+  std::size_t const n = 17;
+  auto xyz = make_coords(n);
+
+  // rotate about x by 60 degrees and translate
+  float const c = std::cos(1.0472f), s = std::sin(1.0472f);
+  std::vector<float> moved(xyz.size());
+  for (std::size_t i = 0; i < n; ++i) {
+    moved[i * 3 + 0] = xyz[i * 3 + 0] - 4.f;
+    moved[i * 3 + 1] = c * xyz[i * 3 + 1] - s * xyz[i * 3 + 2] + 2.f;
+    moved[i * 3 + 2] = s * xyz[i * 3 + 1] + c * xyz[i * 3 + 2];
+  }
+  moved[5] += 1.f;
+
+  QCPConformation target(xyz.data(), n), mobile(moved.data(), n);
+  float matrix[16];
+  float const rms = QCPSuperpose(target, mobile, matrix);
+  REQUIRE(rms == Approx(QCPRMSD(target, mobile)));
+  REQUIRE(matrix[15] == 1.f);
+
+  // applying the matrix gives the same RMSD
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const float* v = moved.data() + i * 3;
+    for (int k = 0; k < 3; ++k) {
+      float const t = matrix[k * 4] * v[0] + matrix[k * 4 + 1] * v[1] +
+                      matrix[k * 4 + 2] * v[2] + matrix[k * 4 + 3];
+      sum += (t - xyz[i * 3 + k]) * (t - xyz[i * 3 + k]);
+    }
+  }
+  REQUIRE(std::sqrt(sum / n) == Approx(rms).margin(1e-4));
+}
+
+TEST_CASE("QCP RMSD matrix tiles", "[RMSMatrix]")
+{
+  std::size_t const n = 10;
+  auto xyz = make_coords(n);
+  std::vector<QCPConformation> confs;
+  for (int k = 0; k < 5; ++k) {
+    xyz[k] += 0.5f * k;
+    confs.emplace_back(xyz.data(), n);
+  }
+
+  std::vector<float> full(25), rows(10);
+  QCPRMSDMatrix(confs, full.data());
+  QCPRMSDMatrixRows(confs, 2, 4, rows.data());
+
+  for (int i = 0; i < 5; ++i) {
+    REQUIRE(full[i * 5 + i] == 0.f);
+    for (int j = 0; j < 5; ++j) {
+      REQUIRE(full[i * 5 + j] == full[j * 5 + i]);
+    }
+  }
+  for (int j = 0; j < 10; ++j) {
+    REQUIRE(rows[j] == full[10 + j]);
+  }
+}
+
+TEST_CASE("GROMOS clustering", "[RMSMatrix]")
+{
+  // 0-1-2 chain (1 is center), 3-4 pair, 5 alone
+  std::vector<std::vector<int>> neighbors = {
+      {1}, {0, 2}, {1}, {4}, {3}, {}};
+  auto clusters = ClusterGromos(neighbors);
+  REQUIRE(clusters == std::vector<int>({0, 0, 0, 1, 1, 2}));
+}
+
+TEST_CASE("GROMOS clusters are ordered by size", "[RMSMatrix]")
+{
+  // star around 6 (size 4), pair 0-1, star around 3 (size 3)
+  std::vector<std::vector<int>> neighbors = {
+      {1}, {0}, {3}, {2, 4}, {3}, {6}, {5, 7, 8}, {6}, {6}};
+  auto clusters = ClusterGromos(neighbors);
+  REQUIRE(clusters == std::vector<int>({2, 2, 1, 1, 1, 0, 0, 0, 0}));
+
+  std::vector<int> sizes(3);
+  for (int c : clusters) {
+    ++sizes[c];
+  }
+  REQUIRE(std::is_sorted(sizes.rbegin(), sizes.rend()));
+}
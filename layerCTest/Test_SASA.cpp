@@ -0,0 +1,59 @@
+#include "Test.h"
+
+#include "SASA.h"
+
+#include <cmath>
+
+using namespace pymol::test;
+
+static SASADots make_dots(std::size_t n)
+{
+  // golden section spiral, equal area per dot
+  std::vector<float> xyz(n * 3), area(n, float(4.0 * M_PI / n));
+  for (std::size_t k = 0; k < n; ++k) {
+    double const z = 1.0 - 2.0 * (k + 0.5) / n;
+    double const r = std::sqrt(1.0 - z * z);
+    double const phi = k * M_PI * (3.0 - std::sqrt(5.0));
+    xyz[k * 3 + 0] = r * std::cos(phi);
+    xyz[k * 3 + 1] = r * std::sin(phi);
+    xyz[k * 3 + 2] = z;
+  }
+  return SASADots(xyz.data(), area.data(), n);
+}
+
+TEST_CASE("SASA of isolated and overlapping spheres", "[SASA]")
+{
+  auto const dots = make_dots(1000);
+
+  float const coords[] = {0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 20.f, 0.f, 0.f};
+  float const radii[] = {2.f, 2.f, 1.5f};
+  float area[3];
+
+  SASAAtomAreas(dots, coords, radii, 3, nullptr, nullptr, area);
+
+  // cap of height 1 is buried: 4 pi R^2 - 2 pi R h
+  REQUIRE(std::abs(area[0] - 12.f * M_PI) < 0.2f);
+  REQUIRE(std::abs(area[1] - 12.f * M_PI) < 0.2f);
+  REQUIRE(std::abs(area[2] - 9.f * M_PI) < 1e-3f);
+
+  // non-occluding atom 1, no surface for atom 2
+  bool const surface[] = {true, true, false};
+  bool const occluder[] = {true, false, true};
+  SASAAtomAreas(dots, coords, radii, 3, surface, occluder, area);
+  REQUIRE(std::abs(area[0] - 16.f * M_PI) < 1e-3f);
+  REQUIRE(std::abs(area[1] - 12.f * M_PI) < 0.2f);
+  REQUIRE(area[2] == 0.f);
+}
+
+TEST_CASE("SASA of buried atom", "[SASA]")
+{
+  auto const dots = make_dots(100);
+
+  float const coords[] = {0.f, 0.f, 0.f, 0.5f, 0.f, 0.f};
+  float const radii[] = {1.f, 3.f};
+  float area[2];
+
+  SASAAtomAreas(dots, coords, radii, 2, nullptr, nullptr, area);
+  REQUIRE(area[0] == 0.f);
+  REQUIRE(area[1] > 0.f);
+}
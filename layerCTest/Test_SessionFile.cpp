@@ -0,0 +1,109 @@
+#include "Test.h"
+
+#include "SessionFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+using namespace pymol::test;
+using pymol::SessionFile;
+using pymol::SessionSection;
+
+TEST_CASE("SessionFile round trip", "[SessionFile]")
+{
+  TmpFILE tmpfile;
+
+  std::vector<float> coords(1000);
+  std::iota(coords.begin(), coords.end(), 0.5f);
+  std::vector<int> idx(333);
+  std::iota(idx.begin(), idx.end(), 7);
+  std::string const pickle = "pickled dictionary";
+
+  {
+    auto file = SessionFile::create(tmpfile.getFilename());
+    REQUIRE(file);
+    auto& f = *file.result();
+    REQUIRE(f.isWriting());
+    REQUIRE(f.write(SessionSection::Coords, 0, coords.data(),
+                sizeof(float) * coords.size()) == 0);
+    REQUIRE(f.write(SessionSection::IdxToAtm, 3, idx.data(),
+                sizeof(int) * idx.size()) == 1);
+    REQUIRE(f.write(SessionSection::Pickle, 0, pickle.data(), pickle.size()) ==
+            2);
+    REQUIRE(f.finish());
+  }
+
+  auto file = SessionFile::open(tmpfile.getFilename());
+  REQUIRE(file);
+  auto const& f = *file.result();
+  REQUIRE(!f.isWriting());
+  REQUIRE(f.size() == 3);
+  REQUIRE(f.section(3) == nullptr);
+  REQUIRE(f.section(-1) == nullptr);
+
+  auto const* s0 = f.section(0);
+  REQUIRE(s0->type == SessionSection::Coords);
+  REQUIRE(s0->offset % 64 == 0);
+  REQUIRE(s0->size == sizeof(float) * coords.size());
+  REQUIRE(std::memcmp(s0->data, coords.data(), s0->size) == 0);
+
+  auto const* s1 = f.section(1);
+  REQUIRE(s1->type == SessionSection::IdxToAtm);
+  REQUIRE(s1->version == 3);
+  REQUIRE(s1->offset % 64 == 0);
+  REQUIRE(std::memcmp(s1->data, idx.data(), s1->size) == 0);
+
+  auto const* s2 = f.find(SessionSection::Pickle);
+  REQUIRE(s2 == f.section(2));
+  REQUIRE(std::string(static_cast<const char*>(s2->data), s2->size) == pickle);
+
+  REQUIRE(f.find(SessionSection::FieldData) == nullptr);
+}
+
+TEST_CASE("SessionFile unfinished file is removed", "[SessionFile]")
+{
+  TmpFILE tmpfile;
+
+  {
+    auto file = SessionFile::create(tmpfile.getFilename());
+    REQUIRE(file);
+    int const value = 42;
+    file.result()->write(SessionSection::Pickle, 0, &value, sizeof(value));
+  }
+
+  REQUIRE(!std::ifstream(tmpfile.getFilename()).good());
+  REQUIRE(!SessionFile::open(tmpfile.getFilename()));
+}
+
+TEST_CASE("SessionFile rejects invalid files", "[SessionFile]")
+{
+  TmpFILE tmpfile;
+
+  {
+    std::ofstream out(tmpfile.getFilename(), std::ios::binary);
+    out << "PYMOLSES but not really a session file";
+  }
+  REQUIRE(!SessionFile::open(tmpfile.getFilename()));
+
+  {
+    auto file = SessionFile::create(tmpfile.getFilename());
+    REQUIRE(file);
+    std::vector<char> data(1000, 'x');
+    file.result()->write(SessionSection::Pickle, 0, data.data(), data.size());
+    REQUIRE(file.result()->finish());
+  }
+  REQUIRE(SessionFile::open(tmpfile.getFilename()));
+
+  // truncate (cuts off the section table)
+  std::string contents;
+  {
+    std::ifstream in(tmpfile.getFilename(), std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), {});
+  }
+  {
+    std::ofstream out(tmpfile.getFilename(), std::ios::binary);
+    out << contents.substr(0, 500);
+  }
+  REQUIRE(!SessionFile::open(tmpfile.getFilename()));
+}
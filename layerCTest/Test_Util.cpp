@@ -76,3 +76,24 @@ TEST_CASE("StartsWith", "[Util]")
   std::string str3 = "_Fello";
   REQUIRE(!pymol::starts_with(str2, "F"));
 }
+
+TEST_CASE("FormatFixed", "[Util]")
+{
+  char buf[64], ref[64];
+
+  for (float value : {0.f, -0.f, 1.f, -1.5f, 0.0625f, -0.0625f, 0.0005f,
+           -0.0004f, 12.3456f, -999.9995f, 1234.5f, 9999.999f, 1e20f}) {
+    for (int precision = 0; precision <= 4; ++precision) {
+      for (int width : {0, 6, 8}) {
+        int n = UtilFormatFixed(buf, value, width, precision);
+        int n_ref = sprintf(ref, "%*.*f", width, precision, value);
+        REQUIRE(n == n_ref);
+        REQUIRE(std::string(buf) == ref);
+      }
+    }
+  }
+
+  // falls back to printf
+  UtilFormatFixed(buf, 1.5f, 8, 6);
+  REQUIRE(std::string(buf) == "1.500000");
+}
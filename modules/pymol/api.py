@@ -104,6 +104,7 @@ from .querying import \
       find_pairs,         \
       get_angle,          \
       get_area,           \
+      get_atom_areas,     \
       get_assembly_ids,   \
       get_bonds,          \
       get_chains,         \
@@ -131,6 +132,7 @@ from .querying import \
       get_names,          \
       get_names_of_type,  \
       get_legal_name,     \
+      get_map_correlation, \
       get_unused_name,    \
       get_object_matrix,  \
       get_object_ttt,     \
@@ -151,9 +153,11 @@ from .querying import \
       id_atom,            \
       identify,           \
       index,              \
+      interaction_table,  \
       overlap,            \
       pi_interactions,    \
-      phi_psi
+      phi_psi,            \
+      pick_atoms
 
 #--------------------------------------------------------------------
 from .selecting import \
@@ -211,6 +215,8 @@ from .editing import \
       map_set_border,     \
       map_double,         \
       map_halve,          \
+      map_lowpass,        \
+      map_sharpen,        \
       map_trim,           \
       matrix_copy,        \
       matrix_reset,       \
@@ -295,13 +301,17 @@ from .fitting import \
       alignto,		 \
       extra_fit,	 \
       fit,               \
+      fit_batch,         \
       super,             \
       rms,               \
       rms_cur,           \
       intra_fit,         \
       intra_rms,         \
       intra_rms_cur,     \
+      rms_matrix,        \
+      cluster_states,    \
       cealign,          \
+      cealign_batch,    \
       pair_fit
 
 #--------------------------------------------------------------------
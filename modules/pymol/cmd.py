@@ -158,8 +158,6 @@ if True:
         from . import internal
 
         _alt = internal._alt
-        _coordset_update_spawn = internal._coordset_update_spawn
-        _coordset_update_thread = internal._coordset_update_thread
         _copy_image = internal._copy_image
         _call_in_gui_thread = lambda func: func()
         _call_with_opengl_context = _call_in_gui_thread
@@ -174,8 +172,6 @@ if True:
         _interpret_color = internal._interpret_color
         _invalidate_color_sc = internal._invalidate_color_sc
         _mpng = internal._mpng
-        _object_update_spawn = internal._object_update_spawn
-        _object_update_thread = internal._object_update_thread
         _quit = internal._quit
         _ray_anti_spawn = internal._ray_anti_spawn
         _ray_hash_spawn = internal._ray_hash_spawn
@@ -99,12 +99,14 @@ def get_auto_arg_list(self_cmd=cmd):
         'cache'          : [ self_cmd.exporting.cache_action_sc , 'cache mode'   , ', ' ],
         'center'         : aa_sel_e,
         'cealign'        : aa_sel_e,
+        'cealign_batch'  : aa_sel_e,
         'centerofmass'   : aa_sel_e,
         'color'          : [ lambda c=self_cmd:c._get_color_sc(c), 'color'       , ', ' ],
         'color_deep'     : [ lambda c=self_cmd:c._get_color_sc(c), 'color'       , ', ' ],
         'config_mouse'   : [ self_cmd.controlling.ring_dict_sc, 'mouse cycle'    , ''   ],
         'clean'          : aa_sel_c,
         'clip'           : [ self_cmd.viewing.clip_action_sc , 'clipping action' , ', ' ],
+        'cluster_states' : aa_sel_e,
         'copy'           : aa_obj_c,
         'copy_to'        : aa_obj_c,
         'count_atoms'    : aa_sel_e,
@@ -120,15 +122,18 @@ def get_auto_arg_list(self_cmd=cmd):
         'extract'        : aa_obj_e,
         'feedback'       : [ self_cmd.fb_action_sc           , 'action'          , ', ' ],
         'fit'            : aa_sel_e,
+        'fit_batch'      : aa_sel_e,
         'flag'           : [ self_cmd.editing.flag_sc        , 'flag'            , ', ' ],
         'fragment'       : [ fragments_sc                    , 'fragment name'   , ''   ],
         'full_screen'    : [ self_cmd.toggle_sc              , 'option'          , ''   ],
         'fuse'           : aa_sel_e,
         'get'            : aa_set_c,
         'get_area'       : aa_sel_e,
+        'get_atom_areas' : aa_sel_e,
         'get_bond'       : aa_set_c,
         'get_chains'     : aa_sel_e,
         'get_extent'     : aa_sel_e,
+        'get_map_correlation' : aa_map_c,
         'get_property_list' : aa_obj_c,
         'get_symmetry'   : aa_obj_c,
         'gradient'       : [ self_cmd.object_sc              , 'gradient'        , ', ' ],
@@ -147,6 +152,8 @@ def get_auto_arg_list(self_cmd=cmd):
         'mview'          : [ self_cmd.moving.mview_action_sc , 'action'          , ''   ],
         'map_double'     : aa_map_c,
         'map_halve'      : aa_map_c,
+        'map_lowpass'    : aa_map_c,
+        'map_sharpen'    : aa_map_c,
         'map_trim'       : aa_map_c,
         'matrix_copy'    : aa_obj_c,
         'matrix_reset'   : aa_obj_c,
@@ -166,6 +173,7 @@ def get_auto_arg_list(self_cmd=cmd):
         'rebuild'        : aa_sel_e,
         'reference'      : [ self_cmd.editing.ref_action_sc  , 'action'          , ', ' ],
         'remove'         : aa_sel_e,
+        'rms_matrix'     : aa_sel_e,
         'reinitialize'   : [ self_cmd.commanding.reinit_sc   , 'option'          , ''   ],
         'scene'          : aa_scene_e,
         'sculpt_activate': aa_obj_e,
@@ -212,6 +220,7 @@ def get_auto_arg_list(self_cmd=cmd):
         'button'         : [ self_cmd.controlling.but_mod_sc , 'modifier'        , ', ' ],
         'cache'          : aa_scene_e,
         'cealign'        : aa_sel_e,
+        'cealign_batch'  : aa_sel_e,
         'clean'          : aa_sel_e,
         'color'          : aa_sel_e,
         'color_deep'     : aa_obj_e,
@@ -906,7 +906,8 @@ SEE ALSO
         if _self._raising(r,_self): raise pymol.CmdException
         return r
 
-    def symexp(prefix, object, selection, cutoff, segi=0, quiet=1,_self=cmd):
+    def symexp(prefix, object, selection, cutoff, segi=0, quiet=1,
+               instanced=0, _self=cmd):
         '''
 DESCRIPTION
 
@@ -915,13 +916,22 @@ DESCRIPTION
 
 USAGE
 
-    symexp prefix, object, selection, cutoff
+    symexp prefix, object, selection, cutoff [, segi [, quiet [, instanced ]]]
+
+ARGUMENTS
+
+    instanced = 0/1: create a single object named "prefix" which renders
+    all symmetry mates from one set of representations {default: 0}
 
 NOTES
 
     The newly objects are labeled using the prefix provided along with
     their crystallographic symmetry operation and translation.
 
+    In instanced mode, the mates are only transformed for display and
+    ray tracing. Atom coordinates, selections and picking refer to the
+    original (untransformed) atoms.
+
 SEE ALSO
 
     load
@@ -934,7 +944,7 @@ SEE ALSO
             _self.lock(_self)
             r = _cmd.symexp(_self._COb,str(prefix),str(object),
                             "("+str(selection)+")",float(cutoff),
-                            int(segi),int(quiet))
+                            int(segi),int(quiet),int(instanced))
         finally:
             _self.unlock(r,_self)
         if _self._raising(r,_self): raise pymol.CmdException
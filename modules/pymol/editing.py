@@ -2454,6 +2454,60 @@ SEE ALSO
         if _self._raising(r,_self): raise pymol.CmdException
         return r
 
+    def map_sharpen(name, b_factor, resolution=0.0, state=0, quiet=1, _self=cmd):
+        '''
+DESCRIPTION
+
+    "map_sharpen" applies a B-factor to a map in reciprocal space (FFT).
+    Positive values sharpen, negative values blur (Gaussian smoothing with
+    sigma = sqrt(|b_factor| / 8) / pi Angstrom).
+
+USAGE
+
+    map_sharpen map_name, b_factor [, resolution [, state ]]
+
+ARGUMENTS
+
+    map_name = str: map object name or pattern
+
+    b_factor = float: B-factor in Angstrom^2
+
+    resolution = float: optional low-pass cutoff in Angstrom {default: 0}
+
+    state = int: map state {default: 0 (all states)}
+
+NOTES
+
+    Maps which cover exactly one unit cell are treated as periodic, all
+    other maps are padded. Uses up to "max_threads" threads.
+
+SEE ALSO
+
+    map_lowpass, get_map_correlation, map_halve
+        '''
+        with _self.lockcm:
+            return _cmd.map_filter(_self._COb, str(name), -float(b_factor),
+                    float(resolution), int(state) - 1, int(quiet))
+
+    def map_lowpass(name, resolution, state=0, quiet=1, _self=cmd):
+        '''
+DESCRIPTION
+
+    "map_lowpass" removes all Fourier terms beyond the given resolution
+    from a map (FFT).
+
+USAGE
+
+    map_lowpass map_name, resolution [, state ]
+
+SEE ALSO
+
+    map_sharpen, get_map_correlation
+        '''
+        with _self.lockcm:
+            return _cmd.map_filter(_self._COb, str(name), 0.0,
+                    float(resolution), int(state) - 1, int(quiet))
+
     def map_trim(name, selection, buffer=0.0, map_state=0, sele_state=0, quiet=1, _self=cmd):
         '''
 DESCRIPTION
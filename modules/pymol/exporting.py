@@ -808,8 +808,8 @@ NOTES
 
     The file format is automatically chosen if the extesion is one of
     the supported output formats: pdb, pqr, mol, sdf, pkl, pkla, mmd, out,
-    dat, mmod, cif, pov, png, pse, psw, aln, fasta, obj, mtl, wrl, dae, idtf,
-    or mol2.
+    dat, mmod, cif, pov, png, pse, psw, pseb, aln, fasta, obj, mtl, wrl, dae,
+    idtf, or mol2.
 
     If the file format is not recognized, then a PDB file is written
     by default.
@@ -843,7 +843,7 @@ SEE ALSO
             format = format_guessed
 
         # PyMOL session
-        if format in ('pse', 'psw',):
+        if format in ('pse', 'psw', 'pseb',):
             _self.set("session_file",
                     # always use unix-like path separators
                     filename.replace("\\", "/"), quiet=1)
@@ -858,7 +858,13 @@ SEE ALSO
 
         contents = None
 
-        if format in savefunctions:
+        if not zipped and savefunctions.get(format) is get_str:
+            # write directly to file, in chunks
+            with _self.lockcm:
+                r = _cmd.save_str(_self._COb, str(filename), str(format),
+                        str(selection), int(state) - 1, str(ref),
+                        int(ref_state), -1, int(quiet))
+        elif format in savefunctions:
             # generic forwarding to format specific save functions
             func = savefunctions[format]
             func = _eval_func(func)
@@ -978,6 +984,26 @@ SEE ALSO
         session = _self.get_session(selection, partial, quiet)
         return cPickle.dumps(session, 1)
 
+    def save_pseb(filename, selection, partial, quiet, _self):
+        '''
+        Binary session file. Atoms, bonds, coordinates and map grids are
+        stored as sections of a memory-mappable container instead of
+        being pickled.
+        '''
+        if '(' in selection: # ignore selections
+            selection = ''
+        with _self.lockcm:
+            _cmd.session_file_create(_self._COb, filename)
+        contents = None
+        try:
+            session = _self.get_session(selection, partial, quiet,
+                                        binary=1, version=0)
+            contents = cPickle.dumps(session, 1)
+        finally:
+            with _self.lockcm:
+                _cmd.session_file_finish(_self._COb, contents)
+        return DEFAULT_SUCCESS
+
     def _get_mtl_obj(format, _self):
         # TODO mtl not implemented, always returns empty string
         if format == 'mtl':
@@ -998,6 +1024,7 @@ SEE ALSO
 
         'pse': get_psestr,
         'psw': get_psestr,
+        'pseb': save_pseb,
 
         'fasta': get_fastastr,
         'aln': get_alnstr,
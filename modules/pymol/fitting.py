@@ -134,6 +134,84 @@ SEE ALSO
                 if _self._raising(r,_self): raise pymol.CmdException
                 return ( {"alignment_length": aliLen, "RMSD" : RMSD, "rotation_matrix" : rotMat } )
 
+        def cealign_batch(target, mobile, target_state=1, mobile_state=1,
+                          quiet=1, guide=1, d0=3.0, d1=4.0, window=8,
+                          gap_max=30, transform=1, *, _self=cmd):
+                '''
+DESCRIPTION
+
+    "cealign_batch" aligns every object in the mobile selection to the
+    target with the CE algorithm. The alignments run in parallel.
+
+USAGE
+
+    cealign_batch target, mobile [, target_state [, mobile_state [, quiet [,
+        guide [, d0 [, d1 [, window [, gap_max, [, transform ]]]]]]]]]
+
+RETURN VALUE
+
+    Dictionary with one "cealign" result per mobile object name, or None
+    if the alignment failed for that object.
+
+EXAMPLE
+
+    fetch 1rlw 1rsy 1byn, async=0
+    cealign_batch 1rlw, 1rsy 1byn
+
+SEE ALSO
+
+    cealign, extra_fit
+                '''
+                quiet = int(quiet)
+                window = int(window)
+                guide = "" if int(guide)==0 else "and guide"
+
+                target = selector.process("(%s) %s" % (target, guide))
+                mobile = selector.process("(%s) %s" % (mobile, guide))
+
+                if window < 3:
+                        print("CEalign-Error: window size must be an integer greater than 2.")
+                        raise pymol.CmdException
+                if int(gap_max) < 0:
+                        print("CEalign-Error: gap_max must be a positive integer.")
+                        raise pymol.CmdException
+
+                sel1 = _self.get_model(target, state=target_state).get_coord_list()
+                if len(sel1) < 2 * window:
+                        print("CEalign-Error: Your target selection is too short.")
+                        raise pymol.CmdException
+
+                models = _self.get_object_list("(" + mobile + ")")
+                sel2 = []
+                for model in models:
+                        coords = _self.get_model("(%s) and %s" % (mobile, model),
+                                                 state=mobile_state).get_coord_list()
+                        if len(coords) < 2 * window:
+                                if not quiet:
+                                        print(" CEalign-Warning: %s is too short, skipped" % model)
+                                coords = []
+                        sel2.append(coords)
+
+                with _self.lockcm:
+                        r = _cmd.cealign_batch(_self._COb, sel1, sel2, float(d0),
+                                               float(d1), window, int(gap_max))
+
+                results = {}
+                for model, ri in zip(models, r):
+                        if ri is None:
+                                if not quiet:
+                                        print(" CEalign-Error: alignment of %s failed" % model)
+                                results[model] = None
+                                continue
+                        (aliLen, RMSD, rotMat, i1, i2) = ri
+                        if not quiet:
+                                print(" %s: RMSD %f over %i residues" % (model, float(RMSD), int(aliLen)))
+                        if int(transform):
+                                _self.transform_object(model, rotMat, state=0)
+                        results[model] = {"alignment_length": aliLen, "RMSD": RMSD,
+                                          "rotation_matrix": rotMat}
+                return results
+
         def extra_fit(selection='(all)', reference='', method='align', zoom=1,
                 quiet=0, *, _self=cmd, **kwargs):
             '''
@@ -540,6 +618,86 @@ SEE ALSO
                 if _self._raising(r,_self): raise pymol.CmdException
                 return r
 
+        def rms_matrix(selection, filename="", quiet=1, *, _self=cmd):
+                '''
+DESCRIPTION
+
+    "rms_matrix" calculates the pairwise RMSD matrix (after optimal
+    superposition) between all states of an object over an atom
+    selection. Coordinates are left unchanged.
+
+    With a filename, the matrix is written tile by tile to a NumPy
+    (.npy) file, so that it never has to be held in memory entirely.
+
+USAGE
+
+    rms_matrix selection [, filename [, quiet ]]
+
+ARGUMENTS
+
+    selection = str: atom selection within a single object
+
+    filename = str: NumPy file to write the matrix to {default: return it}
+
+EXAMPLE
+
+    rms = cmd.rms_matrix("traj and name CA")
+    cmd.rms_matrix("traj and name CA", "rmsd.npy")
+    rms = numpy.load("rmsd.npy")
+
+PYMOL API
+
+    cmd.rms_matrix(string selection, string filename="")
+
+SEE ALSO
+
+    intra_rms, cluster_states
+                '''
+                selection = selector.process(selection)
+                with _self.lockcm:
+                        r = _cmd.rms_matrix(_self._COb, selection,
+                                str(filename), int(quiet))
+                if filename:
+                        return None
+                n = int(round(len(r) ** 0.5))
+                return [r[i * n:(i + 1) * n] for i in range(n)]
+
+        def cluster_states(selection, cutoff=1.0, quiet=1, *, _self=cmd):
+                '''
+DESCRIPTION
+
+    "cluster_states" clusters the states of an object by pairwise RMSD
+    over an atom selection, using the GROMOS method: The state with the
+    most neighbors within the cutoff becomes the center of a cluster
+    which contains all its neighbors, those are removed and the procedure
+    is repeated until all states are assigned.
+
+    The cluster numbers are stored as state titles ("cluster 1" is the
+    largest cluster) and returned as a list.
+
+    The RMSD matrix is computed in tiles, but the neighbor lists are kept
+    in memory and grow with the number of state pairs within the cutoff
+    (up to n_states^2 for a generous cutoff).
+
+USAGE
+
+    cluster_states selection [, cutoff [, quiet ]]
+
+ARGUMENTS
+
+    selection = str: atom selection within a single object
+
+    cutoff = float: RMSD cutoff in Angstrom {default: 1.0}
+
+SEE ALSO
+
+    rms_matrix, intra_rms, get_title
+                '''
+                selection = selector.process(selection)
+                with _self.lockcm:
+                        return _cmd.cluster_states(_self._COb, selection,
+                                float(cutoff), int(quiet))
+
         def fit(mobile, target, mobile_state=0, target_state=0,
 		quiet=1, matchmaker=0, cutoff=2.0, cycles=0, object=None, *, _self=cmd):
             '''
@@ -617,6 +775,54 @@ SEE ALSO
                 raise pymol.CmdException
             return r
 
+        def fit_batch(mobile, target, mobile_state=0, target_state=1,
+                      quiet=1, *, _self=cmd):
+            '''
+DESCRIPTION
+
+    "fit_batch" superimposes all objects and states in the mobile
+    selection onto the target selection. Atoms are matched by their
+    identifiers (segi, chain, resi, resn, name, alt) once per object, the
+    superpositions are computed and applied in parallel. Matching honors
+    the "ignore_case" and "ignore_case_chain" settings.
+
+    This is much faster than calling "fit" for each object, e.g. to
+    superimpose thousands of docking poses onto a reference.
+
+USAGE
+
+    fit_batch mobile, target [, mobile_state [, target_state [, quiet ]]]
+
+ARGUMENTS
+
+    mobile = string: atom selection, may span multiple objects
+
+    target = string: atom selection within a single object
+
+    mobile_state = integer: object state {default: 0, all states}
+
+    target_state = integer: object state {default: 1}
+
+RETURN VALUE
+
+    Dictionary with a list of RMS values (one per state, -1.0 if the state
+    was not fitted) for each mobile object.
+
+EXAMPLES
+
+    fit_batch pose* and not hydro, ref and not hydro
+
+SEE ALSO
+
+    fit, intra_fit, extra_fit
+            '''
+            mobile = selector.process(mobile)
+            target = selector.process(target)
+            with _self.lockcm:
+                return _cmd.fit_batch(_self._COb, mobile, target,
+                        int(mobile_state) - 1, int(target_state) - 1,
+                        int(quiet))
+
         def rms(mobile, target, mobile_state=0, target_state=0, quiet=1,
 			  matchmaker=0, cutoff=2.0, cycles=0, object=None, *, _self=cmd):
             '''
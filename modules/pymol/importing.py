@@ -829,13 +829,24 @@ SEE ALSO
             return func(**kw)
 
     def load_pse(filename, partial=0, quiet=1, format='pse', *, _self=cmd):
-        try:
+        if format == 'pseb':
+            # binary session, sections are read during set_session
+            with _self.lockcm:
+                contents = _cmd.session_file_open(_self._COb, filename)
+        else:
             contents = _self.file_read(filename)
-            session = io.pkl.fromString(contents)
-        except AttributeError as e:
-            raise pymol.CmdException('PSE contains objects which cannot be unpickled (%s)' % str(e))
 
-        r = _self.set_session(session, quiet=quiet, partial=partial, steal=1)
+        try:
+            try:
+                session = io.pkl.fromString(contents)
+            except AttributeError as e:
+                raise pymol.CmdException('PSE contains objects which cannot be unpickled (%s)' % str(e))
+
+            r = _self.set_session(session, quiet=quiet, partial=partial, steal=1)
+        finally:
+            if format == 'pseb':
+                with _self.lockcm:
+                    _cmd.session_file_close(_self._COb)
 
         if not partial:
             _self.set("session_file",
@@ -1636,6 +1647,7 @@ DESCRIPTION
         'idx': load_idx,
         'pse': load_pse,
         'psw': load_pse,
+        'pseb': load_pse,
         'ply': load_ply,
         'r3d': load_r3d,
         'cc1': load_cc1,
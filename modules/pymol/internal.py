@@ -176,62 +176,6 @@ def _ray_spawn(thread_info,_self=cmd):
     for t in thread_list:
         t.join()
 
-def _coordset_update_thread(list_lock,thread_info,_self=cmd):
-    # WARNING: internal routine, subject to change
-    while 1:
-        list_lock.acquire()
-        if not len(thread_info):
-            list_lock.release()
-            break
-        else:
-            info = thread_info.pop(0)
-            list_lock.release()
-        _cmd.coordset_update_thread(_self._COb,info)
-
-def _coordset_update_spawn(thread_info,n_thread,_self=cmd):
-    # WARNING: internal routine, subject to change
-    if len(thread_info):
-        list_lock = threading.Lock() # mutex for list
-        thread_list = []
-        for a in range(1,n_thread):
-            t = threading.Thread(target=_coordset_update_thread,
-                                        args=(list_lock,thread_info))
-            t.setDaemon(1)
-            thread_list.append(t)
-        for t in thread_list:
-            t.start()
-        _coordset_update_thread(list_lock,thread_info)
-        for t in thread_list:
-            t.join()
-
-def _object_update_thread(list_lock,thread_info,_self=cmd):
-    # WARNING: internal routine, subject to change
-    while 1:
-        list_lock.acquire()
-        if not len(thread_info):
-            list_lock.release()
-            break
-        else:
-            info = thread_info.pop(0)
-            list_lock.release()
-        _cmd.object_update_thread(_self._COb,info)
-
-def _object_update_spawn(thread_info,n_thread,_self=cmd):
-    # WARNING: internal routine, subject to change
-    if len(thread_info):
-        list_lock = threading.Lock() # mutex for list
-        thread_list = []
-        for a in range(1,n_thread):
-            t = threading.Thread(target=_object_update_thread,
-                                        args=(list_lock,thread_info))
-            t.setDaemon(1)
-            thread_list.append(t)
-        for t in thread_list:
-            t.start()
-        _object_update_thread(list_lock,thread_info)
-        for t in thread_list:
-            t.join()
-
 # status reporting
 
 # do command (while API already locked)
@@ -250,7 +194,11 @@ def _mpng(prefix, first=-1, last=-1, preserve=0, modal=0,
     try:
         _self.lock(_self)
         fname = prefix
-        if re.search(r"[0-9]*\.png$",fname): # remove numbering, etc.
+        if fname.endswith(".y4m"): # single stream, no numbering
+            format = 2 # Y4M
+        elif fname.endswith(".rgba"):
+            format = 3 # raw RGBA
+        elif re.search(r"[0-9]*\.png$",fname): # remove numbering, etc.
             fname = re.sub(r"[0-9]*\.png$","",fname)
         if re.search(r"[0-9]*\.ppm$",fname):
             if format<0:
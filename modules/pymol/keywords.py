@@ -35,6 +35,7 @@ def get_command_keywords(self_cmd=cmd):
         'cartoon'       : [ self_cmd.cartoon           , 0 , 0 , ''  , parsing.STRICT ],
         'capture'       : [ self_cmd.capture           , 0 , 0 , ''  , parsing.STRICT ],
         'cealign'       : [ self_cmd.cealign	       , 0 , 0 , ''  , parsing.STRICT ],
+        'cealign_batch' : [ self_cmd.cealign_batch     , 0 , 0 , ''  , parsing.STRICT ],
         'centerofmass'  : [ self_cmd.centerofmass      , 0 , 0 , ''  , parsing.STRICT ],
         'cd'            : [ self_cmd.cd                , 0 , 0 , ''  , parsing.STRICT ],
         'center'        : [ self_cmd.center            , 0 , 0 , ''  , parsing.STRICT ],
@@ -43,6 +44,7 @@ def get_command_keywords(self_cmd=cmd):
         'class'         : [ self_cmd.python_help       , 0 , 0 , ''  , parsing.PYTHON ],
         'clip'          : [ self_cmd.clip              , 0 , 0 , ''  , parsing.STRICT ],
         'cls'           : [ self_cmd.cls               , 0 , 0 , ''  , parsing.STRICT ],
+        'cluster_states': [ self_cmd.cluster_states    , 0 , 0 , ''  , parsing.STRICT ],
         '_ctrl'         : [ self_cmd._ctrl             , 0 , 0 , ''  , parsing.STRICT ],
         '_ctsh'         : [ self_cmd._ctsh             , 0 , 0 , ''  , parsing.STRICT ],
         'color'         : [ self_cmd.color             , 0 , 0 , ''  , parsing.STRICT ],
@@ -88,6 +90,7 @@ def get_command_keywords(self_cmd=cmd):
         'feedback'      : [ self_cmd.feedback          , 0,  0 , ''  , parsing.STRICT ],
         'fetch'         : [ self_cmd.fetch             , 0,  0 , ''  , parsing.STRICT ],
         'fit'           : [ self_cmd.fit               , 0 , 0 , ''  , parsing.STRICT ],
+        'fit_batch'     : [ self_cmd.fit_batch         , 0 , 0 , ''  , parsing.STRICT ],
         'fix_chemistry' : [ self_cmd.fix_chemistry     , 0 , 0 , ''  , parsing.STRICT ],
         'flag'          : [ self_cmd.flag              , 0 , 0 , ''  , parsing.LEGACY ],
         'focal_blur'    : [ self_cmd.focal_blur        , 0 , 0 , ''  , parsing.STRICT ],
@@ -101,12 +104,14 @@ def get_command_keywords(self_cmd=cmd):
         'get'           : [ self_cmd.get               , 0 , 0 , ''  , parsing.STRICT ],
         'get_angle'     : [ self_cmd.get_angle         , 0 , 0 , ''  , parsing.STRICT ],
         'get_area'      : [ self_cmd.get_area          , 0 , 0 , ''  , parsing.STRICT ],
+        'get_atom_areas': [ self_cmd.get_atom_areas    , 0 , 0 , ''  , parsing.STRICT ],
         'get_bond'      : [ self_cmd.get_bond          , 0 , 0 , ''  , parsing.STRICT ],
         'get_chains'    : [ self_cmd.get_chains        , 0 , 0 , ''  , parsing.STRICT ],
         'get_clip'      : [ self_cmd.get_clip          , 0 , 0 , ''  , parsing.STRICT ],
         'get_dihedral'  : [ self_cmd.get_dihedral      , 0 , 0 , ''  , parsing.STRICT ],
         'get_distance'  : [ self_cmd.get_distance      , 0 , 0 , ''  , parsing.STRICT ],
         'get_extent'    : [ self_cmd.get_extent        , 0 , 0 , ''  , parsing.STRICT ],
+        'get_map_correlation' : [ self_cmd.get_map_correlation , 0 , 0 , ''  , parsing.STRICT ],
         'get_position'  : [ self_cmd.get_position      , 0 , 0 , ''  , parsing.STRICT ],
         'get_sasa_relative' : [ self_cmd.get_sasa_relative , 0 , 0 , ''  , parsing.STRICT ],
         'get_symmetry'  : [ self_cmd.get_symmetry      , 0 , 0 , ''  , parsing.STRICT ],
@@ -161,7 +166,9 @@ def get_command_keywords(self_cmd=cmd):
         'map_set_border': [ self_cmd.map_set_border    , 0 , 0 , ''  , parsing.STRICT ],
         'map_double'    : [ self_cmd.map_double        , 0 , 0 , ''  , parsing.STRICT ],
         'map_halve'     : [ self_cmd.map_halve         , 0 , 0 , ''  , parsing.STRICT ],
+        'map_lowpass'   : [ self_cmd.map_lowpass       , 0 , 0 , ''  , parsing.STRICT ],
         'map_new'       : [ self_cmd.map_new           , 0 , 0 , ''  , parsing.STRICT ],
+        'map_sharpen'   : [ self_cmd.map_sharpen       , 0 , 0 , ''  , parsing.STRICT ],
         'map_trim'      : [ self_cmd.map_trim          , 0 , 0 , ''  , parsing.STRICT ],
         'mappend'       : [ self_cmd.mappend           , 2 , 2 , ':' , parsing.MOVIE  ],
         'matrix_reset'  : [ self_cmd.matrix_reset      , 0 , 0 , ''  , parsing.STRICT ],
@@ -232,6 +239,7 @@ def get_command_keywords(self_cmd=cmd):
         'run'           : [ self_cmd.run               , 0 , 0 , ',' , parsing.SECURE ], # insecure
         'rms'           : [ self_cmd.rms               , 0 , 0 , ''  , parsing.STRICT ],
         'rms_cur'       : [ self_cmd.rms_cur           , 0 , 0 , ''  , parsing.STRICT ],
+        'rms_matrix'    : [ self_cmd.rms_matrix        , 0 , 0 , ''  , parsing.STRICT ],
         'save'          : [ self_cmd.save              , 0 , 0 , ''  , parsing.SECURE ],
         'scene'         : [ self_cmd.scene             , 0 , 0 , ''  , parsing.STRICT ],
         'scene_order'   : [ self_cmd.scene_order       , 0 , 0 , ''  , parsing.STRICT ],
@@ -369,6 +377,7 @@ def get_help_only_keywords(self_cmd=cmd):
         'launching'             : [ self_cmd.helping.launching  ],
         'load_model'            : [ self_cmd.load_model  ],
         'movies'                : [ self_cmd.helping.movies  ],
+        'pick_atoms'            : [ self_cmd.pick_atoms ],
         'python_help'           : [ self_cmd.python_help   ],
         'povray'                : [ self_cmd.helping.povray  ],
         'read_molstr'           : [ self_cmd.read_molstr ],
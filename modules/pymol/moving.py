@@ -380,7 +380,9 @@ USAGE
 ARGUMENTS
 
     prefix = string: filename prefix for saved images -- output files
-    will be numbered and end in ".png"
+    will be numbered and end in ".png". If the name ends in ".y4m" or
+    ".rgba", all frames are written to this single file (which may be
+    a named pipe to a video encoder) as YUV4MPEG2 or raw top-down RGBA.
 
     first = integer: starting frame {default: 0 (first frame)}
 
@@ -405,6 +407,14 @@ NOTES
 
     Also, be sure to avoid setting "cache_frames" when rendering a
     long movie to avoid running out of memory.
+
+    Frames are compressed and written by background threads while the
+    next frame is rendered. Only a few frames are kept in flight.
+
+    With mode=2 (ray), the "movie_ray_frames" setting traces that many
+    frames at the same time, each with a single thread (0: one frame per
+    "max_threads"). This scales better than multi-threading a single
+    frame for long movies. Frames with labels are traced one at a time.
     
     Arguments "first" and "last" can be used to specify an inclusive
     interval over which to render frames.  Thus, you can write a smart
@@ -173,6 +173,34 @@ PYMOL API
                         print(" get_symmetry: No symmetry defined.")
         return r
 
+    def get_map_correlation(map1, map2, state1=CURRENT_STATE,
+            state2=CURRENT_STATE, resolution=0.0, quiet=1, *, _self=cmd):
+        '''
+DESCRIPTION
+
+    "get_map_correlation" computes the correlation coefficient of two maps
+    on identical grids from their Fourier coefficients (FFT).
+
+USAGE
+
+    get_map_correlation map1, map2 [, state1 [, state2 [, resolution ]]]
+
+ARGUMENTS
+
+    resolution = float: only include terms up to this resolution in
+    Angstrom {default: 0 (all terms)}
+
+SEE ALSO
+
+    map_sharpen, map_lowpass
+        '''
+        with _self.lockcm:
+            r = _cmd.get_map_correlation(_self._COb, str(map1), str(map2),
+                    int(state1) - 1, int(state2) - 1, float(resolution))
+        if not int(quiet):
+            print(" get_map_correlation: %.4f" % r)
+        return r
+
     def get_title(object, state, quiet=1, *, _self=cmd):
         '''
 DESCRIPTION
@@ -1118,6 +1146,44 @@ SEE ALSO
             print(" cmd.get_area: %5.3f Angstroms^2."%r)
         return r
 
+    def get_atom_areas(selection="(all)", state=1, load_b=0, quiet=1, *, _self=cmd):
+        '''
+DESCRIPTION
+
+    Get per-atom surface areas, for one state or all states (trajectory).
+    Same settings and atom flags as "get_area".
+
+USAGE
+
+    get_atom_areas [ selection [, state [, load_b ]]]
+
+ARGUMENTS
+
+    selection = str: atom selection within a single object {default: all}
+
+    state = int: object state, 0 for all states {default: 1}
+
+    load_b = bool: store per-atom surface area (average over states) in
+    b-factors {default: 0}
+
+RETURNS
+
+    List of per-atom area lists (one per state, atoms in "index" order)
+
+SEE ALSO
+
+    get_area
+        '''
+        selection = selector.process(selection)
+        with _self.lockcm:
+            r = _cmd.get_atom_areas(_self._COb, "(" + str(selection) + ")",
+                                    int(state) - 1, int(load_b))
+        if not quiet:
+            for i, areas in enumerate(r):
+                print(" cmd.get_atom_areas: state %d: %5.3f Angstroms^2." %
+                      (i + 1 if int(state) == 0 else int(state), sum(areas)))
+        return r
+
     def get_chains(selection="(all)", state=ALL_STATES, quiet=1, *, _self=cmd):
         '''
 DESCRIPTION
@@ -1329,6 +1395,30 @@ NOTE
                         print(" cmd.index: (%s`%d)"%(a[0],a[1]))
         return r
 
+    def pick_atoms(x, y, width=1, height=1, quiet=1, *, _self=cmd):
+        '''
+DESCRIPTION
+
+    API only function. Returns the atoms at a window position, or in the
+    rectangle with lower left corner (x, y), as (model, index) tuples.
+
+    Works in headless sessions, see the "pick_cpu" setting.
+
+PYMOL API
+
+    list = cmd.pick_atoms(int x, int y, int width=1, int height=1)
+
+SEE ALSO
+
+    index
+        '''
+        with _self.lockcm:
+            r = _cmd.pick(_self._COb, int(x), int(y), int(width), int(height))
+        if not quiet:
+            for a in r:
+                print(" cmd.pick_atoms: (%s`%d)"%(a[0],a[1]))
+        return r
+
     def find_pairs(selection1, selection2, state1=1, state2=1, cutoff=3.5, mode=0, angle=45, *, _self=cmd):
         '''
 DESCRIPTION
@@ -1368,6 +1458,76 @@ NOTE
                                       int(mode),float(cutoff),float(angle))
         return r
 
+    _interaction_types = {
+        'hbond': 0x01,
+        'salt_bridge': 0x02,
+        'halogen': 0x04,
+        'pi_pi': 0x08,
+        'pi_cation': 0x10,
+        'pi': 0x18,
+        'all': 0x1F,
+    }
+
+    def interaction_table(selection1, selection2="same", state=ALL_STATES,
+                          types="all", quiet=1, *, _self=cmd):
+        '''
+DESCRIPTION
+
+    API only function. Detects interactions between two selections in every
+    state (trajectory frame) without creating measurement objects. States are
+    processed in parallel. Criteria are the same as for the "distance"
+    command modes (h_bond_*, salt_bridge_distance and halogen_bond_*
+    settings).
+
+    Returns a column-oriented dictionary: "atoms" is a list of (model,index)
+    tuples and "atom1"/"atom2" index into it; "state", "type", "distance"
+    and "angle" have one entry per interaction.
+
+    atom1/atom2 are donor/acceptor for hydrogen and halogen bonds,
+    anion/cation for salt bridges and ring/ring or ring/cation for pi
+    interactions (rings are represented by their first atom).
+
+    angle is D-H...A for hydrogen bonds, the donor angle for halogen bonds,
+    the angle between ring normals for pi-pi and between ring normal and
+    cation for pi-cation interactions (nan for salt bridges).
+
+ARGUMENTS
+
+    selection1, selection2 = string: atom selections {default for selection2: same}
+
+    state = integer: object state, 0 for all states {default: 0}
+
+    types = string: space separated subset of hbond, salt_bridge, halogen,
+    pi_pi, pi_cation, pi, all {default: all}
+        '''
+        mask = 0
+        for word in types.replace(',', ' ').replace('+', ' ').split():
+            try:
+                mask |= _interaction_types[word]
+            except KeyError:
+                raise pymol.CmdException('unknown interaction type: ' + word)
+
+        if selection2 != "same":
+            selection2 = selector.process(selection2)
+
+        with _self.lockcm:
+            r = _cmd.interaction_table(_self._COb, selector.process(selection1),
+                                       selection2, int(state) - 1, mask,
+                                       int(quiet))
+
+        names = {v: k for (k, v) in _interaction_types.items()
+                 if k not in ('pi', 'all')}
+        atoms, states, itypes, atom1, atom2, distance, angle = r
+        return {
+            'atoms': atoms,
+            'state': states,
+            'type': [names[t] for t in itypes],
+            'atom1': atom1,
+            'atom2': atom2,
+            'distance': distance,
+            'angle': angle,
+        }
+
     def get_extent(selection="(all)", state=ALL_STATES, quiet=1, *, _self=cmd):
         '''
 DESCRIPTION
@@ -564,7 +564,7 @@ if DEBUG and not WIN:
         ("_GLIBCXX_ASSERTIONS", None),
     ]
 
-libs = ["png", "freetype"]
+libs = ["png", "z", "freetype"]
 lib_dirs = []
 ext_comp_args = (
     [
@@ -689,6 +689,7 @@ if WIN:
             "glew32",
             "freetype",
             "libpng",
+            "zlib",
         ]
         + (options.glut)
         * [
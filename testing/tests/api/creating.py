@@ -318,6 +318,19 @@ class TestCreating(testing.PyMOLTestCase):
         self.assertEqual(segis["s03000000"], set(["D000" if segi else ""]))
         self.assertEqual(segis["s04000000"], set(["E000" if segi else ""]))
 
+    @testing.requires_version('3.2')
+    def testSymexpInstanced(self):
+        cmd.load(self.datafile('1oky.pdb.gz'), 'm1')
+        n = cmd.count_atoms()
+        cmd.symexp('s', 'm1', '%m1 & resi 283', 20.0, instanced=1)
+        self.assertEqual(cmd.get_object_list(), ['m1', 's'])
+        self.assertEqual(n * 2, cmd.count_atoms())
+        # extent covers all instances
+        self.assertArrayEqual(
+            cmd.get_extent(),
+            [[40.8978, -8.901, -47.0803], [162.085, 108.416, 31.309]],
+            delta=1e-2)
+
     def testFragment(self):
         frag_name = "ala"
         cmd.fragment(frag_name)
@@ -167,6 +167,96 @@ class TestEditing(testing.PyMOLTestCase):
         with self.assertRaises(IndexError):
             cmd.iterate('all', 'name[100]')
 
+    def _iterate_dump(self, selection):
+        stored.dump = []
+        cmd.iterate(selection, 'stored.dump.append((name, resn, resi, resv,'
+                ' chain, elem, b, q, ss, type, formal_charge))')
+        return stored.dump
+
+    @testing.requires_version('3.2')
+    @testing.foreach(
+        "stored.v.append((name, resi, resv, b, q, type, model, index, elem))",
+        "stored.v.append(b * 2 + resv // 3 - q if resn == 'ALA' else -1.5)",
+        "stored.v.append([str(b), int(resi) % 7, len(name), max(vdw, 1.5), name + chain])",
+    )
+    def testIterateNative(self, expr):
+        cmd.load(self.datafile('1oky.pdb.gz'), 'm1')
+        results = []
+        for native in (0, 1):
+            cmd.set('iterate_native', native)
+            stored.v = []
+            cmd.iterate('resi 100-120', expr)
+            results.append(stored.v)
+        self.assertTrue(len(results[0]) > 0)
+        self.assertEqual(results[0], results[1])
+
+    @testing.requires_version('3.2')
+    @testing.foreach(
+        "b = b * 2 + resv; q = -q",
+        "resi = str(int(resi) + 10); chain = 'Z'",
+        "resv += 1000; name = name + '1'",
+        "elem = 'C' if elem == 'O' else elem; ss = 'H'",
+        "type = 'HETATM'; formal_charge = 1 if resn == 'LYS' else 0",
+    )
+    def testAlterNative(self, expr):
+        cmd.load(self.datafile('1oky.pdb.gz'), 'm1')
+        cmd.create('m2', 'm1')
+        cmd.set('iterate_native', 0)
+        cmd.alter('m1', expr)
+        cmd.set('iterate_native', 1)
+        cmd.alter('m2', expr)
+        self.assertEqual(self._iterate_dump('m1'), self._iterate_dump('m2'))
+
+    @testing.requires_version('3.2')
+    def testAlterStateNative(self):
+        cmd.load(self.datafile('1oky.pdb.gz'), 'm1')
+        cmd.create('m2', 'm1')
+        expr = "x = x + 1.5; y = -y; z = z * state"
+        cmd.set('iterate_native', 0)
+        cmd.alter_state(1, 'm1', expr)
+        cmd.set('iterate_native', 1)
+        cmd.alter_state(1, 'm2', expr)
+        self.assertArrayEqual(cmd.get_coords('m1'), cmd.get_coords('m2'),
+                delta=1e-4)
+
+    @testing.requires_version('3.2')
+    @testing.foreach(0, 1)
+    def testAlterNativeExceptions(self, native):
+        cmd.set('iterate_native', native)
+        cmd.fragment('gly')
+        with self.assertRaises(ZeroDivisionError):
+            cmd.alter('all', 'b = 1 / (resv - resv)')
+        with self.assertRaisesRegex(ValueError, 'float'):
+            cmd.alter('all', 'b = "abc"')
+
+    @testing.requires_version('3.2')
+    @testing.foreach(0, 1)
+    def testIterateNativeIntOverflow(self, native):
+        cmd.set('iterate_native', native)
+        cmd.fragment('gly')
+        n = cmd.count_atoms()
+        stored.v = []
+        cmd.iterate('all', 'stored.v.append(index); '
+                'stored.v.append(index * 10**18 * 100 - 2**63)')
+        self.assertEqual(stored.v, [i for index in range(1, n + 1)
+            for i in (index, index * 10**18 * 100 - 2**63)])
+        cmd.alter('all', 'b = int(1e20) % 7 + int("12345678901234567890") % 5')
+        stored.v = []
+        cmd.iterate('all', 'stored.v.append(b)')
+        self.assertEqual(stored.v, [2.0] * n)
+        with self.assertRaises(OverflowError):
+            cmd.alter('all', 'b = int(1e400)')
+
+    @testing.requires_version('3.2')
+    @testing.foreach(0, 1)
+    def testAlterNativeExceptionKeepsAppended(self, native):
+        cmd.set('iterate_native', native)
+        cmd.fragment('gly')
+        stored.v = []
+        with self.assertRaises(ZeroDivisionError):
+            cmd.alter('all', 'stored.v.append(index); b = 1 // (index - 3)')
+        self.assertEqual(stored.v, [1, 2, 3])
+
     def test_attach(self):
         cmd.pseudoatom()
         cmd.edit('first all')
@@ -493,6 +583,32 @@ class TestEditing(testing.PyMOLTestCase):
         cmd.map_halve
         self.skipTest("TODO")
 
+    def _make_map(self, name='map'):
+        cmd.fragment('trp', 'm1')
+        cmd.set('gaussian_b_floor', 30)
+        cmd.map_new(name, 'gaussian', 0.5, 'm1', 3.0)
+        cmd.delete('m1')
+
+    def test_map_sharpen(self):
+        self._make_map()
+        cmd.copy('map_orig', 'map')
+        stdev1 = cmd.get_volume_histogram('map', 2)[3]
+        cmd.map_sharpen('map', -20.0)
+        stdev2 = cmd.get_volume_histogram('map', 2)[3]
+        self.assertLess(stdev2, stdev1)
+        cc = cmd.get_map_correlation('map', 'map_orig')
+        self.assertGreater(cc, 0.8)
+        self.assertLess(cc, 1.0)
+
+    def test_map_lowpass(self):
+        self._make_map()
+        cmd.copy('map_orig', 'map')
+        cmd.map_lowpass('map', 4.0)
+        self.assertAlmostEqual(1.0,
+            cmd.get_map_correlation('map', 'map_orig', resolution=4.0),
+            delta=1e-3)
+        self.assertLess(cmd.get_map_correlation('map', 'map_orig'), 1.0)
+
     def test_map_set(self):
         cmd.map_set
         self.skipTest("TODO")
@@ -154,6 +154,25 @@ class TestExporting(testing.PyMOLTestCase):
         self.assertEqual(img.shape[:2], (nrow, ncol))
         self.assertImageHasColor('yellow', img)
 
+    @testing.requires_version('3.2')
+    def testPngHeadlessDraw(self):
+        self.ambientOnly()
+        cmd.set('specular', 0)
+        cmd.set('headless_draw')
+        cmd.bg_color('blue')
+        cmd.fragment('gly')
+        cmd.show_as('spheres')
+        cmd.color('yellow')
+        cmd.zoom(complete=1)
+
+        ncol, nrow = 120, 80
+        with testing.mktemp('.png') as filename:
+            cmd.png(filename, ncol, nrow, ray=0)
+            img = self.get_imagearray(filename)
+        self.assertEqual(img.shape[:2], (nrow, ncol))
+        self.assertImageHasColor('yellow', img)
+        self.assertImageHasColor('blue', img)
+
     # not supported in older versions: xyz (no ref)
     @testing.foreach('pdb', 'sdf', 'mol', 'mol2')
     def testSaveRef(self, format):
@@ -348,6 +367,120 @@ class TestExporting(testing.PyMOLTestCase):
             m2 = cmd.get_model()
             self.assertModelsAreSame(m1, m2)
 
+    @testing.requires_version('3.2')
+    def testPSEB(self):
+        '''Binary session, round trip compared to PSE'''
+        cmd.load(self.datafile('1oky.pdb.gz'), 'm1')
+        cmd.create('m1', 'm1', 1, 2)
+        cmd.alter_state(2, 'm1', 'x = x + 1.0')
+        cmd.color('red', 'resn ALA')
+        cmd.set('sphere_scale', 0.5, 'm1')
+        cmd.map_new('map1', 'gaussian', 1.0, 'm1', state=1)
+
+        model = cmd.get_model('m1', state=2)
+        coords = [cmd.get_coords('m1', state) for state in (1, 2)]
+        field = cmd.get_volume_field('map1')
+        colors = []
+        cmd.iterate('m1', 'colors.append(color)', space=locals())
+
+        with testing.mktemp('.pse') as pse, testing.mktemp('.pseb') as pseb:
+            cmd.save(pse)
+            cmd.save(pseb)
+
+            with open(pseb, 'rb') as handle:
+                self.assertEqual(handle.read(8), b'PYMOLSES')
+
+            for filename in (pse, pseb):
+                cmd.reinitialize()
+                cmd.load(filename)
+                self.assertEqual(cmd.get_names(), ['m1', 'map1'])
+                self.assertModelsAreSame(model, cmd.get_model('m1', state=2))
+                for state in (1, 2):
+                    self.assertArrayEqual(coords[state - 1],
+                            cmd.get_coords('m1', state))
+                self.assertArrayEqual(field, cmd.get_volume_field('map1'))
+                colors_loaded = []
+                cmd.iterate('m1', 'colors_loaded.append(color)',
+                        space=locals())
+                self.assertEqual(colors, colors_loaded)
+                self.assertEqual(cmd.get('sphere_scale', 'm1'), '0.50000')
+
+    @testing.requires_version('3.2')
+    @testing.foreach(
+        (2, 'm1'), # AtomInfo
+        (3, 'm1'), # AtomStrings
+        (4, 'm1'), # Bonds
+        (7, 'map1'), # FieldData
+    )
+    def testPSEBCorruptSection(self, section_type, name):
+        '''Sections with a size which doesn't match the object are rejected'''
+        import struct
+        cmd.load(self.datafile('1oky.pdb.gz'), 'm1')
+        cmd.map_new('map1', 'gaussian', 1.0, 'm1', state=1)
+
+        with testing.mktemp('.pseb') as filename:
+            cmd.save(filename)
+            with open(filename, 'rb') as handle:
+                data = bytearray(handle.read())
+
+            # shrink the section (table entry: type, version, offset, size)
+            table_offset, count = struct.unpack_from('=QQ', data, 16)
+            for i in range(count):
+                entry = table_offset + i * 32
+                if struct.unpack_from('=I', data, entry)[0] == section_type:
+                    size = struct.unpack_from('=Q', data, entry + 16)[0]
+                    # for AtomStrings, drops the terminator of the last string
+                    data[entry + 16:entry + 24] = struct.pack('=Q', size - 1)
+
+            with open(filename, 'wb') as handle:
+                handle.write(data)
+
+            cmd.reinitialize()
+            try:
+                cmd.load(filename)
+            except pymol.CmdException:
+                pass
+
+        self.assertNotIn(name, cmd.get_names())
+
+    @testing.requires_version('3.2')
+    def testPSEBPartial(self):
+        cmd.fragment('gly', 'm1')
+        cmd.fragment('ala', 'm2')
+        with testing.mktemp('.pseb') as filename:
+            cmd.save(filename, 'm2')
+            cmd.load(filename, partial=1)
+        self.assertEqual(cmd.count_atoms('m1'), 7)
+        self.assertEqual(cmd.count_atoms('m2'), 10)
+
+    @testing.foreach('pdb', 'cif', 'pmcif', 'pqr', 'sdf', 'mol2', 'xyz', 'mae')
+    @testing.requires_version('3.2')
+    def testSaveMultiStateStream(self, format):
+        '''Large multi-state save is written in chunks, same as get_str'''
+        cmd.load(self.datafile('1oky.pdb.gz'), 'm1')
+        for state in range(2, 31):
+            cmd.create('m1', 'm1', 1, state)
+        cmd.alter_state(0, 'm1', 'x = x + state * 0.0125')
+        self.assertTrue(cmd.count_atoms('m1', state=0) > (1 << 16))
+
+        with testing.mktemp('.' + format) as filename:
+            cmd.save(filename, 'm1', state=0, format=format)
+            with open(filename) as handle:
+                contents = handle.read()
+
+        self.assertEqual(contents, cmd.get_str(format, 'm1', state=0))
+
+    @testing.requires_version('3.2')
+    def testSaveInvalidSelectionKeepsFile(self):
+        '''Failed validation must not touch an existing file'''
+        with testing.mktemp('.pdb') as filename:
+            with open(filename, 'w') as handle:
+                handle.write('keep me')
+            with self.assertRaises(pymol.CmdException):
+                cmd.save(filename, 'no_such_object')
+            with open(filename) as handle:
+                self.assertEqual(handle.read(), 'keep me')
+
     def testGetModelObjectName(self):
         cmd.load(self.datafile("1oky-frag.pdb"))
         cmd.load(self.datafile('1rna.cif'))
@@ -463,3 +596,20 @@ class TestExporting(testing.PyMOLTestCase):
         self.assertEqual(mytypes['NE2'], 'N.pl3')
         self.assertEqual(mytypes['N'], 'N.3')
         self.assertEqual(mytypes['CG'], 'C.2')
+
+    @testing.requires_version('3.2')
+    def testAssignAtomTypesMultipleObjects(self):
+        for i, name in enumerate(['his', 'ser', 'lys', 'asp'] * 5):
+            cmd.fragment(name, 'm%02d' % i)
+        cmd.alter('all', 'text_type = "none"')
+        pymol.exporting.assign_atom_types('all', 'mol2')
+        types = {}
+        cmd.iterate('all', 'types[model, name] = text_type', space=locals())
+        self.assertNotIn('none', types.values())
+        for i in range(0, 20, 4):
+            self.assertEqual(types['m%02d' % i, 'NE2'], 'N.pl3')
+            self.assertEqual(types['m%02d' % (i + 1), 'OG'], 'O.3')
+            self.assertEqual(types['m%02d' % (i + 2), 'NZ'], 'N.4')
+            self.assertEqual(types['m%02d' % (i + 3), 'OD1'], 'O.co2')
+        self.assertEqual(cmd.count_atoms('donors'),
+                         5 * cmd.count_atoms('(m00 m01 m02 m03) and donors'))
@@ -27,6 +27,26 @@ class TestFitting(testing.PyMOLTestCase):
         self.assertEqual(alen, 40)
         self.assertEqual(alen, cmd.count_atoms("aln") / 2)
 
+    @testing.requires_version('3.2')
+    def testCealignBatch(self):
+        cmd.load(self.datafile("1oky-frag.pdb"), "m1")
+        cmd.load(self.datafile("1t46-frag.pdb"), "m2")
+        cmd.create("m3", "m1")
+        cmd.fragment("gly", "m4")
+        r = cmd.cealign_batch("m2", "m1 m3 m4", transform=0)
+        self.assertEqual(sorted(r), ["m1", "m3", "m4"])
+        self.assertEqual(r["m4"], None)
+        ref = cmd.cealign("m2", "m1", transform=0)
+        for name in ["m1", "m3"]:
+            self.assertEqual(r[name]["alignment_length"], ref["alignment_length"])
+            self.assertAlmostEqual(r[name]["RMSD"], ref["RMSD"], delta=1e-6)
+            self.assertArrayEqual(r[name]["rotation_matrix"],
+                                  ref["rotation_matrix"], delta=1e-6)
+        # transform
+        cmd.cealign_batch("m2", "m1")
+        cmd.cealign("m2", "m3")
+        self.assertAlmostEqual(cmd.rms_cur("m1", "m3"), 0.0, delta=1e-3)
+
     def testFit(self):
         cmd.fragment("gly", "m1")
         cmd.create("m2", "m1")
@@ -37,6 +57,52 @@ class TestFitting(testing.PyMOLTestCase):
         rms = cmd.rms_cur("m1", "m2")
         self.assertEqual(rms, 0.0)
 
+    @testing.requires_version('3.2')
+    def testFitBatch(self):
+        self._make_states()
+        cmd.create("m2", "m1", 1, 1)
+        cmd.create("m3", "m1", 2, 1)
+        cmd.rotate("y", 30, "m3", camera=0)
+        r = cmd.fit_batch("m1 m3", "m2")
+        self.assertEqual(sorted(r), ["m1", "m3"])
+        self.assertEqual(len(r["m1"]), 3)
+        self.assertAlmostEqual(r["m1"][0], 0.0, delta=1e-3)
+        self.assertAlmostEqual(r["m1"][1], 0.0, delta=1e-3)
+        self.assertAlmostEqual(r["m3"][0], 0.0, delta=1e-3)
+        # same result as fit
+        cmd.create("m4", "m1", 3, 1)
+        rms = cmd.fit("m4", "m2")
+        self.assertAlmostEqual(r["m1"][2], rms, delta=1e-3)
+        self.assertAlmostEqual(cmd.rms_cur("m1", "m4", 3, 1), 0.0, delta=1e-3)
+        self.assertAlmostEqual(cmd.rms_cur("m3", "m2"), 0.0, delta=1e-3)
+        # single mobile state
+        r = cmd.fit_batch("m1", "m2 and name CA", 2)
+        self.assertEqual(r["m1"][0], -1.0)
+        self.assertAlmostEqual(r["m1"][1], 0.0, delta=1e-3)
+
+    @testing.requires_version('3.2')
+    def testFitBatchMatching(self):
+        # same identifiers as rms (AtomInfoMatch)
+        cmd.fragment("gly", "m1")
+        cmd.create("m2", "m1")
+        cmd.alter("m2", "resn = 'ALA'")
+        r = cmd.fit_batch("m1", "m2")
+        self.assertEqual(r["m1"], [-1.0])
+        cmd.alter("m2", "resn = 'gly'; name = name.lower()")
+        cmd.alter("m2", "chain = 'a'")
+        cmd.alter("m1", "chain = 'A'")
+        cmd.set("ignore_case", 0)
+        r = cmd.fit_batch("m1", "m2")
+        self.assertEqual(r["m1"], [-1.0])
+        cmd.set("ignore_case", 1)
+        cmd.set("ignore_case_chain", 0)
+        r = cmd.fit_batch("m1", "m2")
+        self.assertEqual(r["m1"], [-1.0])
+        cmd.set("ignore_case_chain", 1)
+        r = cmd.fit_batch("m1", "m2")
+        self.assertAlmostEqual(r["m1"][0], 0.0, delta=1e-3)
+        self.assertAlmostEqual(cmd.rms("m1", "m2"), 0.0, delta=1e-3)
+
     def testIntraFit(self):
         cmd.fragment("gly", "m1")
         cmd.create("m1", "m1", 1, 2)
@@ -84,6 +150,43 @@ class TestFitting(testing.PyMOLTestCase):
         rms = cmd.pair_fit(*sele)
         self.assertAlmostEqual(rms, 0.0713, delta=1e-4)
 
+    def _make_states(self):
+        cmd.fragment("trp", "m1")
+        cmd.create("m1", "m1", 1, 2)
+        cmd.create("m1", "m1", 1, 3)
+        cmd.rotate("x", 60, "m1", state=2, camera=0)
+        cmd.translate([1, 2, 3], "m1", state=2, camera=0)
+        cmd.alter_state(3, "m1 and name CA+CB", "x = x + 1.5")
+
+    @testing.requires_version('3.2')
+    def testRmsMatrix(self):
+        self._make_states()
+        m = cmd.rms_matrix("m1")
+        self.assertEqual(len(m), 3)
+        self.assertAlmostEqual(m[0][0], 0.0, delta=1e-4)
+        self.assertAlmostEqual(m[0][1], 0.0, delta=1e-3)
+        self.assertAlmostEqual(m[0][2], m[2][0], delta=1e-5)
+        rms_list = cmd.intra_rms("m1", 3)
+        self.assertAlmostEqual(m[2][0], rms_list[0], delta=1e-3)
+        self.assertAlmostEqual(m[2][1], rms_list[1], delta=1e-3)
+
+    @testing.requires_version('3.2')
+    def testRmsMatrixNpy(self):
+        import numpy
+        self._make_states()
+        with testing.mktemp(".npy") as filename:
+            self.assertEqual(cmd.rms_matrix("m1", filename), None)
+            m = numpy.load(filename)
+        self.assertEqual(m.shape, (3, 3))
+        self.assertArrayEqual(m, cmd.rms_matrix("m1"), delta=1e-6)
+
+    @testing.requires_version('3.2')
+    def testClusterStates(self):
+        self._make_states()
+        clusters = cmd.cluster_states("m1", 0.1)
+        self.assertArrayEqual(clusters, [1, 1, 2])
+        self.assertEqual(cmd.get_title("m1", 3), "cluster 2")
+
     def testRms(self):
         # see fit
         pass
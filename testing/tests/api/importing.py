@@ -451,6 +451,33 @@ class TestImporting(testing.PyMOLTestCase):
         cmd.read_pdbstr(pdbstr, 'm1')
         self.assertEqual(2, cmd.count_states())
 
+    @testing.requires_version('3.2')
+    def testReadPdbstrGuessValences(self):
+        # one object with many ligands gets the same bond orders as
+        # loading each ligand on its own
+        with open(self.datafile("ligs3d.pdb")) as handle:
+            models = handle.read().split("ENDMDL")[:-1]
+        combined = []
+        for i, model in enumerate(models):
+            lines = [line for line in model.splitlines()
+                     if line.startswith("HETATM")]
+            cmd.read_pdbstr("\n".join(lines), "m%02d" % i)
+            for line in lines:
+                x = float(line[30:38]) + 50.0 * i
+                combined.append("%s%8.3f%s%-4s%s" % (line[:30], x,
+                                line[38:72], "L%02d" % i, line[76:]))
+        cmd.read_pdbstr("\n".join(combined), "all_ligs")
+
+        def orders(sele):
+            return sorted(b.order for b in cmd.get_model(sele).bond)
+
+        aromatic = 0
+        for i in range(len(models)):
+            ref = orders("m%02d" % i)
+            self.assertEqual(orders("all_ligs and segi L%02d" % i), ref)
+            aromatic += ref.count(4)
+        self.assertTrue(aromatic > 0)
+
     def testReadSdfstr(self):
         sdfstr = molstr + '$$$$\n'
 
@@ -221,6 +221,45 @@ class TestMoving(testing.PyMOLTestCase):
             self.assertEqual(img.shape[:2], shape2)
             self.assertImageHasColor('blue', img)
 
+    @testing.requires_version('3.2')
+    def testMpngStream(self):
+        import os
+
+        cmd.mset("1x4")
+        cmd.set('movie_fps', 24)
+
+        with testing.mkdtemp() as dirname:
+            filename = os.path.join(dirname, 'movie.y4m')
+            cmd.mpng(filename, width=40, height=30, mode=2)
+            with open(filename, 'rb') as handle:
+                data = handle.read()
+
+        header = b'YUV4MPEG2 W40 H30 F24000:1000 Ip A1:1 C444\n'
+        self.assertTrue(data.startswith(header))
+        self.assertEqual(len(data), len(header) + 4 * (6 + 3 * 40 * 30))
+
+    @testing.requires_version('3.2')
+    def testMpngRayFrames(self):
+        import os
+
+        cmd.fragment('gly')
+        cmd.mset("1x6")
+        cmd.mdo(1, 'bg_color red')
+        cmd.mdo(3, 'bg_color blue; show spheres')
+        cmd.mdo(5, 'turn y, 90; label name CA, "CA"')
+
+        streams = []
+        with testing.mkdtemp() as dirname:
+            for ray_frames in (1, 3):
+                cmd.set('movie_ray_frames', ray_frames)
+                filename = os.path.join(dirname, 'movie%d.rgba' % ray_frames)
+                cmd.mpng(filename, width=40, height=30, mode=2)
+                with open(filename, 'rb') as handle:
+                    streams.append(handle.read())
+
+        self.assertEqual(len(streams[0]), 6 * 40 * 30 * 4)
+        self.assertEqual(streams[0], streams[1])
+
     def testMset(self):
         # basic tet
         self.prep_movie()
@@ -96,6 +96,35 @@ class TestQuerying(testing.PyMOLTestCase):
         pairs = cmd.find_pairs("m2 & donor", "m2 & acceptor", mode=1)
         self.assertEqual(pairs, [(('m2', 29), ('m2', 4))])
 
+    @testing.requires_version('3.2')
+    def testInteractionTable(self):
+        cmd.fab("AAAAAAAA", "m1", ss=1)
+        cmd.create("m1", "m1", 1, 2)
+
+        r = cmd.interaction_table("m1", types="hbond")
+        self.assertEqual(sorted(r), ['angle', 'atom1', 'atom2', 'atoms',
+                                     'distance', 'state', 'type'])
+        n = len(r['state'])
+        self.assertTrue(n > 0)
+        self.assertEqual(r['state'].count(1), n // 2)
+        self.assertEqual(r['state'].count(2), n // 2)
+        self.assertEqual(set(r['type']), {'hbond'})
+
+        names = {}
+        cmd.iterate("m1", "names[index] = name", space=locals())
+        for a1, a2, dist, angle in zip(r['atom1'], r['atom2'],
+                                       r['distance'], r['angle']):
+            self.assertEqual(names[r['atoms'][a1][1]], 'N')
+            self.assertEqual(names[r['atoms'][a2][1]], 'O')
+            self.assertTrue(2.5 < dist < 3.6)
+            self.assertTrue(110.0 < angle <= 180.0)
+
+        r = cmd.interaction_table("m1", state=1, types="salt_bridge")
+        self.assertEqual(r['state'], [])
+
+        with self.assertRaises(CmdException):
+            cmd.interaction_table("m1", types="hbond bogus")
+
     def testGetAngle(self):
         # see testAngle
         pass
@@ -129,6 +158,26 @@ class TestQuerying(testing.PyMOLTestCase):
         cmd.flag('ignore', 'all')
         self.assertEqual(cmd.get_area(), 0.0)
 
+    @testing.requires_version('3.2')
+    def testGetAtomAreas(self):
+        cmd.fragment("gly")
+        cmd.create("gly", "gly", 1, 2)
+        cmd.translate([0.5, 0, 0], "gly & elem O", state=2, camera=0)
+        total = cmd.get_area()
+
+        r = cmd.get_atom_areas()
+        self.assertEqual(len(r), 1)
+        self.assertEqual(len(r[0]), cmd.count_atoms())
+        self.assertAlmostEqual(sum(r[0]), total, delta=1e-3)
+
+        r = cmd.get_atom_areas("elem O", state=0, load_b=1)
+        self.assertEqual(len(r), 2)
+        self.assertAlmostEqual(r[0][0], 15.47754, delta=1e-2)
+        self.assertNotAlmostEqual(r[0][0], r[1][0], delta=1e-2)
+        b_list = []
+        cmd.iterate("elem O", "b_list.append(b)", space=locals())
+        self.assertAlmostEqual(b_list[0], (r[0][0] + r[1][0]) / 2, delta=1e-3)
+
     def testGetAtomCoords(self):
         cmd.fragment("gly")
         coords = cmd.get_atom_coords("elem O")
@@ -523,6 +572,18 @@ class TestQuerying(testing.PyMOLTestCase):
         # see tests/api/get_version.py
         pass
 
+    def testGetMapCorrelation(self):
+        cmd.load(self.datafile('emd_1155.ccp4'), 'map1')
+        cmd.copy('map2', 'map1')
+        self.assertAlmostEqual(cmd.get_map_correlation('map1', 'map2'), 1.0, delta=1e-4)
+        cmd.map_sharpen('map2', -100.0)
+        cc = cmd.get_map_correlation('map1', 'map2')
+        self.assertGreater(cc, 0.0)
+        self.assertLess(cc, 1.0)
+        cmd.map_halve('map2')
+        with self.assertRaises(CmdException):
+            cmd.get_map_correlation('map1', 'map2')
+
     @testing.requires_version('1.7.3.0')
     def testGetVolumeField(self):
         import numpy
@@ -593,6 +654,36 @@ class TestQuerying(testing.PyMOLTestCase):
     def testPhiPsi(self):
         return self._testGetPhipsi(cmd.phi_psi)
 
+    @testing.requires_version('3.2')
+    def testPickAtoms(self):
+        # ray cast picking, also without an OpenGL context
+        cmd.set('pick_cpu', 2)
+        cmd.viewport(100, 100)
+
+        # single pick
+        cmd.pseudoatom('m1', vdw=2.0)
+        cmd.show_as('spheres')
+        cmd.zoom()
+        self.assertEqual(cmd.pick_atoms(50, 50), [('m1', 1)])
+        cmd.hide('everything')
+        self.assertEqual(cmd.pick_atoms(50, 50), [])
+        cmd.delete('*')
+
+        # rectangle pick
+        cmd.fragment('gly', 'm2')
+        cmd.show_as('sticks')
+        cmd.orient()
+        picked = cmd.pick_atoms(0, 0, 100, 100)
+        self.assertTrue(picked)
+        self.assertTrue(set(picked) <= set(cmd.index('m2')))
+
+        # all states object, atoms are only reported once
+        cmd.create('m2', 'm2', 1, 2)
+        cmd.set('all_states', 1, 'm2')
+        picked_all = cmd.pick_atoms(0, 0, 100, 100)
+        self.assertEqual(len(picked_all), len(set(picked_all)))
+        self.assertEqual(sorted(picked_all), sorted(picked))
+
     @testing.requires_version('2.1')
     def testGetBonds(self):
         self.assertEqual([], cmd.get_bonds())
@@ -423,6 +423,80 @@ class TestViewing(testing.PyMOLTestCase):
         # tested in many other tests
         pass
 
+    @testing.requires_version('3.2')
+    def testRayReusePrimitives(self):
+        self.ambientOnly()
+        cmd.fragment('gly')
+        cmd.show_as('sticks')
+        cmd.color('blue')
+        cmd.orient()
+
+        def render():
+            return self.get_imagearray(width=60, height=50, ray=1)
+
+        # opt-in, the cache holds a copy of all primitives
+        self.assertEqual(cmd.get_setting_int('ray_reuse_primitives'), 0)
+
+        images = []
+        for reuse in (0, 1):
+            cmd.set('ray_reuse_primitives', reuse)
+            view = cmd.get_view()
+            images.append([render()])
+            cmd.turn('y', 30)
+            images[-1].append(render())
+            cmd.set_view(view)
+
+        self.assertTrue((images[0][1] == images[1][1]).all())
+        self.assertFalse((images[1][0] == images[1][1]).all())
+
+        # content changes after a camera-only frame are picked up
+        cmd.color('red')
+        self.assertImageHasColor('red', render())
+        self.assertImageHasNotColor('blue', render())
+
+    @testing.requires_version('3.2')
+    def testRayAmbientOcclusion(self):
+        cmd.fragment('trp')
+        cmd.show_as('spheres')
+        cmd.color('white')
+        cmd.orient()
+
+        def brightness(**settings):
+            for name, value in settings.items():
+                cmd.set(name, value)
+            img = self.get_imagearray(width=60, height=50, ray=1)
+            return img[..., :3].astype(float).sum()
+
+        plain = brightness(ray_ambient_occlusion=0)
+        occluded = brightness(ray_ambient_occlusion=16)
+        self.assertLess(occluded, plain)
+
+        hard = brightness(ray_ambient_occlusion=0, ray_shadows=1)
+        soft = brightness(ray_shadow_softness=5.0, ray_shadow_samples=4)
+        self.assertNotEqual(hard, soft)
+
+    @testing.requires_version('3.2')
+    def testRayAdaptiveAntialias(self):
+        cmd.fragment('trp')
+        cmd.show_as('sticks')
+        cmd.orient()
+
+        def render(antialias, adaptive):
+            cmd.set('antialias', antialias)
+            cmd.set('ray_adaptive_antialias', adaptive)
+            img = self.get_imagearray(width=80, height=60, ray=1)
+            return img[..., :3].astype(float)
+
+        plain = render(0, 0)
+        full = render(2, 0)
+        adaptive = render(2, 1)
+        self.assertEqual(adaptive.shape, full.shape)
+        self.assertLess(abs(adaptive - full).mean(), abs(plain - full).mean())
+
+        # no edge cutoff, full supersampling
+        cmd.set('ray_oversample_cutoff', 0)
+        self.assertTrue((render(2, 1) == full).all())
+
     def testRefresh(self):
         cmd.refresh
         self.skipTest('TODO')
@@ -0,0 +1,39 @@
+'''
+Benchmark reciprocal space (FFT) map filters against the real space paths
+'''
+
+from pymol import cmd, testing
+
+class StressMapFilter(testing.PyMOLTestCase):
+
+    def _load_map(self):
+        # 141 x 91 x 281 grid points
+        cmd.delete('*')
+        cmd.load(self.datafile('emd_1155.ccp4'), 'map1')
+
+    def testSmooth(self):
+        self._load_map()
+
+        with self.timing('real space (map_halve smooth=1)'):
+            cmd.map_halve('map1', smooth=1)
+
+        self._load_map()
+
+        with self.timing('fft (map_sharpen -b)', 5.0):
+            cmd.map_sharpen('map1', -50.0)
+
+    def testLowpass(self):
+        self._load_map()
+
+        with self.timing('fft (map_lowpass)', 5.0):
+            cmd.map_lowpass('map1', 8.0)
+
+    def testCorrelation(self):
+        self._load_map()
+        cmd.copy('map2', 'map1')
+        cmd.map_sharpen('map2', -50.0)
+
+        with self.timing('fft (get_map_correlation)', 5.0):
+            cc = cmd.get_map_correlation('map1', 'map2', resolution=10.0)
+
+        self.assertGreater(cc, 0.0)
@@ -0,0 +1,22 @@
+'''
+Headless draw (software rasterizer) vs. ray tracing at 1080p
+'''
+
+from pymol import cmd, testing
+
+@testing.requires('no_run_all')
+class TestRaster(testing.PyMOLTestCase):
+
+    @testing.foreach.product(['spheres', 'sticks'], [0, 1])
+    @testing.requires_version('3.2')
+    def testHeadlessDraw(self, rep, ray):
+        cmd.load(self.datafile('1aon.pdb.gz'))
+        cmd.show_as(rep)
+        cmd.orient()
+        cmd.set('headless_draw')
+
+        msg = '%s %d atoms %s' % (rep, cmd.count_atoms(),
+                'ray' if ray else 'raster')
+
+        with testing.mktemp('.png') as filename, self.timing(msg):
+            cmd.png(filename, 1920, 1080, ray=ray)